@@ -0,0 +1,71 @@
+#ifndef BENCH_BENCHMARK_H
+#define BENCH_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/**
+ * Benchmark Harness
+ *
+ * Each case is calibrated to a batch of at least MIN_BATCH_NS, then timed over BATCHES
+ * batches. One JSON object per case is written to stdout (JSON Lines), so results can be
+ * stored and diffed against a baseline; progress goes to stderr.
+ */
+class Benchmark {
+  public:
+    static const int BATCHES = 15;
+    static const uint64_t MIN_BATCH_NS = 20 * 1000 * 1000;
+
+    explicit Benchmark(const char* filter) : filter(filter) {}
+
+    // Run fn repeatedly; bytes is the input size processed per call, 0 when not meaningful
+    template <typename Fn>
+    void run(const char* name, size_t bytes, Fn&& fn) {
+        if (filter != nullptr && strstr(name, filter) == nullptr) {
+            return;
+        }
+
+        uint64_t iterations = 1;
+        while (time(fn, iterations) < MIN_BATCH_NS && iterations < (1ull << 30)) {
+            iterations *= 2;
+        }
+
+        std::vector<double> samples;
+        for (int i = 0; i < BATCHES; i++) {
+            samples.push_back((double)time(fn, iterations) / iterations);
+        }
+        std::sort(samples.begin(), samples.end());
+        double median = samples[BATCHES / 2];
+
+        printf("{\"benchmark\":\"%s\",\"iterations\":%llu,\"batches\":%d,\"ns_per_op\":%.1f,\"min_ns\":%.1f,"
+               "\"max_ns\":%.1f,\"bytes_per_op\":%zu}\n",
+               name, (unsigned long long)iterations, BATCHES, median, samples.front(), samples.back(), bytes);
+        fflush(stdout);
+        fprintf(stderr, "%-28s %12.1f ns/op\n", name, median);
+    }
+
+  private:
+    const char* filter;
+
+    template <typename Fn>
+    static uint64_t time(Fn& fn, uint64_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            fn();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+};
+
+// Keep a result alive so the optimizer cannot drop the call that produced it
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif  // BENCH_BENCHMARK_H
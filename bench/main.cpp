@@ -0,0 +1,176 @@
+// Host-native benchmarks for the parsing, time and logging hot paths.
+//
+//   pio run -e native && .pio/build/native/program [--filter <name>] [--data <dir>] > results.jsonl
+//
+// Inputs are read from bench/data (relative to the project directory by default) and are kept
+// frozen, so numbers stay comparable between commits.
+
+#include <Arduino.h>
+#include <cstdio>
+#include <string>
+#include "benchmark.h"
+#include "config_store.h"
+#include "logger.h"
+#include "modules/module.h"
+#include "timezone_utils.h"
+
+// PlatformIO installs ArduinoJson from lib_deps; a plain compiler build without it (see
+// docs/benchmarks.md) skips the forecast cases and runs the rest
+#if __has_include(<ArduinoJson.h>)
+#define BENCH_FORECAST 1
+#include "modules/forecast_parser.h"
+#endif
+
+// Defined in main.cpp on the device
+SemaphoreHandle_t spiMutex = nullptr;
+
+static bool readFile(const std::string& path, std::string& out) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "bench: cannot open %s\n", path.c_str());
+        return false;
+    }
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out.append(buffer, read);
+    }
+    fclose(file);
+    return true;
+}
+
+// Same copy ConfigManager::getConfigSection() makes from its in-memory store
+static modules::ConfigSection copySection(const ConfigStore& store, const char* name) {
+    modules::ConfigSection section;
+    int index = store.findSection(name);
+    for (int i = 0; i < store.getEntryCount(index); i++) {
+        section.keyValuePairs[store.getKey(index, i)] = store.getValue(index, i);
+    }
+    return section;
+}
+
+static void benchConfig(Benchmark& bench, const std::string& ini) {
+    bench.run("config_store_load", ini.size(), [&]() {
+        ConfigStore store;
+        doNotOptimize(store.load(ini.c_str(), ini.size()));
+    });
+
+    ConfigStore store;
+    if (!store.load(ini.c_str(), ini.size())) {
+        fprintf(stderr, "bench: config fixture did not parse\n");
+        return;
+    }
+    bench.run("config_get_section", 0, [&]() {
+        modules::ConfigSection section = copySection(store, "accuweather");
+        doNotOptimize(section.keyValuePairs.size());
+    });
+    bench.run("config_get_value", 0, [&]() { doNotOptimize(store.getValue("clock", "show_seconds")); });
+    bench.run("config_missing_section", 0, [&]() { doNotOptimize(store.findSection("does_not_exist")); });
+}
+
+#ifdef BENCH_FORECAST
+static void benchForecast(Benchmark& bench, const std::string& payload) {
+    // The fixture starts at this hour; skipping it exercises the past-hour filter like on the device
+    const time_t firstHour = 1760446800;
+    MemoryStream stream(payload.data(), payload.size());
+    DynamicJsonDocument entry(modules::ForecastParser::ENTRY_DOCUMENT_SIZE);
+    modules::HourlyForecast forecasts[6];
+
+    stream.rewind();
+    int count = 0;
+    if (modules::ForecastParser::parse(stream, entry, firstHour + 3600, forecasts, 6, count) !=
+            modules::ForecastParser::Result::OK ||
+        count != 6) {
+        fprintf(stderr, "bench: forecast fixture parsed %d entries\n", count);
+        return;
+    }
+
+    // Cut off inside the third hour: must fail without touching the forecasts parsed above
+    size_t cut = 0;
+    for (int i = 0; i < 3 && cut != std::string::npos; i++) {
+        cut = payload.find("{\"DateTime\"", cut + 1);
+    }
+    std::string truncated = payload.substr(0, cut != std::string::npos ? cut + 40 : payload.size() / 4);
+    MemoryStream cutOff(truncated.data(), truncated.size());
+    long firstTime = forecasts[0].time;
+    if (modules::ForecastParser::parse(cutOff, entry, firstHour + 3600, forecasts, 6, count) !=
+            modules::ForecastParser::Result::PARSE_ERROR ||
+        forecasts[0].time != firstTime) {
+        fprintf(stderr, "bench: truncated forecast was not rejected\n");
+        return;
+    }
+
+    bench.run("forecast_parse_6_of_12", payload.size(), [&]() {
+        stream.rewind();
+        doNotOptimize(modules::ForecastParser::parse(stream, entry, firstHour + 3600, forecasts, 6, count));
+    });
+    bench.run("forecast_parse_truncated", truncated.size(), [&]() {
+        cutOff.rewind();
+        doNotOptimize(modules::ForecastParser::parse(cutOff, entry, firstHour + 3600, forecasts, 6, count));
+    });
+    bench.run("forecast_parse_error_object", 0, [&]() {
+        MemoryStream fault("{\"Code\":\"ServiceUnavailable\"}", 29);
+        doNotOptimize(modules::ForecastParser::parse(fault, entry, firstHour, forecasts, 6, count));
+    });
+}
+#endif
+
+static void benchTimezone(Benchmark& bench) {
+    TimezoneUtils::setTimezone("Europe/Kiev");
+    const String systemZone = "Europe/Kiev";
+    const String otherZone = "America/New_York";
+    const String posixZone = "CET-1CEST,M3.5.0,M10.5.0/3";
+    const String fixedZone = "GMT+5";
+
+    bench.run("timezone_offset_system", 0, [&]() { doNotOptimize(TimezoneUtils::getTimezoneOffset(systemZone)); });
+    bench.run("timezone_offset_named", 0, [&]() { doNotOptimize(TimezoneUtils::getTimezoneOffset(otherZone)); });
+    bench.run("timezone_offset_posix", 0, [&]() { doNotOptimize(TimezoneUtils::getTimezoneOffset(posixZone)); });
+    bench.run("timezone_offset_fixed", 0, [&]() { doNotOptimize(TimezoneUtils::getTimezoneOffset(fixedZone)); });
+    bench.run("timezone_offset_at", 0, [&]() { doNotOptimize(TimezoneUtils::getOffsetAt(1760446800)); });
+}
+
+static void benchLogger(Benchmark& bench) {
+    static const char message[] = "[AccuWeather] Forecast 3: time=1760457600, temp=11, humidity=73, icon=4";
+    char line[Logger::LOG_LINE_BUFFER_SIZE];
+
+    bench.run("log_format_timestamp", sizeof(message) - 1, [&]() {
+        doNotOptimize(Logger::formatLogMessage(line, sizeof(line), LogLevel::INFO, message, sizeof(message) - 1,
+                                               123456));
+    });
+    bench.run("log_format_wall_clock", sizeof(message) - 1, [&]() {
+        doNotOptimize(Logger::formatLogMessage(line, sizeof(line), LogLevel::INFO, message, sizeof(message) - 1));
+    });
+}
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    std::string dataDir = "bench/data";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--filter") == 0) {
+            filter = argv[i + 1];
+        } else if (strcmp(argv[i], "--data") == 0) {
+            dataDir = argv[i + 1];
+        }
+    }
+
+    // Keep library logging out of the measurements; the level only sticks once init() made the mutex
+    Logger::getInstance().init(false, false, "");
+    Logger::getInstance().setLogLevel(LogLevel::ERROR);
+
+    std::string ini;
+    std::string payload;
+    if (!readFile(dataDir + "/bench_config.ini", ini) || !readFile(dataDir + "/accuweather_hourly_12h.json", payload)) {
+        return 1;
+    }
+
+    Benchmark bench(filter);
+    benchConfig(bench, ini);
+#ifdef BENCH_FORECAST
+    benchForecast(bench, payload);
+#else
+    fprintf(stderr, "bench: built without ArduinoJson, forecast cases skipped\n");
+#endif
+    benchTimezone(bench);
+    benchLogger(bench);
+    return 0;
+}
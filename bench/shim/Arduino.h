@@ -0,0 +1,50 @@
+#ifndef BENCH_SHIM_ARDUINO_H
+#define BENCH_SHIM_ARDUINO_H
+
+// Minimal Arduino core for the native benchmark environment. Only what the sources listed in
+// the [env:native] build_src_filter need; anything hardware related is a no-op.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <thread>
+#include "Print.h"
+#include "Stream.h"
+#include "WString.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define F(text) (text)
+#define PSTR(text) (text)
+#define IRAM_ATTR
+
+#define HIGH 1
+#define LOW 0
+
+inline unsigned long micros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+inline unsigned long millis() { return micros() / 1000; }
+
+inline void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+// Console output goes to stderr, keeping stdout for benchmark results
+class HardwareSerial : public Print {
+  public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override { return fputc(c, stderr) == EOF ? 0 : 1; }
+    size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, stderr); }
+    using Print::write;
+};
+
+inline HardwareSerial Serial;
+
+#endif  // BENCH_SHIM_ARDUINO_H
@@ -0,0 +1,24 @@
+#ifndef BENCH_SHIM_FS_H
+#define BENCH_SHIM_FS_H
+
+#include <Arduino.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+// No file system natively: every file fails to open
+class File : public Stream {
+  public:
+    explicit operator bool() const { return false; }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t) override { return 0; }
+    size_t write(const uint8_t*, size_t) override { return 0; }
+    size_t size() const { return 0; }
+    void flush() {}
+    void close() {}
+};
+
+#endif  // BENCH_SHIM_FS_H
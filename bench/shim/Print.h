@@ -0,0 +1,43 @@
+#ifndef BENCH_SHIM_PRINT_H
+#define BENCH_SHIM_PRINT_H
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "WString.h"
+
+class Print {
+  public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t written = 0;
+        while (written < size && write(buffer[written])) {
+            written++;
+        }
+        return written;
+    }
+
+    size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t println(const char* text) { return print(text) + write("\r\n"); }
+    size_t println(const String& text) { return println(text.c_str()); }
+    size_t println() { return write("\r\n"); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        if (length < 0) {
+            return 0;
+        }
+        return write((const uint8_t*)buffer, (size_t)length < sizeof(buffer) ? length : sizeof(buffer) - 1);
+    }
+};
+
+#endif  // BENCH_SHIM_PRINT_H
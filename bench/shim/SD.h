@@ -0,0 +1,16 @@
+#ifndef BENCH_SHIM_SD_H
+#define BENCH_SHIM_SD_H
+
+#include "FS.h"
+
+class SDFS {
+  public:
+    bool begin(...) { return false; }
+    File open(const String&, const char* = FILE_READ) { return File(); }
+    bool exists(const String&) { return false; }
+    bool remove(const String&) { return false; }
+};
+
+inline SDFS SD;
+
+#endif  // BENCH_SHIM_SD_H
@@ -0,0 +1,69 @@
+#ifndef BENCH_SHIM_STREAM_H
+#define BENCH_SHIM_STREAM_H
+
+#include "Print.h"
+
+// Reading side of the Arduino Stream, without timeouts: a read past the end fails at once
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t write(uint8_t) override { return 0; }
+
+    size_t readBytes(char* buffer, size_t length) {
+        size_t count = 0;
+        while (count < length) {
+            int c = read();
+            if (c < 0) {
+                break;
+            }
+            buffer[count++] = (char)c;
+        }
+        return count;
+    }
+
+    bool find(const char* target) { return findUntil(target, nullptr); }
+
+    // Consume input up to and including target; false at the terminator or the end
+    bool findUntil(const char* target, const char* terminator) {
+        size_t targetLength = strlen(target);
+        size_t terminatorLength = terminator != nullptr ? strlen(terminator) : 0;
+        size_t targetMatched = 0;
+        size_t terminatorMatched = 0;
+        int c;
+        while ((c = read()) >= 0) {
+            targetMatched = c == target[targetMatched] ? targetMatched + 1 : (c == target[0] ? 1 : 0);
+            if (targetMatched == targetLength) {
+                return true;
+            }
+            if (terminatorLength > 0) {
+                terminatorMatched = c == terminator[terminatorMatched] ? terminatorMatched + 1
+                                                                      : (c == terminator[0] ? 1 : 0);
+                if (terminatorMatched == terminatorLength) {
+                    return false;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+// Stream over a caller-owned buffer, rewound between benchmark iterations
+class MemoryStream : public Stream {
+  public:
+    MemoryStream(const char* data, size_t size) : data(data), size(size) {}
+
+    void rewind() { position = 0; }
+    int available() override { return (int)(size - position); }
+    int read() override { return position < size ? (uint8_t)data[position++] : -1; }
+    int peek() override { return position < size ? (uint8_t)data[position] : -1; }
+
+  private:
+    const char* data;
+    size_t size;
+    size_t position = 0;
+};
+
+#endif  // BENCH_SHIM_STREAM_H
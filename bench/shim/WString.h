@@ -0,0 +1,103 @@
+#ifndef BENCH_SHIM_WSTRING_H
+#define BENCH_SHIM_WSTRING_H
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Arduino String for the native environment, backed by std::string. Covers what the sources
+// built into the benchmark use; allocation behaviour differs from the ESP32 core.
+class String {
+  public:
+    String(const char* text = "") : value(text != nullptr ? text : "") {}
+    String(const std::string& text) : value(text) {}
+    String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+    String(float number, unsigned int decimals = 2) : value(format(number, decimals)) {}
+    String(double number, unsigned int decimals = 2) : value(format(number, decimals)) {}
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.length(); }
+    bool isEmpty() const { return value.empty(); }
+    bool reserve(unsigned int size) {
+        value.reserve(size);
+        return true;
+    }
+
+    char charAt(unsigned int index) const { return index < value.size() ? value[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    bool equals(const String& other) const { return value == other.value; }
+    bool equalsIgnoreCase(const String& other) const { return strcasecmp(c_str(), other.c_str()) == 0; }
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+    bool endsWith(const String& suffix) const {
+        return value.size() >= suffix.value.size() &&
+               value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return position(value.find(c, from)); }
+    int indexOf(const String& text, unsigned int from = 0) const { return position(value.find(text.value, from)); }
+    int lastIndexOf(char c) const { return position(value.rfind(c)); }
+    String substring(unsigned int from) const { return from < value.size() ? String(value.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < to && from < value.size() ? String(value.substr(from, to - from)) : String();
+    }
+
+    void trim() {
+        size_t start = value.find_first_not_of(" \t\r\n");
+        size_t end = value.find_last_not_of(" \t\r\n");
+        value = start == std::string::npos ? std::string() : value.substr(start, end - start + 1);
+    }
+    void toLowerCase() {
+        for (char& c : value) {
+            c = (char)tolower((unsigned char)c);
+        }
+    }
+    void toUpperCase() {
+        for (char& c : value) {
+            c = (char)toupper((unsigned char)c);
+        }
+    }
+    void replace(const String& from, const String& to) {
+        if (from.value.empty()) {
+            return;
+        }
+        for (size_t at = value.find(from.value); at != std::string::npos; at = value.find(from.value, at + to.value.size())) {
+            value.replace(at, from.value.size(), to.value);
+        }
+    }
+
+    long toInt() const { return strtol(c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(c_str(), nullptr); }
+
+    String& operator+=(const String& other) {
+        value += other.value;
+        return *this;
+    }
+    bool concat(const char* text, unsigned int length) {
+        value.append(text, length);
+        return true;
+    }
+
+    friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+    friend bool operator==(const String& a, const String& b) { return a.value == b.value; }
+    friend bool operator!=(const String& a, const String& b) { return a.value != b.value; }
+    friend bool operator<(const String& a, const String& b) { return a.value < b.value; }
+
+  private:
+    std::string value;
+
+    static int position(size_t at) { return at == std::string::npos ? -1 : (int)at; }
+    static std::string format(double number, unsigned int decimals) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, number);
+        return buffer;
+    }
+};
+
+#endif  // BENCH_SHIM_WSTRING_H
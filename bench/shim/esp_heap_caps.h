@@ -0,0 +1,17 @@
+#ifndef BENCH_SHIM_ESP_HEAP_CAPS_H
+#define BENCH_SHIM_ESP_HEAP_CAPS_H
+
+#include <cstddef>
+#include <cstdlib>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+inline void* heap_caps_malloc(size_t size, unsigned) { return malloc(size); }
+inline void* heap_caps_calloc(size_t count, size_t size, unsigned) { return calloc(count, size); }
+inline void* heap_caps_realloc(void* ptr, size_t size, unsigned) { return realloc(ptr, size); }
+inline void heap_caps_free(void* ptr) { free(ptr); }
+
+#endif  // BENCH_SHIM_ESP_HEAP_CAPS_H
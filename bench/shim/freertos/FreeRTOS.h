@@ -0,0 +1,25 @@
+#ifndef BENCH_SHIM_FREERTOS_H
+#define BENCH_SHIM_FREERTOS_H
+
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffffu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configMAX_TASK_NAME_LEN 16
+#define tskNO_AFFINITY 0x7fffffff
+
+// The benchmark is single threaded; critical sections compile away
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define taskENTER_CRITICAL(mux) ((void)(mux))
+#define taskEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif  // BENCH_SHIM_FREERTOS_H
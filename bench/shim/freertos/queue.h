@@ -0,0 +1,8 @@
+#ifndef BENCH_SHIM_QUEUE_H
+#define BENCH_SHIM_QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef void* QueueHandle_t;
+
+#endif  // BENCH_SHIM_QUEUE_H
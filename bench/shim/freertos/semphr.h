@@ -0,0 +1,28 @@
+#ifndef BENCH_SHIM_SEMPHR_H
+#define BENCH_SHIM_SEMPHR_H
+
+#include <chrono>
+#include <mutex>
+#include "FreeRTOS.h"
+
+typedef std::timed_mutex* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::timed_mutex(); }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    if (semaphore == nullptr) {
+        return pdFALSE;
+    }
+    if (ticks == portMAX_DELAY) {
+        semaphore->lock();
+        return pdTRUE;
+    }
+    return semaphore->try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    semaphore->unlock();
+    return pdTRUE;
+}
+
+#endif  // BENCH_SHIM_SEMPHR_H
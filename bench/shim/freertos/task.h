@@ -0,0 +1,16 @@
+#ifndef BENCH_SHIM_TASK_H
+#define BENCH_SHIM_TASK_H
+
+#include "FreeRTOS.h"
+
+// No scheduler natively: tasks are never created and notifications go nowhere
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+inline void xTaskNotifyGive(TaskHandle_t) {}
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+inline void vTaskDelay(TickType_t) {}
+inline void vTaskDelete(TaskHandle_t) {}
+
+#endif  // BENCH_SHIM_TASK_H
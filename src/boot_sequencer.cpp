@@ -0,0 +1,93 @@
+#include "boot_sequencer.h"
+#include <esp_timer.h>
+#include "event_manager.h"
+#include "logger.h"
+
+#define BOOT_BIT(stage) (1u << (int)BootSequencer::Stage::stage)
+
+const BootSequencer::StageInfo BootSequencer::STAGES[(int)Stage::COUNT] = {
+    {"setup", 0},
+    {"config", 0},
+    {"wifi", BOOT_BIT(CONFIG)},
+    {"time", BOOT_BIT(WIFI)},
+    {"modules", BOOT_BIT(CONFIG)},
+    {"dashboard", BOOT_BIT(MODULES) | BOOT_BIT(WIFI)},
+};
+
+EventGroupHandle_t BootSequencer::group = NULL;
+int64_t BootSequencer::startedUs[(int)Stage::COUNT];
+int64_t BootSequencer::completedUs[(int)Stage::COUNT];
+
+void BootSequencer::initialize() {
+    if (group != NULL) {
+        return;
+    }
+    group = xEventGroupCreate();
+    for (int i = 0; i < (int)Stage::COUNT; i++) {
+        startedUs[i] = -1;
+        completedUs[i] = -1;
+    }
+    startedUs[(int)Stage::SETUP] = esp_timer_get_time();
+}
+
+void BootSequencer::begin(Stage stage) {
+    uint32_t dependencies = STAGES[(int)stage].dependencies;
+    if (dependencies != 0) {
+        xEventGroupWaitBits(group, dependencies, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    startedUs[(int)stage] = esp_timer_get_time();
+}
+
+void BootSequencer::complete(Stage stage) {
+    int index = (int)stage;
+    if (isComplete(stage)) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    completedUs[index] = now;
+
+    // Stages finished elsewhere without begin() start when their last dependency completed
+    if (startedUs[index] < 0) {
+        startedUs[index] = 0;
+        for (int i = 0; i < (int)Stage::COUNT; i++) {
+            if ((STAGES[index].dependencies & (1u << i)) && completedUs[i] > startedUs[index]) {
+                startedUs[index] = completedUs[i];
+            }
+        }
+    }
+
+    LOG_INFOF("Boot: %s done at %lu ms\n", STAGES[index].name, (unsigned long)(now / 1000));
+    String progress = String(STAGES[index].name) + " +" + String((unsigned long)(now / 1000)) + "ms";
+    EventManager::Emit(TerminalEvent(0, "BOOT", progress,
+                                     stage == Stage::DASHBOARD ? TerminalEvent::State::SUCCESS
+                                                               : TerminalEvent::State::PROCESSING));
+
+    xEventGroupSetBits(group, bitOf(stage));
+
+    if (stage == Stage::DASHBOARD) {
+        logTrace();
+    }
+}
+
+bool BootSequencer::isComplete(Stage stage) {
+    return group != NULL && (xEventGroupGetBits(group) & bitOf(stage)) != 0;
+}
+
+bool BootSequencer::waitFor(Stage stage, TickType_t timeout) {
+    return (xEventGroupWaitBits(group, bitOf(stage), pdFALSE, pdTRUE, timeout) & bitOf(stage)) != 0;
+}
+
+void BootSequencer::logTrace() {
+    // Times in ms since power-on
+    LOG_INFO("Boot trace:");
+    for (int i = 0; i < (int)Stage::COUNT; i++) {
+        if (completedUs[i] < 0) {
+            LOG_INFOF("  %-10s not complete\n", STAGES[i].name);
+            continue;
+        }
+        LOG_INFOF("  %-10s start %6lu  done %6lu  took %6lu ms\n", STAGES[i].name,
+                  (unsigned long)(startedUs[i] / 1000), (unsigned long)(completedUs[i] / 1000),
+                  (unsigned long)((completedUs[i] - startedUs[i]) / 1000));
+    }
+}
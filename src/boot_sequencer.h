@@ -0,0 +1,54 @@
+#ifndef BOOT_SEQUENCER_H
+#define BOOT_SEQUENCER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+/**
+ * Boot Sequencer
+ *
+ * Explicit boot graph. Every stage declares the stages it depends on in one table; a task
+ * calls begin() to block on an event group until those are complete (no readiness polling),
+ * then complete() to release its dependents. Start and completion times are recorded from
+ * power-on, and once the dashboard is up the whole trace is written to the log. Progress is
+ * also shown on a single terminal line while booting.
+ */
+class BootSequencer {
+  public:
+    enum class Stage : uint8_t {
+        SETUP,      // setup(): hardware init and task creation
+        CONFIG,     // SD card mounted and configuration parsed
+        WIFI,       // First connection to the access point
+        TIME,       // Wall clock set by SNTP
+        MODULES,    // All modules instantiated
+        DASHBOARD,  // Dashboard shown for the first time
+        COUNT
+    };
+
+    // Call first thing in setup()
+    static void initialize();
+
+    // Block until every dependency of the stage is complete, then mark it started
+    static void begin(Stage stage);
+    static void complete(Stage stage);
+
+    static bool isComplete(Stage stage);
+    static bool waitFor(Stage stage, TickType_t timeout = portMAX_DELAY);
+
+  private:
+    struct StageInfo {
+        const char* name;
+        uint32_t dependencies;  // Bit mask of stages
+    };
+
+    static const StageInfo STAGES[(int)Stage::COUNT];
+    static EventGroupHandle_t group;
+    static int64_t startedUs[(int)Stage::COUNT];
+    static int64_t completedUs[(int)Stage::COUNT];
+
+    static EventBits_t bitOf(Stage stage) { return 1u << (int)stage; }
+    static void logTrace();
+};
+
+#endif  // BOOT_SEQUENCER_H
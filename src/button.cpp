@@ -1,36 +1,145 @@
 #include "button.h"
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include <hal/gpio_ll.h>
 #include "logger.h"
 #include "config.h"
 #include "event_manager.h"
 
-void Button::Setup() { pinMode(BUTTON_PIN, INPUT_PULLUP); }
+const Button::Input Button::INPUTS[] = {
+    {1, BUTTON_PIN, true, 300},
+};
+const int Button::INPUT_COUNT = sizeof(INPUTS) / sizeof(INPUTS[0]);
+
+TaskHandle_t Button::taskHandle = nullptr;
+Button::State Button::states[sizeof(INPUTS) / sizeof(INPUTS[0])] = {};
+volatile bool Button::levelWakeup = false;
+
+void Button::Setup() {
+    for (int i = 0; i < INPUT_COUNT; i++) {
+        pinMode(INPUTS[i].pin, INPUTS[i].activeLow ? INPUT_PULLUP : INPUT_PULLDOWN);
+        states[i].pressed = readPressed(INPUTS[i]);
+    }
+}
+
+void Button::EnableWakeup() {
+    // A fixed "pressed" level would keep firing for as long as the button is held
+    for (int i = 0; i < INPUT_COUNT; i++) {
+        gpio_num_t pin = (gpio_num_t)INPUTS[i].pin;
+        gpio_wakeup_enable(pin, digitalRead(pin) == HIGH ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+    levelWakeup = true;
+    esp_sleep_enable_gpio_wakeup();
+}
+
+void IRAM_ATTR Button::armOppositeLevel(uint8_t pin) {
+    // Register access only, the GPIO driver takes a lock that is not meant for interrupt context
+    gpio_dev_t* hw = GPIO_LL_GET_HW(GPIO_PORT_0);
+    gpio_ll_set_intr_type(hw, pin, gpio_ll_get_level(hw, pin) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+}
+
+void IRAM_ATTR Button::onEdge(void* arg) {
+    // Interrupts are attached by the task after taskHandle is set
+    uint32_t index = (uint32_t)(uintptr_t)arg;
+    if (levelWakeup) {
+        armOppositeLevel(INPUTS[index].pin);
+    }
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(taskHandle, 1u << index, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+bool Button::readPressed(const Input& input) { return (digitalRead(input.pin) == LOW) == input.activeLow; }
 
 void Button::Run() {
     LOG_DEBUG("Button Run");
+    if (INPUT_COUNT > MAX_INPUTS) {
+        LOG_ERROR("Button: Too many inputs for the notification bits");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    taskHandle = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < INPUT_COUNT; i++) {
+        attachInterruptArg(INPUTS[i].pin, onEdge, (void*)(uintptr_t)i, CHANGE);
+    }
+    if (levelWakeup) {
+        // Attaching put the edge type back, which does not wake the chip
+        EnableWakeup();
+    }
+    LOG_INFOF("Button: %d input(s) on edge interrupts\n", INPUT_COUNT);
+
     while (true) {
-        static uint32_t pressStartTime = 0;
-        static bool lastState = LOW;
-
-        bool currentState = digitalRead(BUTTON_PIN) == LOW;
-
-        if (currentState == HIGH && lastState == LOW) {
-            pressStartTime = millis();
-            lastState = HIGH;
-        } else if (currentState == LOW && lastState == HIGH) {
-            lastState = LOW;
-            uint32_t pressDuration = millis() - pressStartTime;
-
-            if (pressDuration < BUTTON_LONG_PRESS_TIME) {
-                // Emit ButtonShortPressEvent with button ID and duration
-                ButtonShortPressEvent event(1, pressDuration);
-                EventManager::Emit(event);
-            } else {
-                // Emit ButtonLongPressEvent with button ID and duration
-                ButtonLongPressEvent event(1, pressDuration);
-                EventManager::Emit(event);
+        // Sleep until an edge, or until the earliest pending level has settled
+        uint32_t now = millis();
+        TickType_t timeout = portMAX_DELAY;
+        for (int i = 0; i < INPUT_COUNT; i++) {
+            if (!states[i].pending) {
+                continue;
+            }
+            int32_t remaining = (int32_t)(states[i].settleAt - now);
+            TickType_t ticks = remaining > 0 ? pdMS_TO_TICKS(remaining) + 1 : 0;
+            if (ticks < timeout) {
+                timeout = ticks;
+            }
+        }
+
+        uint32_t edges = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &edges, timeout);
+
+        // Every bounce pushes the deadline out again
+        now = millis();
+        for (int i = 0; i < INPUT_COUNT; i++) {
+            if (edges & (1u << i)) {
+                states[i].pending = true;
+                states[i].settleAt = now + DEBOUNCE_MS;
+            }
+            if (states[i].pending && (int32_t)(now - states[i].settleAt) >= 0) {
+                settle(i, now);
             }
         }
+    }
+}
+
+void Button::settle(int index, uint32_t now) {
+    const Input& input = INPUTS[index];
+    State& state = states[index];
+    state.pending = false;
+
+    bool pressed = readPressed(input);
+    if (pressed == state.pressed) {
+        return;  // Bounced back to where it was
+    }
+    state.pressed = pressed;
+
+    // Timestamps exclude the debounce delay, which is the same for both edges
+    uint32_t at = now - DEBOUNCE_MS;
+    if (pressed) {
+        state.pressedAt = at;
+        state.doublePress = input.doublePressMs > 0 && state.windowOpen && at - state.releasedAt <= input.doublePressMs;
+    } else {
+        onRelease(input, state, at);
+    }
+}
+
+void Button::onRelease(const Input& input, State& state, uint32_t now) {
+    uint32_t pressDuration = now - state.pressedAt;
 
-        vTaskDelay(pdMS_TO_TICKS(50));
+    if (pressDuration >= BUTTON_LONG_PRESS_TIME) {
+        // Emit ButtonLongPressEvent with button ID and duration
+        state.windowOpen = false;
+        ButtonLongPressEvent event(input.id, pressDuration);
+        EventManager::Emit(event);
+    } else if (state.doublePress) {
+        // A double press closes the window, a third tap starts a new one
+        state.windowOpen = false;
+        ButtonDoublePressEvent event(input.id, pressDuration);
+        EventManager::Emit(event);
+    } else {
+        // Emit ButtonShortPressEvent with button ID and duration
+        state.windowOpen = true;
+        state.releasedAt = now;
+        ButtonShortPressEvent event(input.id, pressDuration);
+        EventManager::Emit(event);
     }
 }
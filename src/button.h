@@ -2,6 +2,8 @@
 #define BUTTON_H
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include "logger.h"
 #include "pins.h"
 
@@ -9,10 +11,62 @@
 class EventManager;
 class Config;
 
+/**
+ * Button Input
+ *
+ * Each entry of the button table gets a GPIO edge interrupt that only notifies the button task
+ * (one notification bit per button). The task sleeps until an edge arrives, then waits for the
+ * line to stay quiet for DEBOUNCE_MS before it accepts the new level, so the task costs nothing
+ * while no button is touched and no tap is shorter than one polling period any more.
+ *
+ * Presses are classified on release from the debounced timestamps: held BUTTON_LONG_PRESS_TIME
+ * or longer is a long press, otherwise a short press, and a short press that starts within
+ * doublePressMs of the previous short release is reported as a double press instead.
+ */
 class Button {
   public:
     static void Setup();
     static void Run();
+
+    // Let a press wake the chip from light sleep. Light sleep only wakes on a level, so from here
+    // on each input's interrupt waits for the level opposite to its current one and is flipped
+    // again on every change; that wakes on press and release alike and still fires once per edge.
+    static void EnableWakeup();
+
+  private:
+    // One physical input; add rows to the table in button.cpp for more buttons
+    struct Input {
+        int id;                   // button_id carried by the events
+        uint8_t pin;
+        bool activeLow;
+        uint16_t doublePressMs;   // 0 disables double press detection
+    };
+
+    // Runtime state per input, touched by the button task only
+    struct State {
+        bool pressed;             // Debounced level
+        bool pending;             // Edge seen, waiting for the line to settle
+        bool doublePress;         // Current press started inside the double press window
+        bool windowOpen;          // Last release was a short press that a double press may follow
+        uint32_t settleAt;        // millis() at which a pending level is accepted
+        uint32_t pressedAt;
+        uint32_t releasedAt;
+    };
+
+    static const Input INPUTS[];
+    static const int INPUT_COUNT;
+    static const int MAX_INPUTS = 32;  // One notification bit per input
+    static const uint32_t DEBOUNCE_MS = 20;
+
+    static TaskHandle_t taskHandle;
+    static State states[];
+    static volatile bool levelWakeup;  // Interrupts are level-triggered for light sleep wake-up
+
+    static void IRAM_ATTR onEdge(void* arg);
+    static void IRAM_ATTR armOppositeLevel(uint8_t pin);
+    static bool readPressed(const Input& input);
+    static void settle(int index, uint32_t now);
+    static void onRelease(const Input& input, State& state, uint32_t now);
 };
 
-#endif  // BUTTON_H
\ No newline at end of file
+#endif  // BUTTON_H
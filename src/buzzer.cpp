@@ -1,80 +1,181 @@
 #include "buzzer.h"
 #include "logger.h"
+#include "config.h"
+#include "power_manager.h"
+
+extern Config config;
+
+namespace {
+const Buzzer::Tone clickTones[] = {{1000, 50, 100}};
+const Buzzer::Tone alarmOnTones[] = {{800, 100, 100}, {0, 200, 0}, {800, 100, 100}, {0, 200, 0}, {800, 100, 100}};
+const Buzzer::Tone alarmOffTones[] = {{200, 500, 100}};
+
+template <size_t N>
+constexpr uint8_t countOf(const Buzzer::Tone (&)[N]) {
+    return N;
+}
+}  // namespace
+
+const Buzzer::Pattern Buzzer::BUTTON_CLICK = {"click", clickTones, countOf(clickTones), Priority::CLICK};
+const Buzzer::Pattern Buzzer::ALARM_ON = {"alarm on", alarmOnTones, countOf(alarmOnTones), Priority::ALARM};
+const Buzzer::Pattern Buzzer::ALARM_OFF = {"alarm off", alarmOffTones, countOf(alarmOffTones), Priority::ALARM};
 
 // Static member variable definitions
-uint8_t Buzzer::volume = 200;
-Buzzer::SoundType Buzzer::currentSound = Buzzer::SoundType::NONE;
-uint8_t Buzzer::soundStep = 0;
+SemaphoreHandle_t Buzzer::sequencerMutex = NULL;
+esp_timer_handle_t Buzzer::stepTimer = nullptr;
+const Buzzer::Pattern* Buzzer::current = nullptr;
+uint8_t Buzzer::currentStep = 0;
+int64_t Buzzer::stepEndUs = 0;
+const Buzzer::Pattern* Buzzer::queued[Buzzer::QUEUE_LENGTH] = {};
+int Buzzer::queuedCount = 0;
 
 void Buzzer::Setup() {
     pinMode(BUZZER_PIN, OUTPUT);
-    // digitalWrite(BUZZER_PIN, LOW);
 
-    delay(1000);
+    ledcSetup(LEDC_CHANNEL, 1000, LEDC_RESOLUTION_BITS);
+    ledcAttachPin(BUZZER_PIN, LEDC_CHANNEL);
+    ledcWrite(LEDC_CHANNEL, 0);
+
+    sequencerMutex = xSemaphoreCreateMutex();
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = onStepTimer;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "buzzer";
+    if (sequencerMutex == NULL || esp_timer_create(&timerArgs, &stepTimer) != ESP_OK) {
+        stepTimer = nullptr;
+        LOG_ERROR("Buzzer: Sequencer unavailable, buzzer stays silent");
+        return;
+    }
+
+    // Queued so the button task never waits on sound handling
+    EventManager::Subscribe<ButtonShortPressEvent>(on_button_press, EventManager::Delivery::QUEUED);
+    EventManager::Subscribe<CriticalAlarmEvent>(on_alarm_on, EventManager::Delivery::QUEUED);
+    EventManager::Subscribe<CriticalAlarmOffEvent>(on_alarm_off, EventManager::Delivery::QUEUED);
+    EventManager::Subscribe<ConfigChangedEvent>(on_config_changed);
+}
+
+bool Buzzer::Play(const Pattern& pattern) {
+    if (!config.buzzer.enabled || stepTimer == nullptr || pattern.stepCount == 0) {
+        return false;
+    }
 
-    ledcSetup(0, 1000, 8);
-    ledcAttachPin(BUZZER_PIN, 0);
+    xSemaphoreTake(sequencerMutex, portMAX_DELAY);
+    bool accepted = true;
+    if (current == nullptr || pattern.priority >= current->priority) {
+        startPattern(pattern);
+    } else if (queuedCount < QUEUE_LENGTH) {
+        queued[queuedCount++] = &pattern;
+    } else {
+        accepted = false;
+    }
+    xSemaphoreGive(sequencerMutex);
 
-    // Subscribe to new event classes
-    EventManager::Subscribe<ButtonShortPressEvent>(on_button_press);
-    EventManager::Subscribe<CriticalAlarmEvent>(on_alarm_on);
-    EventManager::Subscribe<CriticalAlarmOffEvent>(on_alarm_off);
+    if (!accepted) {
+        LOG_DEBUGF("Buzzer: %s dropped, queue full\n", pattern.name);
+    }
+    return accepted;
 }
 
-void Buzzer::Run() {
-    LOG_DEBUG("Buzzer Run");
-    while (true) {
-        if (currentSound != SoundType::NONE) {
-            switch (currentSound) {
-                case SoundType::BUTTON:
-                    beep(50, 1000);
-                    currentSound = SoundType::NONE;
-                    break;
-
-                case SoundType::ALARM_ON:
-                    if (soundStep < 3) {
-                        beep(100, 800);
-                        soundStep++;
-                    } else {
-                        currentSound = SoundType::NONE;
-                        soundStep = 0;
-                    }
-                    break;
-
-                case SoundType::ALARM_OFF:
-                    beep(500, 200);
-                    currentSound = SoundType::NONE;
-                    break;
-
-                default:
-                    break;
+void Buzzer::Stop() {
+    if (stepTimer == nullptr) {
+        return;
+    }
+    xSemaphoreTake(sequencerMutex, portMAX_DELAY);
+    esp_timer_stop(stepTimer);
+    current = nullptr;
+    queuedCount = 0;
+    silence();
+    xSemaphoreGive(sequencerMutex);
+}
+
+void Buzzer::onStepTimer(void* arg) {
+    xSemaphoreTake(sequencerMutex, portMAX_DELAY);
+
+    // A callback that fired just as its pattern was cut off finds a step that is not over yet
+    if (current != nullptr && esp_timer_get_time() >= stepEndUs) {
+        currentStep++;
+        if (currentStep < current->stepCount) {
+            playStep();
+        } else {
+            current = nullptr;
+            if (!startNextQueued()) {
+                silence();
             }
         }
+    }
 
-        vTaskDelay(200 / portTICK_PERIOD_MS);
+    xSemaphoreGive(sequencerMutex);
+}
+
+void Buzzer::startPattern(const Pattern& pattern) {
+    current = &pattern;
+    currentStep = 0;
+    PowerManager::SetBuzzerActive(true);
+    playStep();
+}
+
+void Buzzer::playStep() {
+    const Tone& tone = current->steps[currentStep];
+
+    uint32_t duty = MAX_DUTY * (uint32_t)config.buzzer.volume / 100 * tone.level / 100;
+    if (tone.frequencyHz == 0 || duty == 0) {
+        ledcWrite(LEDC_CHANNEL, 0);
+    } else {
+        ledcSetup(LEDC_CHANNEL, tone.frequencyHz, LEDC_RESOLUTION_BITS);
+        ledcWrite(LEDC_CHANNEL, duty);
     }
+
+    // Deadline first, so the callback of this very step never reads as stale
+    stepEndUs = esp_timer_get_time() + (int64_t)tone.durationMs * 1000;
+    esp_timer_stop(stepTimer);
+    esp_timer_start_once(stepTimer, (uint64_t)tone.durationMs * 1000);
+}
+
+bool Buzzer::startNextQueued() {
+    if (queuedCount == 0) {
+        return false;
+    }
+
+    // Highest priority first, oldest first among equals
+    int next = 0;
+    for (int i = 1; i < queuedCount; i++) {
+        if (queued[i]->priority > queued[next]->priority) {
+            next = i;
+        }
+    }
+    const Pattern* pattern = queued[next];
+    for (int i = next; i < queuedCount - 1; i++) {
+        queued[i] = queued[i + 1];
+    }
+    queuedCount--;
+
+    startPattern(*pattern);
+    return true;
+}
+
+void Buzzer::silence() {
+    ledcWrite(LEDC_CHANNEL, 0);
+    PowerManager::SetBuzzerActive(false);
 }
 
 void Buzzer::on_button_press(const ButtonShortPressEvent& event) {
     LOG_DEBUGF("Button press - ID: %d, Duration: %lu ms", event.button_id, event.press_duration_ms);
-    currentSound = SoundType::BUTTON;
+    Play(BUTTON_CLICK);
 }
 
 void Buzzer::on_alarm_on(const CriticalAlarmEvent& event) {
     LOG_WARNINGF("Alarm ON - Message: %s, Severity: %d", event.alarm_message, event.severity_level);
-    currentSound = SoundType::ALARM_ON;
-    soundStep = 0;
+    Play(ALARM_ON);
 }
 
 void Buzzer::on_alarm_off(const CriticalAlarmOffEvent& event) {
     LOG_INFOF("Alarm OFF - Reason: %s", event.reason);
-    currentSound = SoundType::ALARM_OFF;
+    Play(ALARM_OFF);
 }
 
-void Buzzer::beep(uint32_t duration_ms, uint32_t frequency_hz) {
-    LOG_DEBUGF("Beep: %d, %d", duration_ms, frequency_hz);
-    ledcWriteTone(0, frequency_hz);
-    ledcWrite(0, Buzzer::volume);
-    vTaskDelay(pdMS_TO_TICKS(duration_ms));
-    ledcWrite(0, 0);
+void Buzzer::on_config_changed(const ConfigChangedEvent& event) {
+    // Volume is read on every step; only turning the buzzer off needs to act right away
+    if (strcasecmp(event.section, "buzzer") == 0 && !config.buzzer.enabled) {
+        Stop();
+    }
 }
@@ -3,28 +3,82 @@
 
 #include <Arduino.h>
 #include "logger.h"
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
+#include <freertos/semphr.h>
 #include "event_manager.h"
 #include "pins.h"
 
+/**
+ * Buzzer Tone Sequencer
+ *
+ * Plays tone patterns on the LEDC channel of the buzzer pin without a task of its own: starting a
+ * pattern writes its first step and arms an esp_timer one-shot, whose callback writes the next step
+ * and re-arms, until the pattern ends. Play() returns at once, so event handlers never wait on a
+ * sound.
+ *
+ * Every pattern has a priority. One of at least the playing pattern's priority cuts it off and
+ * starts right away (a new click restarts a click, an alarm interrupts anything); a lower one waits
+ * in a short queue and plays after, highest priority first. [buzzer] volume scales every step and
+ * enabled=false silences the buzzer, both applied live. Thread-safe.
+ */
 class Buzzer {
   public:
+    enum class Priority : uint8_t { CLICK, ALARM };
+
+    // One step; frequency 0 is a rest. Level is a percentage of the configured volume.
+    struct Tone {
+        uint16_t frequencyHz;
+        uint16_t durationMs;
+        uint8_t level;
+    };
+
+    struct Pattern {
+        const char* name;
+        const Tone* steps;
+        uint8_t stepCount;
+        Priority priority;
+    };
+
+    static const Pattern BUTTON_CLICK;
+    static const Pattern ALARM_ON;
+    static const Pattern ALARM_OFF;
+
     static void Setup();
-    static void Run();
+
+    // Start or queue a pattern; false when the buzzer is disabled or the queue is full
+    static bool Play(const Pattern& pattern);
+
+    // Silence the buzzer and drop everything queued
+    static void Stop();
 
   private:
-    enum class SoundType { NONE, BUTTON, ALARM_ON, ALARM_OFF };
+    static const int LEDC_CHANNEL = 0;
+    // Kept for every tone: ledcWriteTone() would switch the channel to 10 bits behind our back
+    static const int LEDC_RESOLUTION_BITS = 8;
+    static const uint32_t MAX_DUTY = 1u << (LEDC_RESOLUTION_BITS - 1);  // 50% duty is the loudest square wave
+    static const int QUEUE_LENGTH = 4;
+
+    static SemaphoreHandle_t sequencerMutex;
+    static esp_timer_handle_t stepTimer;
 
-    static uint8_t volume;
-    static SoundType currentSound;
-    static uint8_t soundStep;
+    // Guarded by sequencerMutex
+    static const Pattern* current;
+    static uint8_t currentStep;
+    static int64_t stepEndUs;
+    static const Pattern* queued[QUEUE_LENGTH];
+    static int queuedCount;
 
     static void on_button_press(const ButtonShortPressEvent& event);
     static void on_alarm_on(const CriticalAlarmEvent& event);
     static void on_alarm_off(const CriticalAlarmOffEvent& event);
+    static void on_config_changed(const ConfigChangedEvent& event);
 
-    static void beep(uint32_t duration_ms, uint32_t frequency_hz);
+    static void onStepTimer(void* arg);
+    static void startPattern(const Pattern& pattern);
+    static void playStep();
+    static bool startNextQueued();
+    static void silence();
 };
 
-#endif  // BUZZER_H
\ No newline at end of file
+#endif  // BUZZER_H
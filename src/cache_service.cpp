@@ -0,0 +1,240 @@
+#include "cache_service.h"
+#include <esp_heap_caps.h>
+#include <cstring>
+#include "logger.h"
+#include "time_service.h"
+
+// Static instance
+CacheService* CacheService::instance = nullptr;
+
+CacheService::CacheService() {
+    cacheMutex = xSemaphoreCreateMutex();
+    if (cacheMutex == nullptr) {
+        LOG_ERROR("CacheService: Failed to create mutex");
+    }
+}
+
+CacheService* CacheService::getInstance() {
+    if (instance == nullptr) {
+        instance = new CacheService();
+    }
+    return instance;
+}
+
+void CacheService::initialize() {
+    getInstance();
+    LOG_INFOF("CacheService: Initialized (%d entries, %d namespaces)\n", MAX_ENTRIES, MAX_NAMESPACES);
+}
+
+bool CacheService::put(const char* ns, const char* key, uint16_t version, const void* data, size_t size,
+                       uint32_t ttlSeconds) {
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+
+    Namespace* space = findNamespace(ns, true);
+    Entry* entry = space != nullptr ? findEntry(space, key, true) : nullptr;
+    if (entry == nullptr) {
+        xSemaphoreGive(cacheMutex);
+        LOG_WARNINGF("CacheService: Cannot store %s/%s\n", ns, key);
+        return false;
+    }
+
+    // Without a synchronized clock the entry is stored, but never reads as fresh
+    time_t now = time(nullptr);
+    entry->freshness.storedAt = now >= TimeService::MIN_VALID_EPOCH ? now : 0;
+    entry->freshness.ttlSeconds = ttlSeconds;
+    entry->freshness.reserved = 0;
+    entry->hasFreshness = true;
+    setPayload(*entry, version, data, size);
+
+    // The store skips the payload record when it equals what is already in flash
+    char metaKey[RecordStore::MAX_KEY_LENGTH + 1];
+    freshnessKey(key, metaKey);
+    bool staged = space->store->stage(key, version, data, size) &&
+                  space->store->stage(metaKey, FRESHNESS_VERSION, &entry->freshness, sizeof(entry->freshness));
+    int written = staged ? space->store->commit() : -1;
+    if (written < 0) {
+        space->store->discard();
+    }
+
+    xSemaphoreGive(cacheMutex);
+
+    if (written < 0) {
+        LOG_WARNINGF("CacheService: %s/%s kept in RAM only, flash write failed\n", ns, key);
+        return false;
+    }
+    LOG_DEBUGF("CacheService: Stored %s/%s (%u bytes, ttl %lu s, %d records written)\n", ns, key, (unsigned)size,
+               (unsigned long)ttlSeconds, written);
+    return true;
+}
+
+bool CacheService::touch(const char* ns, const char* key) {
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+
+    Namespace* space = findNamespace(ns, true);
+    Entry* entry = space != nullptr ? findEntry(space, key, true) : nullptr;
+    if (entry == nullptr || !loadFreshness(*entry)) {
+        xSemaphoreGive(cacheMutex);
+        return false;
+    }
+
+    time_t now = time(nullptr);
+    entry->freshness.storedAt = now >= TimeService::MIN_VALID_EPOCH ? now : 0;
+
+    char metaKey[RecordStore::MAX_KEY_LENGTH + 1];
+    freshnessKey(key, metaKey);
+    int written = -1;
+    if (space->store->stage(metaKey, FRESHNESS_VERSION, &entry->freshness, sizeof(entry->freshness))) {
+        written = space->store->commit();
+    }
+    if (written < 0) {
+        space->store->discard();
+    }
+
+    xSemaphoreGive(cacheMutex);
+    return written >= 0;
+}
+
+bool CacheService::get(const char* ns, const char* key, uint16_t version, void* data, size_t size,
+                       Freshness* freshness) {
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+
+    Namespace* space = findNamespace(ns, true);
+    Entry* entry = space != nullptr ? findEntry(space, key, true) : nullptr;
+    if (entry == nullptr) {
+        xSemaphoreGive(cacheMutex);
+        return false;
+    }
+
+    bool found = false;
+    if (entry->data != nullptr && entry->version == version && entry->size == size) {
+        memcpy(data, entry->data, size);
+        found = true;
+    } else if (space->store->load(key, version, data, size)) {
+        setPayload(*entry, version, data, size);
+        found = true;
+    }
+
+    if (found && freshness != nullptr) {
+        if (loadFreshness(*entry)) {
+            describe(entry->freshness, *freshness);
+        } else {
+            StoredFreshness unknown = {};
+            describe(unknown, *freshness);
+        }
+    }
+
+    xSemaphoreGive(cacheMutex);
+    return found;
+}
+
+bool CacheService::getFreshness(const char* ns, const char* key, Freshness& freshness) {
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+
+    Namespace* space = findNamespace(ns, true);
+    Entry* entry = space != nullptr ? findEntry(space, key, true) : nullptr;
+    bool found = entry != nullptr && loadFreshness(*entry);
+    if (found) {
+        describe(entry->freshness, freshness);
+    }
+
+    xSemaphoreGive(cacheMutex);
+    return found;
+}
+
+bool CacheService::isFresh(const char* ns, const char* key) {
+    Freshness freshness;
+    return getFreshness(ns, key, freshness) && freshness.fresh;
+}
+
+CacheService::Namespace* CacheService::findNamespace(const char* name, bool create) {
+    for (int i = 0; i < namespaceCount; i++) {
+        if (strcmp(namespaces[i].name, name) == 0) {
+            return &namespaces[i];
+        }
+    }
+    if (!create || namespaceCount == MAX_NAMESPACES || strlen(name) > MAX_NAMESPACE_LENGTH) {
+        return nullptr;
+    }
+
+    // Namespaces are never removed, so the name buffer outlives the store that points at it
+    Namespace* space = &namespaces[namespaceCount];
+    strcpy(space->name, name);
+    space->store = new RecordStore(space->name);
+    namespaceCount++;
+    return space;
+}
+
+CacheService::Entry* CacheService::findEntry(Namespace* ns, const char* key, bool create) {
+    Entry* unused = nullptr;
+    Entry* oldest = nullptr;
+    for (int i = 0; i < MAX_ENTRIES; i++) {
+        Entry& entry = entries[i];
+        if (entry.ns == ns && strcmp(entry.key, key) == 0) {
+            entry.lastUsed = ++useCounter;
+            return &entry;
+        }
+        if (entry.ns == nullptr) {
+            if (unused == nullptr) {
+                unused = &entry;
+            }
+        } else if (oldest == nullptr || entry.lastUsed < oldest->lastUsed) {
+            oldest = &entry;
+        }
+    }
+    if (!create || strlen(key) > MAX_KEY_LENGTH) {
+        return nullptr;
+    }
+
+    // Evicting only drops the RAM copy, flash still holds the entry
+    Entry* entry = unused != nullptr ? unused : oldest;
+    heap_caps_free(entry->data);
+    *entry = Entry();
+    entry->ns = ns;
+    strcpy(entry->key, key);
+    entry->lastUsed = ++useCounter;
+    return entry;
+}
+
+bool CacheService::loadFreshness(Entry& entry) {
+    if (entry.hasFreshness) {
+        return true;
+    }
+    char metaKey[RecordStore::MAX_KEY_LENGTH + 1];
+    freshnessKey(entry.key, metaKey);
+    entry.hasFreshness =
+        entry.ns->store->load(metaKey, FRESHNESS_VERSION, &entry.freshness, sizeof(entry.freshness));
+    return entry.hasFreshness;
+}
+
+bool CacheService::setPayload(Entry& entry, uint16_t version, const void* data, size_t size) {
+    if (entry.data == nullptr || entry.size != size) {
+        heap_caps_free(entry.data);
+        entry.data = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (entry.data == nullptr) {
+            entry.data = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+        }
+        if (entry.data == nullptr) {
+            entry.size = 0;
+            return false;
+        }
+    }
+    memcpy(entry.data, data, size);
+    entry.version = version;
+    entry.size = size;
+    return true;
+}
+
+void CacheService::freshnessKey(const char* key, char* out) {
+    size_t length = strlen(key);
+    memcpy(out, key, length);
+    out[length] = FRESHNESS_SUFFIX;
+    out[length + 1] = '\0';
+}
+
+void CacheService::describe(const StoredFreshness& stored, Freshness& out) {
+    time_t now = time(nullptr);
+    out.storedAt = (time_t)stored.storedAt;
+    out.ttlSeconds = stored.ttlSeconds;
+    out.age = stored.storedAt != 0 && now >= TimeService::MIN_VALID_EPOCH ? now - out.storedAt : -1;
+    out.fresh = out.age >= 0 && out.age < (time_t)stored.ttlSeconds;
+}
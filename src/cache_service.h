@@ -0,0 +1,101 @@
+#ifndef CACHE_SERVICE_H
+#define CACHE_SERVICE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <stdint.h>
+#include <time.h>
+#include "record_store.h"
+
+/**
+ * Module Data Cache
+ *
+ * Key-value cache for data a module wants to survive a reboot, so it can warm-start and skip
+ * a network fetch while the data is still current. Keys are namespaced per owner (one NVS
+ * namespace each, so modules never collide). Every entry carries a layout version, a time-to-
+ * live and the wall-clock time it was last confirmed current; the payload and this freshness
+ * record are stored as two records of a RecordStore, so marking an entry current again
+ * (touch) rewrites only the small freshness record.
+ *
+ * Reads are served from a RAM copy (PSRAM when available) after the first load from flash.
+ * Writes go through to flash in one transaction. All methods are thread-safe.
+ */
+class CacheService {
+public:
+    struct Freshness {
+        time_t storedAt;      // Unix time, 0 when unknown (stored before time was synchronized)
+        uint32_t ttlSeconds;
+        time_t age;           // Seconds since storedAt, -1 when unknown
+        bool fresh;           // Younger than its TTL by a synchronized clock
+    };
+
+    static const size_t MAX_NAMESPACE_LENGTH = RecordStore::MAX_KEY_LENGTH;  // NVS limit
+    static const size_t MAX_KEY_LENGTH = RecordStore::MAX_KEY_LENGTH - 1;    // One char for the freshness suffix
+    static const int MAX_NAMESPACES = 8;
+    static const int MAX_ENTRIES = 16;
+
+    static CacheService* getInstance();
+    static void initialize();
+
+    // Store data with its TTL and mark it current now, written through to flash
+    bool put(const char* ns, const char* key, uint16_t version, const void* data, size_t size, uint32_t ttlSeconds);
+
+    // Mark an existing entry current now without rewriting its payload (e.g. after HTTP 304)
+    bool touch(const char* ns, const char* key);
+
+    // Copy an entry out; false when missing, from another version or size, or corrupt.
+    // Stale entries are still returned; check freshness to decide whether to refetch.
+    bool get(const char* ns, const char* key, uint16_t version, void* data, size_t size,
+             Freshness* freshness = nullptr);
+
+    bool getFreshness(const char* ns, const char* key, Freshness& freshness);
+    bool isFresh(const char* ns, const char* key);
+
+private:
+    CacheService();
+
+    struct StoredFreshness {
+        int64_t storedAt;
+        uint32_t ttlSeconds;
+        uint32_t reserved;
+    };
+
+    struct Namespace {
+        char name[MAX_NAMESPACE_LENGTH + 1];
+        RecordStore* store;
+    };
+
+    // RAM front: the last known state of an entry
+    struct Entry {
+        Namespace* ns;
+        char key[MAX_KEY_LENGTH + 1];
+        uint16_t version;
+        size_t size;
+        uint8_t* data;        // nullptr until the payload was loaded or stored
+        StoredFreshness freshness;
+        bool hasFreshness;
+        uint32_t lastUsed;
+    };
+
+    static const uint16_t FRESHNESS_VERSION = 1;
+    static const char FRESHNESS_SUFFIX = '@';
+
+    static CacheService* instance;
+    SemaphoreHandle_t cacheMutex;
+
+    Namespace namespaces[MAX_NAMESPACES] = {};
+    int namespaceCount = 0;
+    Entry entries[MAX_ENTRIES] = {};
+    uint32_t useCounter = 0;
+
+    Namespace* findNamespace(const char* name, bool create);
+    Entry* findEntry(Namespace* ns, const char* key, bool create);
+    bool loadFreshness(Entry& entry);
+    bool setPayload(Entry& entry, uint16_t version, const void* data, size_t size);
+
+    static void freshnessKey(const char* key, char* out);
+    static void describe(const StoredFreshness& stored, Freshness& out);
+};
+
+#endif // CACHE_SERVICE_H
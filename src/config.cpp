@@ -51,20 +51,35 @@ void Config::printConfig() const {
     LOG_INFO("[WiFi]");
     LOG_INFOF("  SSID: %s\n", wifi.ssid.c_str());
     LOG_INFOF("  Password: %s\n", wifi.password.length() > 0 ? "****" : "Not set");
+    LOG_INFOF("  Address: %s\n", wifi.staticIp.length() > 0 ? wifi.staticIp.c_str() : "DHCP");
 
     LOG_INFO("[System]");
     LOG_INFOF("  Language: %s\n", system.language.c_str());
     LOG_INFOF("  Timezone: %s\n", system.timezone.c_str());
     LOG_INFOF("  NTP Server: %s\n", system.ntpServer.c_str());
+    LOG_INFOF("  Config Reload: %d s\n", system.configReloadSeconds);
 
     LOG_INFO("[Display]");
     LOG_INFOF("  Brightness: %d%%\n", display.brightness);
+    LOG_INFOF("  Partial Refresh: %s\n", display.partialRefresh ? "Yes" : "No");
 
     LOG_INFO("[Buzzer]");
     LOG_INFOF("  Volume: %d%%\n", buzzer.volume);
     LOG_INFOF("  Enabled: %s\n", buzzer.enabled ? "Yes" : "No");
     LOG_INFOF("  Startup Sound: %s\n", buzzer.startupSound ? "Yes" : "No");
 
+    LOG_INFO("[Power]");
+    LOG_INFOF("  Power Management: %s\n", power.enabled ? "Yes" : "No");
+    LOG_INFOF("  CPU: %d-%d MHz\n", power.minCpuMhz, power.maxCpuMhz);
+    LOG_INFOF("  Light Sleep: %s\n", power.lightSleep ? "Yes" : "No");
+
+    LOG_INFO("[Diagnostics]");
+    LOG_INFOF("  Benchmark Mode: %s\n", diagnostics.enabled ? "Yes" : "No");
+
+    LOG_INFO("[Metrics]");
+    LOG_INFOF("  Exporter: %s\n", metrics.enabled ? "Yes" : "No");
+    LOG_INFOF("  Port: %d\n", metrics.port);
+
     LOG_INFO("[Logger]");
     LOG_INFOF("  File Logging: %s\n", logger.fileLoggingEnabled ? "Yes" : "No");
     LOG_INFOF("  Log Level: %s\n", logger.logLevel.c_str());
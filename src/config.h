@@ -10,6 +10,11 @@ class Config {
     struct WiFiSettings {
         String ssid = "";
         String password = "";
+        // Optional static address, skips DHCP when set
+        String staticIp = "";
+        String gateway = "";
+        String subnet = "";
+        String dns = "";
     } wifi;
 
     // System Settings
@@ -17,11 +22,13 @@ class Config {
         String language = "en";
         String timezone = "UTC";
         String ntpServer = "pool.ntp.org";
+        int configReloadSeconds = 10;  // SD card poll for INI edits, 0 = only on a double press
     } system;
 
     // Display Settings
     struct DisplaySettings {
         int brightness = 80;
+        bool partialRefresh = true;  // Send only changed 8x8 tiles instead of the whole framebuffer
     } display;
 
     // Buzzer Settings
@@ -31,6 +38,29 @@ class Config {
         bool startupSound = true;
     } buzzer;
 
+    // Power Settings
+    struct PowerSettings {
+        bool enabled = false;        // Dynamic frequency scaling and frame-rate governor
+        int maxCpuMhz = 240;
+        int minCpuMhz = 80;
+        bool lightSleep = true;      // Automatic light sleep when idle
+    } power;
+
+    // Diagnostics Settings
+    struct DiagnosticsSettings {
+        bool enabled = false;            // Benchmark mode after boot
+        String frameRates = "5,10,20,40";  // Display sweep targets in frames per second
+        int stepSeconds = 10;            // Time at each frame rate
+        int fetchRuns = 2;               // Timed network fetches per module, the first one cold
+        int resultSeconds = 30;          // Terminal with the results stays up this long
+    } diagnostics;
+
+    // Metrics Settings
+    struct MetricsSettings {
+        bool enabled = false;  // Serve GET /metrics for Prometheus
+        int port = 9100;
+    } metrics;
+
     // Logger Settings
     struct LoggerSettings {
         bool fileLoggingEnabled = false;
@@ -71,7 +101,6 @@ extern Config config;
 extern SemaphoreHandle_t spiMutex;
 
 #define CONFIG_DEBUG 1
-#define EEPROM_SIZE 1024
 #define BUTTON_LONG_PRESS_TIME 300
 
 #endif  // CONFIG_H
\ No newline at end of file
@@ -2,15 +2,17 @@
 #include "logger.h"
 #include "memory_manager.h"
 #include <FS.h>
+#include <Preferences.h>
 #include <SD.h>
 #include <SPI.h>
 #include <WiFi.h>
+#include <esp_heap_caps.h>
 #include <algorithm>
 #include <cctype>
-#include <map>
 #include <string>
 #include "event_manager.h"
 #include "pins.h"
+#include "timezone_utils.h"
 
 extern Config config;
 extern SemaphoreHandle_t spiMutex;
@@ -18,7 +20,12 @@ extern SemaphoreHandle_t spiMutex;
 // Static instance for singleton pattern
 ConfigManager* ConfigManager::instance = nullptr;
 
-ConfigManager::ConfigManager() : sdInitialized(false), configFileName("hoowachy_config.ini") {
+// NVS location of the config snapshot
+static const char* SNAPSHOT_NAMESPACE = "hoowachy";
+static const char* SNAPSHOT_KEY = "config";
+
+ConfigManager::ConfigManager()
+    : sdInitialized(false), configFileName("hoowachy_config.ini"), storeMutex(xSemaphoreCreateMutex()) {
     // Initialize empty config
 }
 
@@ -105,127 +112,313 @@ void ConfigManager::trim(std::string& str) {
     str.erase(std::find_if(str.rbegin(), str.rend(), [](int ch) { return !std::isspace(ch); }).base(), str.end());
 }
 
-String ConfigManager::readFile(const String& filePath) {
+bool ConfigManager::readFileIntoStore(const String& filePath, ConfigStore& target, time_t* modified) {
     if (!sdInitialized) {
         LOG_INFO("SD card not initialized");
-        return "";
+        return false;
+    }
+
+    // Hold the shared SPI bus only for one bulk read, parsing happens afterwards
+    if (xSemaphoreTake(spiMutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
+        LOG_WARNINGF("Timed out waiting for SPI bus to read %s\n", filePath.c_str());
+        return false;
     }
 
     File file = SD.open(filePath, FILE_READ);
     if (!file) {
+        xSemaphoreGive(spiMutex);
         LOG_INFOF("Failed to open file: %s\n", filePath.c_str());
-        return "";
+        return false;
     }
 
-    String content = "";
-    while (file.available()) {
-        content += (char)file.read();
+    size_t size = file.size();
+    if (modified != nullptr) {
+        *modified = file.getLastWrite();
     }
+    char* buffer = (char*)heap_caps_malloc(size + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer == nullptr) {
+        buffer = (char*)heap_caps_malloc(size + 1, MALLOC_CAP_8BIT);
+    }
+    if (buffer == nullptr) {
+        file.close();
+        xSemaphoreGive(spiMutex);
+        LOG_ERRORF("Failed to allocate %u bytes for %s\n", (unsigned)size, filePath.c_str());
+        return false;
+    }
+
+    size_t bytesRead = file.read((uint8_t*)buffer, size);
     file.close();
+    xSemaphoreGive(spiMutex);
 
-    return content;
+    bool loaded = bytesRead > 0 && target.load(buffer, bytesRead);
+    heap_caps_free(buffer);
+    return loaded;
 }
 
 bool ConfigManager::parseINIFile(const String& filePath) {
-    String content = readFile(filePath);
-    if (content.length() == 0) {
+    ConfigStore next;
+    if (!readFileIntoStore(filePath, next, &sourceFileTime)) {
         return false;
     }
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    store.swap(next);
+    xSemaphoreGive(storeMutex);
 
-    String currentSection = "";
-
-    int startPos = 0;
-    int endPos = 0;
-
-    while ((endPos = content.indexOf('\n', startPos)) != -1) {
-        String line = content.substring(startPos, endPos);
-        line.trim();
+    applyStore();
+    return true;
+}
 
-        // Skip empty lines and comments
-        if (line.length() == 0 || line.charAt(0) == ';' || line.charAt(0) == '#') {
-            startPos = endPos + 1;
-            continue;
+// Sections read once at boot (the WiFi link, SNTP, the task set) are not live
+const ConfigManager::SectionParser ConfigManager::SECTION_PARSERS[] = {
+    {"wifi", &ConfigManager::parseWiFiSection, [] { config.wifi = Config::WiFiSettings(); }, false},
+    {"system", &ConfigManager::parseSystemSection, [] { config.system = Config::SystemSettings(); }, false},
+    {"display", &ConfigManager::parseDisplaySection, [] { config.display = Config::DisplaySettings(); }, true},
+    {"buzzer", &ConfigManager::parseBuzzerSection, [] { config.buzzer = Config::BuzzerSettings(); }, true},
+    {"logger", &ConfigManager::parseLoggerSection, [] { config.logger = Config::LoggerSettings(); }, false},
+    {"power", &ConfigManager::parsePowerSection, [] { config.power = Config::PowerSettings(); }, false},
+    {"diagnostics", &ConfigManager::parseDiagnosticsSection,
+     [] { config.diagnostics = Config::DiagnosticsSettings(); }, false},
+    {"metrics", &ConfigManager::parseMetricsSection, [] { config.metrics = Config::MetricsSettings(); }, false},
+};
+
+const ConfigManager::SectionParser* ConfigManager::findParser(const char* sectionName) {
+    for (const SectionParser& parser : SECTION_PARSERS) {
+        if (strcmp(parser.name, sectionName) == 0) {
+            return &parser;
         }
+    }
+    return nullptr;
+}
 
-        // Parse section headers [section]
-        if (line.charAt(0) == '[' && line.charAt(line.length() - 1) == ']') {
-            currentSection = line.substring(1, line.length() - 1);
-            currentSection.toLowerCase();
-            LOG_INFOF("Parsing section: [%s]\n", currentSection.c_str());
-            startPos = endPos + 1;
-            continue;
+void ConfigManager::applyStore() {
+    for (int section = 0; section < store.getSectionCount(); section++) {
+        const SectionParser* parser = findParser(store.getSectionName(section));
+        if (parser != nullptr) {
+            applySection(*parser, section);
         }
+    }
 
-        // Parse key=value pairs
-        int equalPos = line.indexOf('=');
-        if (equalPos > 0) {
-            String key = line.substring(0, equalPos);
-            String value = line.substring(equalPos + 1);
+    LOG_INFOF("Config indexed: %d sections, %u bytes\n", store.getSectionCount(), (unsigned)store.getMemoryUsage());
+}
 
-            key.trim();
-            value.trim();
+void ConfigManager::applySection(const SectionParser& parser, int section) {
+    LOG_DEBUGF("Parsing section: [%s]\n", parser.name);
 
-            // Remove quotes from value if present
-            if (value.length() >= 2 && value.charAt(0) == '"' && value.charAt(value.length() - 1) == '"') {
-                value = value.substring(1, value.length() - 1);
-            }
+    for (int i = 0; i < store.getEntryCount(section); i++) {
+        String key = store.getKey(section, i);
+        String value = store.getValue(section, i);
 
-            LOG_INFOF("Config: [%s] %s = %s\n", currentSection.c_str(), key.c_str(), value.c_str());
-
-            // Parse based on section
-            if (currentSection == "wifi") {
-                parseWiFiSection(key, value);
-            } else if (currentSection == "system") {
-                parseSystemSection(key, value);
-            } else if (currentSection == "display") {
-                parseDisplaySection(key, value);
-            } else if (currentSection == "buzzer") {
-                parseBuzzerSection(key, value);
-            } else if (currentSection == "logger") {
-                parseLoggerSection(key, value);
+        LOG_DEBUGF("Config: [%s] %s = %s\n", parser.name, key.c_str(), value.c_str());
+        (this->*parser.parse)(key, value);
+    }
+}
+
+bool ConfigManager::loadSnapshot() {
+    Preferences preferences;
+    if (!preferences.begin(SNAPSHOT_NAMESPACE, true)) {
+        return false;
+    }
+
+    size_t size = preferences.getBytesLength(SNAPSHOT_KEY);
+    if (size == 0) {
+        preferences.end();
+        LOG_INFO("Config: No snapshot in NVS");
+        return false;
+    }
+
+    uint8_t* buffer = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer == nullptr) {
+        buffer = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    if (buffer == nullptr) {
+        preferences.end();
+        return false;
+    }
+
+    bool loaded = preferences.getBytes(SNAPSHOT_KEY, buffer, size) == size && store.loadSnapshot(buffer, size);
+    preferences.end();
+    heap_caps_free(buffer);
+
+    if (!loaded) {
+        LOG_WARNING("Config: Snapshot unreadable, falling back to SD");
+        return false;
+    }
+
+    applyStore();
+    config.setReady(true);
+    LOG_INFOF("Config: Loaded from snapshot (INI %u bytes, crc %08x)\n", (unsigned)store.getSourceSize(),
+              (unsigned)store.getSourceCrc());
+    return true;
+}
+
+bool ConfigManager::saveSnapshot() { return saveSnapshot(store); }
+
+bool ConfigManager::saveSnapshot(const ConfigStore& source) {
+    size_t size = source.getSnapshotSize();
+    if (size == 0) {
+        return false;
+    }
+
+    uint8_t* buffer = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer == nullptr) {
+        buffer = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    if (buffer == nullptr || !source.writeSnapshot(buffer, size)) {
+        heap_caps_free(buffer);
+        return false;
+    }
+
+    Preferences preferences;
+    bool saved = preferences.begin(SNAPSHOT_NAMESPACE, false) && preferences.putBytes(SNAPSHOT_KEY, buffer, size) == size;
+    preferences.end();
+    heap_caps_free(buffer);
+
+    if (saved) {
+        LOG_INFOF("Config: Snapshot saved (%u bytes)\n", (unsigned)size);
+    } else {
+        LOG_WARNING("Config: Failed to save snapshot");
+    }
+    return saved;
+}
+
+bool ConfigManager::readFileStamp(const String& filePath, size_t& size, time_t& modified) {
+    if (xSemaphoreTake(spiMutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
+        return false;
+    }
+    File file = SD.open(filePath, FILE_READ);
+    bool opened = (bool)file;
+    if (opened) {
+        size = file.size();
+        modified = file.getLastWrite();
+        file.close();
+    }
+    xSemaphoreGive(spiMutex);
+    return opened;
+}
+
+void ConfigManager::remountSD() {
+    // A card taken out for editing comes back as a new card; the old mount cannot see it
+    if (xSemaphoreTake(spiMutex, pdMS_TO_TICKS(2000)) == pdTRUE) {
+        SD.end();
+        xSemaphoreGive(spiMutex);
+    }
+    sdInitialized = false;
+}
+
+ConfigManager::ReloadResult ConfigManager::reload(const char* fileName, bool force) {
+    if (!initializeSD()) {
+        return ReloadResult::UNAVAILABLE;
+    }
+
+    configFileName = fileName;
+    String filePath = String("/") + fileName;
+
+    size_t fileSize = 0;
+    time_t fileTime = 0;
+    if (!readFileStamp(filePath, fileSize, fileTime)) {
+        remountSD();
+        return ReloadResult::UNAVAILABLE;
+    }
+    if (!force && sourceFileTime != 0 && fileTime == sourceFileTime && fileSize == store.getSourceSize()) {
+        return ReloadResult::UNCHANGED;
+    }
+
+    // Parsed into a scratch store first, the one in use is only replaced when the text differs
+    ConfigStore next;
+    if (!readFileIntoStore(filePath, next, &fileTime)) {
+        return ReloadResult::UNAVAILABLE;
+    }
+    sourceFileTime = fileTime;
+    if (next.getSourceSize() == store.getSourceSize() && next.getSourceCrc() == store.getSourceCrc()) {
+        return ReloadResult::UNCHANGED;
+    }
+
+    // Sections present in either version, each compared once
+    const int MAX_CHANGED = 24;
+    char changed[MAX_CHANGED][ConfigChangedEvent::MAX_SECTION_LENGTH + 1];
+    bool enableChanged[MAX_CHANGED];
+    int changedCount = 0;
+    bool restartRequired = false;
+    const ConfigStore* versions[] = {&next, &store};
+    for (const ConfigStore* version : versions) {
+        for (int section = 0; section < version->getSectionCount(); section++) {
+            const char* name = version->getSectionName(section);
+            bool seen = false;
+            for (int i = 0; i < changedCount && !seen; i++) {
+                seen = strcmp(changed[i], name) == 0;
+            }
+            if (seen || ConfigStore::sectionsEqual(store, next, name)) {
+                continue;
             }
+            const SectionParser* parser = findParser(name);
+            if (changedCount == MAX_CHANGED || strlen(name) > ConfigChangedEvent::MAX_SECTION_LENGTH ||
+                (parser != nullptr && !parser->live)) {
+                restartRequired = true;
+                continue;
+            }
+
+            const char* enableNow = next.getValue(name, "enable");
+            const char* enableBefore = store.getValue(name, "enable");
+            enableChanged[changedCount] = strcmp(enableNow != nullptr ? enableNow : "",
+                                                 enableBefore != nullptr ? enableBefore : "") != 0;
+            strcpy(changed[changedCount++], name);
         }
+    }
 
-        startPos = endPos + 1;
-    }
-
-    // Handle last line if no newline at end
-    if (startPos < content.length()) {
-        String line = content.substring(startPos);
-        line.trim();
-
-        if (line.length() > 0 && line.charAt(0) != ';' && line.charAt(0) != '#' && line.charAt(0) != '[') {
-            int equalPos = line.indexOf('=');
-            if (equalPos > 0) {
-                String key = line.substring(0, equalPos);
-                String value = line.substring(equalPos + 1);
-
-                key.trim();
-                value.trim();
-
-                if (value.length() >= 2 && value.charAt(0) == '"' && value.charAt(value.length() - 1) == '"') {
-                    value = value.substring(1, value.length() - 1);
-                }
-
-                LOG_INFOF("Config: [%s] %s = %s\n", currentSection.c_str(), key.c_str(), value.c_str());
-
-                // Parse based on section
-                if (currentSection == "wifi") {
-                    parseWiFiSection(key, value);
-                } else if (currentSection == "system") {
-                    parseSystemSection(key, value);
-                } else if (currentSection == "display") {
-                    parseDisplaySection(key, value);
-                } else if (currentSection == "buzzer") {
-                    parseBuzzerSection(key, value);
-                } else if (currentSection == "logger") {
-                    parseLoggerSection(key, value);
-                }
-            }
+    // Other tasks are still running on the store and config in use; the restart boots from the snapshot
+    if (restartRequired) {
+        LOG_INFOF("Config: %s changed in a section read only at boot\n", fileName);
+        saveSnapshot(next);
+        return ReloadResult::RESTART_REQUIRED;
+    }
+
+    LOG_INFOF("Config: %s changed, applying the sections that differ\n", fileName);
+    // Readers copy out under the lock, so none still points into the old block freed with next
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    store.swap(next);
+    xSemaphoreGive(storeMutex);
+
+    for (int i = 0; i < changedCount; i++) {
+        const SectionParser* parser = findParser(changed[i]);
+        if (parser != nullptr) {
+            parser->reset();
+            applySection(*parser, store.findSection(changed[i]));
         }
+        LOG_INFOF("Config: [%s] changed%s\n", changed[i], enableChanged[i] ? ", enable flipped" : "");
+        EventManager::Emit(ConfigChangedEvent(changed[i], enableChanged[i]));
     }
 
-    return true;
+    saveSnapshot();
+    return ReloadResult::APPLIED;
+}
+
+namespace {
+
+void onReloadGesture(const ButtonDoublePressEvent& event, void* context) {
+    xTaskNotifyGive(static_cast<TaskHandle_t>(context));
+}
+
+}  // namespace
+
+void ConfigManager::watch(const char* fileName) {
+    EventManager::Subscribe<ButtonDoublePressEvent>(onReloadGesture, xTaskGetCurrentTaskHandle());
+
+    while (true) {
+        // Re-read every round, the interval itself may have been changed by a restart
+        uint32_t intervalMs = config.system.configReloadSeconds > 0 ? config.system.configReloadSeconds * 1000 : 0;
+        bool forced = ulTaskNotifyTake(pdTRUE, intervalMs > 0 ? pdMS_TO_TICKS(intervalMs) : portMAX_DELAY) > 0;
+
+        ReloadResult result = reload(fileName, forced);
+        if (result == ReloadResult::UNCHANGED && forced) {
+            LOG_INFO("Config: Reload requested, file unchanged");
+        } else if (result == ReloadResult::APPLIED) {
+            LOG_INFO("Config: Changes applied without restart");
+        } else if (result == ReloadResult::RESTART_REQUIRED) {
+            LOG_WARNING("Config: Changed sections take effect at boot, restarting");
+            vTaskDelay(pdMS_TO_TICKS(500));
+            ESP.restart();
+        }
+    }
 }
 
 void ConfigManager::parseWiFiSection(const String& key, const String& value) {
@@ -233,26 +426,35 @@ void ConfigManager::parseWiFiSection(const String& key, const String& value) {
         config.wifi.ssid = value;
     } else if (key == "password") {
         config.wifi.password = value;
+    } else if (key == "static_ip") {
+        config.wifi.staticIp = value;
+    } else if (key == "gateway") {
+        config.wifi.gateway = value;
+    } else if (key == "subnet") {
+        config.wifi.subnet = value;
+    } else if (key == "dns") {
+        config.wifi.dns = value;
     }
 }
 
 void ConfigManager::parseSystemSection(const String& key, const String& value) {
-    LOG_INFOF("ConfigManager::parseSystemSection: key='%s', value='%s'\n", key.c_str(), value.c_str());
     if (key == "language") {
         config.system.language = value;
-        LOG_INFOF("Set system.language = '%s'\n", config.system.language.c_str());
     } else if (key == "timezone") {
         config.system.timezone = value;
-        LOG_INFOF("Set system.timezone = '%s'\n", config.system.timezone.c_str());
+        TimezoneUtils::setTimezone(value);
     } else if (key == "ntp_server") {
         config.system.ntpServer = value;
-        LOG_INFOF("Set system.ntpServer = '%s'\n", config.system.ntpServer.c_str());
+    } else if (key == "config_reload_seconds") {
+        config.system.configReloadSeconds = value.toInt();
     }
 }
 
 void ConfigManager::parseDisplaySection(const String& key, const String& value) {
     if (key == "brightness") {
         config.display.brightness = value.toInt();
+    } else if (key == "partial_refresh") {
+        config.display.partialRefresh = (value == "true" || value == "1");
     }
 }
 
@@ -278,6 +480,43 @@ void ConfigManager::parseLoggerSection(const String& key, const String& value) {
     }
 }
 
+void ConfigManager::parsePowerSection(const String& key, const String& value) {
+    if (key == "enable") {
+        config.power.enabled = (value == "true" || value == "1");
+    } else if (key == "max_cpu_mhz") {
+        config.power.maxCpuMhz = value.toInt();
+    } else if (key == "min_cpu_mhz") {
+        config.power.minCpuMhz = value.toInt();
+    } else if (key == "light_sleep") {
+        config.power.lightSleep = (value == "true" || value == "1");
+    }
+}
+
+void ConfigManager::parseDiagnosticsSection(const String& key, const String& value) {
+    if (key == "enable") {
+        config.diagnostics.enabled = (value == "true" || value == "1");
+    } else if (key == "frame_rates") {
+        config.diagnostics.frameRates = value;
+    } else if (key == "step_seconds") {
+        config.diagnostics.stepSeconds = value.toInt();
+    } else if (key == "fetch_runs") {
+        config.diagnostics.fetchRuns = value.toInt();
+    } else if (key == "result_seconds") {
+        config.diagnostics.resultSeconds = value.toInt();
+    }
+}
+
+void ConfigManager::parseMetricsSection(const String& key, const String& value) {
+    if (key == "enable") {
+        config.metrics.enabled = (value == "true" || value == "1");
+    } else if (key == "port") {
+        int port = value.toInt();
+        if (port > 0 && port <= 65535) {
+            config.metrics.port = port;
+        }
+    }
+}
+
 // Load config from SD card
 bool ConfigManager::loadConfig(const char* fileName) {
     // ConfigManager bypasses MemoryManager - configuration is critical for system operation
@@ -304,108 +543,47 @@ bool ConfigManager::validateConfig() { return config.isValid(); }
 modules::ConfigSection ConfigManager::getConfigSection(const String& sectionName, const String& filePath) {
     modules::ConfigSection section;
 
-    // Debug: Print what we're looking for
-    LOG_INFOF("Debug: ConfigManager::getConfigSection called with section='%s', file='%s'\n", 
-                  sectionName.c_str(), filePath.c_str());
-
     // Add "/" prefix only if it's not already there
     String fullPath = filePath;
     if (!fullPath.startsWith("/")) {
         fullPath = String("/") + filePath;
     }
-    LOG_INFOF("Debug: Full file path: '%s'\n", fullPath.c_str());
-
-    String content = readFile(fullPath);
-    if (content.length() == 0) {
-        LOG_INFOF("Debug: File content is empty or file not found\n");
-        return section;
-    }
-
-    LOG_INFOF("Debug: File content length: %d characters\n", content.length());
-
-    String targetSection = sectionName;
-    targetSection.toLowerCase();
-    String currentSection = "";
-    bool foundSection = false;
-
-    LOG_INFOF("Debug: Looking for section '%s' (lowercase)\n", targetSection.c_str());
-
-    // Parse INI content line by line
-    int startPos = 0;
-    int endPos = 0;
 
-    while ((endPos = content.indexOf('\n', startPos)) != -1) {
-        String line = content.substring(startPos, endPos);
-        line.trim();
-
-        // Skip empty lines and comments
-        if (line.length() == 0 || line.charAt(0) == ';' || line.charAt(0) == '#') {
-            startPos = endPos + 1;
-            continue;
-        }
-
-        // Parse section headers [section]
-        if (line.charAt(0) == '[' && line.charAt(line.length() - 1) == ']') {
-            currentSection = line.substring(1, line.length() - 1);
-            currentSection.toLowerCase();
-            foundSection = (currentSection == targetSection);
-            LOG_INFOF("Debug: Found section [%s], target match: %s\n", 
-                          currentSection.c_str(), foundSection ? "YES" : "NO");
-            startPos = endPos + 1;
-            continue;
+    // The loaded config is served from memory, copied under the lock; any other file is parsed on demand
+    const ConfigStore* source = &store;
+    ConfigStore otherFile;
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    if (!store.isLoaded() || fullPath != String("/") + configFileName) {
+        xSemaphoreGive(storeMutex);
+        if (!readFileIntoStore(fullPath, otherFile)) {
+            LOG_INFOF("Config file %s is empty or not found\n", fullPath.c_str());
+            return section;
         }
-
-        // Parse key=value pairs if we're in the right section
-        if (foundSection) {
-            int equalPos = line.indexOf('=');
-            if (equalPos > 0) {
-                String key = line.substring(0, equalPos);
-                String value = line.substring(equalPos + 1);
-
-                key.trim();
-                value.trim();
-
-                // Remove quotes from value if present
-                if (value.length() >= 2 && value.charAt(0) == '"' && value.charAt(value.length() - 1) == '"') {
-                    value = value.substring(1, value.length() - 1);
-                }
-
-                LOG_INFOF("Debug: Adding key='%s' value='%s'\n", key.c_str(), value.c_str());
-                section.keyValuePairs[key] = value;
-            }
-        }
-
-        startPos = endPos + 1;
+        source = &otherFile;
     }
 
-    // Handle last line if no newline at end
-    if (startPos < content.length() && foundSection) {
-        String line = content.substring(startPos);
-        line.trim();
-
-        if (line.length() > 0 && line.charAt(0) != ';' && line.charAt(0) != '#' && line.charAt(0) != '[') {
-            int equalPos = line.indexOf('=');
-            if (equalPos > 0) {
-                String key = line.substring(0, equalPos);
-                String value = line.substring(equalPos + 1);
-
-                key.trim();
-                value.trim();
-
-                if (value.length() >= 2 && value.charAt(0) == '"' && value.charAt(value.length() - 1) == '"') {
-                    value = value.substring(1, value.length() - 1);
-                }
-
-                LOG_INFOF("Debug: Adding key='%s' value='%s' (last line)\n", key.c_str(), value.c_str());
-                section.keyValuePairs[key] = value;
-            }
-        }
+    int index = source->findSection(sectionName.c_str());
+    for (int i = 0; i < source->getEntryCount(index); i++) {
+        section.keyValuePairs[source->getKey(index, i)] = source->getValue(index, i);
+    }
+    if (source == &store) {
+        xSemaphoreGive(storeMutex);
     }
 
-    LOG_INFOF("Debug: Final section contains %d key-value pairs\n", section.keyValuePairs.size());
+    LOG_DEBUGF("ConfigManager: [%s] has %d key-value pairs\n", sectionName.c_str(), (int)section.keyValuePairs.size());
     return section;
 }
 
+bool ConfigManager::getValue(const char* sectionName, const char* key, char* out, size_t outSize) const {
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    const char* value = store.getValue(sectionName, key);
+    if (value != nullptr) {
+        snprintf(out, outSize, "%s", value);
+    }
+    xSemaphoreGive(storeMutex);
+    return value != nullptr;
+}
+
 void ConfigManager::printConfig() { config.printConfig(); }
 
 bool ConfigManager::configExists() {
@@ -418,11 +596,11 @@ bool ConfigManager::fileExists(const String& filePath) {
         return false;
     }
 
-    File file = SD.open(filePath, FILE_READ);
-    if (file) {
-        file.close();
-        return true;
+    if (xSemaphoreTake(spiMutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
+        return false;
     }
 
-    return false;
+    bool exists = SD.exists(filePath);
+    xSemaphoreGive(spiMutex);
+    return exists;
 }
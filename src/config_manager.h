@@ -3,7 +3,10 @@
 
 #include <Arduino.h>
 #include "logger.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "config.h"
+#include "config_store.h"
 #include "modules/module.h"
 
 // Forward declarations
@@ -21,6 +24,24 @@ class ConfigManager {
     bool sdInitialized;
     const char* configFileName;
 
+    // Parsed configuration file, indexed once at load time. Only the config task changes it; readers
+    // on other tasks copy values out under storeMutex, which reload() also holds while replacing it.
+    ConfigStore store;
+    SemaphoreHandle_t storeMutex;
+
+    // Modification time of the INI file the store was read from, 0 when unknown (e.g. from the snapshot)
+    time_t sourceFileTime = 0;
+
+    // Parser of one core section; sections without one belong to modules
+    struct SectionParser {
+        const char* name;
+        void (ConfigManager::*parse)(const String& key, const String& value);
+        void (*reset)();  // Back to the defaults, so keys removed from the file do not linger
+        bool live;        // Read where it is used, so a runtime change needs no restart
+    };
+    static const SectionParser SECTION_PARSERS[];
+    static const SectionParser* findParser(const char* sectionName);
+
     // SPI management for avoiding conflicts with display
     void restoreSPISettings();
     bool tryAlternativeSDInit();
@@ -32,7 +53,12 @@ class ConfigManager {
     // Helper methods
     void trim(std::string& str);
     bool parseINIFile(const String& filePath);
-    String readFile(const String& filePath);
+    bool readFileIntoStore(const String& filePath, ConfigStore& target, time_t* modified = nullptr);
+    void applyStore();
+    void applySection(const SectionParser& parser, int section);
+    bool readFileStamp(const String& filePath, size_t& size, time_t& modified);
+    bool saveSnapshot(const ConfigStore& source);
+    void remountSD();
 
     // Configuration parsing helpers
     void parseWiFiSection(const String& key, const String& value);
@@ -40,6 +66,9 @@ class ConfigManager {
     void parseDisplaySection(const String& key, const String& value);
     void parseBuzzerSection(const String& key, const String& value);
     void parseLoggerSection(const String& key, const String& value);
+    void parsePowerSection(const String& key, const String& value);
+    void parseDiagnosticsSection(const String& key, const String& value);
+    void parseMetricsSection(const String& key, const String& value);
 
   public:
     // Singleton pattern
@@ -57,6 +86,22 @@ class ConfigManager {
 
     // Configuration file operations
     bool loadConfig(const char* fileName = "hoowachy_config.ini");
+
+    // Binary snapshot of the parsed config in NVS, so boot does not wait for the SD card
+    bool loadSnapshot();
+    bool saveSnapshot();
+
+    // Compare the INI file on SD with the one in use and apply what changed. Sections that differ
+    // are re-parsed in place and announced with a ConfigChangedEvent each. RESTART_REQUIRED means
+    // one of them only takes effect at boot; nothing is applied then, the store and config in use
+    // stay as they are until the restart. The new file replaces the snapshot either way. Unless
+    // forced, a file with the same size and modification time is not read at all.
+    enum class ReloadResult { UNCHANGED, APPLIED, RESTART_REQUIRED, UNAVAILABLE };
+    ReloadResult reload(const char* fileName = "hoowachy_config.ini", bool force = true);
+
+    // Poll the INI file every [system] config_reload_seconds and reload it on change, or right away
+    // on a double press of any button. Never returns; restarts the device on RESTART_REQUIRED.
+    void watch(const char* fileName = "hoowachy_config.ini");
     // bool saveConfig(const char* fileName = "hoowachy_config.ini");
 
     // Configuration validation
@@ -65,6 +110,10 @@ class ConfigManager {
     // Configuration section operations
     modules::ConfigSection getConfigSection(const String& sectionName, const String& filePath = "hoowachy_config.ini");
 
+    // One value of the loaded configuration, copied into out without copying the section;
+    // false when the key is missing
+    bool getValue(const char* sectionName, const char* key, char* out, size_t outSize) const;
+
     // Utility methods
     void printConfig();
     bool configExists();
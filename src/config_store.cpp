@@ -0,0 +1,444 @@
+#include "config_store.h"
+#include <esp_heap_caps.h>
+#include <strings.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include "logger.h"
+
+namespace {
+
+enum class LineType { BLANK, SECTION, ENTRY };
+
+struct Line {
+    LineType type = LineType::BLANK;
+    const char* name = nullptr;   // Section name or key
+    size_t nameLength = 0;
+    const char* value = nullptr;
+    size_t valueLength = 0;
+};
+
+void trimRange(const char*& start, const char*& end) {
+    while (start < end && isspace((unsigned char)*start)) {
+        start++;
+    }
+    while (end > start && isspace((unsigned char)end[-1])) {
+        end--;
+    }
+}
+
+// Classify the line starting at pos and advance pos past its newline
+Line scanLine(const char* text, size_t length, size_t& pos) {
+    const char* start = text + pos;
+    const char* newline = (const char*)memchr(start, '\n', length - pos);
+    const char* end = newline ? newline : text + length;
+    pos = (end - text) + (newline ? 1 : 0);
+
+    Line line;
+    trimRange(start, end);
+
+    // Skip empty lines and comments
+    if (start == end || *start == ';' || *start == '#') {
+        return line;
+    }
+
+    // Section headers [section]
+    if (*start == '[' && end[-1] == ']' && end - start >= 2) {
+        line.type = LineType::SECTION;
+        line.name = start + 1;
+        line.nameLength = end - start - 2;
+        return line;
+    }
+
+    // key=value pairs
+    const char* equals = (const char*)memchr(start, '=', end - start);
+    if (equals == nullptr || equals == start) {
+        return line;
+    }
+
+    const char* keyStart = start;
+    const char* keyEnd = equals;
+    const char* valueStart = equals + 1;
+    const char* valueEnd = end;
+    trimRange(keyStart, keyEnd);
+    trimRange(valueStart, valueEnd);
+
+    // Remove quotes from value if present
+    if (valueEnd - valueStart >= 2 && *valueStart == '"' && valueEnd[-1] == '"') {
+        valueStart++;
+        valueEnd--;
+    }
+
+    line.type = LineType::ENTRY;
+    line.name = keyStart;
+    line.nameLength = keyEnd - keyStart;
+    line.value = valueStart;
+    line.valueLength = valueEnd - valueStart;
+    return line;
+}
+
+}  // namespace
+
+ConfigStore::~ConfigStore() { clear(); }
+
+void ConfigStore::swap(ConfigStore& other) {
+    std::swap(block, other.block);
+    std::swap(blockSize, other.blockSize);
+    std::swap(sections, other.sections);
+    std::swap(sectionCount, other.sectionCount);
+    std::swap(entries, other.entries);
+    std::swap(entryCount, other.entryCount);
+    std::swap(slots, other.slots);
+    std::swap(slotMask, other.slotMask);
+    std::swap(arena, other.arena);
+    std::swap(arenaUsed, other.arenaUsed);
+    std::swap(sourceSize, other.sourceSize);
+    std::swap(sourceCrc, other.sourceCrc);
+}
+
+bool ConfigStore::sectionsEqual(const ConfigStore& a, const ConfigStore& b, const char* name) {
+    int sectionA = a.findSection(name);
+    int sectionB = b.findSection(name);
+    int count = a.getEntryCount(sectionA);
+    if (count != b.getEntryCount(sectionB)) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (strcmp(a.getKey(sectionA, i), b.getKey(sectionB, i)) != 0 ||
+            strcmp(a.getValue(sectionA, i), b.getValue(sectionB, i)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ConfigStore::clear() {
+    if (block != nullptr) {
+        heap_caps_free(block);
+    }
+    block = nullptr;
+    blockSize = 0;
+    sections = nullptr;
+    sectionCount = 0;
+    entries = nullptr;
+    entryCount = 0;
+    slots = nullptr;
+    slotMask = 0;
+    arena = nullptr;
+    arenaUsed = 0;
+    sourceSize = 0;
+    sourceCrc = 0;
+}
+
+bool ConfigStore::allocate(size_t sectionTotal, size_t entryTotal, size_t slotTotal, size_t arenaBytes) {
+    size_t sectionsBytes = sectionTotal * sizeof(Section);
+    size_t entriesBytes = entryTotal * sizeof(Entry);
+    size_t slotsBytes = slotTotal * sizeof(int16_t);
+    size_t totalBytes = sectionsBytes + entriesBytes + slotsBytes + arenaBytes;
+
+    block = (char*)heap_caps_malloc(totalBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (block == nullptr) {
+        block = (char*)heap_caps_malloc(totalBytes, MALLOC_CAP_8BIT);
+    }
+    if (block == nullptr) {
+        LOG_ERRORF("ConfigStore: Failed to allocate %u bytes\n", (unsigned)totalBytes);
+        return false;
+    }
+
+    blockSize = totalBytes;
+    sections = (Section*)block;
+    entries = (Entry*)(block + sectionsBytes);
+    slots = (int16_t*)(block + sectionsBytes + entriesBytes);
+    arena = block + sectionsBytes + entriesBytes + slotsBytes;
+    slotMask = slotTotal - 1;
+    return true;
+}
+
+bool ConfigStore::load(const char* text, size_t length) {
+    clear();
+
+    // Pass 1: size every table exactly so the store is a single allocation
+    size_t headerCount = 0;
+    size_t entriesNeeded = 0;
+    size_t arenaNeeded = 0;
+    bool inSection = false;
+
+    for (size_t pos = 0; pos < length;) {
+        Line line = scanLine(text, length, pos);
+        if (line.type == LineType::SECTION) {
+            headerCount++;
+            arenaNeeded += line.nameLength + 1;
+            inSection = true;
+        } else if (line.type == LineType::ENTRY && inSection) {
+            entriesNeeded++;
+            arenaNeeded += line.nameLength + line.valueLength + 2;
+        }
+    }
+
+    // Offsets and indices are 16-bit to keep the tables small
+    if (arenaNeeded > UINT16_MAX || entriesNeeded > UINT16_MAX || headerCount > INT16_MAX / 2) {
+        LOG_ERRORF("ConfigStore: INI too large (%u bytes of strings)\n", (unsigned)arenaNeeded);
+        return false;
+    }
+
+    // At most half the hash slots are used, so probing always finds an empty one
+    size_t slotCount = 4;
+    while (slotCount < headerCount * 2) {
+        slotCount <<= 1;
+    }
+
+    if (!allocate(headerCount, entriesNeeded, slotCount, arenaNeeded)) {
+        return false;
+    }
+    for (size_t i = 0; i < slotCount; i++) {
+        slots[i] = EMPTY_SLOT;
+    }
+    sourceSize = length;
+    sourceCrc = crc32(text, length);
+
+    // Pass 2: intern strings and build the index; keys before the first header are ignored
+    int currentSection = -1;
+    for (size_t pos = 0; pos < length;) {
+        Line line = scanLine(text, length, pos);
+        if (line.type == LineType::SECTION) {
+            currentSection = addSection(line.name, line.nameLength);
+        } else if (line.type == LineType::ENTRY && currentSection >= 0) {
+            Entry& entry = entries[entryCount++];
+            entry.section = currentSection;
+            entry.key = intern(line.name, line.nameLength, false);
+            entry.value = intern(line.value, line.valueLength, false);
+        }
+    }
+
+    // Repeated headers interleave entries; group them per section, keeping file order
+    std::stable_sort(entries, entries + entryCount,
+                     [](const Entry& a, const Entry& b) { return a.section < b.section; });
+    for (uint16_t i = 0; i < entryCount; i++) {
+        Section& section = sections[entries[i].section];
+        if (section.entryCount == 0) {
+            section.firstEntry = i;
+        }
+        section.entryCount++;
+    }
+
+    // Pass 1 counted a repeated header and its name once per occurrence. Close the gaps so the block
+    // holds exactly the counts a snapshot records and loadSnapshot() sizes its allocation from.
+    if (sectionCount < headerCount || arenaUsed < arenaNeeded) {
+        char* tail = block + sectionCount * sizeof(Section);
+        memmove(tail, entries, entryCount * sizeof(Entry));
+        entries = (Entry*)tail;
+        tail += entryCount * sizeof(Entry);
+        memmove(tail, slots, slotCount * sizeof(int16_t));
+        slots = (int16_t*)tail;
+        tail += slotCount * sizeof(int16_t);
+        memmove(tail, arena, arenaUsed);
+        arena = tail;
+        blockSize = tail + arenaUsed - block;
+    }
+
+    LOG_DEBUGF("ConfigStore: %d sections, %d keys, %u bytes\n", sectionCount, entryCount, (unsigned)blockSize);
+    return true;
+}
+
+size_t ConfigStore::getSnapshotSize() const { return block == nullptr ? 0 : sizeof(SnapshotHeader) + blockSize; }
+
+bool ConfigStore::writeSnapshot(uint8_t* out, size_t capacity) const {
+    if (block == nullptr || capacity < getSnapshotSize()) {
+        return false;
+    }
+
+    SnapshotHeader header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.sectionCount = sectionCount;
+    header.entryCount = entryCount;
+    header.slotCount = slotMask + 1;
+    header.arenaUsed = arenaUsed;
+    header.sourceSize = sourceSize;
+    header.sourceCrc = sourceCrc;
+
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), block, blockSize);
+    return true;
+}
+
+bool ConfigStore::loadSnapshot(const uint8_t* data, size_t size) {
+    clear();
+
+    SnapshotHeader header;
+    if (data == nullptr || size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    // The arena is sized exactly at load time, so the byte count must match the counts in the header
+    size_t slotCount = header.slotCount;
+    size_t expected = header.sectionCount * sizeof(Section) + header.entryCount * sizeof(Entry) +
+                      slotCount * sizeof(int16_t) + header.arenaUsed;
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION || slotCount < 4 ||
+        (slotCount & (slotCount - 1)) != 0 || header.sectionCount * 2 > slotCount || header.arenaUsed == 0 ||
+        size != sizeof(header) + expected) {
+        LOG_WARNING("ConfigStore: Snapshot rejected");
+        return false;
+    }
+
+    if (!allocate(header.sectionCount, header.entryCount, slotCount, header.arenaUsed)) {
+        return false;
+    }
+    memcpy(block, data + sizeof(header), blockSize);
+    sectionCount = header.sectionCount;
+    entryCount = header.entryCount;
+    arenaUsed = header.arenaUsed;
+    sourceSize = header.sourceSize;
+    sourceCrc = header.sourceCrc;
+
+    // Every string must stay inside the arena
+    if (arena[arenaUsed - 1] != '\0') {
+        LOG_WARNING("ConfigStore: Snapshot arena is corrupt");
+        clear();
+        return false;
+    }
+    for (uint16_t i = 0; i < sectionCount; i++) {
+        if (sections[i].name >= arenaUsed || sections[i].firstEntry + sections[i].entryCount > entryCount) {
+            LOG_WARNING("ConfigStore: Snapshot tables are corrupt");
+            clear();
+            return false;
+        }
+    }
+    for (size_t i = 0; i < slotCount; i++) {
+        if (slots[i] != EMPTY_SLOT && (slots[i] < 0 || slots[i] >= sectionCount)) {
+            LOG_WARNING("ConfigStore: Snapshot index is corrupt");
+            clear();
+            return false;
+        }
+    }
+    for (uint16_t i = 0; i < entryCount; i++) {
+        if (entries[i].key >= arenaUsed || entries[i].value >= arenaUsed) {
+            LOG_WARNING("ConfigStore: Snapshot tables are corrupt");
+            clear();
+            return false;
+        }
+    }
+
+    LOG_DEBUGF("ConfigStore: %d sections, %d keys restored from snapshot\n", sectionCount, entryCount);
+    return true;
+}
+
+int ConfigStore::findSection(const char* name) const {
+    if (block == nullptr || name == nullptr) {
+        return -1;
+    }
+    size_t length = strlen(name);
+    return lookupSection(name, length, hashName(name, length));
+}
+
+const char* ConfigStore::getSectionName(int section) const {
+    if (section < 0 || section >= sectionCount) {
+        return nullptr;
+    }
+    return arena + sections[section].name;
+}
+
+int ConfigStore::getEntryCount(int section) const {
+    if (section < 0 || section >= sectionCount) {
+        return 0;
+    }
+    return sections[section].entryCount;
+}
+
+const char* ConfigStore::getKey(int section, int index) const {
+    if (index < 0 || index >= getEntryCount(section)) {
+        return nullptr;
+    }
+    return arena + entries[sections[section].firstEntry + index].key;
+}
+
+const char* ConfigStore::getValue(int section, int index) const {
+    if (index < 0 || index >= getEntryCount(section)) {
+        return nullptr;
+    }
+    return arena + entries[sections[section].firstEntry + index].value;
+}
+
+const char* ConfigStore::getValue(const char* section, const char* key) const {
+    int index = findSection(section);
+    if (index < 0 || key == nullptr) {
+        return nullptr;
+    }
+
+    // Search backwards so a repeated key resolves to its last assignment
+    const Section& s = sections[index];
+    for (int i = s.entryCount - 1; i >= 0; i--) {
+        const Entry& entry = entries[s.firstEntry + i];
+        if (strcmp(arena + entry.key, key) == 0) {
+            return arena + entry.value;
+        }
+    }
+    return nullptr;
+}
+
+uint16_t ConfigStore::intern(const char* start, size_t length, bool lowercase) {
+    uint16_t offset = arenaUsed;
+    char* destination = arena + arenaUsed;
+    for (size_t i = 0; i < length; i++) {
+        destination[i] = lowercase ? tolower((unsigned char)start[i]) : start[i];
+    }
+    destination[length] = '\0';
+    arenaUsed += length + 1;
+    return offset;
+}
+
+int ConfigStore::addSection(const char* name, size_t length) {
+    uint32_t hash = hashName(name, length);
+    int existing = lookupSection(name, length, hash);
+    if (existing >= 0) {
+        return existing;
+    }
+
+    Section& section = sections[sectionCount];
+    section.hash = hash;
+    section.name = intern(name, length, true);
+    section.firstEntry = 0;
+    section.entryCount = 0;
+
+    uint16_t slot = hash & slotMask;
+    while (slots[slot] != EMPTY_SLOT) {
+        slot = (slot + 1) & slotMask;
+    }
+    slots[slot] = sectionCount;
+    return sectionCount++;
+}
+
+int ConfigStore::lookupSection(const char* name, size_t length, uint32_t hash) const {
+    uint16_t slot = hash & slotMask;
+    while (slots[slot] != EMPTY_SLOT) {
+        const Section& section = sections[slots[slot]];
+        const char* sectionName = arena + section.name;
+        if (section.hash == hash && strncasecmp(sectionName, name, length) == 0 && sectionName[length] == '\0') {
+            return slots[slot];
+        }
+        slot = (slot + 1) & slotMask;
+    }
+    return -1;
+}
+
+uint32_t ConfigStore::crc32(const char* data, size_t length) {
+    // Bitwise CRC-32 (IEEE); configs are a few KB, a table would cost more than it saves
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint8_t)data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+uint32_t ConfigStore::hashName(const char* name, size_t length) {
+    // Case-insensitive FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)tolower((unsigned char)name[i])) * 16777619u;
+    }
+    return hash;
+}
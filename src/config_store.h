@@ -0,0 +1,118 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/**
+ * Indexed INI Store
+ *
+ * Holds a parsed INI file in one compact allocation (PSRAM when available): a string arena
+ * with every section name, key and value interned once, a section table, an entry table with
+ * each section's keys stored contiguously, and an open-addressing hash index giving O(1)
+ * section lookup. Section names are case-insensitive, keys are case-sensitive, and later
+ * duplicates win, matching the previous line-scanning parser.
+ *
+ * Tables address the block by offset only, so the block can be written out as a snapshot and
+ * loaded back verbatim, without the source text. The snapshot records the size and CRC-32 of
+ * the text it was built from, letting the caller detect a changed source.
+ */
+class ConfigStore {
+public:
+    ConfigStore() = default;
+    ~ConfigStore();
+
+    ConfigStore(const ConfigStore&) = delete;
+    ConfigStore& operator=(const ConfigStore&) = delete;
+
+    // Parse INI text; the text buffer is not referenced after the call
+    bool load(const char* text, size_t length);
+    void clear();
+    bool isLoaded() const { return block != nullptr; }
+
+    // Exchange contents with another store, e.g. to put a freshly parsed file in place
+    void swap(ConfigStore& other);
+
+    // Section access, returns -1 when the section does not exist
+    int findSection(const char* name) const;
+    int getSectionCount() const { return sectionCount; }
+    const char* getSectionName(int section) const;
+
+    // Entry access within a section
+    int getEntryCount(int section) const;
+    const char* getKey(int section, int index) const;
+    const char* getValue(int section, int index) const;
+
+    // Direct lookup, returns nullptr when the key is missing
+    const char* getValue(const char* section, const char* key) const;
+
+    // True when the section has the same keys and values, in the same order, in both stores;
+    // a section missing from both counts as equal
+    static bool sectionsEqual(const ConfigStore& a, const ConfigStore& b, const char* name);
+
+    size_t getMemoryUsage() const { return blockSize; }
+
+    // Identity of the INI text the store was built from
+    uint32_t getSourceSize() const { return sourceSize; }
+    uint32_t getSourceCrc() const { return sourceCrc; }
+    static uint32_t crc32(const char* data, size_t length);
+
+    // Binary snapshot: header plus the block, position independent
+    size_t getSnapshotSize() const;
+    bool writeSnapshot(uint8_t* out, size_t capacity) const;
+    bool loadSnapshot(const uint8_t* data, size_t size);
+
+private:
+    struct Section {
+        uint32_t hash;
+        uint16_t name;        // Arena offset
+        uint16_t firstEntry;
+        uint16_t entryCount;
+    };
+
+    struct Entry {
+        uint16_t section;
+        uint16_t key;         // Arena offsets
+        uint16_t value;
+    };
+
+    struct SnapshotHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t sectionCount;
+        uint16_t entryCount;
+        uint16_t slotCount;
+        uint32_t arenaUsed;
+        uint32_t sourceSize;
+        uint32_t sourceCrc;
+    };
+
+    static const int16_t EMPTY_SLOT = -1;
+    static const uint32_t SNAPSHOT_MAGIC = 0x53434648;  // "HFCS"
+    static const uint16_t SNAPSHOT_VERSION = 1;
+
+    char* block = nullptr;
+    size_t blockSize = 0;
+
+    Section* sections = nullptr;
+    uint16_t sectionCount = 0;
+    Entry* entries = nullptr;
+    uint16_t entryCount = 0;
+    int16_t* slots = nullptr;
+    uint16_t slotMask = 0;
+    char* arena = nullptr;
+    size_t arenaUsed = 0;
+    uint32_t sourceSize = 0;
+    uint32_t sourceCrc = 0;
+
+    // Allocate the block and lay out the tables for the given counts
+    bool allocate(size_t sectionTotal, size_t entryTotal, size_t slotTotal, size_t arenaBytes);
+
+    uint16_t intern(const char* start, size_t length, bool lowercase);
+    int addSection(const char* name, size_t length);
+    int lookupSection(const char* name, size_t length, uint32_t hash) const;
+
+    static uint32_t hashName(const char* name, size_t length);
+};
+
+#endif // CONFIG_STORE_H
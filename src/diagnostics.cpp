@@ -0,0 +1,136 @@
+#include "diagnostics.h"
+#include "boot_sequencer.h"
+#include "config.h"
+#include "display.h"
+#include "event_manager.h"
+#include "logger.h"
+
+bool Diagnostics::enabled = false;
+int Diagnostics::fetchRuns = 0;
+std::atomic<bool> Diagnostics::showingResults{false};
+
+void Diagnostics::Start() {
+    enabled = config.diagnostics.enabled;
+    if (!enabled) {
+        return;
+    }
+    fetchRuns = config.diagnostics.fetchRuns > 0 ? config.diagnostics.fetchRuns : 1;
+
+    if (xTaskCreate(Run, "Diagnostics", TASK_STACK_SIZE, NULL, TASK_PRIORITY, NULL) != pdPASS) {
+        LOG_ERROR("Diagnostics: Failed to create task");
+        enabled = false;
+        return;
+    }
+    LOG_INFO("Diagnostics: Benchmark mode enabled");
+}
+
+int Diagnostics::parseFrameRates(const String& list, int* rates, int maxRates) {
+    int count = 0;
+    int start = 0;
+    while (start < (int)list.length() && count < maxRates) {
+        int comma = list.indexOf(',', start);
+        int end = comma >= 0 ? comma : list.length();
+        int rate = list.substring(start, end).toInt();
+        if (rate > 0 && rate <= 1000) {
+            rates[count++] = rate;
+        }
+        start = end + 1;
+    }
+    return count;
+}
+
+void Diagnostics::Run(void* parameter) {
+    BootSequencer::waitFor(BootSequencer::Stage::DASHBOARD);
+
+    int rates[MAX_FRAME_RATES];
+    int rateCount = parseFrameRates(config.diagnostics.frameRates, rates, MAX_FRAME_RATES);
+    int stepSeconds = config.diagnostics.stepSeconds > 0 ? config.diagnostics.stepSeconds : 1;
+
+    LOG_INFOF("Diagnostics: Sweeping %d frame rates, %d s each\n", rateCount, stepSeconds);
+    for (int i = 0; i < rateCount; i++) {
+        benchmarkFrameRate(rates[i], stepSeconds);
+    }
+    Display::SetBenchmarkInterval(0);
+
+    // Results stay on the terminal; fetch reports emitted meanwhile land there as well
+    showingResults.store(true);
+    Display::SetState(Display::State::TERMINAL);
+    TerminalEvent done(0, "DG", "Benchmark finished", TerminalEvent::State::SUCCESS);
+    EventManager::Emit(done);
+    vTaskDelay(pdMS_TO_TICKS((uint32_t)config.diagnostics.resultSeconds * 1000));
+    showingResults.store(false);
+
+    LOG_INFO("Diagnostics: Done, resuming normal operation");
+    vTaskDelete(NULL);
+}
+
+void Diagnostics::benchmarkFrameRate(int framesPerSecond, int stepSeconds) {
+    Display::FrameStats stats;
+    Display::SetBenchmarkInterval(1000 / framesPerSecond);
+
+    // The first collection closes whatever window was open, so the step is measured on its own
+    if (!Display::CollectFrameStats(stats, STATS_TIMEOUT)) {
+        LOG_WARNING("Diagnostics: Display did not answer, skipping frame rate");
+        return;
+    }
+    vTaskDelay(pdMS_TO_TICKS((uint32_t)stepSeconds * 1000));
+    if (!Display::CollectFrameStats(stats, STATS_TIMEOUT)) {
+        LOG_WARNING("Diagnostics: Display did not answer, skipping frame rate");
+        return;
+    }
+
+    uint32_t achievedTenths = stats.windowMs > 0 ? stats.frames * 10000 / stats.windowMs : 0;
+    LOG_INFOF("Diagnostics: target %d fps, achieved %u.%u fps (%u frames in %u ms)\n", framesPerSecond,
+              (unsigned)(achievedTenths / 10), (unsigned)(achievedTenths % 10), (unsigned)stats.frames,
+              (unsigned)stats.windowMs);
+    LOG_INFOF("  draw p50/p95/max %u/%u/%u us, send p50/p95 %u/%u us\n", (unsigned)stats.drawP50,
+              (unsigned)stats.drawP95, (unsigned)stats.drawMax, (unsigned)stats.sendP50, (unsigned)stats.sendP95);
+    for (int i = 0; i < stats.moduleCount; i++) {
+        const Display::FrameStats::ModuleCost& cost = stats.modules[i];
+        LOG_INFOF("  %-12s draw %u/%u/%u us over %u frames\n", cost.name, (unsigned)cost.p50, (unsigned)cost.p95,
+                  (unsigned)cost.max, (unsigned)cost.draws);
+    }
+
+    char line[48];
+    snprintf(line, sizeof(line), "%d fps: %u.%u fps, draw %u us", framesPerSecond, (unsigned)(achievedTenths / 10),
+             (unsigned)(achievedTenths % 10), (unsigned)stats.drawP95);
+    bool kept = achievedTenths * 100 >= (uint32_t)framesPerSecond * 950;  // Within 5% of the target
+    TerminalEvent event(0, "DG", line, kept ? TerminalEvent::State::SUCCESS : TerminalEvent::State::FAILURE);
+    EventManager::Emit(event);
+}
+
+void Diagnostics::ReportFetch(const char* group, int run, int httpCode, const HttpService::RequestTiming& timing) {
+    using Timing = HttpService::RequestTiming;
+
+    uint32_t totalUs = 0;
+    for (int i = 0; i < Timing::PHASE_COUNT; i++) {
+        totalUs += timing.phases[i].micros;
+    }
+
+    LOG_INFOF("Diagnostics: %s fetch %d (%s) HTTP %d, %u bytes, %u us%s%s\n", group, run + 1,
+              run == 0 ? "cold" : "warm", httpCode, (unsigned)timing.bodyBytes, (unsigned)totalUs,
+              timing.dnsCached ? ", DNS cached" : "", timing.reusedConnection ? ", socket reused" : "");
+    for (int i = 0; i < Timing::PHASE_COUNT; i++) {
+        const Timing::PhaseSample& phase = timing.phases[i];
+        LOG_INFOF("  %-10s %8u us  min free %u -> %u, largest block %u -> %u\n",
+                  Timing::phaseName(i), (unsigned)phase.micros,
+                  (unsigned)phase.minFreeHeapBefore, (unsigned)phase.minFreeHeapAfter,
+                  (unsigned)phase.largestBlockBefore, (unsigned)phase.largestBlockAfter);
+    }
+
+    char line[48];
+    snprintf(line, sizeof(line), "Fetch %d %s: %u ms", run + 1, run == 0 ? "cold" : "warm",
+             (unsigned)(totalUs / 1000));
+    bool ok = httpCode == 200 || httpCode == 304;
+    TerminalEvent summary(0, group, line, ok ? TerminalEvent::State::SUCCESS : TerminalEvent::State::FAILURE);
+    EventManager::Emit(summary);
+
+    snprintf(line, sizeof(line), "dns %u conn %u ttfb %u rd %u ps %u",
+             (unsigned)(timing.phases[Timing::DNS].micros / 1000),
+             (unsigned)(timing.phases[Timing::CONNECT].micros / 1000),
+             (unsigned)(timing.phases[Timing::FIRST_BYTE].micros / 1000),
+             (unsigned)(timing.phases[Timing::BODY_READ].micros / 1000),
+             (unsigned)(timing.phases[Timing::PARSE].micros / 1000));
+    TerminalEvent phases(0, group, line, TerminalEvent::State::SUCCESS);
+    EventManager::Emit(phases);
+}
@@ -0,0 +1,49 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "http_service.h"
+
+/**
+ * Diagnostics Mode
+ *
+ * With [diagnostics] enable=true the device benchmarks itself once the dashboard is up. The
+ * display is swept through the configured frame rates with render caches bypassed, and for
+ * every step the achieved frame rate and the draw, send and per-module costs are recorded.
+ * Network modules run fetch_runs timed fetches, the first one on a cold socket and DNS cache,
+ * and report each HTTP phase with its duration and the heap around it.
+ *
+ * Every figure is written to the log and summarized on the terminal, which then stays up for
+ * result_seconds before the dashboard returns. Normal operation resumes afterwards.
+ */
+class Diagnostics {
+  public:
+    // Start the benchmark task when enabled, called once after the configuration is loaded
+    static void Start();
+
+    static bool IsEnabled() { return enabled; }
+    static int GetFetchRuns() { return fetchRuns; }
+
+    // True while the results hold the terminal; the dashboard waits until then
+    static bool IsShowingResults() { return showingResults.load(); }
+
+    // Report one timed fetch of a network module; run 0 is the cold one
+    static void ReportFetch(const char* group, int run, int httpCode, const HttpService::RequestTiming& timing);
+
+  private:
+    static const int MAX_FRAME_RATES = 8;
+    static const uint32_t TASK_STACK_SIZE = 4096;
+    static const UBaseType_t TASK_PRIORITY = 1;
+    static const TickType_t STATS_TIMEOUT = pdMS_TO_TICKS(2000);
+
+    static bool enabled;
+    static int fetchRuns;
+    static std::atomic<bool> showingResults;
+
+    static void Run(void* parameter);
+    static void benchmarkFrameRate(int framesPerSecond, int stepSeconds);
+    static int parseFrameRates(const String& list, int* rates, int maxRates);
+};
+
+#endif  // DIAGNOSTICS_H
@@ -1,9 +1,18 @@
 #include "display.h"
 #include "logger.h"
+#include "config.h"
+#include "display_dma.h"
 #include "memory_manager.h"
+#include "metrics.h"
+#include "power_manager.h"
 #include <SPI.h>
 #include <U8g2lib.h>
+#include <algorithm>
+#include <cstring>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include "modules/module.h"
+#include "modules/module_registry.h"
 #include "terminal.h"
 
 extern SemaphoreHandle_t spiMutex;
@@ -12,6 +21,8 @@ extern SemaphoreHandle_t spiMutex;
 U8G2_SSD1309_128X64_NONAME0_F_4W_HW_SPI u8g2(U8G2_R0, DISPLAY_CS_PIN, DISPLAY_DC_PIN, DISPLAY_RES_PIN);
 
 Display::State Display::currentState = Display::State::TERMINAL;
+TaskHandle_t Display::taskHandle = NULL;
+uint32_t Display::frameCount = 0;
 
 // Initialize animation variables
 int Display::loadingAngle = 0;
@@ -21,14 +32,74 @@ int Display::bootStep = 0;
 int Display::stepProgress = 0;
 bool Display::stepCompleted = false;
 
+TaskHandle_t Display::txTaskHandle = NULL;
+SemaphoreHandle_t Display::txIdle = NULL;
+uint8_t Display::txFrame[Display::FRAME_BUFFER_SIZE];
+uint8_t Display::previousFrame[Display::FRAME_BUFFER_SIZE];
+std::atomic<bool> Display::fullRefreshPending{true};
+
+LatencyHistogram Display::spiWaitHistogram;
+LatencyHistogram Display::drawHistogram;
+LatencyHistogram Display::sendHistogram;
+portMUX_TYPE Display::histogramLock = portMUX_INITIALIZER_UNLOCKED;
+Display::ModuleProfile Display::moduleProfiles[Display::MAX_PROFILED_MODULES];
+unsigned long Display::lastFrameStatsLog = 0;
+std::atomic<uint32_t> Display::benchmarkIntervalMs{0};
+std::atomic<bool> Display::frameStatsRequested{false};
+SemaphoreHandle_t Display::frameStatsReady = NULL;
+Display::FrameStats Display::lastFrameStats = {};
+
+Terminal::Line Display::terminalSnapshot[Display::TERMINAL_VISIBLE_LINES];
+Display::TerminalRow Display::terminalRows[Display::TERMINAL_VISIBLE_LINES];
+int Display::terminalRowCount = 0;
+
+Display::RenderCache Display::renderCaches[Display::MAX_CACHED_MODULES];
+uint8_t Display::regionScratch[Display::FRAME_BUFFER_SIZE];
+uint32_t Display::renderCacheHits = 0;
+uint32_t Display::renderCacheMisses = 0;
+
+Display::Layer Display::layers[Display::MAX_LAYERS];
+int Display::layerCount = 0;
+modules::Bounds Display::dirtyRegions[Display::MAX_DIRTY_REGIONS];
+int Display::dirtyCount = 0;
+bool Display::dashboardInvalid = true;
+std::atomic<bool> Display::renderCachesInvalid{false};
+SemaphoreHandle_t Display::compositionMutex = NULL;
+
+namespace {
+Metrics::Id framesMetric = Metrics::NO_METRIC;
+Metrics::Id drawDurationMetric = Metrics::NO_METRIC;
+Metrics::Id sendDurationMetric = Metrics::NO_METRIC;
+}  // namespace
+
 void Display::Setup() {
     LOG_INFO("Display setup");
+    frameStatsReady = xSemaphoreCreateBinary();
+    compositionMutex = xSemaphoreCreateMutex();
+    framesMetric = Metrics::Register(Metrics::Type::COUNTER, "display_frames_total", "Frames sent to the panel");
+    drawDurationMetric =
+        Metrics::Register(Metrics::Type::HISTOGRAM, "display_draw_duration_seconds", "Dashboard composition time");
+    sendDurationMetric =
+        Metrics::Register(Metrics::Type::HISTOGRAM, "display_send_duration_seconds", "Frame transfer time");
+    DisplayDma::attach(u8g2.getU8x8());
     u8g2.begin();
 }
 
 void Display::Run() {
+    taskHandle = xTaskGetCurrentTaskHandle();
     Terminal::Setup();
 
+    // The transfer stage runs next to the compositor; without it frames are sent inline
+    txIdle = xSemaphoreCreateBinary();
+    if (txIdle != NULL) {
+        xSemaphoreGive(txIdle);
+        if (xTaskCreatePinnedToCore(txTaskWrapper, "DisplayTx", TX_TASK_STACK_SIZE, NULL, TX_TASK_PRIORITY,
+                                    &txTaskHandle, xPortGetCoreID()) != pdPASS) {
+            txTaskHandle = NULL;
+            LOG_WARNING("Display: Transfer task not started, sending frames inline");
+        }
+    }
+
     // Skip MemoryManager for Display - it's causing system hangs
     // Display will work directly with available heap memory
     bool memoryReserved = true; // Always assume we have memory for basic display operations
@@ -56,46 +127,85 @@ void Display::Run() {
             continue;
         }
 
-        if (xSemaphoreTake(spiMutex, portMAX_DELAY) == pdTRUE) {
-            // Only draw if we have memory reserved OR if we're in emergency mode
-            if (memoryReserved) {
-                switch (currentState) {
-                    case State::TERMINAL:
-                        drawTerminal();
-                        break;
-                    case State::DASHBOARD:
-                        drawDashboard();
-                        break;
-                }
+        // Terminal scrolling animates continuously, the dashboard sleeps until the earliest module deadline
+        uint32_t nextUpdateMs = normalUpdateMs;
+        bool animating = true;
+
+        // Composition only touches the framebuffer, the bus is taken by the transfer stage
+        if (memoryReserved) {
+            switch (currentState) {
+                case State::TERMINAL:
+                    animating = drawTerminal();
+                    break;
+                case State::DASHBOARD:
+                    drawDashboard();
+                    nextUpdateMs = getDashboardRedrawInterval();
+                    animating = nextUpdateMs < ANIMATION_INTERVAL_MS;
+                    break;
             }
+        }
+        nextUpdateMs = governFrameInterval(nextUpdateMs, animating);
 
-            xSemaphoreGive(spiMutex);
+        if (!memoryReserved) {
+            nextUpdateMs = degradedUpdateMs;
         }
-        
-        // Use different update frequencies based on memory availability
-        vTaskDelay(pdMS_TO_TICKS(memoryReserved ? normalUpdateMs : degradedUpdateMs));
+
+        bool statsRequested = frameStatsRequested.exchange(false);
+        if (statsRequested || millis() - lastFrameStatsLog >= FRAME_STATS_LOG_INTERVAL_MS) {
+            logFrameStats();
+            lastFrameStatsLog = millis();
+            if (statsRequested && frameStatsReady != NULL) {
+                xSemaphoreGive(frameStatsReady);
+            }
+        }
+
+        // Sleep until the deadline or until someone calls RequestRedraw()
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(nextUpdateMs));
     }
     
     // No memory cleanup needed in direct mode
 }
 
-void Display::drawTerminal() {
-    const auto& console_lines = Terminal::GetLines();
+void Display::refreshTerminalRows() {
+    // A snapshot torn by writers every time is rare; drawing the previous one keeps the frame consistent
+    int count = Terminal::GetLines(terminalSnapshot, TERMINAL_VISIBLE_LINES);
+    if (count < 0) {
+        return;
+    }
+
+    // A line keeps its scroll position while its text is unchanged, wherever it moved on screen
+    float offsets[TERMINAL_VISIBLE_LINES];
+    for (int i = 0; i < count; i++) {
+        offsets[i] = 0;
+        for (int j = 0; j < terminalRowCount; j++) {
+            if (terminalRows[j].line.revision == terminalSnapshot[i].revision) {
+                offsets[i] = terminalRows[j].offsetX;
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        terminalRows[i].line = terminalSnapshot[i];
+        terminalRows[i].offsetX = offsets[i];
+    }
+    terminalRowCount = count;
+}
+
+bool Display::drawTerminal() {
+    refreshTerminalRows();
 
     u8g2.clearBuffer();
     u8g2.setFont(u8g2_font_5x7_tf);
     int yPos = 10;
     char progress_str[10];
 
-    int linesToShow = std::min(6, (int)console_lines.size());
-    int startIndex = std::max(0, (int)console_lines.size() - 6);
-
-    int group_width[linesToShow];
+    int linesToShow = terminalRowCount;
+    int group_width[TERMINAL_VISIBLE_LINES];
+    bool animating = false;
 
     for (int i = 0; i < linesToShow; i++) {
-        int lineIndex = startIndex + i;
         char group_with_brackets[10];
-        snprintf(group_with_brackets, sizeof(group_with_brackets), "[%s]", console_lines[lineIndex].group.c_str());
+        snprintf(group_with_brackets, sizeof(group_with_brackets), "[%s]", terminalRows[i].line.group);
         u8g2.drawStr(0, yPos, group_with_brackets);
         group_width[i] = u8g2.getStrWidth(group_with_brackets);
         yPos += 10;
@@ -105,24 +215,21 @@ void Display::drawTerminal() {
     int xPos = 20;
     u8g2.setFont(u8g2_font_4x6_tf);
 
-    // Get mutable reference to console_lines for animation
-    auto& mutable_console_lines = const_cast<std::vector<Terminal::ConsoleLine>&>(console_lines);
-
     for (int i = 0; i < linesToShow; i++) {
-        int lineIndex = startIndex + i;
+        TerminalRow& row = terminalRows[i];
         xPos = group_width[i] + 1;
-        int charCount = 24 - mutable_console_lines[lineIndex].group.length();
-        if (mutable_console_lines[lineIndex].status.length() == 0) {
+        int charCount = 24 - strlen(row.line.group);
+        if (row.line.status[0] == '\0') {
             charCount -= 1;
         }
 
         char description[30];
-        int startPos = int(mutable_console_lines[lineIndex].offsetX);
+        int startPos = int(row.offsetX);
         for (int j = 0; j < charCount; j++) {
             if (startPos + j < 0) {
                 description[j] = ' ';  // Show spaces during pause
             } else {
-                description[j] = mutable_console_lines[lineIndex].description[startPos + j];
+                description[j] = row.line.description[startPos + j];
                 if (description[j] == '\0') {
                     break;
                 }
@@ -130,25 +237,27 @@ void Display::drawTerminal() {
         }
         description[charCount] = '\0';
 
-        int descriptionLength = mutable_console_lines[lineIndex].description.length();
+        int descriptionLength = strlen(row.line.description);
         if (descriptionLength > charCount) {
+            animating = true;
+
             // Smoother animation with smaller increments
-            mutable_console_lines[lineIndex].offsetX += 0.12;
+            row.offsetX += 0.12;
 
             // Calculate proper loop point for seamless scrolling
             int maxOffset = descriptionLength - charCount;
-            if (mutable_console_lines[lineIndex].offsetX > maxOffset + 3) {  // Add 3 char pause at end
-                mutable_console_lines[lineIndex].offsetX = -3;               // Start 3 chars before beginning for pause
+            if (row.offsetX > maxOffset + 3) {  // Add 3 char pause at end
+                row.offsetX = -3;               // Start 3 chars before beginning for pause
             }
         }
 
         u8g2.drawStr(xPos, yPos, description);
-        if (mutable_console_lines[lineIndex].status.length() > 0) {
+        if (row.line.status[0] != '\0') {
             char status_with_brackets[10];
-            snprintf(status_with_brackets, sizeof(status_with_brackets), "[%s]",
-                     mutable_console_lines[lineIndex].status.c_str());
+            snprintf(status_with_brackets, sizeof(status_with_brackets), "[%s]", row.line.status);
             drawRightAlignedText(status_with_brackets, yPos);
         } else {
+            animating = true;
             switch (loadingDots) {
                 case 0:
                     strcpy(progress_str, "[.  ]");
@@ -168,40 +277,621 @@ void Display::drawTerminal() {
         yPos += 10;
     }
 
-    u8g2.sendBuffer();
+    presentFrame();
     animationCounter++;
 
     if (animationCounter % 15 == 0) {
         loadingDots = (loadingDots + 1) % 4;
     }
+    return animating;
 }
 
 void Display::drawDashboard() {
-    u8g2.clearBuffer();
+    LockComposition();
+    bool changed = composeDashboard();
+    UnlockComposition();
 
-    // First pass: Draw all non-overlay modules
-    for (int i = 0; i < active_modules.size(); i++) {
+    if (changed) {
+        presentFrame();
+    }
+}
+
+bool Display::composeDashboard() {
+    int64_t drawStart = esp_timer_get_time();
+
+    // A module was reconfigured: what it retained may look different now at the same version
+    if (renderCachesInvalid.exchange(false)) {
+        for (int i = 0; i < MAX_CACHED_MODULES; i++) {
+            renderCaches[i].version = modules::IModule::CONTENT_UNVERSIONED;
+        }
+        dashboardInvalid = true;
+    }
+
+    // Benchmark frames measure the full composition, not the cost of an unchanged frame
+    if (benchmarkIntervalMs.load() != 0) {
+        dashboardInvalid = true;
+    }
+
+    Layer next[MAX_LAYERS];
+    int nextCount = collectLayers(next);
+
+    // Invalidate what changed since the last frame: new, removed, moved, shown or hidden layers,
+    // and visible layers whose content version moved on (or that have none)
+    dirtyCount = 0;
+    for (int i = 0; i < nextCount; i++) {
+        const Layer& layer = next[i];
+        const Layer* previous = nullptr;
+        for (int j = 0; j < layerCount; j++) {
+            if (layers[j].module == layer.module) {
+                previous = &layers[j];
+                break;
+            }
+        }
+
+        if (previous == nullptr) {
+            if (layer.visible) {
+                invalidateRegion(layer.bounds);
+            }
+        } else if (previous->visible != layer.visible || !sameBounds(previous->bounds, layer.bounds)) {
+            if (previous->visible) {
+                invalidateRegion(previous->bounds);
+            }
+            if (layer.visible) {
+                invalidateRegion(layer.bounds);
+            }
+        } else if (layer.visible && (layer.version == modules::IModule::CONTENT_UNVERSIONED ||
+                                     layer.version != previous->version)) {
+            invalidateRegion(layer.bounds);
+        }
+    }
+    for (int j = 0; j < layerCount; j++) {
+        bool present = false;
+        for (int i = 0; i < nextCount && !present; i++) {
+            present = next[i].module == layers[j].module;
+        }
+        if (!present && layers[j].visible) {
+            invalidateRegion(layers[j].bounds);
+        }
+    }
+    memcpy(layers, next, sizeof(Layer) * nextCount);
+    layerCount = nextCount;
+
+    if (dashboardInvalid) {
+        u8g2.clearBuffer();
+        dirtyRegions[0] = {0, 0, FRAME_TILE_WIDTH * 8, FRAME_TILE_HEIGHT * 8};
+        dirtyCount = 1;
+        dashboardInvalid = false;
+    }
+
+    // Nothing changed: the frame on the panel is still right
+    if (dirtyCount == 0) {
+        return false;
+    }
+
+    for (int r = 0; r < dirtyCount; r++) {
+        const modules::Bounds& region = dirtyRegions[r];
+        clearRegion(region);
+        for (int i = 0; i < layerCount; i++) {
+            modules::Bounds clip;
+            if (layers[i].visible && intersect(layers[i].bounds, region, clip)) {
+                drawModule(layers[i], clip);
+            }
+        }
+    }
+    uint32_t drawUs = esp_timer_get_time() - drawStart;
+    drawHistogram.record(drawUs);
+    Metrics::Observe(drawDurationMetric, drawUs);
+    return true;
+}
+
+int Display::collectLayers(Layer* out) {
+    // Every module in the table can be on the dashboard at once, so no active module is ever dropped
+    static_assert(MAX_LAYERS >= modules::ModuleRegistry::MAX_MODULES, "MAX_LAYERS below MAX_MODULES");
+
+    int count = 0;
+    for (int i = 0; i < active_modules.size() && count < MAX_LAYERS; i++) {
         modules::IModule* module = active_modules[i];
-        if (!module->IsOverlay()) {
-            module->Draw();
+        Layer layer;
+        layer.module = module;
+        layer.visible = module->IsVisible();
+        bool bounded = module->GetBounds(layer.bounds) && clampBounds(layer.bounds);
+        if (!bounded) {
+            layer.bounds = {0, 0, FRAME_TILE_WIDTH * 8, FRAME_TILE_HEIGHT * 8};
         }
+        layer.version = bounded && layer.visible ? module->GetContentVersion() : modules::IModule::CONTENT_UNVERSIONED;
+
+        // Stable insertion by z-order: equal layers keep registration order
+        int position = count;
+        while (position > 0 && out[position - 1].module->GetZOrder() > module->GetZOrder()) {
+            out[position] = out[position - 1];
+            position--;
+        }
+        out[position] = layer;
+        count++;
     }
-    
-    // Second pass: Draw overlay modules on top
+    return count;
+}
+
+void Display::invalidateRegion(const modules::Bounds& region) {
+    // Inside an existing region already
+    for (int i = 0; i < dirtyCount; i++) {
+        modules::Bounds overlap;
+        if (intersect(dirtyRegions[i], region, overlap) && sameBounds(overlap, region)) {
+            return;
+        }
+    }
+    if (dirtyCount < MAX_DIRTY_REGIONS) {
+        dirtyRegions[dirtyCount++] = region;
+        return;
+    }
+
+    // Too many to track: fold everything into one bounding rectangle
+    int x0 = region.x, y0 = region.y;
+    int x1 = region.x + region.width, y1 = region.y + region.height;
+    for (int i = 0; i < dirtyCount; i++) {
+        x0 = std::min(x0, dirtyRegions[i].x);
+        y0 = std::min(y0, dirtyRegions[i].y);
+        x1 = std::max(x1, dirtyRegions[i].x + dirtyRegions[i].width);
+        y1 = std::max(y1, dirtyRegions[i].y + dirtyRegions[i].height);
+    }
+    dirtyRegions[0] = {x0, y0, x1 - x0, y1 - y0};
+    dirtyCount = 1;
+}
+
+bool Display::intersect(const modules::Bounds& a, const modules::Bounds& b, modules::Bounds& out) {
+    int x0 = std::max(a.x, b.x);
+    int y0 = std::max(a.y, b.y);
+    int x1 = std::min(a.x + a.width, b.x + b.width);
+    int y1 = std::min(a.y + a.height, b.y + b.height);
+    if (x1 <= x0 || y1 <= y0) {
+        return false;
+    }
+    out = {x0, y0, x1 - x0, y1 - y0};
+    return true;
+}
+
+bool Display::sameBounds(const modules::Bounds& a, const modules::Bounds& b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+void Display::drawModule(const Layer& layer, const modules::Bounds& clip) {
+    int64_t start = esp_timer_get_time();
+
+    // Benchmark frames time Draw() itself, so retained bitmaps are bypassed
+    RenderCache* cache = layer.version != modules::IModule::CONTENT_UNVERSIONED && benchmarkIntervalMs.load() == 0
+                             ? findRenderCache(layer.module, layer.bounds)
+                             : nullptr;
+    if (cache != nullptr) {
+        if (cache->version == layer.version) {
+            renderCacheHits++;
+        } else {
+            renderToCache(layer.module, layer.bounds, *cache, layer.version);
+            renderCacheMisses++;
+        }
+        mergeCached(*cache, clip);
+    } else {
+        u8g2.setClipWindow(clip.x, clip.y, clip.x + clip.width, clip.y + clip.height);
+        layer.module->Draw();
+        u8g2.setMaxClipWindow();
+    }
+    uint32_t elapsed = esp_timer_get_time() - start;
+
+    // Modules are few and long-lived; claim a profile slot on first draw. Slots of released modules
+    // are freed again, so the module's own slot may come after a free one.
+    ModuleProfile* unused = nullptr;
+    for (int i = 0; i < MAX_PROFILED_MODULES; i++) {
+        ModuleProfile& profile = moduleProfiles[i];
+        if (profile.module == layer.module) {
+            profile.histogram.record(elapsed);
+            return;
+        }
+        if (profile.module == nullptr && unused == nullptr) {
+            unused = &profile;
+        }
+    }
+    if (unused != nullptr) {
+        unused->module = layer.module;
+        unused->histogram.record(elapsed);
+    }
+}
+
+void Display::renderToCache(modules::IModule* module, const modules::Bounds& bounds, RenderCache& cache,
+                            uint32_t version) {
+    // Draw alone into the cleared rectangle, keep the result, then put the frame back as it was
+    captureRegion(bounds, regionScratch);
+    clearRegion(bounds);
+    u8g2.setClipWindow(bounds.x, bounds.y, bounds.x + bounds.width, bounds.y + bounds.height);
+    module->Draw();
+    u8g2.setMaxClipWindow();
+    captureRegion(bounds, cache.pixels);
+    restoreRegion(bounds, regionScratch);
+    cache.version = version;
+}
+
+Display::RenderCache* Display::findRenderCache(const modules::IModule* module, const modules::Bounds& bounds) {
+    RenderCache* unused = nullptr;
+    for (int i = 0; i < MAX_CACHED_MODULES; i++) {
+        RenderCache& cache = renderCaches[i];
+        if (cache.module == module) {
+            if (cache.x == bounds.x && cache.y == bounds.y && cache.width == bounds.width &&
+                cache.height == bounds.height) {
+                return &cache;
+            }
+            // Moved or resized: the retained pixels no longer apply
+            heap_caps_free(cache.pixels);
+            cache = RenderCache();
+            unused = &cache;
+            break;
+        }
+        if (cache.module == nullptr && unused == nullptr) {
+            unused = &cache;
+        }
+    }
+    if (unused == nullptr) {
+        return nullptr;
+    }
+
+    int pages = (bounds.y + bounds.height - 1) / 8 - bounds.y / 8 + 1;
+    size_t size = (size_t)pages * bounds.width;
+    uint8_t* pixels = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    if (pixels == nullptr) {
+        return nullptr;
+    }
+    unused->module = module;
+    unused->version = modules::IModule::CONTENT_UNVERSIONED;
+    unused->x = bounds.x;
+    unused->y = bounds.y;
+    unused->width = bounds.width;
+    unused->height = bounds.height;
+    unused->pixels = pixels;
+    unused->size = size;
+    return unused;
+}
+
+bool Display::clampBounds(modules::Bounds& bounds) {
+    const int screenWidth = FRAME_TILE_WIDTH * 8;
+    const int screenHeight = FRAME_TILE_HEIGHT * 8;
+    int x1 = std::min(bounds.x + bounds.width, screenWidth);
+    int y1 = std::min(bounds.y + bounds.height, screenHeight);
+    bounds.x = std::max(bounds.x, 0);
+    bounds.y = std::max(bounds.y, 0);
+    bounds.width = x1 - bounds.x;
+    bounds.height = y1 - bounds.y;
+    return bounds.width > 0 && bounds.height > 0;
+}
+
+// The framebuffer is page-ordered: one byte holds 8 vertical pixels of a column, LSB on top
+static uint8_t pageMask(const modules::Bounds& bounds, int page) {
+    int top = std::max(bounds.y - page * 8, 0);
+    int bottom = std::min(bounds.y + bounds.height - page * 8, 8);
+    return (uint8_t)((0xFF << top) & (0xFF >> (8 - bottom)));
+}
+
+void Display::captureRegion(const modules::Bounds& bounds, uint8_t* out) {
+    const uint8_t* buffer = u8g2.getBufferPtr();
+    const int stride = FRAME_TILE_WIDTH * 8;
+    for (int page = bounds.y / 8; page <= (bounds.y + bounds.height - 1) / 8; page++) {
+        uint8_t mask = pageMask(bounds, page);
+        const uint8_t* row = buffer + page * stride + bounds.x;
+        for (int column = 0; column < bounds.width; column++) {
+            *out++ = row[column] & mask;
+        }
+    }
+}
+
+void Display::clearRegion(const modules::Bounds& bounds) {
+    uint8_t* buffer = u8g2.getBufferPtr();
+    const int stride = FRAME_TILE_WIDTH * 8;
+    for (int page = bounds.y / 8; page <= (bounds.y + bounds.height - 1) / 8; page++) {
+        uint8_t keep = ~pageMask(bounds, page);
+        uint8_t* row = buffer + page * stride + bounds.x;
+        for (int column = 0; column < bounds.width; column++) {
+            row[column] &= keep;
+        }
+    }
+}
+
+void Display::restoreRegion(const modules::Bounds& bounds, const uint8_t* pixels) {
+    uint8_t* buffer = u8g2.getBufferPtr();
+    const int stride = FRAME_TILE_WIDTH * 8;
+    for (int page = bounds.y / 8; page <= (bounds.y + bounds.height - 1) / 8; page++) {
+        uint8_t keep = ~pageMask(bounds, page);
+        uint8_t* row = buffer + page * stride + bounds.x;
+        for (int column = 0; column < bounds.width; column++) {
+            row[column] = (row[column] & keep) | *pixels++;
+        }
+    }
+}
+
+void Display::mergeCached(const RenderCache& cache, const modules::Bounds& clip) {
+    uint8_t* buffer = u8g2.getBufferPtr();
+    const int stride = FRAME_TILE_WIDTH * 8;
+    const int firstPage = cache.y / 8;
+    for (int page = clip.y / 8; page <= (clip.y + clip.height - 1) / 8; page++) {
+        uint8_t mask = pageMask(clip, page);
+        uint8_t* row = buffer + page * stride + clip.x;
+        const uint8_t* source = cache.pixels + (page - firstPage) * cache.width + (clip.x - cache.x);
+        for (int column = 0; column < clip.width; column++) {
+            row[column] |= source[column] & mask;
+        }
+    }
+}
+
+void Display::CopyFrameHistograms(LatencyHistogram& spiWait, LatencyHistogram& draw, LatencyHistogram& send) {
+    // Recorded by this task, no lock needed
+    draw = drawHistogram;
+
+    portENTER_CRITICAL(&histogramLock);
+    spiWait = spiWaitHistogram;
+    send = sendHistogram;
+    portEXIT_CRITICAL(&histogramLock);
+}
+
+void Display::logFrameStats() {
+    // Hold the transfer stage idle so its histograms are not reset mid-record
+    if (txIdle != NULL) {
+        xSemaphoreTake(txIdle, portMAX_DELAY);
+    }
+    FrameStats& stats = lastFrameStats;
+    memset(&stats, 0, sizeof(stats));
+    stats.windowMs = millis() - lastFrameStatsLog;
+    if (sendHistogram.getCount() == 0) {
+        if (txIdle != NULL) {
+            xSemaphoreGive(txIdle);
+        }
+        return;
+    }
+    stats.frames = sendHistogram.getCount();
+    stats.drawP50 = drawHistogram.getPercentile(50);
+    stats.drawP95 = drawHistogram.getPercentile(95);
+    stats.drawMax = drawHistogram.getMax();
+    stats.sendP50 = sendHistogram.getPercentile(50);
+    stats.sendP95 = sendHistogram.getPercentile(95);
+
+    // Microseconds, p50/p95/max over the last window
+    LOG_INFOF("Display: %u frames, spi wait %u/%u/%u us, draw %u/%u/%u us, send %u/%u/%u us\n",
+              (unsigned)sendHistogram.getCount(), (unsigned)spiWaitHistogram.getPercentile(50),
+              (unsigned)spiWaitHistogram.getPercentile(95), (unsigned)spiWaitHistogram.getMax(),
+              (unsigned)drawHistogram.getPercentile(50), (unsigned)drawHistogram.getPercentile(95),
+              (unsigned)drawHistogram.getMax(), (unsigned)sendHistogram.getPercentile(50),
+              (unsigned)sendHistogram.getPercentile(95), (unsigned)sendHistogram.getMax());
+
+    if (renderCacheHits + renderCacheMisses > 0) {
+        LOG_INFOF("  render cache %u hits, %u misses\n", (unsigned)renderCacheHits, (unsigned)renderCacheMisses);
+    }
+    renderCacheHits = 0;
+    renderCacheMisses = 0;
+
+    // Under the composition lock, so no module is released while its name is read
+    LockComposition();
+    for (int i = 0; i < MAX_PROFILED_MODULES; i++) {
+        ModuleProfile& profile = moduleProfiles[i];
+        if (profile.module == nullptr) {
+            continue;
+        }
+        // Only still-active modules are logged; the pointer is never dereferenced otherwise
+        bool active = std::find(active_modules.begin(), active_modules.end(), profile.module) != active_modules.end();
+        if (active && profile.histogram.getCount() > 0) {
+            FrameStats::ModuleCost& cost = stats.modules[stats.moduleCount++];
+            cost.name = profile.module->GetName();
+            cost.draws = profile.histogram.getCount();
+            cost.p50 = profile.histogram.getPercentile(50);
+            cost.p95 = profile.histogram.getPercentile(95);
+            cost.max = profile.histogram.getMax();
+            LOG_INFOF("  %-12s draw %u/%u/%u us\n", cost.name, (unsigned)cost.p50, (unsigned)cost.p95,
+                      (unsigned)cost.max);
+        }
+        profile.histogram.reset();
+    }
+    UnlockComposition();
+
+    spiWaitHistogram.reset();
+    drawHistogram.reset();
+    sendHistogram.reset();
+
+    if (txIdle != NULL) {
+        xSemaphoreGive(txIdle);
+    }
+}
+
+uint32_t Display::getDashboardRedrawInterval() {
+    // Never spin faster than the normal frame rate; the governor caps the sleep as a safety net
+    const uint32_t minIntervalMs = FRAME_INTERVAL_MS;
+
+    uint32_t intervalMs = modules::IModule::REDRAW_NEVER;
     for (int i = 0; i < active_modules.size(); i++) {
-        modules::IModule* module = active_modules[i];
-        if (module->IsOverlay()) {
-            module->Draw();
+        uint32_t moduleIntervalMs = active_modules[i]->GetRedrawInterval();
+        if (moduleIntervalMs < intervalMs) {
+            intervalMs = moduleIntervalMs;
+        }
+    }
+
+    return std::max(intervalMs, minIntervalMs);
+}
+
+uint32_t Display::governFrameInterval(uint32_t intervalMs, bool animating) {
+    uint32_t benchmarkMs = benchmarkIntervalMs.load();
+    if (benchmarkMs != 0) {
+        PowerManager::SetDisplayActive(true);
+        return benchmarkMs;
+    }
+
+    if (!PowerManager::IsPowerSaving()) {
+        return intervalMs < SAFETY_INTERVAL_MS ? intervalMs : SAFETY_INTERVAL_MS;
+    }
+
+    // Composition at the low DFS clock would stretch every frame of an animation
+    PowerManager::SetDisplayActive(animating);
+    if (animating) {
+        return intervalMs;
+    }
+
+    // Nothing moves: new terminal lines only need a prompt poll, the dashboard wakes on its deadlines
+    if (currentState == State::TERMINAL && intervalMs < IDLE_TERMINAL_INTERVAL_MS) {
+        intervalMs = IDLE_TERMINAL_INTERVAL_MS;
+    }
+    return intervalMs < IDLE_SAFETY_INTERVAL_MS ? intervalMs : IDLE_SAFETY_INTERVAL_MS;
+}
+
+void Display::SetBenchmarkInterval(uint32_t intervalMs) {
+    benchmarkIntervalMs.store(intervalMs);
+    if (intervalMs == 0) {
+        dashboardInvalid = true;  // Caches were not updated during the sweep
+    }
+    RequestRedraw();
+}
+
+bool Display::CollectFrameStats(FrameStats& out, TickType_t timeout) {
+    if (frameStatsReady == NULL || taskHandle == NULL) {
+        return false;
+    }
+    xSemaphoreTake(frameStatsReady, 0);  // Drop a stale completion
+    frameStatsRequested.store(true);
+    RequestRedraw();
+    if (xSemaphoreTake(frameStatsReady, timeout) != pdTRUE) {
+        return false;
+    }
+    out = lastFrameStats;
+    return true;
+}
+
+bool Display::LockComposition(TickType_t timeout) {
+    // Before Setup() there is no compositor to exclude
+    return compositionMutex == NULL || xSemaphoreTake(compositionMutex, timeout) == pdTRUE;
+}
+
+void Display::UnlockComposition() {
+    if (compositionMutex != NULL) {
+        xSemaphoreGive(compositionMutex);
+    }
+}
+
+void Display::InvalidateDashboard() {
+    renderCachesInvalid.store(true);
+    RequestRedraw();
+}
+
+void Display::ForgetModule(const modules::IModule* module) {
+    LockComposition();
+    for (int i = 0; i < MAX_CACHED_MODULES; i++) {
+        if (renderCaches[i].module == module) {
+            heap_caps_free(renderCaches[i].pixels);
+            renderCaches[i] = RenderCache();
         }
     }
+    for (int i = 0; i < MAX_PROFILED_MODULES; i++) {
+        if (moduleProfiles[i].module == module) {
+            moduleProfiles[i].module = nullptr;
+            moduleProfiles[i].histogram.reset();
+        }
+    }
+    UnlockComposition();
+}
 
-    u8g2.sendBuffer();
+void Display::RequestRedraw() {
+    if (taskHandle != NULL) {
+        xTaskNotifyGive(taskHandle);
+    }
 }
 
+void Display::presentFrame() {
+    frameCount++;
+    Metrics::Add(framesMetric);
+    if (txTaskHandle == NULL) {
+        memcpy(txFrame, u8g2.getBufferPtr(), FRAME_BUFFER_SIZE);
+        sendFrame();
+        return;
+    }
+
+    // Only waits when the previous frame is still on the bus
+    xSemaphoreTake(txIdle, portMAX_DELAY);
+    memcpy(txFrame, u8g2.getBufferPtr(), FRAME_BUFFER_SIZE);
+    xTaskNotifyGive(txTaskHandle);
+}
+
+void Display::txTaskWrapper(void* parameter) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        sendFrame();
+        xSemaphoreGive(txIdle);
+    }
+}
+
+void Display::sendFrame() {
+    // A panel on its own DMA bus shares nothing with the SD card
+    bool sharedBus = !DisplayDma::isActive();
+
+    int64_t waitStart = esp_timer_get_time();
+    if (sharedBus && xSemaphoreTake(spiMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    int64_t sendStart = esp_timer_get_time();
+    portENTER_CRITICAL(&histogramLock);
+    spiWaitHistogram.record(sendStart - waitStart);
+    portEXIT_CRITICAL(&histogramLock);
+
+    transferFrame();
+
+    if (sharedBus) {
+        xSemaphoreGive(spiMutex);
+    }
+    uint32_t sendUs = esp_timer_get_time() - sendStart;
+    portENTER_CRITICAL(&histogramLock);
+    sendHistogram.record(sendUs);
+    portEXIT_CRITICAL(&histogramLock);
+    Metrics::Observe(sendDurationMetric, sendUs);
+}
+
+void Display::transferFrame() {
+    // Fall back to a full transfer when tile diffing is off or the panel content is unknown.
+    // The flag is cleared first so an invalidation during the transfer is not lost.
+    if (fullRefreshPending.exchange(false) || !config.display.partialRefresh) {
+        for (int tileY = 0; tileY < FRAME_TILE_HEIGHT; tileY++) {
+            u8g2.drawTile(0, tileY, FRAME_TILE_WIDTH, txFrame + tileY * FRAME_TILE_WIDTH * 8);
+        }
+        memcpy(previousFrame, txFrame, FRAME_BUFFER_SIZE);
+        return;
+    }
+
+    // Each tile row is FRAME_TILE_WIDTH tiles of 8 bytes (one byte per pixel column)
+    for (int tileY = 0; tileY < FRAME_TILE_HEIGHT; tileY++) {
+        int rowOffset = tileY * FRAME_TILE_WIDTH * 8;
+        int runStart = -1;
+
+        for (int tileX = 0; tileX <= FRAME_TILE_WIDTH; tileX++) {
+            bool changed = false;
+            if (tileX < FRAME_TILE_WIDTH) {
+                int tileOffset = rowOffset + tileX * 8;
+                changed = memcmp(txFrame + tileOffset, previousFrame + tileOffset, 8) != 0;
+            }
+
+            if (changed && runStart < 0) {
+                runStart = tileX;
+            } else if (!changed && runStart >= 0) {
+                // Send the run of consecutive changed tiles in one transfer
+                uint8_t* run = txFrame + rowOffset + runStart * 8;
+                u8g2.drawTile(runStart, tileY, tileX - runStart, run);
+                memcpy(previousFrame + rowOffset + runStart * 8, run, (tileX - runStart) * 8);
+                runStart = -1;
+            }
+        }
+    }
+}
+
+void Display::invalidateFrame() { fullRefreshPending.store(true); }
+
 void Display::drawRightAlignedText(const char* text, int y) {
     int textWidth = u8g2.getStrWidth(text);
     int x = 128 - textWidth;
     u8g2.drawStr(x, y, text);
 }
 
-void Display::SetState(State state) { currentState = state; }
\ No newline at end of file
+void Display::SetState(State state) {
+    if (state != currentState) {
+        // Screen layout changes completely, recompose and resend the whole frame
+        invalidateFrame();
+        dashboardInvalid = true;
+        currentState = state;
+        RequestRedraw();
+    }
+}
\ No newline at end of file
@@ -3,9 +3,12 @@
 
 #include <Arduino.h>
 #include "logger.h"
+#include <atomic>
 #include <vector>
+#include "latency_histogram.h"
 #include "pins.h"
 #include "terminal.h"
+#include "modules/module.h"
 
 // Forward declarations
 class U8G2_SSD1309_128X64_NONAME0_F_4W_HW_SPI;
@@ -17,6 +20,15 @@ class IModule;
 // External reference to active modules
 extern std::vector<modules::IModule*> active_modules;
 
+/**
+ * Display Pipeline
+ *
+ * The display task composes every frame into the u8g2 framebuffer without holding spiMutex;
+ * drawing only touches RAM. The finished frame is copied into a transfer buffer and handed to
+ * the DisplayTx task, which takes the bus just long enough to send the changed tiles. SD access
+ * from the logger and config loader therefore waits for one transfer at most, never a whole
+ * frame, and the next frame is composed while the previous one is still on the wire.
+ */
 class Display {
   public:
     enum class State { TERMINAL, DASHBOARD };
@@ -25,13 +37,179 @@ class Display {
     static void Run();
     static void SetState(State state);
 
+    // Wake the display task to draw a new frame before its next scheduled deadline
+    static void RequestRedraw();
+
+    // Held while the dashboard is composed. Take it to change active_modules or to reconfigure a
+    // module in place, so Draw() never runs against a half-applied change.
+    static bool LockComposition(TickType_t timeout = portMAX_DELAY);
+    static void UnlockComposition();
+
+    // Recompose the whole dashboard and drop retained bitmaps, for changes no content version reflects
+    static void InvalidateDashboard();
+
+    // Free the retained bitmap and draw profile of a module that is being released. Call it once the
+    // module is off active_modules; a later instance at the same address starts from nothing.
+    static void ForgetModule(const modules::IModule* module);
+
+    // Frames handed to the panel so far; frames with nothing invalidated are not counted
+    static uint32_t GetFrameCount() { return frameCount; }
+
+    // Figures of one frame statistics window, in microseconds
+    struct FrameStats {
+        struct ModuleCost {
+            const char* name;
+            uint32_t draws;
+            uint32_t p50;
+            uint32_t p95;
+            uint32_t max;
+        };
+
+        uint32_t frames;
+        uint32_t windowMs;
+        uint32_t drawP50;
+        uint32_t drawP95;
+        uint32_t drawMax;
+        uint32_t sendP50;
+        uint32_t sendP95;
+        int moduleCount;
+        ModuleCost modules[8];
+    };
+
+    // Diagnostics sweep: compose every dashboard frame in full, without render caches, at this
+    // interval; 0 returns to normal pacing
+    static void SetBenchmarkInterval(uint32_t intervalMs);
+
+    // Close the current statistics window (logged as usual) and copy its figures out; waits for the
+    // display task, false on timeout
+    static bool CollectFrameStats(FrameStats& out, TickType_t timeout);
+
+    // Copies the frame-time breakdown of the current window. Bus wait and send are recorded by the
+    // transfer task, so they are copied under the same lock it records them with.
+    static void CopyFrameHistograms(LatencyHistogram& spiWait, LatencyHistogram& draw, LatencyHistogram& send);
+
   private:
     static State currentState;
+    static uint32_t frameCount;
+    static TaskHandle_t taskHandle;
     static void on_button_press();
-    static void drawTerminal();
+    // Returns true while a line scrolls or shows the loading animation
+    static bool drawTerminal();
     static void drawDashboard();
+    static bool composeDashboard();
+    static uint32_t getDashboardRedrawInterval();
+
+    // Frame-rate governor: with power management on, a static frame sleeps longer and an
+    // animating one holds the CPU at full speed
+    static const uint32_t FRAME_INTERVAL_MS = 25;            // 40 fps while anything moves
+    static const uint32_t ANIMATION_INTERVAL_MS = 200;       // Module deadlines closer than this animate
+    static const uint32_t SAFETY_INTERVAL_MS = 1000;         // Longest sleep, even with nothing due
+    static const uint32_t IDLE_SAFETY_INTERVAL_MS = 10000;   // Same, with power management on
+    static const uint32_t IDLE_TERMINAL_INTERVAL_MS = 250;   // Terminal poll for new lines when static
+    static uint32_t governFrameInterval(uint32_t intervalMs, bool animating);
     static void drawRightAlignedText(const char* text, int y);
 
+    // Hand the composed framebuffer to the transfer task, after it has finished the previous frame
+    static void presentFrame();
+    static void invalidateFrame();
+
+    // Transfer stage: owns the bus side of the pipeline
+    static const UBaseType_t TX_TASK_PRIORITY = 2;
+    static const uint32_t TX_TASK_STACK_SIZE = 3072;
+    static TaskHandle_t txTaskHandle;
+    static SemaphoreHandle_t txIdle;  // Given when txFrame may be overwritten
+    static void txTaskWrapper(void* parameter);
+    static void sendFrame();
+
+    // Send txFrame to the panel, only the changed tiles when partial refresh is on
+    static void transferFrame();
+
+    // Frame being sent and a copy of the last frame on the panel, used to find changed 8x8 tiles
+    static const int FRAME_TILE_WIDTH = 16;
+    static const int FRAME_TILE_HEIGHT = 8;
+    static const int FRAME_BUFFER_SIZE = FRAME_TILE_WIDTH * FRAME_TILE_HEIGHT * 8;
+    static uint8_t txFrame[FRAME_BUFFER_SIZE];
+    static uint8_t previousFrame[FRAME_BUFFER_SIZE];
+    static std::atomic<bool> fullRefreshPending;  // Panel content unknown, next transfer sends everything
+
+    // Frame timing: bus wait, all Draw() calls, panel transfer, plus Draw() per module
+    struct ModuleProfile {
+        const modules::IModule* module;
+        LatencyHistogram histogram;
+    };
+    static const int MAX_PROFILED_MODULES = sizeof(FrameStats::modules) / sizeof(FrameStats::modules[0]);
+    static const uint32_t FRAME_STATS_LOG_INTERVAL_MS = 60000;
+    static LatencyHistogram spiWaitHistogram;
+    static LatencyHistogram drawHistogram;
+    static LatencyHistogram sendHistogram;
+    static portMUX_TYPE histogramLock;  // Guards spiWait/send between the transfer task and readers
+    static ModuleProfile moduleProfiles[MAX_PROFILED_MODULES];
+    static unsigned long lastFrameStatsLog;
+    static std::atomic<uint32_t> benchmarkIntervalMs;
+    static std::atomic<bool> frameStatsRequested;
+    static SemaphoreHandle_t frameStatsReady;  // Given after a requested window was closed
+    static FrameStats lastFrameStats;
+
+    // Boot terminal: lines copied from Terminal each frame, with their scroll offset carried by revision
+    static const int TERMINAL_VISIBLE_LINES = 6;
+    struct TerminalRow {
+        Terminal::Line line;
+        float offsetX;
+    };
+    static Terminal::Line terminalSnapshot[TERMINAL_VISIBLE_LINES];
+    static TerminalRow terminalRows[TERMINAL_VISIBLE_LINES];
+    static int terminalRowCount;
+    static void refreshTerminalRows();
+
+    // Retained bitmaps of versioned modules: the bounds' pages, masked to the rectangle
+    struct RenderCache {
+        const modules::IModule* module;
+        uint32_t version;
+        int x, y, width, height;
+        uint8_t* pixels;
+        size_t size;
+    };
+    static const int MAX_CACHED_MODULES = 8;
+    static RenderCache renderCaches[MAX_CACHED_MODULES];
+    static uint8_t regionScratch[FRAME_BUFFER_SIZE];
+    static uint32_t renderCacheHits;
+    static uint32_t renderCacheMisses;
+
+    static RenderCache* findRenderCache(const modules::IModule* module, const modules::Bounds& bounds);
+    static bool clampBounds(modules::Bounds& bounds);
+    static void renderToCache(modules::IModule* module, const modules::Bounds& bounds, RenderCache& cache,
+                              uint32_t version);
+    static void captureRegion(const modules::Bounds& bounds, uint8_t* out);
+    static void restoreRegion(const modules::Bounds& bounds, const uint8_t* pixels);
+    static void clearRegion(const modules::Bounds& bounds);
+    static void mergeCached(const RenderCache& cache, const modules::Bounds& clip);
+
+    // Compositor: the dashboard frame persists between frames and only invalidated regions are
+    // re-rendered, by every visible layer that intersects them, bottom to top, clipped to the region
+    struct Layer {
+        modules::IModule* module;
+        modules::Bounds bounds;  // Whole screen for modules without bounds
+        uint32_t version;
+        bool visible;
+    };
+    static const int MAX_LAYERS = 8;
+    static const int MAX_DIRTY_REGIONS = 8;
+    static Layer layers[MAX_LAYERS];
+    static int layerCount;
+    static modules::Bounds dirtyRegions[MAX_DIRTY_REGIONS];
+    static int dirtyCount;
+    static bool dashboardInvalid;  // Frame buffer holds something else (terminal, first frame)
+    static std::atomic<bool> renderCachesInvalid;
+    static SemaphoreHandle_t compositionMutex;
+
+    static int collectLayers(Layer* out);
+    static void invalidateRegion(const modules::Bounds& region);
+    static bool intersect(const modules::Bounds& a, const modules::Bounds& b, modules::Bounds& out);
+    static bool sameBounds(const modules::Bounds& a, const modules::Bounds& b);
+
+    static void drawModule(const Layer& layer, const modules::Bounds& clip);
+    static void logFrameStats();
+
     // Animation variables
     static int loadingAngle;
     static int loadingDots;
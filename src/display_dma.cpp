@@ -0,0 +1,146 @@
+#include "display_dma.h"
+#include "logger.h"
+#include "pins.h"
+
+#ifdef DISPLAY_USE_DMA
+#include <driver/spi_master.h>
+#include <esp_heap_caps.h>
+#include <algorithm>
+#include <cstring>
+
+#if !defined(DISPLAY_DMA_CLK_PIN) || !defined(DISPLAY_DMA_MOSI_PIN)
+#error "DISPLAY_USE_DMA needs DISPLAY_DMA_CLK_PIN and DISPLAY_DMA_MOSI_PIN: the panel must have its own SPI bus"
+#endif
+
+// Arduino SPI (and with it the SD card) uses SPI2
+#define DISPLAY_DMA_HOST SPI3_HOST
+#endif
+
+bool DisplayDma::active = false;
+u8x8_msg_cb DisplayDma::fallbackCallback = nullptr;
+
+#ifdef DISPLAY_USE_DMA
+
+namespace {
+
+spi_device_handle_t device = nullptr;
+uint8_t* staging[2] = {nullptr, nullptr};
+spi_transaction_t transactions[2];
+int nextStaging = 0;
+int pending = 0;
+
+}  // namespace
+
+bool DisplayDma::attach(u8x8_t* u8x8) {
+    // One allocation split in two, so one half can be filled while the other is on the wire
+    uint8_t* buffer = (uint8_t*)heap_caps_malloc(STAGING_SIZE * 2, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (buffer == nullptr) {
+        LOG_ERROR("DisplayDma: Failed to allocate staging buffers, keeping Arduino SPI");
+        return false;
+    }
+    staging[0] = buffer;
+    staging[1] = buffer + STAGING_SIZE;
+
+    fallbackCallback = u8x8->byte_cb;
+    u8x8->byte_cb = byteCallback;
+    return true;
+}
+
+bool DisplayDma::initBus(u8x8_t* u8x8) {
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num = DISPLAY_DMA_MOSI_PIN;
+    bus.miso_io_num = -1;
+    bus.sclk_io_num = DISPLAY_DMA_CLK_PIN;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = STAGING_SIZE;
+    if (spi_bus_initialize(DISPLAY_DMA_HOST, &bus, SPI_DMA_CH_AUTO) != ESP_OK) {
+        return false;
+    }
+
+    // Chip select stays with u8x8 so it brackets whole command/data sequences
+    spi_device_interface_config_t config = {};
+    config.clock_speed_hz = u8x8->display_info->sck_clock_hz;
+    config.mode = u8x8->display_info->spi_mode;
+    config.spics_io_num = -1;
+    config.queue_size = 2;
+    return spi_bus_add_device(DISPLAY_DMA_HOST, &config, &device) == ESP_OK;
+}
+
+void DisplayDma::send(const uint8_t* data, size_t length) {
+    while (length > 0) {
+        // Both halves in flight: block (not spin) until the older one completes
+        if (pending == 2) {
+            spi_transaction_t* done;
+            spi_device_get_trans_result(device, &done, portMAX_DELAY);
+            pending--;
+        }
+
+        size_t chunk = std::min(length, STAGING_SIZE);
+        memcpy(staging[nextStaging], data, chunk);
+
+        spi_transaction_t& transaction = transactions[nextStaging];
+        memset(&transaction, 0, sizeof(transaction));
+        transaction.length = chunk * 8;
+        transaction.tx_buffer = staging[nextStaging];
+        spi_device_queue_trans(device, &transaction, portMAX_DELAY);
+
+        pending++;
+        nextStaging ^= 1;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void DisplayDma::flush() {
+    while (pending > 0) {
+        spi_transaction_t* done;
+        spi_device_get_trans_result(device, &done, portMAX_DELAY);
+        pending--;
+    }
+}
+
+uint8_t DisplayDma::byteCallback(u8x8_t* u8x8, uint8_t msg, uint8_t argInt, void* argPtr) {
+    if (!active && msg != U8X8_MSG_BYTE_INIT) {
+        return fallbackCallback(u8x8, msg, argInt, argPtr);
+    }
+
+    switch (msg) {
+        case U8X8_MSG_BYTE_SEND:
+            send((const uint8_t*)argPtr, argInt);
+            break;
+        case U8X8_MSG_BYTE_INIT:
+            active = initBus(u8x8);
+            if (!active) {
+                LOG_ERROR("DisplayDma: SPI bus init failed, falling back to Arduino SPI");
+                u8x8->byte_cb = fallbackCallback;
+                return fallbackCallback(u8x8, msg, argInt, argPtr);
+            }
+            u8x8_gpio_SetCS(u8x8, u8x8->display_info->chip_disable_level);
+            LOG_INFO("DisplayDma: Panel on dedicated DMA bus");
+            break;
+        case U8X8_MSG_BYTE_SET_DC:
+            // DC applies to the bytes that follow, so everything queued must be out first
+            flush();
+            u8x8_gpio_SetDC(u8x8, argInt);
+            break;
+        case U8X8_MSG_BYTE_START_TRANSFER:
+            u8x8_gpio_SetCS(u8x8, u8x8->display_info->chip_enable_level);
+            u8x8->gpio_and_delay_cb(u8x8, U8X8_MSG_DELAY_NANO, u8x8->display_info->post_chip_enable_wait_ns, NULL);
+            break;
+        case U8X8_MSG_BYTE_END_TRANSFER:
+            flush();
+            u8x8->gpio_and_delay_cb(u8x8, U8X8_MSG_DELAY_NANO, u8x8->display_info->pre_chip_disable_wait_ns, NULL);
+            u8x8_gpio_SetCS(u8x8, u8x8->display_info->chip_disable_level);
+            break;
+        default:
+            return 0;
+    }
+    return 1;
+}
+
+#else
+
+bool DisplayDma::attach(u8x8_t* u8x8) { return false; }
+
+#endif  // DISPLAY_USE_DMA
@@ -0,0 +1,40 @@
+#ifndef DISPLAY_DMA_H
+#define DISPLAY_DMA_H
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+/**
+ * DMA Display Transport
+ *
+ * Optional u8x8 byte callback that sends panel traffic with the ESP-IDF SPI master driver and
+ * DMA instead of Arduino SPI. Each chunk is copied into one of two DMA staging buffers and queued;
+ * while it is on the wire the caller returns and prepares the next one, and waits are blocking
+ * rather than spinning, so the transfer task yields the CPU for the whole frame.
+ *
+ * Enabled with -DDISPLAY_USE_DMA. The SPI master driver cannot share a host with the Arduino
+ * SPI driver used by the SD card, so the panel needs its own bus: DISPLAY_DMA_CLK_PIN and
+ * DISPLAY_DMA_MOSI_PIN must be defined, and frames are then sent without taking spiMutex.
+ * If the bus cannot be brought up the original Arduino callback is used.
+ */
+class DisplayDma {
+  public:
+    // Install the callback, before u8g2.begin(); returns false when DMA is compiled out
+    static bool attach(u8x8_t* u8x8);
+
+    // True once the dedicated bus is running, i.e. transfers do not need spiMutex
+    static bool isActive() { return active; }
+
+  private:
+    static const size_t STAGING_SIZE = 256;
+
+    static bool active;
+    static u8x8_msg_cb fallbackCallback;
+
+    static uint8_t byteCallback(u8x8_t* u8x8, uint8_t msg, uint8_t argInt, void* argPtr);
+    static bool initBus(u8x8_t* u8x8);
+    static void send(const uint8_t* data, size_t length);
+    static void flush();
+};
+
+#endif  // DISPLAY_DMA_H
@@ -1,2 +1,75 @@
 #include "event_manager.h"
 #include "logger.h"
+
+portMUX_TYPE EventManager::lock = portMUX_INITIALIZER_UNLOCKED;
+EventManager::SubscriptionHandle EventManager::nextHandle = EventManager::INVALID_SUBSCRIPTION;
+TaskHandle_t EventManager::dispatcherTask = nullptr;
+QueueHandle_t EventManager::pendingQueue = nullptr;
+QueueHandle_t EventManager::freeQueue = nullptr;
+EventManager::Slot EventManager::slots[EventManager::QUEUE_SLOTS];
+volatile uint32_t EventManager::queuedCount = 0;
+volatile uint32_t EventManager::fallbackCount = 0;
+
+bool EventManager::StartDispatcher(UBaseType_t priority, uint32_t stackSize) {
+    if (dispatcherTask != nullptr) {
+        return true;
+    }
+
+    pendingQueue = xQueueCreate(QUEUE_SLOTS, sizeof(uint8_t));
+    freeQueue = xQueueCreate(QUEUE_SLOTS, sizeof(uint8_t));
+    if (pendingQueue == nullptr || freeQueue == nullptr) {
+        LOG_ERROR("EventManager: Failed to create dispatch queues");
+        return false;
+    }
+
+    for (uint8_t i = 0; i < QUEUE_SLOTS; i++) {
+        xQueueSend(freeQueue, &i, 0);
+    }
+
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreate(DispatcherTask, "EventDispatch", stackSize, nullptr, priority, &handle) != pdPASS) {
+        LOG_ERROR("EventManager: Failed to create dispatcher task");
+        return false;
+    }
+
+    // Published last: Emit() only queues once the task exists to drain the queue
+    dispatcherTask = handle;
+    LOG_INFOF("EventManager: Dispatcher started (%d slots)\n", QUEUE_SLOTS);
+    return true;
+}
+
+int EventManager::AcquireSlot() {
+    uint8_t index;
+    if (freeQueue == nullptr || xQueueReceive(freeQueue, &index, 0) != pdTRUE) {
+        return -1;
+    }
+    return index;
+}
+
+bool EventManager::PostSlot(int index) {
+    uint8_t value = index;
+    if (xQueueSend(pendingQueue, &value, 0) != pdTRUE) {
+        return false;
+    }
+    queuedCount++;
+    return true;
+}
+
+void EventManager::ReleaseSlot(int index) {
+    uint8_t value = index;
+    xQueueSend(freeQueue, &value, 0);
+}
+
+void EventManager::DispatcherTask(void* parameter) {
+    uint8_t index;
+    while (true) {
+        if (xQueueReceive(pendingQueue, &index, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        Slot& slot = slots[index];
+        slot.deliver(slot.storage);
+        slot.destroy(slot.storage);
+        ReleaseSlot(index);
+    }
+}
@@ -3,8 +3,11 @@
 
 #include <Arduino.h>
 #include "logger.h"
-#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
 #include <memory>
+#include <new>
 #include <typeinfo>
 #include <vector>
 
@@ -38,6 +41,33 @@ class ButtonLongPressEvent : public Event {
     const char* GetTypeName() const override { return "ButtonLongPressEvent"; }
 };
 
+// Second short press within the button's double press window, emitted instead of a second short press
+class ButtonDoublePressEvent : public Event {
+  public:
+    ButtonDoublePressEvent(int button_id, unsigned long press_duration_ms)
+        : button_id(button_id), press_duration_ms(press_duration_ms) {}
+
+    int button_id;
+    unsigned long press_duration_ms;
+
+    const char* GetTypeName() const override { return "ButtonDoublePressEvent"; }
+};
+
+// An INI section was re-parsed at runtime after the file on the SD card changed
+class ConfigChangedEvent : public Event {
+  public:
+    static const size_t MAX_SECTION_LENGTH = 31;
+
+    ConfigChangedEvent(const char* section_name, bool enable_changed) : enable_changed(enable_changed) {
+        snprintf(section, sizeof(section), "%s", section_name);
+    }
+
+    char section[MAX_SECTION_LENGTH + 1];  // Lowercase, as indexed by ConfigStore
+    bool enable_changed;                   // The section's "enable" value differs from before
+
+    const char* GetTypeName() const override { return "ConfigChangedEvent"; }
+};
+
 // Alarm events
 class CriticalAlarmEvent : public Event {
   public:
@@ -79,42 +109,253 @@ class TerminalEvent : public Event {
     const char* GetTypeName() const override { return "TerminalEvent"; }
 };
 
+/**
+ * Event Manager
+ *
+ * Typed publish/subscribe bus. Each event type has a fixed table of subscribers guarded by a
+ * spinlock, so subscribing, unsubscribing and emitting are safe from any task. Callbacks are
+ * plain function pointers with an optional context pointer; nothing is heap allocated per
+ * subscription.
+ *
+ * INLINE subscribers run on the emitting task before Emit() returns. QUEUED subscribers run on
+ * the dispatcher task: the event is copied into a slot from a fixed pool and the slot index is
+ * posted to a FreeRTOS queue, so a slow handler never stalls the emitter. Until the dispatcher
+ * is started, or when every slot is in use, queued subscribers are called inline instead so no
+ * event is lost.
+ */
 class EventManager {
   public:
+    enum class Delivery { INLINE, QUEUED };
+
+    typedef uint32_t SubscriptionHandle;
+    static const SubscriptionHandle INVALID_SUBSCRIPTION = 0;
+
     template <typename T>
-    using EventCallback = std::function<void(const T&)>;
+    using EventCallback = void (*)(const T&);
 
     template <typename T>
-    static void Subscribe(EventCallback<T> callback) {
+    using ContextCallback = void (*)(const T&, void* context);
+
+    static const int MAX_SUBSCRIBERS_PER_EVENT = 8;
+    static const int QUEUE_SLOTS = 16;
+    static const size_t SLOT_SIZE = 96;
+
+    // Create the dispatch queue and task; safe to call once from setup()
+    static bool StartDispatcher(UBaseType_t priority, uint32_t stackSize);
+    static bool IsDispatcherRunning() { return dispatcherTask != nullptr; }
+
+    template <typename T>
+    static SubscriptionHandle Subscribe(EventCallback<T> callback, Delivery delivery = Delivery::INLINE) {
+        static_assert(std::is_base_of<Event, T>::value, "T must be derived from Event");
+        return AddSubscriber<T>(callback, nullptr, nullptr, delivery);
+    }
+
+    template <typename T>
+    static SubscriptionHandle Subscribe(ContextCallback<T> callback, void* context,
+                                        Delivery delivery = Delivery::INLINE) {
+        static_assert(std::is_base_of<Event, T>::value, "T must be derived from Event");
+        return AddSubscriber<T>(nullptr, callback, context, delivery);
+    }
+
+    // Remove exactly the subscription returned by Subscribe()
+    template <typename T>
+    static bool Unsubscribe(SubscriptionHandle handle) {
         static_assert(std::is_base_of<Event, T>::value, "T must be derived from Event");
-        GetCallbacks<T>().push_back(callback);
+        if (handle == INVALID_SUBSCRIPTION) {
+            return false;
+        }
+
+        bool removed = false;
+        Registry<T>& registry = GetRegistry<T>();
+        taskENTER_CRITICAL(&lock);
+        for (int i = 0; i < MAX_SUBSCRIBERS_PER_EVENT; i++) {
+            if (registry.entries[i].handle == handle) {
+                registry.entries[i] = Subscriber<T>();
+                removed = true;
+                break;
+            }
+        }
+        taskEXIT_CRITICAL(&lock);
+        return removed;
     }
 
+    // Remove every subscription of this function
     template <typename T>
-    static void Unsubscribe(EventCallback<T> callback) {
+    static bool Unsubscribe(EventCallback<T> callback) {
         static_assert(std::is_base_of<Event, T>::value, "T must be derived from Event");
-        auto& callbacks = GetCallbacks<T>();
-        // Note: Function comparison is complex, for now we'll clear all callbacks
-        // In a real implementation, you'd need a more sophisticated approach
-        callbacks.clear();
+        bool removed = false;
+        Registry<T>& registry = GetRegistry<T>();
+        taskENTER_CRITICAL(&lock);
+        for (int i = 0; i < MAX_SUBSCRIBERS_PER_EVENT; i++) {
+            if (registry.entries[i].handle != INVALID_SUBSCRIPTION && registry.entries[i].callback == callback) {
+                registry.entries[i] = Subscriber<T>();
+                removed = true;
+            }
+        }
+        taskEXIT_CRITICAL(&lock);
+        return removed;
     }
 
     template <typename T>
     static void Emit(const T& event) {
         static_assert(std::is_base_of<Event, T>::value, "T must be derived from Event");
 
-        const auto& callbacks = GetCallbacks<T>();
-        for (const auto& callback : callbacks) {
-            callback(event);
+        Subscriber<T> snapshot[MAX_SUBSCRIBERS_PER_EVENT];
+        int count = TakeSnapshot<T>(snapshot, false);
+
+        bool queue = false;
+        for (int i = 0; i < count; i++) {
+            if (snapshot[i].delivery == Delivery::QUEUED && IsDispatcherRunning()) {
+                queue = true;
+            } else {
+                Invoke(snapshot[i], event);
+            }
+        }
+
+        if (queue && !Enqueue(event)) {
+            // Pool exhausted: late delivery on this task beats losing the event
+            fallbackCount++;
+            for (int i = 0; i < count; i++) {
+                if (snapshot[i].delivery == Delivery::QUEUED) {
+                    Invoke(snapshot[i], event);
+                }
+            }
         }
     }
 
+    static uint32_t GetQueuedCount() { return queuedCount; }
+    static uint32_t GetFallbackCount() { return fallbackCount; }
+
   private:
     template <typename T>
-    static std::vector<EventCallback<T>>& GetCallbacks() {
-        static std::vector<EventCallback<T>> callbacks;
-        return callbacks;
+    struct Subscriber {
+        SubscriptionHandle handle = INVALID_SUBSCRIPTION;
+        EventCallback<T> callback = nullptr;
+        ContextCallback<T> contextCallback = nullptr;
+        void* context = nullptr;
+        Delivery delivery = Delivery::INLINE;
+    };
+
+    template <typename T>
+    struct Registry {
+        Subscriber<T> entries[MAX_SUBSCRIBERS_PER_EVENT];
+    };
+
+    // A queued event: storage holds a copy of the event, the function pointers know its type
+    struct Slot {
+        alignas(8) uint8_t storage[SLOT_SIZE];
+        void (*deliver)(void* storage);
+        void (*destroy)(void* storage);
+    };
+
+    static portMUX_TYPE lock;
+    static SubscriptionHandle nextHandle;
+    static TaskHandle_t dispatcherTask;
+    static QueueHandle_t pendingQueue;  // Slot indices waiting for delivery
+    static QueueHandle_t freeQueue;     // Slot indices available to Emit()
+    static Slot slots[QUEUE_SLOTS];
+    static volatile uint32_t queuedCount;
+    static volatile uint32_t fallbackCount;
+
+    template <typename T>
+    static Registry<T>& GetRegistry() {
+        static Registry<T> registry;
+        return registry;
+    }
+
+    template <typename T>
+    static SubscriptionHandle AddSubscriber(EventCallback<T> callback, ContextCallback<T> contextCallback,
+                                            void* context, Delivery delivery) {
+        SubscriptionHandle handle = INVALID_SUBSCRIPTION;
+        Registry<T>& registry = GetRegistry<T>();
+        taskENTER_CRITICAL(&lock);
+        for (int i = 0; i < MAX_SUBSCRIBERS_PER_EVENT; i++) {
+            Subscriber<T>& entry = registry.entries[i];
+            if (entry.handle == INVALID_SUBSCRIPTION) {
+                handle = ++nextHandle;
+                entry.handle = handle;
+                entry.callback = callback;
+                entry.contextCallback = contextCallback;
+                entry.context = context;
+                entry.delivery = delivery;
+                break;
+            }
+        }
+        taskEXIT_CRITICAL(&lock);
+
+        if (handle == INVALID_SUBSCRIPTION) {
+            LOG_ERRORF("EventManager: Subscriber table full (%d entries)\n", MAX_SUBSCRIBERS_PER_EVENT);
+        }
+        return handle;
+    }
+
+    // Copy the live subscribers so callbacks run without holding the lock
+    template <typename T>
+    static int TakeSnapshot(Subscriber<T>* snapshot, bool queuedOnly) {
+        int count = 0;
+        Registry<T>& registry = GetRegistry<T>();
+        taskENTER_CRITICAL(&lock);
+        for (int i = 0; i < MAX_SUBSCRIBERS_PER_EVENT; i++) {
+            const Subscriber<T>& entry = registry.entries[i];
+            if (entry.handle != INVALID_SUBSCRIPTION && (!queuedOnly || entry.delivery == Delivery::QUEUED)) {
+                snapshot[count++] = entry;
+            }
+        }
+        taskEXIT_CRITICAL(&lock);
+        return count;
+    }
+
+    template <typename T>
+    static void Invoke(const Subscriber<T>& subscriber, const T& event) {
+        if (subscriber.callback != nullptr) {
+            subscriber.callback(event);
+        } else if (subscriber.contextCallback != nullptr) {
+            subscriber.contextCallback(event, subscriber.context);
+        }
+    }
+
+    template <typename T>
+    static bool Enqueue(const T& event) {
+        static_assert(sizeof(T) <= SLOT_SIZE, "Event too large for a queue slot");
+        static_assert(alignof(T) <= 8, "Event alignment exceeds queue slot alignment");
+
+        int index = AcquireSlot();
+        if (index < 0) {
+            return false;
+        }
+
+        Slot& slot = slots[index];
+        new (slot.storage) T(event);
+        slot.deliver = &DeliverQueued<T>;
+        slot.destroy = &DestroyQueued<T>;
+
+        if (!PostSlot(index)) {
+            slot.destroy(slot.storage);
+            ReleaseSlot(index);
+            return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    static void DeliverQueued(void* storage) {
+        const T& event = *reinterpret_cast<T*>(storage);
+        Subscriber<T> snapshot[MAX_SUBSCRIBERS_PER_EVENT];
+        int count = TakeSnapshot<T>(snapshot, true);
+        for (int i = 0; i < count; i++) {
+            Invoke(snapshot[i], event);
+        }
     }
+
+    template <typename T>
+    static void DestroyQueued(void* storage) {
+        reinterpret_cast<T*>(storage)->~T();
+    }
+
+    static int AcquireSlot();
+    static bool PostSlot(int index);
+    static void ReleaseSlot(int index);
+    static void DispatcherTask(void* parameter);
 };
 
-#endif  // EVENT_MANAGER_H
\ No newline at end of file
+#endif  // EVENT_MANAGER_H
@@ -0,0 +1,532 @@
+#include "http_service.h"
+#include <HTTPClient.h>
+#include <StreamString.h>
+#include <algorithm>
+#include <cstring>
+#include <esp_timer.h>
+#include "logger.h"
+#include "memory_manager.h"
+#include "metrics.h"
+#include "wifi_manager.h"
+
+namespace {
+
+// Forwards reads to the socket while counting consumed bytes, so the unread tail of a
+// Content-Length body can be drained and the connection stays usable for the next request.
+// When timed, the time from a read finding the socket empty until the next byte arrives is
+// added to waitUs; consuming buffered bytes is not counted.
+class CountingStream : public Stream {
+  public:
+    explicit CountingStream(Stream& source, int64_t* waitUs = nullptr) : source(source), waitUs(waitUs) {}
+
+    int available() override { return source.available(); }
+    int peek() override { return source.peek(); }
+    int read() override {
+        int c = source.read();
+        if (c >= 0) {
+            consumed++;
+            if (waitStartUs != 0) {
+                *waitUs += esp_timer_get_time() - waitStartUs;
+                waitStartUs = 0;
+            }
+        } else if (waitUs != nullptr && waitStartUs == 0) {
+            waitStartUs = esp_timer_get_time();
+        }
+        return c;
+    }
+    size_t write(uint8_t) override { return 0; }
+
+    size_t getConsumed() const { return consumed; }
+
+  private:
+    Stream& source;
+    size_t consumed = 0;
+    int64_t* waitUs;
+    int64_t waitStartUs = 0;
+};
+
+// Append-only body buffer in the request's PSRAM arena; replaces a growing String in internal RAM
+class ArenaStream : public Stream {
+  public:
+    explicit ArenaStream(PsramArena& arena) : arena(arena) {}
+
+    int available() override { return length - position; }
+    int peek() override { return position < length ? data[position] : -1; }
+    int read() override { return position < length ? data[position++] : -1; }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (length + size > capacity) {
+            size_t grown = std::max({capacity * 2, length + size, (size_t)1024});
+            uint8_t* moved = (uint8_t*)arena.reallocate(data, capacity, grown);
+            if (moved == nullptr) {
+                overflowed = true;
+                return 0;
+            }
+            data = moved;
+            capacity = grown;
+        }
+        memcpy(data + length, buffer, size);
+        length += size;
+        return size;
+    }
+
+    bool hasOverflowed() const { return overflowed; }
+
+  private:
+    PsramArena& arena;
+    uint8_t* data = nullptr;
+    size_t capacity = 0;
+    size_t length = 0;
+    size_t position = 0;
+    bool overflowed = false;
+};
+
+bool drainBody(CountingStream& body, size_t contentLength) {
+    char scratch[128];
+    while (body.getConsumed() < contentLength) {
+        size_t chunk = std::min(sizeof(scratch), contentLength - body.getConsumed());
+        if (body.readBytes(scratch, chunk) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+// Static instance
+HttpService* HttpService::instance = nullptr;
+
+namespace {
+Metrics::Id requestsMetric = Metrics::NO_METRIC;
+Metrics::Id failedRequestsMetric = Metrics::NO_METRIC;
+Metrics::Id notModifiedMetric = Metrics::NO_METRIC;
+Metrics::Id reusedConnectionsMetric = Metrics::NO_METRIC;
+Metrics::Id requestDurationMetric = Metrics::NO_METRIC;
+}  // namespace
+
+HttpService::HttpService() {
+    requestMutex = xSemaphoreCreateMutex();
+    if (requestMutex == nullptr) {
+        LOG_ERROR("HttpService: Failed to create mutex");
+    }
+    for (int i = 0; i < MAX_DNS_ENTRIES; i++) {
+        dnsCache[i].host[0] = '\0';
+        dnsCache[i].resolvedAt = 0;
+    }
+    memset(validators, 0, sizeof(validators));
+
+    requestsMetric = Metrics::Register(Metrics::Type::COUNTER, "http_requests_total", "HTTP requests made");
+    failedRequestsMetric = Metrics::Register(Metrics::Type::COUNTER, "http_failed_requests_total",
+                                             "HTTP requests without a 2xx or 304 answer");
+    notModifiedMetric =
+        Metrics::Register(Metrics::Type::COUNTER, "http_not_modified_total", "HTTP requests answered with 304");
+    reusedConnectionsMetric = Metrics::Register(Metrics::Type::COUNTER, "http_reused_connections_total",
+                                                "HTTP requests on a kept-alive socket");
+    requestDurationMetric =
+        Metrics::Register(Metrics::Type::HISTOGRAM, "http_request_duration_seconds", "HTTP request duration");
+}
+
+HttpService* HttpService::getInstance() {
+    if (instance == nullptr) {
+        instance = new HttpService();
+    }
+    return instance;
+}
+
+void HttpService::initialize() {
+    getInstance();
+    LOG_INFO("HttpService: Shared HTTP client initialized");
+}
+
+int HttpService::get(const String& url, const BodyHandler& onBody, const char* moduleName, String* errorBody,
+                     const char* accept, RequestTiming* requestTiming) {
+    String host;
+    String path;
+    uint16_t port = 80;
+    if (!parseUrl(url, host, port, path)) {
+        LOG_ERRORF("HttpService: Unsupported URL for %s\n", moduleName);
+        return ERROR_BAD_URL;
+    }
+
+    if (!WiFiManager::IsConnected()) {
+        return ERROR_NOT_CONNECTED;
+    }
+
+    // One request at a time: modules never hold socket buffers concurrently
+    if (requestMutex == nullptr || xSemaphoreTake(requestMutex, pdMS_TO_TICKS(REQUEST_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        LOG_WARNINGF("HttpService: Timed out waiting for the connection (%s)\n", moduleName);
+        return ERROR_BUSY;
+    }
+
+    if (!MEMORY_REQUEST(MemoryManager::Operation::HTTP_REQUEST, MemoryManager::Priority::NORMAL,
+                        REQUEST_MEMORY_BYTES, moduleName)) {
+        xSemaphoreGive(requestMutex);
+        return ERROR_NO_MEMORY;
+    }
+
+    if (requestTiming != nullptr) {
+        memset(requestTiming, 0, sizeof(*requestTiming));
+    }
+    timing = requestTiming;
+
+    unsigned long startTime = millis();
+    int64_t startUs = esp_timer_get_time();
+    int code = performGet(host, port, path, onBody, errorBody, accept);
+    requestCount++;
+    timing = nullptr;
+
+    Metrics::Add(requestsMetric);
+    Metrics::Observe(requestDurationMetric, esp_timer_get_time() - startUs);
+    if (code != HTTP_CODE_NOT_MODIFIED && (code < 200 || code >= 300)) {
+        Metrics::Add(failedRequestsMetric);
+    }
+
+    // Query strings carry API keys, keep them out of the log
+    String logPath = path.indexOf('?') >= 0 ? path.substring(0, path.indexOf('?')) : path;
+    LOG_INFOF("HttpService: GET %s%s -> %d in %lu ms (%s)\n", host.c_str(), logPath.c_str(), code,
+              millis() - startTime, moduleName);
+
+    MEMORY_RELEASE(MemoryManager::Operation::HTTP_REQUEST, moduleName);
+    xSemaphoreGive(requestMutex);
+    return code;
+}
+
+int HttpService::performGet(const String& host, uint16_t port, const String& path, const BodyHandler& onBody,
+                            String* errorBody, const char* accept) {
+    if (!ensureConnected(host, port)) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    HTTPClient http;
+    http.setReuse(true);
+    http.setTimeout(RESPONSE_TIMEOUT_MS);
+    http.begin(client, host, port, path);
+
+    http.addHeader("User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/91.0.4472.124 Safari/537.36");
+    http.addHeader("Accept", accept);
+    http.addHeader("Accept-Encoding", "identity"); // Disable compression, bodies are parsed as they arrive
+
+    uint32_t urlHash = hashUrl(host, path);
+    Validator* validator = findValidator(urlHash);
+    if (validator != nullptr) {
+        if (validator->etag[0] != '\0') {
+            http.addHeader("If-None-Match", validator->etag);
+        }
+        if (validator->lastModified[0] != '\0') {
+            http.addHeader("If-Modified-Since", validator->lastModified);
+        }
+    }
+
+    const char* headerKeys[] = {"ETag", "Last-Modified"};
+    http.collectHeaders(headerKeys, 2);
+
+    // Sending the request and waiting for the status line and headers
+    beginPhase(RequestTiming::FIRST_BYTE);
+    int64_t phaseStart = esp_timer_get_time();
+    int code = http.GET();
+    endPhase(RequestTiming::FIRST_BYTE, esp_timer_get_time() - phaseStart);
+
+    if (code == HTTP_CODE_OK) {
+        int contentLength = http.getSize();
+        bool accepted = false;
+
+        if (contentLength >= 0) {
+            // Identity body: hand the socket to the handler, then skip whatever it did not read
+            int64_t waitUs = 0;
+            CountingStream body(*http.getStreamPtr(), timing != nullptr ? &waitUs : nullptr);
+            body.setTimeout(RESPONSE_TIMEOUT_MS);
+            beginPhase(RequestTiming::BODY_READ);
+            beginPhase(RequestTiming::PARSE);
+            phaseStart = esp_timer_get_time();
+            accepted = onBody(body);
+            if (timing != nullptr) {
+                // Reading and parsing interleave: waiting for bytes is the read, the rest is the handler
+                int64_t handlerUs = esp_timer_get_time() - phaseStart;
+                endPhase(RequestTiming::BODY_READ, waitUs);
+                endPhase(RequestTiming::PARSE, handlerUs - waitUs);
+                timing->bodyBytes = body.getConsumed();
+            }
+            if (!drainBody(body, contentLength)) {
+                client.stop();
+            }
+        } else {
+            // Chunked body: let HTTPClient decode it first, into PSRAM when an arena is available
+            PsramArena* arena = MemoryManager::getInstance()->getArena(MemoryManager::Operation::HTTP_REQUEST);
+            if (arena != nullptr) {
+                ArenaStream payload(*arena);
+                beginPhase(RequestTiming::BODY_READ);
+                phaseStart = esp_timer_get_time();
+                http.writeToStream(&payload);
+                endPhase(RequestTiming::BODY_READ, esp_timer_get_time() - phaseStart);
+                if (timing != nullptr) {
+                    timing->bodyBytes = payload.available();
+                }
+                beginPhase(RequestTiming::PARSE);
+                phaseStart = esp_timer_get_time();
+                accepted = !payload.hasOverflowed() && onBody(payload);
+                endPhase(RequestTiming::PARSE, esp_timer_get_time() - phaseStart);
+            } else {
+                StreamString payload;
+                beginPhase(RequestTiming::BODY_READ);
+                phaseStart = esp_timer_get_time();
+                http.writeToStream(&payload);
+                endPhase(RequestTiming::BODY_READ, esp_timer_get_time() - phaseStart);
+                if (timing != nullptr) {
+                    timing->bodyBytes = payload.length();
+                }
+                beginPhase(RequestTiming::PARSE);
+                phaseStart = esp_timer_get_time();
+                accepted = onBody(payload);
+                endPhase(RequestTiming::PARSE, esp_timer_get_time() - phaseStart);
+            }
+        }
+
+        if (accepted) {
+            storeValidator(urlHash, http.header("ETag"), http.header("Last-Modified"));
+        } else {
+            code = ERROR_BODY_REJECTED;
+        }
+    } else if (code == HTTP_CODE_NOT_MODIFIED) {
+        notModifiedCount++;
+        Metrics::Add(notModifiedMetric);
+    } else if (code > 0) {
+        // Read error bodies completely so the connection can still be reused
+        String body = http.getString();
+        if (errorBody != nullptr) {
+            *errorBody = body;
+        }
+    } else {
+        client.stop();
+        invalidateHost(host);
+    }
+
+    http.end();
+    return code;
+}
+
+bool HttpService::ensureConnected(const String& host, uint16_t port) {
+    // A kept-alive socket to another server is useless
+    if (client.connected() && (connectedHost != host || connectedPort != port)) {
+        client.stop();
+    }
+
+    if (client.connected()) {
+        reusedConnectionCount++;
+        Metrics::Add(reusedConnectionsMetric);
+        if (timing != nullptr) {
+            timing->reusedConnection = true;
+        }
+        return true;
+    }
+
+    IPAddress address;
+    bool cached = false;
+    beginPhase(RequestTiming::DNS);
+    int64_t phaseStart = esp_timer_get_time();
+    bool resolved = resolveHost(host, address, cached);
+    endPhase(RequestTiming::DNS, esp_timer_get_time() - phaseStart);
+    if (timing != nullptr) {
+        timing->dnsCached = cached;
+    }
+    if (!resolved) {
+        LOG_WARNINGF("HttpService: DNS lookup failed for %s\n", host.c_str());
+        return false;
+    }
+
+    // Connect to the cached address ourselves; HTTPClient then reuses the open socket
+    beginPhase(RequestTiming::CONNECT);
+    phaseStart = esp_timer_get_time();
+    bool connected = client.connect(address, port, CONNECT_TIMEOUT_MS);
+    endPhase(RequestTiming::CONNECT, esp_timer_get_time() - phaseStart);
+    if (!connected) {
+        LOG_WARNINGF("HttpService: Connection to %s failed\n", host.c_str());
+        invalidateHost(host);
+        return false;
+    }
+
+    connectedHost = host;
+    connectedPort = port;
+    return true;
+}
+
+bool HttpService::resolveHost(const String& host, IPAddress& address, bool& cached) {
+    unsigned long now = millis();
+    DnsEntry* freeSlot = nullptr;
+    DnsEntry* oldest = &dnsCache[0];
+
+    for (int i = 0; i < MAX_DNS_ENTRIES; i++) {
+        DnsEntry& entry = dnsCache[i];
+        if (entry.host[0] == '\0') {
+            freeSlot = freeSlot ? freeSlot : &entry;
+            continue;
+        }
+        if (host.equals(entry.host)) {
+            if (now - entry.resolvedAt < DNS_TTL_MS) {
+                address = entry.address;
+                return true;
+            }
+            freeSlot = &entry;  // Expired, refresh in place
+            break;
+        }
+        if (entry.resolvedAt < oldest->resolvedAt) {
+            oldest = &entry;
+        }
+    }
+
+    if (WiFi.hostByName(host.c_str(), address) != 1) {
+        return false;
+    }
+
+    DnsEntry* slot = freeSlot ? freeSlot : oldest;
+    strncpy(slot->host, host.c_str(), sizeof(slot->host) - 1);
+    slot->host[sizeof(slot->host) - 1] = '\0';
+    slot->address = address;
+    slot->resolvedAt = now;
+    return true;
+}
+
+void HttpService::dropConnection() {
+    if (requestMutex == nullptr || xSemaphoreTake(requestMutex, pdMS_TO_TICKS(REQUEST_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        return;
+    }
+    client.stop();
+    connectedHost = "";
+    connectedPort = 0;
+    for (int i = 0; i < MAX_DNS_ENTRIES; i++) {
+        dnsCache[i].host[0] = '\0';
+    }
+    xSemaphoreGive(requestMutex);
+}
+
+void HttpService::forgetValidators() {
+    if (requestMutex == nullptr || xSemaphoreTake(requestMutex, pdMS_TO_TICKS(REQUEST_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        return;
+    }
+    memset(validators, 0, sizeof(validators));
+    nextValidatorSlot = 0;
+    xSemaphoreGive(requestMutex);
+}
+
+void HttpService::beginPhase(RequestTiming::Phase phase) {
+    if (timing == nullptr) {
+        return;
+    }
+    MemoryManager* memory = MemoryManager::getInstance();
+    timing->phases[phase].minFreeHeapBefore = memory->getMinimumFreeHeap();
+    timing->phases[phase].largestBlockBefore = memory->getLargestFreeBlock();
+}
+
+void HttpService::endPhase(RequestTiming::Phase phase, int64_t elapsedUs) {
+    if (timing == nullptr) {
+        return;
+    }
+    MemoryManager* memory = MemoryManager::getInstance();
+    RequestTiming::PhaseSample& sample = timing->phases[phase];
+    sample.micros = (uint32_t)elapsedUs;
+    sample.minFreeHeapAfter = memory->getMinimumFreeHeap();
+    sample.largestBlockAfter = memory->getLargestFreeBlock();
+}
+
+const char* HttpService::RequestTiming::phaseName(int phase) {
+    switch (phase) {
+        case DNS:        return "dns";
+        case CONNECT:    return "connect";
+        case FIRST_BYTE: return "first byte";
+        case BODY_READ:  return "body read";
+        case PARSE:      return "parse";
+        default:         return "?";
+    }
+}
+
+void HttpService::invalidateHost(const String& host) {
+    for (int i = 0; i < MAX_DNS_ENTRIES; i++) {
+        if (host.equals(dnsCache[i].host)) {
+            dnsCache[i].host[0] = '\0';
+        }
+    }
+}
+
+HttpService::Validator* HttpService::findValidator(uint32_t urlHash) {
+    for (int i = 0; i < MAX_VALIDATORS; i++) {
+        if (validators[i].urlHash == urlHash) {
+            return &validators[i];
+        }
+    }
+    return nullptr;
+}
+
+void HttpService::storeValidator(uint32_t urlHash, const String& etag, const String& lastModified) {
+    Validator* validator = findValidator(urlHash);
+    if (etag.isEmpty() && lastModified.isEmpty()) {
+        // Server gave nothing to revalidate against; forget any stale validator
+        if (validator != nullptr) {
+            memset(validator, 0, sizeof(Validator));
+        }
+        return;
+    }
+
+    if (validator == nullptr) {
+        validator = &validators[nextValidatorSlot];
+        nextValidatorSlot = (nextValidatorSlot + 1) % MAX_VALIDATORS;
+    }
+
+    validator->urlHash = urlHash;
+    strncpy(validator->etag, etag.c_str(), sizeof(validator->etag) - 1);
+    validator->etag[sizeof(validator->etag) - 1] = '\0';
+    strncpy(validator->lastModified, lastModified.c_str(), sizeof(validator->lastModified) - 1);
+    validator->lastModified[sizeof(validator->lastModified) - 1] = '\0';
+}
+
+bool HttpService::parseUrl(const String& url, String& host, uint16_t& port, String& path) {
+    const char* prefix = "http://";
+    if (!url.startsWith(prefix)) {
+        return false;
+    }
+
+    int hostStart = strlen(prefix);
+    int pathStart = url.indexOf('/', hostStart);
+    String authority = pathStart < 0 ? url.substring(hostStart) : url.substring(hostStart, pathStart);
+    path = pathStart < 0 ? String("/") : url.substring(pathStart);
+
+    int colon = authority.indexOf(':');
+    if (colon >= 0) {
+        host = authority.substring(0, colon);
+        port = authority.substring(colon + 1).toInt();
+    } else {
+        host = authority;
+        port = 80;
+    }
+
+    return !host.isEmpty() && port != 0;
+}
+
+uint32_t HttpService::hashUrl(const String& host, const String& path) {
+    // FNV-1a over host and path; 0 is reserved for empty validator slots
+    uint32_t hash = 2166136261u;
+    for (unsigned int i = 0; i < host.length(); i++) {
+        hash = (hash ^ (uint8_t)host[i]) * 16777619u;
+    }
+    for (unsigned int i = 0; i < path.length(); i++) {
+        hash = (hash ^ (uint8_t)path[i]) * 16777619u;
+    }
+    return hash == 0 ? 1 : hash;
+}
+
+String HttpService::errorToString(int code) {
+    switch (code) {
+        case ERROR_BAD_URL:
+            return "unsupported URL";
+        case ERROR_NOT_CONNECTED:
+            return "WiFi not connected";
+        case ERROR_BUSY:
+            return "HTTP service busy";
+        case ERROR_NO_MEMORY:
+            return "memory unavailable";
+        case ERROR_BODY_REJECTED:
+            return "response body rejected";
+        default:
+            return HTTPClient::errorToString(code);
+    }
+}
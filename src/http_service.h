@@ -0,0 +1,135 @@
+#ifndef HTTP_SERVICE_H
+#define HTTP_SERVICE_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <functional>
+
+/**
+ * Shared HTTP Service
+ *
+ * Single owner of the HTTP socket for all network modules. Requests are serialized so only
+ * one set of TCP buffers exists at a time, the connection is kept alive between requests to
+ * the same host, DNS results are cached, and ETag / Last-Modified validators are replayed so
+ * unchanged resources come back as 304 without a body.
+ */
+class HttpService {
+public:
+    // Called with the response body on 200; return false to reject it (validators are not stored)
+    typedef std::function<bool(Stream& body)> BodyHandler;
+
+    // Service-level errors, reported alongside the negative HTTPClient error codes
+    static const int ERROR_BAD_URL = -100;
+    static const int ERROR_NOT_CONNECTED = -101;
+    static const int ERROR_BUSY = -102;
+    static const int ERROR_NO_MEMORY = -103;
+    static const int ERROR_BODY_REJECTED = -104;
+
+    // Where the time of one request went, filled in when a timing record is passed to get()
+    struct RequestTiming {
+        enum Phase { DNS, CONNECT, FIRST_BYTE, BODY_READ, PARSE, PHASE_COUNT };
+
+        struct PhaseSample {
+            uint32_t micros;
+            uint32_t minFreeHeapBefore;   // MemoryManager::getMinimumFreeHeap()
+            uint32_t minFreeHeapAfter;
+            uint32_t largestBlockBefore;  // MemoryManager::getLargestFreeBlock()
+            uint32_t largestBlockAfter;
+        };
+
+        PhaseSample phases[PHASE_COUNT];
+        bool dnsCached;         // DNS and CONNECT are zero when the kept-alive socket was reused
+        bool reusedConnection;
+        uint32_t bodyBytes;
+
+        static const char* phaseName(int phase);
+    };
+
+    static HttpService* getInstance();
+    static void initialize();
+
+    // Perform a GET on an http:// URL. Returns the HTTP status code (200, 304, 4xx...) or a negative error.
+    // The body handler runs only for 200; errorBody receives the body of non-2xx/3xx responses if given.
+    // With timing, a Content-Length body is read by the handler straight from the socket: BODY_READ is
+    // only the time from a read finding the socket empty until the next byte arrives, and PARSE is the
+    // rest of the handler, copying bytes already received included. Both run interleaved, so they share
+    // heap samples. A chunked body is decoded into a buffer first; BODY_READ is that whole transfer.
+    int get(const String& url, const BodyHandler& onBody, const char* moduleName, String* errorBody = nullptr,
+            const char* accept = "application/json", RequestTiming* timing = nullptr);
+
+    // Close the kept-alive socket and forget cached DNS results, so the next request starts cold
+    void dropConnection();
+
+    // Forget all ETag / Last-Modified validators, so the next requests fetch full bodies
+    void forgetValidators();
+
+    static String errorToString(int code);
+
+    // Statistics
+    uint32_t getRequestCount() const { return requestCount; }
+    uint32_t getReusedConnectionCount() const { return reusedConnectionCount; }
+    uint32_t getNotModifiedCount() const { return notModifiedCount; }
+
+private:
+    HttpService();
+
+    static HttpService* instance;
+    SemaphoreHandle_t requestMutex;
+
+    // Persistent socket, reused while the server keeps it open
+    WiFiClient client;
+    String connectedHost;
+    uint16_t connectedPort = 0;
+
+    // DNS cache (hostByName has no TTL information, so entries expire after a fixed time)
+    struct DnsEntry {
+        char host[64];
+        IPAddress address;
+        unsigned long resolvedAt;
+    };
+    static const int MAX_DNS_ENTRIES = 4;
+    static const unsigned long DNS_TTL_MS = 10UL * 60 * 1000;
+    DnsEntry dnsCache[MAX_DNS_ENTRIES];
+
+    // Conditional request validators, keyed by a hash of host + path
+    struct Validator {
+        uint32_t urlHash;
+        char etag[64];
+        char lastModified[40];
+    };
+    static const int MAX_VALIDATORS = 4;
+    Validator validators[MAX_VALIDATORS];
+    int nextValidatorSlot = 0;
+
+    static const uint32_t REQUEST_LOCK_TIMEOUT_MS = 30000;
+    static const uint32_t CONNECT_TIMEOUT_MS = 5000;
+    static const uint16_t RESPONSE_TIMEOUT_MS = 10000;
+    static const size_t REQUEST_MEMORY_BYTES = 2048;
+
+    // Timing record of the request in progress, nullptr when it is not being timed
+    RequestTiming* timing = nullptr;
+
+    uint32_t requestCount = 0;
+    uint32_t reusedConnectionCount = 0;
+    uint32_t notModifiedCount = 0;
+
+    int performGet(const String& host, uint16_t port, const String& path, const BodyHandler& onBody,
+                   String* errorBody, const char* accept);
+    bool ensureConnected(const String& host, uint16_t port);
+    bool resolveHost(const String& host, IPAddress& address, bool& cached);
+    void invalidateHost(const String& host);
+    Validator* findValidator(uint32_t urlHash);
+    void storeValidator(uint32_t urlHash, const String& etag, const String& lastModified);
+
+    // Heap samples around a timed phase; no-ops unless the request is timed
+    void beginPhase(RequestTiming::Phase phase);
+    void endPhase(RequestTiming::Phase phase, int64_t elapsedUs);
+
+    static bool parseUrl(const String& url, String& host, uint16_t& port, String& path);
+    static uint32_t hashUrl(const String& host, const String& path);
+};
+
+#endif // HTTP_SERVICE_H
@@ -0,0 +1,87 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Latency Histogram
+ *
+ * Fixed-size log-linear histogram of durations in microseconds: every power of two is split
+ * into four linear buckets, giving at most 25% error per reading from 1 us to about 8 s in
+ * 176 bytes. Recording is a couple of instructions, so it can sit on the display hot path.
+ * Not synchronized; record and read from the same task.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 2;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int BUCKET_COUNT = 88;
+
+    void record(uint32_t micros) {
+        int index = bucketIndex(micros);
+        if (counts[index] != UINT16_MAX) {
+            counts[index]++;
+        }
+        total++;
+        if (micros > maxValue) {
+            maxValue = micros;
+        }
+    }
+
+    void reset() {
+        memset(counts, 0, sizeof(counts));
+        total = 0;
+        maxValue = 0;
+    }
+
+    uint32_t getCount() const { return total; }
+    uint32_t getMax() const { return maxValue; }
+
+    // Upper bound of the bucket holding the given percentile (0-100), never above the maximum
+    uint32_t getPercentile(float percentile) const {
+        if (total == 0) {
+            return 0;
+        }
+
+        uint32_t seen = 0;
+        uint32_t target = (uint32_t)(total * percentile / 100.0f + 0.5f);
+        if (target == 0) {
+            target = 1;
+        }
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts[i];
+            if (seen >= target) {
+                uint32_t upper = bucketUpperBound(i);
+                return upper < maxValue ? upper : maxValue;
+            }
+        }
+        return maxValue;
+    }
+
+private:
+    uint16_t counts[BUCKET_COUNT] = {};
+    uint32_t total = 0;
+    uint32_t maxValue = 0;
+
+    static int bucketIndex(uint32_t value) {
+        if (value < (uint32_t)SUB_BUCKETS) {
+            return value;
+        }
+        int msb = 31 - __builtin_clz(value);
+        int sub = (value >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+        int index = (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+        return index < BUCKET_COUNT ? index : BUCKET_COUNT - 1;
+    }
+
+    static uint32_t bucketUpperBound(int index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        int shift = index / SUB_BUCKETS - 1;
+        uint32_t lower = (uint32_t)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+        return lower + (1u << shift) - 1;
+    }
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,110 @@
+#include "log_ring.h"
+#include <esp_heap_caps.h>
+#include <cstring>
+
+bool LogRing::begin(size_t requestedCapacity, uint32_t caps) {
+    if (buffer != nullptr) {
+        return true;
+    }
+    if (requestedCapacity == 0 || (requestedCapacity & (requestedCapacity - 1)) != 0 ||
+        requestedCapacity > UINT16_MAX + 1) {
+        return false;
+    }
+
+    buffer = (uint8_t*)heap_caps_calloc(1, requestedCapacity, caps);
+    if (buffer == nullptr) {
+        return false;
+    }
+
+    capacity = requestedCapacity;
+    mask = requestedCapacity - 1;
+    return true;
+}
+
+bool LogRing::push(uint8_t level, uint32_t timestamp, const char* message, size_t length) {
+    if (buffer == nullptr) {
+        return false;
+    }
+    if (length > MAX_MESSAGE_LENGTH) {
+        length = MAX_MESSAGE_LENGTH;
+    }
+
+    // Records never straddle the end: if one does not fit, the tail is filled with padding
+    uint32_t needed = recordSize(length);
+    uint32_t reserved = head.load(std::memory_order_relaxed);
+    uint32_t total;
+    while (true) {
+        uint32_t contiguous = capacity - (reserved & mask);
+        total = contiguous < needed ? contiguous + needed : needed;
+        if (reserved + total - tail.load(std::memory_order_acquire) > capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (head.compare_exchange_weak(reserved, reserved + total, std::memory_order_acq_rel,
+                                       std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    uint32_t offset = reserved & mask;
+    if (total != needed) {
+        Header* padding = (Header*)(buffer + offset);
+        padding->length = capacity - offset - sizeof(Header);
+        __atomic_store_n(&padding->state, PADDING, __ATOMIC_RELEASE);
+        offset = 0;
+    }
+
+    Header* header = (Header*)(buffer + offset);
+    header->length = length;
+    header->level = level;
+    header->timestamp = timestamp;
+    memcpy(header + 1, message, length);
+    __atomic_store_n(&header->state, COMMITTED, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool LogRing::peek(Record& record) {
+    if (buffer == nullptr) {
+        return false;
+    }
+
+    uint32_t position = tail.load(std::memory_order_relaxed);
+    while (position != head.load(std::memory_order_acquire)) {
+        Header* header = (Header*)(buffer + (position & mask));
+        uint8_t state = __atomic_load_n(&header->state, __ATOMIC_ACQUIRE);
+
+        // Reserved but not yet written; later records wait for it to keep order
+        if (state == EMPTY) {
+            return false;
+        }
+
+        uint32_t size = recordSize(header->length);
+        if (state == PADDING) {
+            // Clear before releasing the space so a future lap never sees a stale state
+            __atomic_store_n(&header->state, EMPTY, __ATOMIC_RELAXED);
+            position += size;
+            tail.store(position, std::memory_order_release);
+            continue;
+        }
+
+        record.level = header->level;
+        record.timestamp = header->timestamp;
+        record.message = (const char*)(header + 1);
+        record.length = header->length;
+        peekedSize = size;
+        return true;
+    }
+    return false;
+}
+
+void LogRing::pop() {
+    if (peekedSize == 0) {
+        return;
+    }
+
+    uint32_t position = tail.load(std::memory_order_relaxed);
+    Header* header = (Header*)(buffer + (position & mask));
+    __atomic_store_n(&header->state, EMPTY, __ATOMIC_RELAXED);
+    tail.store(position + peekedSize, std::memory_order_release);
+    peekedSize = 0;
+}
@@ -0,0 +1,69 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * Lock-free Log Ring
+ *
+ * Fixed-capacity byte ring of length-prefixed log records. Any number of tasks may push
+ * concurrently: space is reserved with a compare-and-swap on the head index and the record
+ * is published by a release store of its state byte. A single consumer (the file writer task)
+ * reads committed records in place and frees them in order. When the ring is full the new
+ * record is dropped and counted instead of blocking the caller.
+ *
+ * Indices live in the object (internal RAM, atomics); the record storage may be in PSRAM.
+ */
+class LogRing {
+public:
+    struct Record {
+        uint8_t level;
+        uint32_t timestamp;
+        const char* message;  // Not NUL-terminated, valid until pop()
+        size_t length;
+    };
+
+    // Longest message stored per record, longer ones are truncated
+    static const size_t MAX_MESSAGE_LENGTH = 512;
+
+    // Capacity must be a power of two; storage is allocated once from the given heap_caps and never freed
+    bool begin(size_t capacity, uint32_t caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    bool isReady() const { return buffer != nullptr; }
+
+    // Producer side (any task)
+    bool push(uint8_t level, uint32_t timestamp, const char* message, size_t length);
+
+    // Consumer side (one task only)
+    bool peek(Record& record);
+    void pop();
+
+    size_t getUsed() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    size_t getCapacity() const { return capacity; }
+    uint32_t takeDropped() { return dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+    enum : uint8_t { EMPTY = 0, COMMITTED = 1, PADDING = 2 };
+
+    struct Header {
+        uint16_t length;
+        uint8_t level;
+        uint8_t state;
+        uint32_t timestamp;
+    };
+
+    static uint32_t recordSize(size_t length) { return (sizeof(Header) + length + 7) & ~7u; }
+
+    uint8_t* buffer = nullptr;
+    uint32_t capacity = 0;
+    uint32_t mask = 0;
+
+    std::atomic<uint32_t> head{0};     // Next byte to reserve (monotonic)
+    std::atomic<uint32_t> tail{0};     // Oldest unconsumed byte (monotonic)
+    std::atomic<uint32_t> dropped{0};
+    uint32_t peekedSize = 0;
+};
+
+#endif // LOG_RING_H
@@ -1,8 +1,10 @@
 #include "logger.h"
-#include "memory_manager.h"
 #include "config.h"
+#include <esp_heap_caps.h>
+#include <algorithm>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
 
 // External SPI mutex for SD card operations
 extern SemaphoreHandle_t spiMutex;
@@ -11,7 +13,9 @@ extern SemaphoreHandle_t spiMutex;
 extern Config config;
 
 // Static member definitions
-const size_t Logger::MAX_BUFFER_SIZE;
+const size_t Logger::RING_CAPACITY;
+const size_t Logger::RING_FALLBACK_CAPACITY;
+const size_t Logger::STAGING_BUFFER_SIZE;
 const uint32_t Logger::FILE_WRITE_INTERVAL_MS;
 
 Logger& Logger::getInstance() {
@@ -29,14 +33,27 @@ void Logger::init(bool enableSerial, bool enableFile, const char* logFileName) {
         }
     }
     
-    if (bufferMutex == nullptr) {
-        bufferMutex = xSemaphoreCreateMutex();
-        if (bufferMutex == nullptr) {
-            Serial.println("Logger: Failed to create buffer mutex!");
-            return;
+    // Ring and staging buffer are allocated once, the first time file logging is enabled
+    if (enableFile && !logRing.isReady()) {
+        // Full size in PSRAM, or the smaller ring in internal RAM on boards without it
+        if (!logRing.begin(RING_CAPACITY) &&
+            !logRing.begin(RING_FALLBACK_CAPACITY, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)) {
+            Serial.println("Logger: Failed to allocate log ring, file logging disabled");
+            enableFile = false;
         }
     }
-    
+
+    if (enableFile && stagingBuffer == nullptr) {
+        stagingBuffer = (char*)heap_caps_malloc(STAGING_BUFFER_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (stagingBuffer == nullptr) {
+            stagingBuffer = (char*)heap_caps_malloc(STAGING_BUFFER_SIZE, MALLOC_CAP_8BIT);
+        }
+        if (stagingBuffer == nullptr) {
+            Serial.println("Logger: Failed to allocate staging buffer, file logging disabled");
+            enableFile = false;
+        }
+    }
+
     serialEnabled = enableSerial;
     fileEnabled = enableFile;
     logFilePath = logFileName;
@@ -59,380 +76,186 @@ void Logger::setLogLevel(LogLevel level) {
 }
 
 void Logger::log(LogLevel level, const char* message) {
-    log(level, String(message));
-}
-
-void Logger::log(LogLevel level, const String& message) {
-    if (level < currentLogLevel) {
+    if (level < currentLogLevel || message == nullptr) {
         return; // Filter out messages below current log level
     }
-    
-    writeLog(level, message);
+
+    writeLog(level, message, strlen(message));
 }
 
-void Logger::logf(LogLevel level, const char* format, ...) {
+void Logger::log(LogLevel level, const String& message) {
     if (level < currentLogLevel) {
         return; // Filter out messages below current log level
     }
-    
-    va_list args;
-    va_start(args, format);
-    
-    // Calculate required buffer size
-    int size = vsnprintf(nullptr, 0, format, args) + 1;
-    va_end(args);
-    
-    if (size <= 0) return;
-    
-    char* buffer = new char[size];
-    if (buffer == nullptr) return;
-    
-    va_start(args, format);
-    vsnprintf(buffer, size, format, args);
-    va_end(args);
-    
-    writeLog(level, String(buffer));
-    delete[] buffer;
-}
 
-void Logger::debug(const char* message) {
-    log(LogLevel::DEBUG, message);
+    writeLog(level, message.c_str(), message.length());
 }
 
-void Logger::debug(const String& message) {
-    log(LogLevel::DEBUG, message);
-}
-
-void Logger::debugf(const char* format, ...) {
-    if (LogLevel::DEBUG < currentLogLevel) return;
-    
+void Logger::logf(LogLevel level, const char* format, ...) {
     va_list args;
     va_start(args, format);
-    
-    int size = vsnprintf(nullptr, 0, format, args) + 1;
+    vlogf(level, format, args);
     va_end(args);
-    
-    if (size <= 0) return;
-    
-    char* buffer = new char[size];
-    if (buffer == nullptr) return;
-    
-    va_start(args, format);
-    vsnprintf(buffer, size, format, args);
-    va_end(args);
-    
-    writeLog(LogLevel::DEBUG, String(buffer));
-    delete[] buffer;
 }
 
-void Logger::info(const char* message) {
-    log(LogLevel::INFO, message);
-}
+void Logger::vlogf(LogLevel level, const char* format, va_list args) {
+    if (level < currentLogLevel) {
+        return; // Filter out messages below current log level
+    }
 
-void Logger::info(const String& message) {
-    log(LogLevel::INFO, message);
-}
+    // Format on the caller's stack, long messages are truncated
+    char message[LOG_MESSAGE_BUFFER_SIZE];
+    int length = vsnprintf(message, sizeof(message), format, args);
+    if (length < 0) {
+        return;
+    }
 
-void Logger::infof(const char* format, ...) {
-    if (LogLevel::INFO < currentLogLevel) return;
-    
-    va_list args;
-    va_start(args, format);
-    
-    int size = vsnprintf(nullptr, 0, format, args) + 1;
-    va_end(args);
-    
-    if (size <= 0) return;
-    
-    char* buffer = new char[size];
-    if (buffer == nullptr) return;
-    
-    va_start(args, format);
-    vsnprintf(buffer, size, format, args);
-    va_end(args);
-    
-    writeLog(LogLevel::INFO, String(buffer));
-    delete[] buffer;
+    writeLog(level, message, std::min((size_t)length, sizeof(message) - 1));
 }
 
-void Logger::warning(const char* message) {
-    log(LogLevel::WARNING, message);
-}
+// Convenience methods forward to the single formatting path
+#define LOGGER_FORWARD_FORMAT(level, format) \
+    va_list args;                            \
+    va_start(args, format);                  \
+    vlogf(level, format, args);              \
+    va_end(args)
 
-void Logger::warning(const String& message) {
-    log(LogLevel::WARNING, message);
-}
+void Logger::debug(const char* message) { log(LogLevel::DEBUG, message); }
+void Logger::debug(const String& message) { log(LogLevel::DEBUG, message); }
+void Logger::debugf(const char* format, ...) { LOGGER_FORWARD_FORMAT(LogLevel::DEBUG, format); }
 
-void Logger::warningf(const char* format, ...) {
-    if (LogLevel::WARNING < currentLogLevel) return;
-    
-    va_list args;
-    va_start(args, format);
-    
-    int size = vsnprintf(nullptr, 0, format, args) + 1;
-    va_end(args);
-    
-    if (size <= 0) return;
-    
-    char* buffer = new char[size];
-    if (buffer == nullptr) return;
-    
-    va_start(args, format);
-    vsnprintf(buffer, size, format, args);
-    va_end(args);
-    
-    writeLog(LogLevel::WARNING, String(buffer));
-    delete[] buffer;
-}
+void Logger::info(const char* message) { log(LogLevel::INFO, message); }
+void Logger::info(const String& message) { log(LogLevel::INFO, message); }
+void Logger::infof(const char* format, ...) { LOGGER_FORWARD_FORMAT(LogLevel::INFO, format); }
 
-void Logger::error(const char* message) {
-    log(LogLevel::ERROR, message);
-}
+void Logger::warning(const char* message) { log(LogLevel::WARNING, message); }
+void Logger::warning(const String& message) { log(LogLevel::WARNING, message); }
+void Logger::warningf(const char* format, ...) { LOGGER_FORWARD_FORMAT(LogLevel::WARNING, format); }
 
-void Logger::error(const String& message) {
-    log(LogLevel::ERROR, message);
-}
-
-void Logger::errorf(const char* format, ...) {
-    if (LogLevel::ERROR < currentLogLevel) return;
-    
-    va_list args;
-    va_start(args, format);
-    
-    int size = vsnprintf(nullptr, 0, format, args) + 1;
-    va_end(args);
-    
-    if (size <= 0) return;
-    
-    char* buffer = new char[size];
-    if (buffer == nullptr) return;
-    
-    va_start(args, format);
-    vsnprintf(buffer, size, format, args);
-    va_end(args);
-    
-    writeLog(LogLevel::ERROR, String(buffer));
-    delete[] buffer;
-}
+void Logger::error(const char* message) { log(LogLevel::ERROR, message); }
+void Logger::error(const String& message) { log(LogLevel::ERROR, message); }
+void Logger::errorf(const char* format, ...) { LOGGER_FORWARD_FORMAT(LogLevel::ERROR, format); }
 
 // Print methods for easy Serial replacement
-void Logger::print(const char* message) {
-    log(LogLevel::INFO, message);
-}
+void Logger::print(const char* message) { log(LogLevel::INFO, message); }
+void Logger::print(const String& message) { log(LogLevel::INFO, message); }
+void Logger::println(const char* message) { log(LogLevel::INFO, message); }
+void Logger::println(const String& message) { log(LogLevel::INFO, message); }
+void Logger::printf(const char* format, ...) { LOGGER_FORWARD_FORMAT(LogLevel::INFO, format); }
+
+#undef LOGGER_FORWARD_FORMAT
+
+void Logger::writeLog(LogLevel level, const char* message, size_t length) {
+    // Messages carry their own trailing newline inconsistently; every output line gets exactly one
+    while (length > 0 && (message[length - 1] == '\n' || message[length - 1] == '\r')) {
+        length--;
+    }
 
-void Logger::print(const String& message) {
-    log(LogLevel::INFO, message);
-}
+    if (serialEnabled) {
+        char line[LOG_LINE_BUFFER_SIZE];
+        size_t lineLength = formatLogMessage(line, sizeof(line), level, message, length);
 
-void Logger::println(const char* message) {
-    log(LogLevel::INFO, message);
-}
+        if (logMutex == nullptr) {
+            // Fallback to direct Serial output if mutex not available
+            Serial.write((const uint8_t*)line, lineLength);
+        } else if (xSemaphoreTake(logMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+            // Mutex only keeps lines from different tasks from interleaving
+            Serial.write((const uint8_t*)line, lineLength);
+            xSemaphoreGive(logMutex);
+        }
+    }
 
-void Logger::println(const String& message) {
-    log(LogLevel::INFO, message);
+    // Add to ring for file logging (if enabled)
+    if (fileEnabled) {
+        addToBuffer(level, message, length);
+    }
 }
 
-void Logger::printf(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    
-    int size = vsnprintf(nullptr, 0, format, args) + 1;
-    va_end(args);
-    
-    if (size <= 0) return;
-    
-    char* buffer = new char[size];
-    if (buffer == nullptr) return;
-    
-    va_start(args, format);
-    vsnprintf(buffer, size, format, args);
-    va_end(args);
-    
-    writeLog(LogLevel::INFO, String(buffer));
-    delete[] buffer;
-}
+void Logger::addToBuffer(LogLevel level, const char* message, size_t length) {
+    // Lock-free and allocation-free; a full ring drops the record and counts it
+    logRing.push((uint8_t)level, millis(), message, length);
 
-void Logger::writeLog(LogLevel level, const String& message) {
-    if (logMutex == nullptr) {
-        // Fallback to direct Serial output if mutex not available
-        if (serialEnabled) {
-            Serial.println(message);
-        }
-        return;
-    }
-    
-    // Take logger mutex with timeout
-    if (xSemaphoreTake(logMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        String formattedMessage = formatLogMessage(level, message);
-        
-        // Output to Serial immediately
-        if (serialEnabled) {
-            Serial.print(formattedMessage);
-        }
-        
-        // Add to buffer for file logging (if enabled)
-        if (fileEnabled) {
-            addToBuffer(level, message);
-        }
-        
-        xSemaphoreGive(logMutex);
+    // Drain early under bursts instead of waiting for the next interval
+    if (fileWriterTaskHandle != nullptr && logRing.getUsed() > logRing.getCapacity() / 2) {
+        xTaskNotifyGive(fileWriterTaskHandle);
     }
 }
 
-void Logger::addToBuffer(LogLevel level, const String& message) {
-    if (bufferMutex == nullptr) return;
-    
-    // Check available memory before adding to buffer - more aggressive
-    size_t freeHeap = ESP.getFreeHeap();
-    if (freeHeap < 6144) {  // Need at least 6KB free memory (increased from 4KB)
-        return;  // Skip buffering if memory is low
-    }
-    
-    if (xSemaphoreTake(bufferMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        try {
-            // Aggressive buffer management based on memory pressure
-            size_t maxSize;
-            if (freeHeap < 8192) {
-                maxSize = MAX_BUFFER_SIZE / 4;  // Very aggressive when low memory
-            } else if (freeHeap < 12288) {
-                maxSize = MAX_BUFFER_SIZE / 2;  // Moderate reduction
-            } else {
-                maxSize = MAX_BUFFER_SIZE;      // Normal size
-            }
-            
-            // If critically low memory, clear buffer entirely
-            if (freeHeap < 8192 && !logBuffer.empty()) {
-                logBuffer.clear();
-                logBuffer.shrink_to_fit();  // Force deallocation
-            } else {
-                while (logBuffer.size() >= maxSize) {
-                    logBuffer.erase(logBuffer.begin());
-                }
-            }
-            
-            // Add new entry with current timestamp
-            logBuffer.emplace_back(level, message, millis());
-            
-        } catch (const std::exception& e) {
-            // If adding fails, clear some space and try again
-            if (!logBuffer.empty()) {
-                logBuffer.erase(logBuffer.begin(), logBuffer.begin() + std::min(static_cast<size_t>(10), logBuffer.size()));
-                try {
-                    logBuffer.emplace_back(level, message, millis());
-                } catch (...) {
-                    // If still fails, just ignore this log entry
-                }
-            }
-        }
-        
-        xSemaphoreGive(bufferMutex);
+bool Logger::writeStaging(File& file, size_t& used) {
+    if (used == 0) {
+        return true;
     }
+    bool written = file.write((const uint8_t*)stagingBuffer, used) == used;
+    used = 0;
+    return written;
 }
 
 void Logger::flushBufferToFile() {
-    if (bufferMutex == nullptr || spiMutex == nullptr) return;
-    
-    // Request memory for file operations through MemoryManager
-    if (!MEMORY_REQUEST(MemoryManager::Operation::CONFIG_OPERATION, 
-                       MemoryManager::Priority::BACKGROUND, 
-                       2048, "Logger-Flush")) {
-        // Skip this flush cycle if we can't get memory
-        return;
-    }
-    
-    std::vector<LogEntry> bufferCopy;
-    
-    // Only reserve if we have sufficient memory
-    size_t freeHeap = ESP.getFreeHeap();
-    size_t reserveSize = std::min(static_cast<size_t>(25), static_cast<size_t>(freeHeap / 500));
-    try {
-        bufferCopy.reserve(reserveSize);
-    } catch (...) {
-        // If reserve fails, release memory and return
-        MEMORY_RELEASE(MemoryManager::Operation::CONFIG_OPERATION, "Logger-Flush");
-        return;
+    if (spiMutex == nullptr || stagingBuffer == nullptr || logRing.getUsed() == 0) return;
+
+    if (xSemaphoreTake(spiMutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
+        return;  // Records stay in the ring until the next cycle
     }
-    
-    // Move buffer contents under mutex protection (avoid copying)
-    if (xSemaphoreTake(bufferMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        if (!logBuffer.empty()) {
-            try {
-                // Use move semantics to avoid copying
-                bufferCopy = std::move(logBuffer);
-                logBuffer.clear();
-                
-                // Only reserve if we have enough memory
-                if (ESP.getFreeHeap() > (MAX_BUFFER_SIZE * 100 + 4096)) {  // Buffer size + safety margin
-                    logBuffer.reserve(MAX_BUFFER_SIZE);
-                }
-            } catch (const std::exception& e) {
-                // If move fails, fall back to processing in chunks
-                size_t chunkSize = std::min(static_cast<size_t>(10), logBuffer.size());
-                bufferCopy.assign(logBuffer.begin(), logBuffer.begin() + chunkSize);
-                logBuffer.erase(logBuffer.begin(), logBuffer.begin() + chunkSize);
-            }
+
+    File logFile = SD.open(logFilePath, FILE_APPEND);
+    if (logFile) {
+        size_t used = 0;
+
+        uint32_t dropped = logRing.takeDropped();
+        if (dropped > 0) {
+            used = snprintf(stagingBuffer, STAGING_BUFFER_SIZE, "[%lu] [WARN] Logger: %u records dropped, ring full\n",
+                            millis(), (unsigned)dropped);
         }
-        xSemaphoreGive(bufferMutex);
-    }
-    
-    // Write to file if we have entries (outside of buffer mutex)
-    if (!bufferCopy.empty()) {
-        if (xSemaphoreTake(spiMutex, pdMS_TO_TICKS(2000)) == pdTRUE) {
-            File logFile = SD.open(logFilePath, FILE_APPEND);
-            if (logFile) {
-                // Process entries in smaller chunks to avoid memory issues
-                for (size_t i = 0; i < bufferCopy.size(); i++) {
-                    const auto& entry = bufferCopy[i];
-                    
-                    // Check memory before processing each entry
-                    if (ESP.getFreeHeap() < 2048) {
-                        break;  // Stop if memory gets too low
-                    }
-                    
-                    String formattedMessage = formatLogMessage(entry.level, entry.message, entry.timestamp);
-                    logFile.print(formattedMessage);
-                    
-                    // Yield to other tasks every 5 entries
-                    if (i % 5 == 0) {
-                        vTaskDelay(pdMS_TO_TICKS(1));
-                    }
-                }
-                logFile.close();
+
+        // Format committed records into the staging buffer and write it in large blocks
+        LogRing::Record record;
+        while (logRing.peek(record)) {
+            size_t needed = record.length + 40;  // Timestamp, level and separators
+            if (used + needed > STAGING_BUFFER_SIZE && !writeStaging(logFile, used)) {
+                break;
+            }
+
+            int length = snprintf(stagingBuffer + used, STAGING_BUFFER_SIZE - used, "[%lu] [%s] %.*s\n",
+                                  (unsigned long)record.timestamp, getLevelString((LogLevel)record.level),
+                                  (int)record.length, record.message);
+            if (length > 0) {
+                used += std::min((size_t)length, STAGING_BUFFER_SIZE - used - 1);
             }
-            xSemaphoreGive(spiMutex);
+            logRing.pop();
         }
+
+        writeStaging(logFile, used);
+        logFile.close();
     }
-    MEMORY_RELEASE(MemoryManager::Operation::CONFIG_OPERATION, "Logger-Flush"); // Release memory after file operation
+    xSemaphoreGive(spiMutex);
 }
 
 void Logger::fileWriterTask(void* parameter) {
-    Logger* logger = static_cast<Logger*>(parameter);
-    
-    while (true) {
-        // Wait for the specified interval
-        vTaskDelay(pdMS_TO_TICKS(FILE_WRITE_INTERVAL_MS));
-        
-        // Flush buffer to file
-        if (logger->fileEnabled) {
-            logger->flushBufferToFile();
-        }
-    }
+    static_cast<Logger*>(parameter)->runFileWriterTask();
 }
 
-String Logger::formatLogMessage(LogLevel level, const String& message, unsigned long timestamp) {
-    String timeStr;
+size_t Logger::formatLogMessage(char* out, size_t size, LogLevel level, const char* message, size_t length,
+                                unsigned long timestamp) {
+    if (size == 0) {
+        return 0;
+    }
+
+    char timeStr[24];
     if (timestamp == 0) {
-        timeStr = getCurrentTimestamp();
+        formatTimestamp(timeStr, sizeof(timeStr));
     } else {
-        timeStr = String(timestamp);
+        snprintf(timeStr, sizeof(timeStr), "%lu", timestamp);
     }
-    String levelStr = getLevelString(level);
-    
-    // Format: [TIMESTAMP] [LEVEL] MESSAGE\n
-    return "[" + timeStr + "] [" + levelStr + "] " + message + "\n";
+
+    // Format: [TIMESTAMP] [LEVEL] MESSAGE\n, truncated to fit but always newline-terminated
+    int written = snprintf(out, size, "[%s] [%s] %.*s", timeStr, getLevelString(level), (int)length, message);
+    size_t used = written < 0 ? 0 : std::min((size_t)written, size - 2);
+    out[used++] = '\n';
+    out[used] = '\0';
+    return used;
 }
 
-String Logger::getLevelString(LogLevel level) {
+const char* Logger::getLevelString(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG:   return "DEBUG";
         case LogLevel::INFO:    return "INFO";
@@ -442,18 +265,17 @@ String Logger::getLevelString(LogLevel level) {
     }
 }
 
-String Logger::getCurrentTimestamp() {
+void Logger::formatTimestamp(char* out, size_t size) {
     time_t now;
     struct tm timeInfo;
-    
+
     if (time(&now) == -1 || !localtime_r(&now, &timeInfo)) {
         // If time is not available, use millis()
-        return String(millis());
+        snprintf(out, size, "%lu", millis());
+        return;
     }
-    
-    char timeString[64];
-    strftime(timeString, sizeof(timeString), "%Y-%m-%d %H:%M:%S", &timeInfo);
-    return String(timeString);
+
+    strftime(out, size, "%Y-%m-%d %H:%M:%S", &timeInfo);
 }
 
 void Logger::initFromConfig() {
@@ -499,57 +321,22 @@ String Logger::generateLogFilename(const String& prefix, bool includeDate) {
 }
 
 void Logger::runFileWriterTask() {
+    fileWriterTaskHandle = xTaskGetCurrentTaskHandle();
     uint32_t cycleCount = 0;
-    uint32_t emergencyClears = 0;
-    
+
     while (true) {
-        // Check memory more frequently than file writes
-        for (int i = 0; i < 15; i++) {  // Check every second for 15 seconds
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            
-            size_t freeHeap = ESP.getFreeHeap();
-            
-            // Use MemoryManager to check critical memory situations
-            if (MEMORY_CHECK_CRITICAL() && bufferMutex != nullptr) {
-                if (xSemaphoreTake(bufferMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-                    if (!logBuffer.empty()) {
-                        logBuffer.clear();
-                        logBuffer.shrink_to_fit();
-                        emergencyClears++;
-                        Serial.printf("[LOGGER] EMERGENCY: Cleared buffer, free heap: %d bytes\n", ESP.getFreeHeap());
-                        
-                        // Trigger global cleanup through MemoryManager
-                        MEMORY_FORCE_GC();
-                    }
-                    xSemaphoreGive(bufferMutex);
-                }
-            }
-        }
-        
-        // Flush buffer to file
+        // Wake on the interval, or early when producers fill half of the ring
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FILE_WRITE_INTERVAL_MS));
+
         if (fileEnabled) {
-            size_t freeHeap = ESP.getFreeHeap();
-            size_t bufferSize = 0;
-            
-            if (bufferMutex != nullptr && xSemaphoreTake(bufferMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                bufferSize = logBuffer.size();
-                xSemaphoreGive(bufferMutex);
-            }
-            
-            // Log memory status every 10 cycles (every 2.5 minutes)
+            // Log ring status every 10 cycles
             if (cycleCount % 10 == 0) {
-                Serial.printf("[LOGGER] Memory: %d bytes free, Buffer: %d entries, Emergency clears: %d\n", 
-                             freeHeap, bufferSize, emergencyClears);
-            }
-            
-            // Only flush if we have sufficient memory
-            if (freeHeap >= 12288) {
-                flushBufferToFile();
-            } else {
-                Serial.printf("[LOGGER] Skipping flush due to low memory: %d bytes\n", freeHeap);
+                Serial.printf("[LOGGER] Ring: %u/%u bytes used\n", (unsigned)logRing.getUsed(),
+                              (unsigned)logRing.getCapacity());
             }
-            
+
+            flushBufferToFile();
             cycleCount++;
         }
     }
-} 
\ No newline at end of file
+}
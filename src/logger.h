@@ -8,8 +8,15 @@
 #include <freertos/task.h>
 #include <freertos/queue.h>
 #include <string>
+#include <cstdarg>
 #include <ctime>
-#include <vector>
+#include "log_ring.h"
+
+// Compile-time minimum level (0=DEBUG, 1=INFO, 2=WARNING, 3=ERROR), set from platformio.ini.
+// LOG_* macros below this level generate no code.
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
 
 enum class LogLevel {
     DEBUG = 0,
@@ -18,16 +25,6 @@ enum class LogLevel {
     ERROR = 3
 };
 
-struct LogEntry {
-    LogLevel level;
-    String message;
-    unsigned long timestamp;
-    
-    LogEntry() : level(LogLevel::INFO), timestamp(0) {}
-    LogEntry(LogLevel l, const String& msg, unsigned long ts) 
-        : level(l), message(msg), timestamp(ts) {}
-};
-
 class Logger {
 public:
     static Logger& getInstance();
@@ -47,75 +44,110 @@ public:
     // Basic logging methods
     void log(LogLevel level, const char* message);
     void log(LogLevel level, const String& message);
-    void logf(LogLevel level, const char* format, ...);
+    void logf(LogLevel level, const char* format, ...) __attribute__((format(printf, 3, 4)));
+    void vlogf(LogLevel level, const char* format, va_list args);
     
     // Convenience methods for different log levels
     void debug(const char* message);
     void debug(const String& message);
-    void debugf(const char* format, ...);
+    void debugf(const char* format, ...) __attribute__((format(printf, 2, 3)));
     
     void info(const char* message);
     void info(const String& message);
-    void infof(const char* format, ...);
+    void infof(const char* format, ...) __attribute__((format(printf, 2, 3)));
     
     void warning(const char* message);
     void warning(const String& message);
-    void warningf(const char* format, ...);
+    void warningf(const char* format, ...) __attribute__((format(printf, 2, 3)));
     
     void error(const char* message);
     void error(const String& message);
-    void errorf(const char* format, ...);
+    void errorf(const char* format, ...) __attribute__((format(printf, 2, 3)));
     
     // Print methods for easy Serial replacement
     void print(const char* message);
     void print(const String& message);
     void println(const char* message);
     void println(const String& message);
-    void printf(const char* format, ...);
+    void printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
     
     // Public method for external task creation
     void runFileWriterTask();
 
+    // Format "[TIMESTAMP] [LEVEL] MESSAGE\n" into out without allocating; returns the line length.
+    // A zero timestamp means "now" (wall clock once time is synced, millis() before).
+    static size_t formatLogMessage(char* out, size_t size, LogLevel level, const char* message, size_t length,
+                                   unsigned long timestamp = 0);
+
+    // Stack buffers used per log call
+    static const size_t LOG_MESSAGE_BUFFER_SIZE = 256;
+    static const size_t LOG_LINE_BUFFER_SIZE = LOG_MESSAGE_BUFFER_SIZE + 32;
+
 private:
     Logger() = default;
     ~Logger() = default;
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
     
-    void writeLog(LogLevel level, const String& message);
-    void addToBuffer(LogLevel level, const String& message);
+    void writeLog(LogLevel level, const char* message, size_t length);
+    void addToBuffer(LogLevel level, const char* message, size_t length);
     void flushBufferToFile();
-    String formatLogMessage(LogLevel level, const String& message, unsigned long timestamp = 0);
-    String getLevelString(LogLevel level);
-    String getCurrentTimestamp();
+    bool writeStaging(File& file, size_t& used);
+    static const char* getLevelString(LogLevel level);
+    static void formatTimestamp(char* out, size_t size);
     static void fileWriterTask(void* parameter);
     
     SemaphoreHandle_t logMutex = nullptr;
-    SemaphoreHandle_t bufferMutex = nullptr;
     LogLevel currentLogLevel = LogLevel::DEBUG;
     bool serialEnabled = true;
     bool fileEnabled = false;
     String logFilePath = "/log.txt";
     
-    // Buffered file logging
-    std::vector<LogEntry> logBuffer;
+    // Buffered file logging: producers push into the ring, the writer task drains it
+    LogRing logRing;
+    char* stagingBuffer = nullptr;
     TaskHandle_t fileWriterTaskHandle = nullptr;
-    static const size_t MAX_BUFFER_SIZE = 50;  // Reduced from 100 to 50 to save memory
+    static const size_t RING_CAPACITY = 16384;          // PSRAM
+    static const size_t RING_FALLBACK_CAPACITY = 4096;  // Internal RAM if PSRAM is unavailable
+    static const size_t STAGING_BUFFER_SIZE = 2048;     // Bytes per File.write()
     static const uint32_t FILE_WRITE_INTERVAL_MS = 15000; // 15 seconds
 };
 
 // Global logger instance accessor
 #define LOG Logger::getInstance()
 
-// Convenient macros for logging
+// Convenient macros for logging, compiled out below LOG_MIN_LEVEL.
+// Disabled calls stay type-checked but are dead code: arguments are never evaluated.
+#define LOG_DISCARD(call) \
+    do {                  \
+        if (false) {      \
+            call;         \
+        }                 \
+    } while (0)
+
+#if LOG_MIN_LEVEL <= 0
 #define LOG_DEBUG(msg) LOG.debug(msg)
 #define LOG_DEBUGF(fmt, ...) LOG.debugf(fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(msg) LOG_DISCARD(LOG.debug(msg))
+#define LOG_DEBUGF(fmt, ...) LOG_DISCARD(LOG.debugf(fmt, ##__VA_ARGS__))
+#endif
 
+#if LOG_MIN_LEVEL <= 1
 #define LOG_INFO(msg) LOG.info(msg)
 #define LOG_INFOF(fmt, ...) LOG.infof(fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(msg) LOG_DISCARD(LOG.info(msg))
+#define LOG_INFOF(fmt, ...) LOG_DISCARD(LOG.infof(fmt, ##__VA_ARGS__))
+#endif
 
+#if LOG_MIN_LEVEL <= 2
 #define LOG_WARNING(msg) LOG.warning(msg)
 #define LOG_WARNINGF(fmt, ...) LOG.warningf(fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARNING(msg) LOG_DISCARD(LOG.warning(msg))
+#define LOG_WARNINGF(fmt, ...) LOG_DISCARD(LOG.warningf(fmt, ##__VA_ARGS__))
+#endif
 
 #define LOG_ERROR(msg) LOG.error(msg)
 #define LOG_ERRORF(fmt, ...) LOG.errorf(fmt, ##__VA_ARGS__)
@@ -1,54 +1,36 @@
 
 #include <Arduino.h>
-#include <EEPROM.h>
 #include <SPI.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <sys/time.h>
 #include <time.h>
+#include "boot_sequencer.h"
 #include "button.h"
 #include "buzzer.h"
+#include "cache_service.h"
 #include "config.h"
 #include "config_manager.h"
+#include "diagnostics.h"
 #include "display.h"
+#include "event_manager.h"
+#include "http_service.h"
 #include "logger.h"
 #include "memory_manager.h"
+#include "metrics.h"
+#include "pins.h"
+#include "power_manager.h"
 #include "modules/module.h"
 #include "modules/module_manager.h"
+#include "telemetry.h"
+#include "time_service.h"
 #include "timezone_utils.h"
 #include "wifi_manager.h"
 
-// Include modules to trigger auto-registration
-#include "modules/accuweather.h"
-#include "modules/clock.h"
-#include "modules/overlay.h"
-
-// Function to register all modules explicitly
-void registerModules() {
-    LOG_INFO("Registering modules explicitly...");
-    
-    // Register Clock module
-    modules::ModuleRegistry::RegisterModule("Clock", "clock", 2, 4096, 
-                                           []() -> modules::IModule* { return new modules::Clock(); });
-    
-    // Register AccuWeather module  
-    modules::ModuleRegistry::RegisterModule("AccuWeather", "accuweather", 5, 12 * 1024, 
-                                           []() -> modules::IModule* { return new modules::AccuWeather(); });
-    
-    // Register Overlay module
-    modules::ModuleRegistry::RegisterModule("Overlay", "overlay", 3, 4096, 
-                                           []() -> modules::IModule* { return new modules::Overlay(); });
-    
-    LOG_INFO("All modules registered explicitly");
-}
-
 // External config instance
 extern Config config;
 SemaphoreHandle_t spiMutex;
 
-#define BUZZER_TASK_PRIORITY 5
-#define BUZZER_TASK_STACK_SIZE 4096
-
 #define BUTTON_TASK_PRIORITY 5
 #define BUTTON_TASK_STACK_SIZE 4096
 
@@ -64,13 +46,20 @@ SemaphoreHandle_t spiMutex;
 #define SYSTEM_TASK_PRIORITY 2
 #define SYSTEM_TASK_STACK_SIZE 4096
 
+#define MODULE_RUNTIME_TASK_PRIORITY 3
+#define MODULE_RUNTIME_TASK_STACK_SIZE 4096
+
 #define TIME_SYNC_TASK_PRIORITY 3
 #define TIME_SYNC_TASK_STACK_SIZE 6144
 
 #define LOGGER_TASK_PRIORITY 2
 #define LOGGER_TASK_STACK_SIZE 4096
 
-TaskHandle_t buzzerTaskHandle = NULL;
+#define BOOT_POWER_SETTLE_MS 100
+
+#define EVENT_DISPATCH_TASK_PRIORITY 4
+#define EVENT_DISPATCH_TASK_STACK_SIZE 4096
+
 TaskHandle_t buttonTaskHandle = NULL;
 TaskHandle_t displayTaskHandle = NULL;
 TaskHandle_t wifiTaskHandle = NULL;
@@ -79,8 +68,13 @@ TaskHandle_t systemTaskHandle = NULL;
 TaskHandle_t timeSyncTaskHandle = NULL;
 TaskHandle_t loggerTaskHandle = NULL;
 
+// Applies [tasks] overrides from the INI file, defined with the task table below
+void applyTaskOverrides();
+
+// Set by setup() when the config was restored from the NVS snapshot before the tasks started
+static bool snapshotLoaded = false;
+
 // Task wrapper functions
-void buzzerTaskWrapper(void* parameter) { Buzzer::Run(); }
 
 void buttonTaskWrapper(void* parameter) { Button::Run(); }
 
@@ -90,39 +84,73 @@ void wifiTaskWrapper(void* parameter) { WiFiManager::Run(); }
 
 void loggerTaskWrapper(void* parameter) { Logger::getInstance().runFileWriterTask(); }
 
+// Steps shared by both config sources once the values are in place
+void finishConfig(ConfigManager* configManager) {
+    // Print current configuration
+    configManager->printConfig();
+
+    // Validate configuration
+    if (configManager->validateConfig()) {
+        LOG_INFO("Configuration is valid");
+    } else {
+        LOG_WARNING("Configuration validation failed - some settings may be incorrect");
+    }
+
+    applyTaskOverrides();
+    PowerManager::Configure(config.power);
+    Diagnostics::Start();
+    Metrics::Start(config.metrics);
+
+    // Dependents start only now that every section has been parsed
+    BootSequencer::complete(BootSequencer::Stage::CONFIG);
+}
+
 void configTaskWrapper(void* parameter) {
+    BootSequencer::begin(BootSequencer::Stage::CONFIG);
     LOG_INFO("Initializing configuration...");
 
     // Get ConfigManager instance
     ConfigManager* configManager = ConfigManager::getInstance();
 
-    // Initialize SD card and load configuration
-    if (configManager->loadConfig("hoowachy_config.ini")) {
+    // Booted from the NVS snapshot loaded in setup(); check it against the SD card afterwards
+    if (snapshotLoaded) {
+        finishConfig(configManager);
+
+        ConfigManager::ReloadResult check = configManager->reload("hoowachy_config.ini");
+        if (check == ConfigManager::ReloadResult::RESTART_REQUIRED) {
+            // A section read only at boot changed; restart so everything boots from the new values
+            LOG_WARNING("Configuration changed on SD card, restarting to apply it");
+            vTaskDelay(pdMS_TO_TICKS(500));
+            ESP.restart();
+        } else if (check == ConfigManager::ReloadResult::UNAVAILABLE) {
+            LOG_WARNING("SD configuration unavailable, running from the snapshot");
+        }
+    } else if (configManager->loadConfig("hoowachy_config.ini")) {
+        // Initialize SD card and load configuration
         LOG_INFO("Configuration loaded successfully");
+        configManager->saveSnapshot();
+        finishConfig(configManager);
+    } else {
+        LOG_ERROR("Failed to load configuration, stages depending on it stay blocked");
+    }
 
-        // Print current configuration
-        configManager->printConfig();
-
-        // Validate configuration
-        if (configManager->validateConfig()) {
-            LOG_INFO("Configuration is valid");
-        } else {
-            LOG_WARNING("Configuration validation failed - some settings may be incorrect");
-        }
-        
-        // Reinitialize logger with config settings
+    // File logging needs the SD card, which the snapshot path mounts only after the config is applied
+    if (BootSequencer::isComplete(BootSequencer::Stage::CONFIG)) {
         LOG_INFO("Reinitializing logger with config settings...");
         Logger::getInstance().initFromConfig();
         LOG_INFO("Logger reinitialized from configuration");
-        
-    } else {
-        LOG_ERROR("Failed to load configuration");
+
+        // Edits on the SD card are applied from here on, without a restart where possible
+        configManager->watch("hoowachy_config.ini");
     }
 
     // Delete this task as it's no longer needed
     vTaskDelete(NULL);
 }
 
+// How long the completed terminal stays on screen before the first dashboard frame
+#define DASHBOARD_HOLD_MS 1000
+
 void systemTaskWrapper(void* parameter) {
     Display::SetState(Display::State::TERMINAL);
 
@@ -135,17 +163,30 @@ void systemTaskWrapper(void* parameter) {
             }
         }
 
-        if (allModulesReady && WiFiManager::IsConnected()) {
-            vTaskDelay(pdMS_TO_TICKS(3000));
+        if (Diagnostics::IsShowingResults()) {
+            // Benchmark results hold the terminal until they time out
+        } else if (allModulesReady && WiFiManager::IsConnected() &&
+                   BootSequencer::isComplete(BootSequencer::Stage::MODULES)) {
+            // Leave the finished boot log readable for a moment the first time only
+            if (!BootSequencer::isComplete(BootSequencer::Stage::DASHBOARD)) {
+                vTaskDelay(pdMS_TO_TICKS(DASHBOARD_HOLD_MS));
+            }
             Display::SetState(Display::State::DASHBOARD);
+            BootSequencer::complete(BootSequencer::Stage::DASHBOARD);
         } else {
             Display::SetState(Display::State::TERMINAL);
         }
 
+        // Per-task CPU and stack usage, consumed by the overlay
+        Telemetry::getInstance()->sample();
+        MemoryManager::getInstance()->publishMetrics();
+        WiFiManager::PublishMetrics();
+
         // Memory monitoring - log status every 2 minutes instead of every 60 seconds
         static unsigned long lastMemoryCheck = 0;
         if (millis() - lastMemoryCheck > 120000) { // Every 2 minutes
             MEMORY_LOG("System Monitor");
+            Telemetry::getInstance()->logReport();
             lastMemoryCheck = millis();
         }
 
@@ -153,30 +194,79 @@ void systemTaskWrapper(void* parameter) {
     }
 }
 
-void timeSyncTaskWrapper(void* parameter) {
-    LOG_INFO("Time sync task started");
-    
-    // Wait for configuration to be ready
-    while (!config.isReady()) {
-        LOG_INFO("Waiting for config to be ready for time sync...");
-        vTaskDelay(pdMS_TO_TICKS(1000));
+void timeSyncTaskWrapper(void* parameter) { TimeService::Run(); }
+
+// System tasks, created in this order. The config key prefixes the [tasks] overrides
+// (<key>_priority, <key>_core); the config task has none since it exits after loading.
+// Cores come from the NVS snapshot, the only config readable before the tasks exist.
+struct SystemTask {
+    const char* name;
+    const char* configKey;
+    TaskFunction_t function;
+    uint32_t stackSize;
+    UBaseType_t priority;
+    BaseType_t core;
+    TaskHandle_t* handle;
+};
+
+SystemTask systemTasks[] = {
+    {"ButtonTask", "button", buttonTaskWrapper, BUTTON_TASK_STACK_SIZE, BUTTON_TASK_PRIORITY, tskNO_AFFINITY,
+     &buttonTaskHandle},
+    {"DisplayTask", "display", displayTaskWrapper, DISPLAY_TASK_STACK_SIZE, DISPLAY_TASK_PRIORITY, RENDER_CORE,
+     &displayTaskHandle},
+    {"WifiTask", "wifi", wifiTaskWrapper, WIFI_TASK_STACK_SIZE, WIFI_TASK_PRIORITY, NETWORK_CORE, &wifiTaskHandle},
+    {"ConfigTask", nullptr, configTaskWrapper, CONFIG_TASK_STACK_SIZE, CONFIG_TASK_PRIORITY, tskNO_AFFINITY,
+     &configTaskHandle},
+    {"TimeSyncTask", "time_sync", timeSyncTaskWrapper, TIME_SYNC_TASK_STACK_SIZE, TIME_SYNC_TASK_PRIORITY,
+     NETWORK_CORE, &timeSyncTaskHandle},
+    {"SystemTask", "system", systemTaskWrapper, SYSTEM_TASK_STACK_SIZE, SYSTEM_TASK_PRIORITY, tskNO_AFFINITY,
+     &systemTaskHandle},
+    {"LoggerTask", "logger", loggerTaskWrapper, LOGGER_TASK_STACK_SIZE, LOGGER_TASK_PRIORITY, tskNO_AFFINITY,
+     &loggerTaskHandle},
+};
+
+void applyTaskCores() {
+    modules::ConfigSection section = ConfigManager::getInstance()->getConfigSection("tasks");
+
+    for (SystemTask& task : systemTasks) {
+        if (task.configKey == nullptr) {
+            continue;
+        }
+        BaseType_t core = section.getCoreValue(String(task.configKey) + "_core", task.core);
+        if (core != task.core) {
+            task.core = core;
+            LOG_INFOF("Tasks: %s pinned to core %s\n", task.name, core == tskNO_AFFINITY ? "any" : String(core).c_str());
+        }
     }
-    
-    while (true) {
-        while (!WiFiManager::IsConnected()) {
-            vTaskDelay(pdMS_TO_TICKS(1000));
+}
+
+void applyTaskOverrides() {
+    modules::ConfigSection section = ConfigManager::getInstance()->getConfigSection("tasks");
+
+    for (SystemTask& task : systemTasks) {
+        if (task.configKey == nullptr || *task.handle == NULL) {
+            continue;
         }
+        String key = task.configKey;
 
-        configTime(0, 0, config.system.ntpServer.c_str());
-        LOG_INFO("Time synchronized successfully");
+        int priority = section.getIntValue(key + "_priority", 0);
+        if (priority > 0 && priority < configMAX_PRIORITIES && (UBaseType_t)priority != task.priority) {
+            vTaskPrioritySet(*task.handle, priority);
+            task.priority = priority;
+            LOG_INFOF("Tasks: %s priority set to %d\n", task.name, priority);
+        }
 
-        // Wait a bit for sync to complete
-        vTaskDelay(pdMS_TO_TICKS(60 * 1000));
+        // Tasks cannot migrate once created; a core that differs from the snapshot's applies after a restart
+        BaseType_t core = section.getCoreValue(key + "_core", task.core);
+        if (core != task.core) {
+            LOG_WARNINGF("Tasks: %s_core takes effect after a restart\n", task.configKey);
+        }
     }
 }
 
 void setup() {
     Serial.begin(115200);
+    BootSequencer::initialize();
     
     // Initialize global memory coordination early
     MemoryManager::initialize();
@@ -186,15 +276,22 @@ void setup() {
     // Initialize logger with default settings (config will be loaded later)
     Logger::getInstance().init(true, false, "/hoowachy_boot.log");
     Logger::getInstance().setLogLevel(LogLevel::DEBUG);
+
+    // Right time on the dashboard after a reset, before WiFi and SNTP
+    TimeService::restore();
     
     LOG_INFO("Hoowachy system starting up...");
     LOG_INFOF("Initial free heap: %d bytes\n", ESP.getFreeHeap());
+
+    HttpService::initialize();
+    Telemetry::initialize();
+    CacheService::initialize();
+
+    // Start before any Setup() so queued subscribers never see events from a half-built system
+    EventManager::StartDispatcher(EVENT_DISPATCH_TASK_PRIORITY, EVENT_DISPATCH_TASK_STACK_SIZE);
     
-    if (!EEPROM.begin(EEPROM_SIZE)) {
-        LOG_ERROR("Failed to initialize EEPROM");
-        return;
-    }
-    delay(3000);
+    // Panel and SD card power-up; both need well under this before their first command
+    delay(BOOT_POWER_SETTLE_MS);
 
     spiMutex = xSemaphoreCreateMutex();
 
@@ -213,47 +310,24 @@ void setup() {
     WiFiManager::Setup();
     LOG_INFO("Setup done");
 
-    delay(1000);
+    // NVS is ready already; the config task checks the snapshot against the SD card later
+    snapshotLoaded = ConfigManager::getInstance()->loadSnapshot();
+    if (snapshotLoaded) {
+        applyTaskCores();
+    }
 
     LOG_INFO("Creating tasks...");
 
-    BaseType_t result = xTaskCreate(buzzerTaskWrapper, "BuzzerTask", BUZZER_TASK_STACK_SIZE, NULL, BUZZER_TASK_PRIORITY,
-                                    &buzzerTaskHandle);
-    LOG_INFOF("BuzzerTask created: %s", result == pdPASS ? "SUCCESS" : "FAILED");
-
-    result = xTaskCreate(buttonTaskWrapper, "ButtonTask", BUTTON_TASK_STACK_SIZE, NULL, BUTTON_TASK_PRIORITY,
-                         &buttonTaskHandle);
-    LOG_INFOF("ButtonTask created: %s", result == pdPASS ? "SUCCESS" : "FAILED");
-
-    result = xTaskCreate(displayTaskWrapper, "DisplayTask", DISPLAY_TASK_STACK_SIZE, NULL, DISPLAY_TASK_PRIORITY,
-                         &displayTaskHandle);
-    LOG_INFOF("DisplayTask created: %s", result == pdPASS ? "SUCCESS" : "FAILED");
-
-    result = xTaskCreate(wifiTaskWrapper, "WifiTask", WIFI_TASK_STACK_SIZE, NULL, WIFI_TASK_PRIORITY, &wifiTaskHandle);
-    LOG_INFOF("WifiTask created: %s", result == pdPASS ? "SUCCESS" : "FAILED");
-
-    result = xTaskCreate(configTaskWrapper, "ConfigTask", CONFIG_TASK_STACK_SIZE, NULL, CONFIG_TASK_PRIORITY,
-                         &configTaskHandle);
-    LOG_INFOF("ConfigTask created: %s", result == pdPASS ? "SUCCESS" : "FAILED");
-
-    // Register modules explicitly
-    registerModules();
+    for (const SystemTask& task : systemTasks) {
+        BaseType_t result = xTaskCreatePinnedToCore(task.function, task.name, task.stackSize, NULL, task.priority,
+                                                    task.handle, task.core);
+        LOG_INFOF("%s created: %s", task.name, result == pdPASS ? "SUCCESS" : "FAILED");
+    }
 
     // Start all registered modules
-    modules::ModuleManager::StartAllModules();
-
-    result = xTaskCreate(timeSyncTaskWrapper, "TimeSyncTask", TIME_SYNC_TASK_STACK_SIZE, NULL, TIME_SYNC_TASK_PRIORITY,
-                         &timeSyncTaskHandle);
-    LOG_INFOF("TimeSyncTask created: %s", result == pdPASS ? "SUCCESS" : "FAILED");
-
-    result = xTaskCreate(systemTaskWrapper, "SystemTask", SYSTEM_TASK_STACK_SIZE, NULL, SYSTEM_TASK_PRIORITY,
-                         &systemTaskHandle);
-    LOG_INFOF("SystemTask created: %s", result == pdPASS ? "SUCCESS" : "FAILED");
-
-    result = xTaskCreate(loggerTaskWrapper, "LoggerTask", LOGGER_TASK_STACK_SIZE, NULL, LOGGER_TASK_PRIORITY,
-                         &loggerTaskHandle);
-    LOG_INFOF("LoggerTask created: %s", result == pdPASS ? "SUCCESS" : "FAILED");
+    modules::ModuleManager::StartAllModules(MODULE_RUNTIME_TASK_PRIORITY, MODULE_RUNTIME_TASK_STACK_SIZE);
     
+    BootSequencer::complete(BootSequencer::Stage::SETUP);
     MEMORY_LOG("Setup Complete");
     LOG_INFOF("Setup completed, free heap: %d bytes\n", ESP.getFreeHeap());
 }
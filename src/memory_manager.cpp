@@ -1,10 +1,22 @@
 #include "memory_manager.h"
 #include "logger.h"
+#include "metrics.h"
+#include <esp_heap_caps.h>
+#include <algorithm>
 #include <cstring>
 
 // Static instance
 MemoryManager* MemoryManager::instance = nullptr;
 
+namespace {
+Metrics::Id freeHeapMetric = Metrics::NO_METRIC;
+Metrics::Id minimumFreeHeapMetric = Metrics::NO_METRIC;
+Metrics::Id largestBlockMetric = Metrics::NO_METRIC;
+Metrics::Id psramFreeMetric = Metrics::NO_METRIC;
+Metrics::Id reservedMetric = Metrics::NO_METRIC;
+Metrics::Id rejectedMetric = Metrics::NO_METRIC;
+}  // namespace
+
 MemoryManager::MemoryManager() {
     memoryMutex = xSemaphoreCreateMutex();
     if (memoryMutex == nullptr) {
@@ -16,8 +28,24 @@ MemoryManager::MemoryManager() {
     // Initialize all operation slots to empty
     memset(activeOperations, 0, sizeof(activeOperations));
     memset(cleanupCallbacks, 0, sizeof(cleanupCallbacks));
+    memset(waiters, 0, sizeof(waiters));
+    memset(arenas, 0, sizeof(arenas));
+    memset(arenaUnavailable, 0, sizeof(arenaUnavailable));
+    for (int i = 0; i < MAX_WAITERS; i++) {
+        waiters[i].signal = xSemaphoreCreateBinary();
+    }
     
     updateMinimumFreeHeap();
+
+    freeHeapMetric = Metrics::Register(Metrics::Type::GAUGE, "heap_free_bytes", "Free internal heap");
+    minimumFreeHeapMetric =
+        Metrics::Register(Metrics::Type::GAUGE, "heap_min_free_bytes", "Lowest free internal heap since boot");
+    largestBlockMetric =
+        Metrics::Register(Metrics::Type::GAUGE, "heap_largest_block_bytes", "Largest free internal heap block");
+    psramFreeMetric = Metrics::Register(Metrics::Type::GAUGE, "psram_free_bytes", "Free PSRAM");
+    reservedMetric = Metrics::Register(Metrics::Type::GAUGE, "memory_reserved_bytes", "Bytes held by reservations");
+    rejectedMetric = Metrics::Register(Metrics::Type::COUNTER, "memory_rejected_total",
+                                       "Reservations refused after waiting or with a full queue");
     LOG_INFO("MemoryManager initialized");
 }
 
@@ -46,109 +74,36 @@ void MemoryManager::setDefaultThresholds(size_t lowThreshold, size_t criticalThr
 }
 
 bool MemoryManager::requestMemory(Operation operation, Priority priority, size_t estimatedBytes, const char* moduleName) {
-    LOG_INFOF("🔍 DEBUG: %s requesting %zu bytes, heap: %zu\n", moduleName, estimatedBytes, getFreeHeap());
-    
     if (memoryMutex == nullptr || moduleName == nullptr) {
-        LOG_INFOF("❌ DEBUG: Invalid parameters for %s\n", moduleName);
+        LOG_DEBUGF("MemoryManager: Invalid request parameters for %s\n", moduleName ? moduleName : "(null)");
         return false;
     }
 
     // Take mutex with timeout
     if (xSemaphoreTake(memoryMutex, pdMS_TO_TICKS(5000)) != pdTRUE) {
-        LOG_INFOF("❌ DEBUG: Failed to acquire mutex for %s\n", moduleName);
+        LOG_DEBUGF("MemoryManager: Failed to acquire mutex for %s\n", moduleName);
         return false;
     }
 
-    LOG_INFOF("✅ DEBUG: %s got mutex, checking slots...\n", moduleName);
     LOG_INFOF("MemoryManager: %s requesting %zu bytes for operation %d, priority %d\n", 
               moduleName, estimatedBytes, (int)operation, (int)priority);
 
-    bool success = false;
-    
-    // Check if we have a slot available
-    LOG_INFOF("🔍 DEBUG: %s checking slots: %d/%d active\n", moduleName, activeOperationCount, MAX_ACTIVE_OPERATIONS);
-    if (!hasAvailableSlot()) {
-        LOG_INFOF("❌ DEBUG: No available slots for %s (%d/%d used)\n", moduleName, activeOperationCount, MAX_ACTIVE_OPERATIONS);
-        xSemaphoreGive(memoryMutex);
-        return false;
-    }
-    LOG_INFOF("✅ DEBUG: %s has available slot, checking memory...\n", moduleName);
-
-    // Check if we can allocate the memory
-    if (!canAllocate(estimatedBytes, priority)) {
-        size_t freeHeap = getFreeHeap();
-        size_t requiredFree = 0;
-        switch (priority) {
-            case Priority::CRITICAL: requiredFree = criticalMemoryThreshold / 2; break;
-            case Priority::IMPORTANT: requiredFree = criticalMemoryThreshold; break;
-            case Priority::NORMAL: requiredFree = lowMemoryThreshold; break;
-            case Priority::BACKGROUND: requiredFree = lowMemoryThreshold + 10000; break;
-        }
-        size_t totalNeeded = estimatedBytes + requiredFree;
-        
-        LOG_INFOF("MemoryManager: Cannot allocate %zu bytes for %s (priority %d)\n", 
-                  estimatedBytes, moduleName, (int)priority);
-        LOG_INFOF("  Free heap: %zu, Required reserve: %zu, Total needed: %zu\n", 
-                  freeHeap, requiredFree, totalNeeded);
-        
-        // Release mutex temporarily for cleanup
+    // Fast path: fits now and nobody of equal or higher priority is already queued
+    if (hasAvailableSlot() && !hasWaiterAhead(priority) && canAllocate(estimatedBytes, priority)) {
+        bool success = addOperation(operation, priority, estimatedBytes, moduleName);
         xSemaphoreGive(memoryMutex);
-        
-        // Perform cleanup
-        performGlobalCleanup();
-        
-        // Wait for memory to become available
-        waitForMemory(estimatedBytes, priority);
-        
-        // Re-acquire mutex
-        if (xSemaphoreTake(memoryMutex, pdMS_TO_TICKS(5000)) != pdTRUE) {
-            LOG_INFOF("MemoryManager: Failed to re-acquire mutex for %s\n", moduleName);
-            return false;
-        }
-        
-        // Check again after cleanup
-        if (!canAllocate(estimatedBytes, priority)) {
-            LOG_INFOF("MemoryManager: Still cannot allocate memory for %s after cleanup\n", moduleName);
-            xSemaphoreGive(memoryMutex);
-            return false;
-        }
+        return success;
     }
 
-    // Find available slot and register operation
-    LOG_INFOF("🔍 DEBUG: Searching for empty slot for %s\n", moduleName);
-    for (int i = 0; i < MAX_ACTIVE_OPERATIONS; i++) {
-        LOG_INFOF("🔍 DEBUG: Slot %d: moduleName[0]=%d ('%c'), moduleName='%s'\n", 
-                  i, (int)activeOperations[i].moduleName[0], 
-                  activeOperations[i].moduleName[0] == '\0' ? '0' : activeOperations[i].moduleName[0],
-                  activeOperations[i].moduleName);
-        if (activeOperations[i].moduleName[0] == '\0') {
-            LOG_INFOF("✅ DEBUG: Found empty slot %d for %s\n", i, moduleName);
-            activeOperations[i].operation = operation;
-            activeOperations[i].priority = priority;
-            activeOperations[i].estimatedBytes = estimatedBytes;
-            activeOperations[i].startTime = millis();
-            strncpy(activeOperations[i].moduleName, moduleName, sizeof(activeOperations[i].moduleName) - 1);
-            activeOperations[i].moduleName[sizeof(activeOperations[i].moduleName) - 1] = '\0';
-            activeOperationCount++;
-            success = true;
-            break;
-        }
-    }
-    
-    if (!success) {
-        LOG_INFOF("❌ DEBUG: No empty slot found for %s despite hasAvailableSlot()=true, activeCount=%d\n", 
-                  moduleName, activeOperationCount);
-    }
-
-    updateMinimumFreeHeap();
-    
-    if (success) {
-        LOG_INFOF("MemoryManager: ✅ GRANTED %zu bytes for %s (priority %d), active ops: %d/%d, free heap: %zu\n", 
-                  estimatedBytes, moduleName, (int)priority, activeOperationCount, MAX_ACTIVE_OPERATIONS, getFreeHeap());
-    }
+    LOG_INFOF("MemoryManager: Cannot allocate %zu bytes for %s (priority %d)\n", 
+              estimatedBytes, moduleName, (int)priority);
+    LOG_INFOF("  Free heap: %zu, Largest block: %zu, Reserved: %zu, Required reserve: %zu\n", getFreeHeap(),
+              getLargestFreeBlock(), reservedBytes, getRequiredReserve(priority));
 
+    // Release mutex for cleanup, then queue up until a release makes room
     xSemaphoreGive(memoryMutex);
-    return success;
+    performGlobalCleanup();
+    return waitForMemory(operation, priority, estimatedBytes, moduleName);
 }
 
 void MemoryManager::releaseMemory(Operation operation, const char* moduleName) {
@@ -172,9 +127,8 @@ void MemoryManager::releaseMemory(Operation operation, const char* moduleName) {
         LOG_INFOF("MemoryManager: Operation not found for release: %s\n", moduleName);
     }
 
-    // Force garbage collection after release
-    forceGarbageCollection();
     updateMinimumFreeHeap();
+    wakeFirstWaiter();
 
     xSemaphoreGive(memoryMutex);
 }
@@ -190,40 +144,10 @@ bool MemoryManager::requestMemoryQuiet(Operation operation, Priority priority, s
         return false;
     }
 
+    // Don't wait or cleanup for frequent operations
     bool success = false;
-    
-    // Check if we have a slot available
-    if (!hasAvailableSlot()) {
-        xSemaphoreGive(memoryMutex);
-        return false;
-    }
-
-    // Check if we can allocate the memory
-    if (!canAllocate(estimatedBytes, priority)) {
-        xSemaphoreGive(memoryMutex);
-        return false; // Don't wait or cleanup for frequent operations
-    }
-
-    // Find available slot and register operation
-    for (int i = 0; i < MAX_ACTIVE_OPERATIONS; i++) {
-        if (activeOperations[i].moduleName[0] == '\0') {
-            activeOperations[i].operation = operation;
-            activeOperations[i].priority = priority;
-            activeOperations[i].estimatedBytes = estimatedBytes;
-            activeOperations[i].startTime = millis();
-            strncpy(activeOperations[i].moduleName, moduleName, sizeof(activeOperations[i].moduleName) - 1);
-            activeOperations[i].moduleName[sizeof(activeOperations[i].moduleName) - 1] = '\0';
-            activeOperationCount++;
-            success = true;
-            break;
-        }
-    }
-
-    updateMinimumFreeHeap();
-    
-    // No verbose logging for quiet operations - only log if failed
-    if (!success) {
-        LOG_INFOF("MemoryManager: Failed quiet request for %s\n", moduleName);
+    if (hasAvailableSlot() && !hasWaiterAhead(priority) && canAllocate(estimatedBytes, priority)) {
+        success = addOperation(operation, priority, estimatedBytes, moduleName, false);
     }
 
     xSemaphoreGive(memoryMutex);
@@ -246,9 +170,8 @@ void MemoryManager::releaseMemoryQuiet(Operation operation, const char* moduleNa
         // No logging for quiet release
     }
 
-    // Force garbage collection after release (but don't log)
-    forceGarbageCollection();
     updateMinimumFreeHeap();
+    wakeFirstWaiter();
 
     xSemaphoreGive(memoryMutex);
 }
@@ -257,7 +180,14 @@ size_t MemoryManager::getFreeHeap() {
     return ESP.getFreeHeap();
 }
 
+size_t MemoryManager::getLargestFreeBlock() {
+    // Same internal heap ESP.getFreeHeap() reports on; PSRAM is not counted
+    return heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
 size_t MemoryManager::getMinimumFreeHeap() {
+    // Include the current level, so a reading taken right after some work reflects it
+    updateMinimumFreeHeap();
     return minimumFreeHeap;
 }
 
@@ -309,6 +239,15 @@ void MemoryManager::registerCleanupCallback(const char* moduleName, void (*callb
     }
 
     if (xSemaphoreTake(memoryMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        // A module started again after a stop registers once more; keep a single entry per name
+        for (int i = 0; i < cleanupCallbackCount; i++) {
+            if (strcmp(cleanupCallbacks[i].moduleName, moduleName) == 0) {
+                cleanupCallbacks[i].callback = callback;
+                xSemaphoreGive(memoryMutex);
+                return;
+            }
+        }
+
         strncpy(cleanupCallbacks[cleanupCallbackCount].moduleName, moduleName, 
                 sizeof(cleanupCallbacks[cleanupCallbackCount].moduleName) - 1);
         cleanupCallbacks[cleanupCallbackCount].moduleName[sizeof(cleanupCallbacks[cleanupCallbackCount].moduleName) - 1] = '\0';
@@ -335,9 +274,17 @@ void MemoryManager::logMemoryStatus(const char* context) {
     size_t freeHeap = getFreeHeap();
     size_t allocated = getAllocatedBytes();
     
-    LOG_INFOF("MemoryManager Status [%s]: Free: %zu, Min: %zu, Allocated: %zu, Active ops: %d\n", 
-              context ? context : "General", freeHeap, minimumFreeHeap, allocated, activeOperationCount);
+    LOG_INFOF("MemoryManager Status [%s]: Free: %zu, Largest: %zu, Min: %zu, Allocated: %zu, Active ops: %d\n", 
+              context ? context : "General", freeHeap, getLargestFreeBlock(), minimumFreeHeap, allocated,
+              activeOperationCount);
     
+    for (int i = 0; i < OPERATION_COUNT; i++) {
+        if (arenas[i] != nullptr) {
+            LOG_INFOF("  Arena op=%d: used=%zu, peak=%zu, capacity=%zu\n", i, arenas[i]->getUsed(),
+                      arenas[i]->getHighWater(), arenas[i]->getCapacity());
+        }
+    }
+
     if (activeOperationCount > 0) {
         LOG_INFO("Active operations:");
         if (xSemaphoreTake(memoryMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
@@ -357,17 +304,16 @@ void MemoryManager::logMemoryStatus(const char* context) {
     }
 }
 
+void MemoryManager::publishMetrics() {
+    Metrics::Set(freeHeapMetric, getFreeHeap());
+    Metrics::Set(minimumFreeHeapMetric, getMinimumFreeHeap());
+    Metrics::Set(largestBlockMetric, getLargestFreeBlock());
+    Metrics::Set(psramFreeMetric, heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    Metrics::Set(reservedMetric, reservedBytes);
+}
+
 size_t MemoryManager::getAllocatedBytes() {
-    size_t total = 0;
-    if (xSemaphoreTake(memoryMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        for (int i = 0; i < MAX_ACTIVE_OPERATIONS; i++) {
-            if (activeOperations[i].moduleName[0] != '\0') {
-                total += activeOperations[i].estimatedBytes;
-            }
-        }
-        xSemaphoreGive(memoryMutex);
-    }
-    return total;
+    return reservedBytes;
 }
 
 int MemoryManager::getActiveOperations() {
@@ -390,64 +336,240 @@ int MemoryManager::findOperationSlot(Operation operation, const char* moduleName
     return -1;
 }
 
+bool MemoryManager::addOperation(Operation operation, Priority priority, size_t estimatedBytes, const char* moduleName,
+                                 bool verbose) {
+    for (int i = 0; i < MAX_ACTIVE_OPERATIONS; i++) {
+        if (activeOperations[i].moduleName[0] == '\0') {
+            activeOperations[i].operation = operation;
+            activeOperations[i].priority = priority;
+            activeOperations[i].estimatedBytes = estimatedBytes;
+            activeOperations[i].startTime = millis();
+            strncpy(activeOperations[i].moduleName, moduleName, sizeof(activeOperations[i].moduleName) - 1);
+            activeOperations[i].moduleName[sizeof(activeOperations[i].moduleName) - 1] = '\0';
+            activeOperationCount++;
+            reservedBytes += estimatedBytes;
+            updateMinimumFreeHeap();
+
+            if (verbose) {
+                LOG_INFOF("MemoryManager: ✅ GRANTED %zu bytes for %s (priority %d), active ops: %d/%d, reserved: %zu, free heap: %zu\n",
+                          estimatedBytes, moduleName, (int)priority, activeOperationCount, MAX_ACTIVE_OPERATIONS,
+                          reservedBytes, getFreeHeap());
+            }
+            return true;
+        }
+    }
+
+    LOG_INFOF("MemoryManager: No free operation slot for %s\n", moduleName);
+    return false;
+}
+
 void MemoryManager::removeOperation(int slot) {
     if (slot >= 0 && slot < MAX_ACTIVE_OPERATIONS) {
+        Operation operation = activeOperations[slot].operation;
+        reservedBytes -= activeOperations[slot].estimatedBytes;
         memset(&activeOperations[slot], 0, sizeof(ActiveOperation));
         activeOperationCount--;
+
+        // Last holder gone: everything allocated from the operation's arena is freed at once
+        PsramArena* arena = arenas[(int)operation];
+        if (arena != nullptr) {
+            bool stillHeld = false;
+            for (int i = 0; i < MAX_ACTIVE_OPERATIONS; i++) {
+                stillHeld = stillHeld ||
+                            (activeOperations[i].moduleName[0] != '\0' && activeOperations[i].operation == operation);
+            }
+            if (!stillHeld) {
+                arena->reset();
+            }
+        }
     }
 }
 
-bool MemoryManager::canAllocate(size_t bytes, Priority priority) {
-    size_t freeHeap = getFreeHeap();
-    size_t requiredFree = 0;
-    
+size_t MemoryManager::getArenaCapacity(Operation operation) {
+    switch (operation) {
+        case Operation::HTTP_REQUEST:
+            return 32 * 1024;  // Buffered (chunked) response bodies
+        case Operation::JSON_PARSING:
+            return 16 * 1024;
+        case Operation::DATA_PROCESSING:
+            return 16 * 1024;
+        default:
+            return 0;
+    }
+}
+
+PsramArena* MemoryManager::getArena(Operation operation) {
+    int index = (int)operation;
+    if (index < 0 || index >= OPERATION_COUNT || getArenaCapacity(operation) == 0 || arenaUnavailable[index]) {
+        return nullptr;
+    }
+    if (arenas[index] != nullptr) {
+        return arenas[index];
+    }
+
+    if (xSemaphoreTake(memoryMutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return nullptr;
+    }
+    if (arenas[index] == nullptr) {
+        PsramArena* arena = new PsramArena();
+        if (arena->begin(getArenaCapacity(operation))) {
+            arenas[index] = arena;
+            LOG_INFOF("MemoryManager: Created %zu byte PSRAM arena for operation %d\n", arena->getCapacity(), index);
+        } else {
+            LOG_WARNINGF("MemoryManager: No PSRAM for operation %d arena, using internal heap\n", index);
+            arenaUnavailable[index] = true;
+            delete arena;
+        }
+    }
+    PsramArena* arena = arenas[index];
+    xSemaphoreGive(memoryMutex);
+    return arena;
+}
+
+size_t MemoryManager::getRequiredReserve(Priority priority) {
     // Different minimum free memory requirements based on priority
     switch (priority) {
         case Priority::CRITICAL:
-            requiredFree = criticalMemoryThreshold / 2; // 2.5KB minimum
-            break;
+            return criticalMemoryThreshold / 2;
         case Priority::IMPORTANT:
-            requiredFree = criticalMemoryThreshold; // 5KB minimum
-            break;
+            return criticalMemoryThreshold;
         case Priority::NORMAL:
-            requiredFree = lowMemoryThreshold; // 10KB minimum
-            break;
+            return lowMemoryThreshold;
         case Priority::BACKGROUND:
-            requiredFree = lowMemoryThreshold + 10000; // 20KB minimum
-            break;
+        default:
+            return lowMemoryThreshold + 10000;
     }
+}
+
+bool MemoryManager::canAllocate(size_t bytes, Priority priority) {
+    // Outstanding reservations may not have been allocated yet, so count them as used
+    size_t freeHeap = getFreeHeap();
+    size_t available = freeHeap > reservedBytes ? freeHeap - reservedBytes : 0;
+    size_t largestBlock = getLargestFreeBlock();
+    size_t requiredFree = getRequiredReserve(priority);
+
+    // Plenty of free bytes is useless if they are fragmented into pieces smaller than the request
+    bool canAlloc = available >= bytes + requiredFree && largestBlock >= bytes;
     
-    size_t totalNeeded = bytes + requiredFree;
-    bool canAlloc = (freeHeap >= totalNeeded);
-    
-    LOG_INFOF("🔍 canAllocate: free=%zu, need=%zu+%zu=%zu, result=%s\n", 
-              freeHeap, bytes, requiredFree, totalNeeded, canAlloc ? "YES" : "NO");
+    LOG_DEBUGF("MemoryManager: canAllocate free=%zu reserved=%zu largest=%zu need=%zu+%zu -> %s\n", freeHeap,
+               reservedBytes, largestBlock, bytes, requiredFree, canAlloc ? "YES" : "NO");
     
     return canAlloc;
 }
 
-void MemoryManager::waitForMemory(size_t bytes, Priority priority, unsigned long timeoutMs) {
+bool MemoryManager::waitForMemory(Operation operation, Priority priority, size_t bytes, const char* moduleName,
+                                  unsigned long timeoutMs) {
+    if (xSemaphoreTake(memoryMutex, pdMS_TO_TICKS(5000)) != pdTRUE) {
+        return false;
+    }
+    int slot = addWaiter(priority, bytes);
+    xSemaphoreGive(memoryMutex);
+
+    if (slot < 0) {
+        LOG_INFOF("MemoryManager: Too many waiting requests, rejecting %s\n", moduleName);
+        Metrics::Add(rejectedMetric);
+        return false;
+    }
+
+    LOG_INFOF("MemoryManager: %s waiting for %zu bytes to become available\n", moduleName, bytes);
+
     unsigned long startTime = millis();
-    unsigned long lastLogTime = 0;
-    
-    LOG_INFOF("MemoryManager: Waiting for %zu bytes to become available\n", bytes);
-    
-    while (millis() - startTime < timeoutMs) {
-        if (canAllocate(bytes, priority)) {
-            LOG_INFOF("MemoryManager: Memory became available after %lu ms\n", millis() - startTime);
-            return;
+    unsigned long lastLogTime = startTime;
+    bool granted = false;
+
+    while (true) {
+        if (xSemaphoreTake(memoryMutex, pdMS_TO_TICKS(5000)) == pdTRUE) {
+            // Only the head of the queue may take memory, so large high-priority requests are not starved
+            if (findFirstWaiter() == slot && hasAvailableSlot() && canAllocate(bytes, priority)) {
+                removeWaiter(slot);
+                granted = addOperation(operation, priority, bytes, moduleName);
+                // The next waiter may fit in what is left
+                wakeFirstWaiter();
+            }
+            xSemaphoreGive(memoryMutex);
         }
-        
+
+        unsigned long elapsed = millis() - startTime;
+        if (granted) {
+            LOG_INFOF("MemoryManager: Memory became available after %lu ms\n", elapsed);
+            return true;
+        }
+        if (elapsed >= timeoutMs) {
+            break;
+        }
+
         // Log status every 5 seconds
         if (millis() - lastLogTime > 5000) {
             logMemoryStatus("Waiting");
             lastLogTime = millis();
         }
-        
-        vTaskDelay(pdMS_TO_TICKS(500)); // Wait 500ms between checks
+
+        unsigned long remaining = timeoutMs - elapsed;
+        xSemaphoreTake(waiters[slot].signal, pdMS_TO_TICKS(std::min<unsigned long>(remaining, WAIT_RECHECK_MS)));
+    }
+
+    if (xSemaphoreTake(memoryMutex, pdMS_TO_TICKS(5000)) == pdTRUE) {
+        removeWaiter(slot);
+        wakeFirstWaiter();
+        xSemaphoreGive(memoryMutex);
+    }
+
+    LOG_INFOF("MemoryManager: Timeout waiting for memory for %s after %lu ms\n", moduleName, timeoutMs);
+    Metrics::Add(rejectedMetric);
+    return false;
+}
+
+int MemoryManager::addWaiter(Priority priority, size_t bytes) {
+    for (int i = 0; i < MAX_WAITERS; i++) {
+        if (!waiters[i].active && waiters[i].signal != nullptr) {
+            // Drop a wake-up left over from the slot's previous owner
+            xSemaphoreTake(waiters[i].signal, 0);
+            waiters[i].active = true;
+            waiters[i].priority = priority;
+            waiters[i].bytes = bytes;
+            waiters[i].sequence = nextWaiterSequence++;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void MemoryManager::removeWaiter(int slot) {
+    if (slot >= 0 && slot < MAX_WAITERS) {
+        waiters[slot].active = false;
+    }
+}
+
+int MemoryManager::findFirstWaiter() {
+    // Highest priority first, oldest first within a priority
+    int first = -1;
+    for (int i = 0; i < MAX_WAITERS; i++) {
+        if (!waiters[i].active) {
+            continue;
+        }
+        if (first < 0 || waiters[i].priority > waiters[first].priority ||
+            (waiters[i].priority == waiters[first].priority &&
+             (int32_t)(waiters[i].sequence - waiters[first].sequence) < 0)) {
+            first = i;
+        }
+    }
+    return first;
+}
+
+bool MemoryManager::hasWaiterAhead(Priority priority) {
+    for (int i = 0; i < MAX_WAITERS; i++) {
+        if (waiters[i].active && waiters[i].priority >= priority) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MemoryManager::wakeFirstWaiter() {
+    int first = findFirstWaiter();
+    if (first >= 0) {
+        xSemaphoreGive(waiters[first].signal);
     }
-    
-    LOG_INFOF("MemoryManager: Timeout waiting for memory after %lu ms\n", timeoutMs);
 }
 
 void MemoryManager::updateMinimumFreeHeap() {
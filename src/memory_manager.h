@@ -5,12 +5,23 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
+#include "psram_arena.h"
 
 /**
  * Global Memory Manager
  * 
  * Coordinates memory usage across all modules to prevent memory conflicts
  * and fragmentation. Provides centralized memory monitoring and cleanup.
+ *
+ * Admission is based on accounting rather than a snapshot: bytes of granted but not yet
+ * released reservations are deducted from the free internal heap, and the request must also
+ * fit in the largest free block. A request that does not fit waits on its own semaphore;
+ * releaseMemory() wakes waiters one at a time in priority order (FIFO within a priority),
+ * and a waiting request is never overtaken by a later one of equal or lower priority.
+ *
+ * Large, short-lived buffers come from per-operation PSRAM arenas: a holder of an
+ * HTTP_REQUEST, JSON_PARSING or DATA_PROCESSING reservation may allocate from getArena(op),
+ * and the arena is reset in one step when the last reservation of that operation is released.
  */
 class MemoryManager {
 public:
@@ -28,6 +39,7 @@ public:
         DISPLAY_UPDATE,  // Display operations
         CONFIG_OPERATION // Configuration operations
     };
+    static const int OPERATION_COUNT = 5;
 
     static MemoryManager* getInstance();
     
@@ -45,6 +57,7 @@ public:
     
     // Memory status
     size_t getFreeHeap();
+    size_t getLargestFreeBlock();
     size_t getMinimumFreeHeap();
     bool isMemoryLow();
     bool isMemoryCritical();
@@ -53,6 +66,10 @@ public:
     void forceGarbageCollection();
     void performGlobalCleanup();
     void registerCleanupCallback(const char* moduleName, void (*callback)());
+
+    // PSRAM arena of an operation, valid while the caller holds a reservation for it.
+    // Returns nullptr for operations without an arena or when PSRAM is unavailable.
+    PsramArena* getArena(Operation operation);
     
     // Memory thresholds
     void setLowMemoryThreshold(size_t threshold);
@@ -60,6 +77,7 @@ public:
     
     // Statistics and monitoring
     void logMemoryStatus(const char* context = "");
+    void publishMetrics();  // Heap gauges of the metrics registry, called from the system monitor
     size_t getAllocatedBytes();
     int getActiveOperations();
 
@@ -86,7 +104,27 @@ private:
     static const int MAX_ACTIVE_OPERATIONS = 16;
     ActiveOperation activeOperations[MAX_ACTIVE_OPERATIONS];
     int activeOperationCount = 0;
+    size_t reservedBytes = 0;  // Sum of estimatedBytes of active operations
+
+    // Requests blocked in waitForMemory(), each with its own wake-up semaphore
+    struct Waiter {
+        bool active;
+        Priority priority;
+        size_t bytes;
+        uint32_t sequence;  // Arrival order within a priority
+        SemaphoreHandle_t signal;
+    };
+
+    static const int MAX_WAITERS = 8;
+    static const uint32_t WAIT_RECHECK_MS = 1000;  // Heap can also grow without a release
+    Waiter waiters[MAX_WAITERS];
+    uint32_t nextWaiterSequence = 0;
     
+    // Per-operation PSRAM arenas, created on first use
+    PsramArena* arenas[OPERATION_COUNT];
+    bool arenaUnavailable[OPERATION_COUNT];
+    static size_t getArenaCapacity(Operation operation);
+
     // Cleanup callbacks
     struct CleanupCallback {
         char moduleName[32];
@@ -104,9 +142,18 @@ private:
     // Internal methods
     bool hasAvailableSlot();
     int findOperationSlot(Operation operation, const char* moduleName);
+    bool addOperation(Operation operation, Priority priority, size_t estimatedBytes, const char* moduleName,
+                      bool verbose = true);
     void removeOperation(int slot);
+    size_t getRequiredReserve(Priority priority);
     bool canAllocate(size_t bytes, Priority priority);
-    void waitForMemory(size_t bytes, Priority priority, unsigned long timeoutMs = 30000);
+    bool waitForMemory(Operation operation, Priority priority, size_t bytes, const char* moduleName,
+                       unsigned long timeoutMs = 30000);
+    int addWaiter(Priority priority, size_t bytes);
+    void removeWaiter(int slot);
+    int findFirstWaiter();
+    bool hasWaiterAhead(Priority priority);
+    void wakeFirstWaiter();
     void updateMinimumFreeHeap();
 };
 
@@ -0,0 +1,210 @@
+#include "metrics.h"
+#include <WiFi.h>
+#include <cstring>
+#include "logger.h"
+#include "wifi_manager.h"
+
+const uint32_t Metrics::BUCKET_BOUNDS_US[BUCKET_COUNT] = {1000,  2500,   5000,   10000,  25000,
+                                                          50000, 100000, 250000, 1000000, 5000000};
+
+Metrics::Slot Metrics::slots[MAX_METRICS] = {};
+std::atomic<int32_t> Metrics::values[MAX_METRICS] = {};
+Metrics::Histogram Metrics::histograms[MAX_HISTOGRAMS] = {};
+int Metrics::slotCount = 0;
+int Metrics::histogramCount = 0;
+portMUX_TYPE Metrics::lock = portMUX_INITIALIZER_UNLOCKED;
+uint16_t Metrics::port = 0;
+
+namespace {
+
+// Collects the response into TCP-sized writes instead of one segment per line
+class BufferedPrint : public Print {
+  public:
+    explicit BufferedPrint(Print& target) : target(target) {}
+    ~BufferedPrint() { flush(); }
+
+    size_t write(uint8_t c) override {
+        if (length == sizeof(buffer)) {
+            flush();
+        }
+        buffer[length++] = c;
+        return 1;
+    }
+
+    void flush() override {
+        if (length > 0) {
+            target.write(buffer, length);
+            length = 0;
+        }
+    }
+
+  private:
+    Print& target;
+    uint8_t buffer[512];
+    size_t length = 0;
+};
+
+bool sameLabels(const char* a, const char* b) {
+    return a == b || (a != nullptr && b != nullptr && strcmp(a, b) == 0);
+}
+
+}  // namespace
+
+Metrics::Id Metrics::Register(Type type, const char* name, const char* help, const char* labels) {
+    Id id = NO_METRIC;
+    portENTER_CRITICAL(&lock);
+    // A module registers again on every start; its series keep their slot and value
+    for (int i = 0; i < slotCount; i++) {
+        if (slots[i].type == type && strcmp(slots[i].name, name) == 0 && sameLabels(slots[i].labels, labels)) {
+            id = i;
+            break;
+        }
+    }
+    bool histogramFull = type == Type::HISTOGRAM && histogramCount == MAX_HISTOGRAMS;
+    if (id == NO_METRIC && slotCount < MAX_METRICS && !histogramFull) {
+        id = slotCount++;
+        Slot& slot = slots[id];
+        slot.name = name;
+        slot.help = help;
+        slot.labels = labels;
+        slot.type = type;
+        slot.histogram = type == Type::HISTOGRAM ? histogramCount++ : -1;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (id == NO_METRIC) {
+        LOG_WARNINGF("Metrics: No slot left for %s\n", name);
+    }
+    return id;
+}
+
+void Metrics::Observe(Id id, uint32_t micros) {
+    if (id < 0) {
+        return;
+    }
+    int bucket = 0;
+    while (bucket < BUCKET_COUNT && micros > BUCKET_BOUNDS_US[bucket]) {
+        bucket++;
+    }
+
+    Histogram& histogram = histograms[slots[id].histogram];
+    portENTER_CRITICAL(&lock);
+    if (bucket < BUCKET_COUNT) {
+        histogram.buckets[bucket]++;
+    }
+    histogram.count++;
+    histogram.sumMicros += micros;
+    portEXIT_CRITICAL(&lock);
+}
+
+void Metrics::Start(const Config::MetricsSettings& settings) {
+    if (!settings.enabled) {
+        return;
+    }
+    port = settings.port;
+    if (xTaskCreate(RunServer, "MetricsServer", TASK_STACK_SIZE, NULL, TASK_PRIORITY, NULL) != pdPASS) {
+        LOG_ERROR("Metrics: Failed to create server task");
+    }
+}
+
+void Metrics::RunServer(void* parameter) {
+    WiFiManager::WaitForConnection();
+
+    WiFiServer server(port);
+    server.begin();
+    LOG_INFOF("Metrics: Serving http://%s:%u/metrics\n", WiFi.localIP().toString().c_str(), (unsigned)port);
+
+    char requestLine[64];
+    while (true) {
+        WiFiClient client = server.available();
+        if (!client) {
+            vTaskDelay(pdMS_TO_TICKS(250));
+            continue;
+        }
+
+        // Only the request line matters; the headers are drained up to the blank line
+        client.setTimeout(REQUEST_TIMEOUT_MS);
+        size_t length = client.readBytesUntil('\n', requestLine, sizeof(requestLine) - 1);
+        requestLine[length] = '\0';
+        char header[64];
+        size_t headerLength;
+        do {
+            headerLength = client.readBytesUntil('\n', header, sizeof(header));
+        } while (client.connected() && headerLength > 1);
+
+        char next = requestLine[12];
+        bool metricsPath = strncmp(requestLine, "GET /metrics", 12) == 0 &&
+                           (next == ' ' || next == '?' || next == '\r' || next == '\0');
+        if (metricsPath) {
+            BufferedPrint out(client);
+            out.print("HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\n\r\n");
+            Write(out);
+        } else {
+            client.print("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        }
+        client.stop();
+    }
+}
+
+void Metrics::Write(Print& out) {
+    int count = slotCount;
+    for (int i = 0; i < count; i++) {
+        // Series of one name are written together, under the header of the first one
+        bool seen = false;
+        for (int j = 0; j < i && !seen; j++) {
+            seen = strcmp(slots[j].name, slots[i].name) == 0;
+        }
+        if (seen) {
+            continue;
+        }
+
+        writeHeader(out, slots[i]);
+        for (int j = i; j < count; j++) {
+            if (strcmp(slots[j].name, slots[i].name) != 0) {
+                continue;
+            }
+            if (slots[j].type == Type::HISTOGRAM) {
+                writeHistogram(out, slots[j]);
+            } else {
+                writeSample(out, slots[j], "", nullptr, values[j].load(std::memory_order_relaxed));
+            }
+        }
+    }
+}
+
+void Metrics::writeHeader(Print& out, const Slot& slot) {
+    static const char* TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+    out.printf("# HELP hoowachy_%s %s\n# TYPE hoowachy_%s %s\n", slot.name, slot.help, slot.name,
+               TYPE_NAMES[(int)slot.type]);
+}
+
+void Metrics::writeSample(Print& out, const Slot& slot, const char* suffix, const char* extraLabel, int64_t value) {
+    bool labeled = slot.labels != nullptr || extraLabel != nullptr;
+    bool both = slot.labels != nullptr && extraLabel != nullptr;
+    out.printf("hoowachy_%s%s%s%s%s%s%s %lld\n", slot.name, suffix, labeled ? "{" : "",
+               slot.labels != nullptr ? slot.labels : "", both ? "," : "", extraLabel != nullptr ? extraLabel : "",
+               labeled ? "}" : "", (long long)value);
+}
+
+void Metrics::writeHistogram(Print& out, const Slot& slot) {
+    // Copy under the lock so buckets, count and sum describe the same observations
+    Histogram snapshot;
+    portENTER_CRITICAL(&lock);
+    snapshot = histograms[slot.histogram];
+    portEXIT_CRITICAL(&lock);
+
+    char bound[24];
+    uint32_t cumulative = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        cumulative += snapshot.buckets[i];
+        snprintf(bound, sizeof(bound), "le=\"%g\"", BUCKET_BOUNDS_US[i] / 1000000.0);
+        writeSample(out, slot, "_bucket", bound, cumulative);
+    }
+    writeSample(out, slot, "_bucket", "le=\"+Inf\"", snapshot.count);
+
+    // The sum is in seconds, which needs a fraction
+    bool labeled = slot.labels != nullptr;
+    out.printf("hoowachy_%s_sum%s%s%s %.6f\n", slot.name, labeled ? "{" : "", labeled ? slot.labels : "",
+               labeled ? "}" : "", snapshot.sumMicros / 1000000.0);
+    writeSample(out, slot, "_count", nullptr, snapshot.count);
+}
@@ -0,0 +1,93 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * Metrics Registry
+ *
+ * Counters, gauges and histograms that subsystems publish into for fleet monitoring. All
+ * storage is preallocated: a metric is registered once at setup and gets a slot id, after
+ * which updating it is one relaxed atomic operation (a short critical section for a histogram
+ * observation), with no allocation or locking on the hot paths. Registration with a full
+ * table returns NO_METRIC, which every update ignores.
+ *
+ * With [metrics] enable=true the registry is served as Prometheus text on GET /metrics over
+ * a small single-client HTTP server. Names are prefixed with "hoowachy_"; metrics sharing a
+ * name differ by their label set. Histograms take microseconds and export seconds.
+ */
+class Metrics {
+  public:
+    enum class Type : uint8_t { COUNTER, GAUGE, HISTOGRAM };
+
+    typedef int8_t Id;
+    static const Id NO_METRIC = -1;
+
+    // name and help are not copied; labels is a Prometheus label list such as "module=\"clock\"".
+    // Registering the same type, name and labels again returns the existing id.
+    static Id Register(Type type, const char* name, const char* help, const char* labels = nullptr);
+
+    static void Add(Id id, uint32_t amount = 1) {
+        if (id >= 0) {
+            values[id].fetch_add(amount, std::memory_order_relaxed);
+        }
+    }
+
+    static void Set(Id id, int32_t value) {
+        if (id >= 0) {
+            values[id].store(value, std::memory_order_relaxed);
+        }
+    }
+
+    static void Observe(Id id, uint32_t micros);
+
+    // Start the exporter task when enabled, called once after the configuration is loaded
+    static void Start(const Config::MetricsSettings& settings);
+
+    // Write the registry in the Prometheus text format
+    static void Write(Print& out);
+
+  private:
+    struct Slot {
+        const char* name;
+        const char* help;
+        const char* labels;
+        Type type;
+        int8_t histogram;  // Index into histograms, -1 for counters and gauges
+    };
+
+    // Buckets in microseconds, from a fast frame to a slow HTTP request
+    static const int BUCKET_COUNT = 10;
+    static const uint32_t BUCKET_BOUNDS_US[BUCKET_COUNT];
+
+    struct Histogram {
+        uint32_t buckets[BUCKET_COUNT];  // Not cumulative; the export sums them up
+        uint32_t count;
+        uint64_t sumMicros;
+    };
+
+    static const int MAX_METRICS = 40;
+    static const int MAX_HISTOGRAMS = 4;
+    static const uint32_t TASK_STACK_SIZE = 4096;
+    static const UBaseType_t TASK_PRIORITY = 1;
+    static const uint32_t REQUEST_TIMEOUT_MS = 2000;
+
+    static Slot slots[MAX_METRICS];
+    static std::atomic<int32_t> values[MAX_METRICS];
+    static Histogram histograms[MAX_HISTOGRAMS];
+    static int slotCount;
+    static int histogramCount;
+    static portMUX_TYPE lock;
+    static uint16_t port;
+
+    static void RunServer(void* parameter);
+    static void writeHeader(Print& out, const Slot& slot);
+    static void writeSample(Print& out, const Slot& slot, const char* suffix, const char* extraLabel, int64_t value);
+    static void writeHistogram(Print& out, const Slot& slot);
+};
+
+#endif  // METRICS_H
@@ -2,17 +2,21 @@
 #include "logger.h"
 #include "memory_manager.h"
 #include <ArduinoJson.h>
-#include <EEPROM.h>
 #include <HTTPClient.h>
 #include <U8g2lib.h>
 #include <WiFi.h>
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <esp_heap_caps.h>
 #include <vector>
+#include "../display.h"
 #include "../event_manager.h"
+#include "../http_service.h"
+#include "../metrics.h"
 #include "../wifi_manager.h"
 #include "../config_manager.h"
+#include "../diagnostics.h"
 #include "../timezone_utils.h"
 #include "module_registry.h"
 #include "weather_icons.h"
@@ -21,6 +25,12 @@ extern U8G2_SSD1309_128X64_NONAME0_F_4W_HW_SPI u8g2;
 
 namespace modules {
 
+const char* AccuWeather::CACHE_NAMESPACE = "accuweather";
+const char* AccuWeather::CACHE_FORECASTS = "forecasts";
+
+static Metrics::Id fetchSuccessMetric = Metrics::NO_METRIC;
+static Metrics::Id fetchFailureMetric = Metrics::NO_METRIC;
+
 // Global cleanup function for AccuWeather memory management  
 static void accuWeatherCleanupCallback() {
     LOG_INFO("AccuWeather: Memory cleanup callback triggered");
@@ -49,10 +59,11 @@ void AccuWeather::Configure(const ModuleConfig& config) {
 bool AccuWeather::ConfigureFromSection(const ConfigSection& section) {
     LOG_INFO("AccuWeather configured from INI section");
     
-    // Debug: Print all key-value pairs in the section
-    LOG_INFO("Debug: All config section key-value pairs:");
+    // Debug: Print all key-value pairs in the section, never the API key itself
+    LOG_DEBUG("Debug: All config section key-value pairs:");
     for (const auto& pair : section.keyValuePairs) {
-        LOG_INFOF("  '%s' = '%s'\n", pair.first.c_str(), pair.second.c_str());
+        bool secret = pair.first == "api_key";
+        LOG_DEBUGF("  '%s' = '%s'\n", pair.first.c_str(), secret ? "<redacted>" : pair.second.c_str());
     }
     
     // Parse configuration from INI section
@@ -65,10 +76,13 @@ bool AccuWeather::ConfigureFromSection(const ConfigSection& section) {
     moduleConfig.width = section.getIntValue("width", 128);
     moduleConfig.height = section.getIntValue("height", 64);
     moduleConfig.enable = section.getBoolValue("enable", false);
+    moduleConfig.refreshIntervalMinutes = section.getIntValue("refresh_interval", 60);
+    moduleConfig.refreshLeadSeconds = section.getIntValue("refresh_lead", 120);
+    moduleConfig.dailyBudget = section.getIntValue("daily_budget", 40);
 
     // Debug: Print what we actually got
-    LOG_INFOF("Debug: api_key value = '%s' (length: %d)\n", moduleConfig.apiKey.c_str(), moduleConfig.apiKey.length());
-    LOG_INFOF("Debug: city value = '%s' (length: %d)\n", moduleConfig.city.c_str(), moduleConfig.city.length());
+    LOG_DEBUGF("Debug: api_key length: %d\n", moduleConfig.apiKey.length());
+    LOG_DEBUGF("Debug: city value = '%s' (length: %d)\n", moduleConfig.city.c_str(), moduleConfig.city.length());
 
     // Validation
     if (moduleConfig.apiKey.isEmpty()) {
@@ -89,6 +103,9 @@ bool AccuWeather::ConfigureFromSection(const ConfigSection& section) {
     LOG_INFOF("  Position: (%d, %d)\n", moduleConfig.positionX, moduleConfig.positionY);
     LOG_INFOF("  Size: %dx%d\n", moduleConfig.width, moduleConfig.height);
     LOG_INFOF("  Enabled: %s\n", moduleConfig.enable ? "YES" : "NO");
+    LOG_INFOF("  Refresh: every %lu min, %lu s early, budget %u/day\n",
+              (unsigned long)moduleConfig.refreshIntervalMinutes, (unsigned long)moduleConfig.refreshLeadSeconds,
+              moduleConfig.dailyBudget);
 
     return true;
 }
@@ -96,97 +113,62 @@ bool AccuWeather::ConfigureFromSection(const ConfigSection& section) {
 void AccuWeather::Setup() {
     // Weather setup initialization
     LOG_INFO("AccuWeather module setup");
-    loadFromEEPROM();
-    LOG_INFO("Forecasts loaded from EEPROM");
+    loadForecasts();
+    LOG_INFO("Forecasts loaded");
+
+    buildIconFrames();
 
     // Register cleanup callback with MemoryManager
     MemoryManager::getInstance()->registerCleanupCallback("AccuWeather", accuWeatherCleanupCallback);
 }
 
-void AccuWeather::saveToEEPROM() {
-    LOG_INFO("Saving forecasts to EEPROM...");
-
-    // Write magic number to indicate valid data
-    uint32_t magic = 0xABCD1234;
-    EEPROM.put(EEPROM_FORECAST_START, magic);
+void AccuWeather::saveForecasts(bool forecastsChanged) {
+    LOG_INFO("Saving forecasts...");
 
-    // Write Unix timestamp when data was saved
-    lastDataSaveTime = time(nullptr);
-    LOG_INFOF("Saving lastDataSaveTime to EEPROM: %ld (Unix timestamp)\n", lastDataSaveTime);
-    
-    // Convert to human readable time for debugging
-    struct tm* timeinfo = localtime(&lastDataSaveTime);
-    if (timeinfo) {
-        char timeString[64];
-        strftime(timeString, sizeof(timeString), "%Y-%m-%d %H:%M:%S", timeinfo);
-        LOG_INFOF("Data saved at: %s\n", timeString);
+    // Forecast unchanged on the server: only mark the cached copy current again
+    CacheService* cache = CacheService::getInstance();
+    bool saved = false;
+    if (!forecastsChanged) {
+        saved = cache->touch(CACHE_NAMESPACE, CACHE_FORECASTS);
     }
-    
-    EEPROM.put(EEPROM_FORECAST_START + sizeof(magic), lastDataSaveTime);
-
-    // Write forecasts data
-    int address = EEPROM_FORECAST_START + sizeof(magic) + sizeof(lastDataSaveTime);
-    for (int i = 0; i < 6; i++) {  // Updated for 6 forecasts
-        EEPROM.put(address, forecasts[i]);
-        address += sizeof(Forecast);
+    if (!saved) {
+        saved = cache->put(CACHE_NAMESPACE, CACHE_FORECASTS, FORECASTS_VERSION, forecasts, sizeof(forecasts),
+                           FORECASTS_TTL_SECONDS);
     }
 
-    EEPROM.commit();
-    LOG_INFO("Forecasts saved to EEPROM successfully");
+    if (!saved) {
+        LOG_WARNING("Failed to save forecasts");
+        return;
+    }
+    LOG_INFO("Forecasts saved");
 }
 
-void AccuWeather::loadFromEEPROM() {
-    LOG_INFO("Loading forecasts from EEPROM...");
-
-    // Read magic number to check if data is valid
-    uint32_t magic;
-    EEPROM.get(EEPROM_FORECAST_START, magic);
+void AccuWeather::loadForecasts() {
+    LOG_INFO("Loading forecasts...");
 
-    if (magic != 0xABCD1234) {
-        LOG_INFO("No valid forecast data found in EEPROM, initializing empty forecasts");
+    CacheService::Freshness freshness;
+    if (!CacheService::getInstance()->get(CACHE_NAMESPACE, CACHE_FORECASTS, FORECASTS_VERSION, staged,
+                                          sizeof(staged), &freshness)) {
+        LOG_INFO("No valid forecast data stored, initializing empty forecasts");
 
         // Initialize with empty forecasts
-        for (int i = 0; i < 6; i++) {  // Updated for 6 forecasts
-            forecasts[i] = Forecast();
-        }
-        lastDataSaveTime = 0;  // Mark as no data
+        clearStaged();
+        publishForecasts(staged);
         return;
     }
 
-    // Read Unix timestamp when data was saved
-    EEPROM.get(EEPROM_FORECAST_START + sizeof(magic), lastDataSaveTime);
-    LOG_INFOF("Loaded lastDataSaveTime from EEPROM: %ld (Unix timestamp)\n", lastDataSaveTime);
-    
     // Convert to human readable time for debugging
-    if (lastDataSaveTime > 0) {
-        struct tm* timeinfo = localtime(&lastDataSaveTime);
+    if (freshness.storedAt > 0) {
+        struct tm* timeinfo = localtime(&freshness.storedAt);
         if (timeinfo) {
             char timeString[64];
             strftime(timeString, sizeof(timeString), "%Y-%m-%d %H:%M:%S", timeinfo);
             LOG_INFOF("Data was saved at: %s\n", timeString);
         }
     }
-    
-    // Show current time for comparison
-    time_t currentTime = time(nullptr);
-    if (currentTime > 0) {
-        struct tm* currentTimeinfo = localtime(&currentTime);
-        if (currentTimeinfo) {
-            char currentTimeString[64];
-            strftime(currentTimeString, sizeof(currentTimeString), "%Y-%m-%d %H:%M:%S", currentTimeinfo);
-            LOG_INFOF("Current time: %s\n", currentTimeString);
-        }
-    }
-
-    // Read forecasts data
-    int address = EEPROM_FORECAST_START + sizeof(magic) + sizeof(lastDataSaveTime);
-    for (int i = 0; i < 6; i++) {  // Updated for 6 forecasts
-        EEPROM.get(address, forecasts[i]);
-        address += sizeof(Forecast);
-    }
 
-    LOG_INFOF("Successfully loaded %d forecasts from EEPROM\n", 6);
-    LOG_INFOF("Data saved at: %lu, current time: %lu\n", lastDataSaveTime, millis());
+    publishForecasts(staged);
+    LOG_INFOF("Successfully loaded %d forecasts\n", 6);
 
     // Check data freshness immediately after loading
     LOG_INFOF("Is data fresh after loading? %s\n", isDataFresh() ? "YES" : "NO");
@@ -194,24 +176,40 @@ void AccuWeather::loadFromEEPROM() {
     // Print loaded data for verification
     for (int i = 0; i < 6; i++) {  // Updated for 6 forecasts
         if (forecasts[i].time != 0) {
-            LOG_INFOF("Forecast %d: temp=%d, humidity=%d, icon=%d, phrase=%.20s\n", i, forecasts[i].temperature,
+            LOG_DEBUGF("Forecast %d: temp=%d, humidity=%d, icon=%d, phrase=%.20s\n", i, forecasts[i].temperature,
                           forecasts[i].humidity, forecasts[i].icon, forecasts[i].phrase);
         } else {
-            LOG_INFOF("Forecast %d: EMPTY (time=0)\n", i);
+            LOG_DEBUGF("Forecast %d: EMPTY (time=0)\n", i);
         }
     }
     
     // Debug: Print all forecasts regardless of time value
-    LOG_INFO("[AccuWeather loadFromEEPROM] All forecast data loaded:");
+    LOG_INFO("[AccuWeather loadForecasts] All forecast data loaded:");
     for (int i = 0; i < 6; i++) {
-        LOG_INFOF("  Forecast %d: time=%ld, temp=%d, humidity=%d, icon=%d, phrase=%.20s\n", 
+        LOG_DEBUGF("  Forecast %d: time=%ld, temp=%d, humidity=%d, icon=%d, phrase=%.20s\n", 
                      i, forecasts[i].time, forecasts[i].temperature, 
                      forecasts[i].humidity, forecasts[i].icon, forecasts[i].phrase);
     }
 }
+
+void AccuWeather::publishForecasts(const Forecast (&source)[6]) {
+    Display::LockComposition();
+    for (int i = 0; i < 6; i++) {
+        forecasts[i] = source[i];
+    }
+    forecastRevision++;
+    Display::UnlockComposition();
+}
+
+void AccuWeather::clearStaged() {
+    for (int i = 0; i < 6; i++) {
+        staged[i] = Forecast();
+    }
+}
     
 void AccuWeather::Run(void* parameter) {
     LOG_INFO("Weather Run");
+    taskHandle = xTaskGetCurrentTaskHandle();
 
      ConfigManager* configManager = ConfigManager::getInstance();
     
@@ -222,7 +220,7 @@ void AccuWeather::Run(void* parameter) {
     
     if (!ConfigureFromSection(moduleSection)) {
         LOG_INFO("Failed to re-configure AccuWeather module after config ready");
-        vTaskDelete(NULL);
+        taskHandle = NULL;
         return;
     }
     
@@ -231,52 +229,69 @@ void AccuWeather::Run(void* parameter) {
     LOG_INFOF("AccuWeather: Forced systemTimezone to '%s'\n", moduleConfig.systemTimezone.c_str());
 
     // Wait for WiFi connection
-    while (!WiFiManager::IsConnected()) {
-        vTaskDelay(pdMS_TO_TICKS(1000));
-    }
+    bool online = waitForWiFi();
 
-    if (!moduleConfig.enable) {
-        vTaskDelete(NULL);
+    // The manager only starts the module when enabled; this covers a flip while waiting for WiFi
+    if (!moduleConfig.enable || !online) {
+        taskHandle = NULL;
         return;
     }
 
-    TerminalEvent event(0, "AW", "Load data from EEPROM", TerminalEvent::State::SUCCESS);
+    TerminalEvent event(0, "AW", "Load cached data", TerminalEvent::State::SUCCESS);
     EventManager::Emit(event);
     ready = true;
+    Display::RequestRedraw();
 
-    // Check if EEPROM data is fresh (less than 2 hours old), if not - fetch immediately
-    if (!isDataFresh()) {
-        LOG_INFO("EEPROM data is older than 2 hours, fetching fresh weather data on startup...");
-        if (!fetchWeatherData()) {
-            LOG_INFO("Failed to fetch fresh data on startup, using stale EEPROM data");
-            TerminalEvent startupEvent(0, "AW", "Using stale cached data", TerminalEvent::State::PROCESSING);
-            EventManager::Emit(startupEvent);
-        }
-    } else {
-        LOG_INFO("EEPROM data is fresh (less than 2 hours old), skipping immediate fetch");
-        TerminalEvent freshEvent(0, "AW", "Using fresh cached data", TerminalEvent::State::SUCCESS);
-        EventManager::Emit(freshEvent);
+    // Stale or missing data is fetched right away, fresh data waits for the next aligned slot
+    bool fresh = isDataFresh();
+    TerminalEvent cacheEvent(0, "AW", fresh ? "Using fresh cached data" : "Cached data is stale",
+                             fresh ? TerminalEvent::State::SUCCESS : TerminalEvent::State::PROCESSING);
+    EventManager::Emit(cacheEvent);
+
+    scheduler.start(makeSchedule(), !fresh);
+
+    fetchSuccessMetric = Metrics::Register(Metrics::Type::COUNTER, "module_fetches_total", "Module data fetches",
+                                           "module=\"accuweather\",outcome=\"success\"");
+    fetchFailureMetric = Metrics::Register(Metrics::Type::COUNTER, "module_fetches_total", "Module data fetches",
+                                           "module=\"accuweather\",outcome=\"failure\"");
+
+    if (Diagnostics::IsEnabled()) {
+        runDiagnosticFetches();
     }
 
-    while (true) {
-        // Always wait 30 minutes between API requests
-        const unsigned long waitTimeMinutes = 30;
-        unsigned long waitTime = waitTimeMinutes * 60 * 1000; // Convert to milliseconds
-        
-        LOG_INFOF("Waiting %lu minutes until next update...\n", waitTimeMinutes);
-        vTaskDelay(pdMS_TO_TICKS(waitTime));
-        
-        LOG_INFO("Scheduled weather data update...");
-        if (!fetchWeatherData()) {
-            LOG_INFO("Scheduled update failed, retrying in 30 seconds");
-            vTaskDelay(pdMS_TO_TICKS(30 * 1000));
-            ready = false;
+    while (!IsStopRequested()) {
+        if (scheduler.getState() == RefreshScheduler::State::STOPPED) {
+            // Nothing left to do until the configuration is fixed
+            sleepOrReconfigure(portMAX_DELAY);
+            continue;
+        }
+
+        uint32_t waitMs = scheduler.getDelayMs();
+        if (waitMs > 0) {
+            sleepOrReconfigure(pdMS_TO_TICKS(waitMs));
             continue;
         }
-        ready = true;
+
+        // An offline radio is not a failed request: wait for the link without spending budget
+        if (!WiFiManager::IsConnected()) {
+            waitForWiFi();
+            continue;
+        }
+
+        if (!scheduler.beginRequest()) {
+            continue;
+        }
+
+        LOG_INFO("Scheduled weather data update...");
+        RefreshScheduler::Outcome outcome = fetchWeatherData();
+        scheduler.report(outcome);
+        Metrics::Add(outcome == RefreshScheduler::Outcome::SUCCESS ? fetchSuccessMetric : fetchFailureMetric);
+        ready = outcome == RefreshScheduler::Outcome::SUCCESS || hasForecastData();
+        Display::RequestRedraw();
     }
-    vTaskDelete(NULL);
-    return;
+
+    // Stopped: the module manager releases the instance once Run() returns
+    taskHandle = NULL;
 }
 
 void AccuWeather::Draw() {
@@ -299,9 +314,7 @@ void AccuWeather::Draw() {
     
     // Get current time for filtering (same logic as in parsing)
     time_t currentTime = time(nullptr);
-    ConfigManager* configManager = ConfigManager::getInstance();
-    String timezone = configManager->getSystemTimezone();
-    int timezoneOffset = TimezoneUtils::getTimezoneOffset(timezone);
+    int timezoneOffset = TimezoneUtils::getOffsetAt(currentTime);
     time_t localCurrentTime = currentTime + timezoneOffset;
     time_t currentHourTimeUTC = (localCurrentTime / 3600) * 3600 - timezoneOffset;
     
@@ -330,26 +343,9 @@ void AccuWeather::Draw() {
         const uint8_t* forecastIcon = weatherIcon(forecasts[forecastIndex].icon);
         int currentYPos = yPos + (i * 16);  // Fixed positioning calculation
 
-        if (i == 0) {
-            unsigned long animationTime = millis();
-            float scale = 1.0f + 0.1f * sin(animationTime / 1000.0f);
-
-            int iconSize = 19;
-
-            for (int y = 0; y < iconSize; y++) {
-                for (int x = 0; x < iconSize; x++) {
-                    int srcX = ((x * 18) / iconSize) / scale;
-                    int srcY = ((y * 18) / iconSize) / scale;
-                    if (srcX < 16 && srcY < 16) {
-                        int byteIndex = srcY * 2 + srcX / 8;
-                        int bitIndex = srcX % 8;
-                        if (forecastIcon[byteIndex] & (1 << bitIndex)) {
-                            u8g2.drawPixel(xPos + x, currentYPos + y);
-                        }
-                    }
-                }
-            }
-
+        const uint8_t* frame = i == 0 ? getIconFrame(forecastIcon, millis()) : nullptr;
+        if (frame != nullptr) {
+            u8g2.drawXBMP(xPos, currentYPos, ICON_FRAME_SIZE, ICON_FRAME_SIZE, frame);
         } else {
             u8g2.drawXBMP(xPos, currentYPos, 16, 16, forecastIcon);
         }
@@ -361,13 +357,8 @@ void AccuWeather::Draw() {
         if (forecasts[forecastIndex].time != 0) {
             time_t timestamp = forecasts[forecastIndex].time;
 
-            // Always use system timezone from ConfigManager
-            ConfigManager* configManager = ConfigManager::getInstance();
-            String timezone = configManager->getSystemTimezone();
-
-            // Apply timezone offset
-            int timezoneOffset = TimezoneUtils::getTimezoneOffset(timezone);
-            timestamp += timezoneOffset;
+            // Apply the system timezone offset in effect at the forecast hour
+            timestamp += TimezoneUtils::getOffsetAt(timestamp);
 
             struct tm* timeinfo = gmtime(&timestamp);
             snprintf(time_buffer, sizeof(time_buffer), "%02d:%02d", timeinfo->tm_hour, timeinfo->tm_min);
@@ -393,9 +384,10 @@ void AccuWeather::updateForecast(int index, const long time, int temperature, in
         return;
     }
 
-    LOG_INFOF("[AccuWeather updateForecast] Updating index %d with: time=%ld, temp=%d, humidity=%d, icon=%d\n", 
+    LOG_DEBUGF("[AccuWeather updateForecast] Updating index %d with: time=%ld, temp=%d, humidity=%d, icon=%d\n", 
                  index, time, temperature, humidity, icon);
 
+    Display::LockComposition();
     forecasts[index].time = time;
     forecasts[index].temperature = temperature;
     forecasts[index].humidity = humidity;
@@ -408,13 +400,13 @@ void AccuWeather::updateForecast(int index, const long time, int temperature, in
     } else {
         forecasts[index].phrase[0] = '\0';
     }
+    forecastRevision++;
+    Display::UnlockComposition();
 
-    LOG_INFOF("Updated forecast %d: temp=%d, humidity=%d, icon=%d\n", index, temperature, humidity, icon);
-    LOG_INFOF("[AccuWeather updateForecast] Forecast array after update: time=%ld, temp=%d, humidity=%d\n", 
+    LOG_DEBUGF("Updated forecast %d: temp=%d, humidity=%d, icon=%d\n", index, temperature, humidity, icon);
+    LOG_DEBUGF("[AccuWeather updateForecast] Forecast array after update: time=%ld, temp=%d, humidity=%d\n", 
                  forecasts[index].time, forecasts[index].temperature, forecasts[index].humidity);
 
-    // Temporarily disable automatic EEPROM save to avoid issues with partial data
-    // saveToEEPROM();
 }
 
 void AccuWeather::updateForecast(int index, const Forecast& forecast) {
@@ -423,12 +415,12 @@ void AccuWeather::updateForecast(int index, const Forecast& forecast) {
         return;
     }
 
+    Display::LockComposition();
     forecasts[index] = forecast;
+    forecastRevision++;
+    Display::UnlockComposition();
 
     LOG_INFOF("Updated forecast %d from Forecast object\n", index);
-
-    // Automatically save to EEPROM after update
-    saveToEEPROM();
 }
 
 AccuWeather::Forecast AccuWeather::getForecast(int index) const {
@@ -443,12 +435,15 @@ AccuWeather::Forecast AccuWeather::getForecast(int index) const {
 void AccuWeather::clearForecasts() {
     LOG_INFO("Clearing all forecasts...");
 
+    Display::LockComposition();
     for (int i = 0; i < 6; i++) {  // Updated for 6 forecasts
         forecasts[i] = Forecast();
     }
+    forecastRevision++;
+    Display::UnlockComposition();
 
-    // Save cleared state to EEPROM
-    saveToEEPROM();
+    // Save cleared state
+    saveForecasts();
 }
 
 bool AccuWeather::hasForecastData() const {
@@ -582,60 +577,202 @@ const uint8_t* AccuWeather::weatherIcon(int p) {
     return Sunny_01_16;
 }
 
+void AccuWeather::buildIconFrames() {
+    if (iconFrames != nullptr) {
+        return;
+    }
+
+    // Collect each distinct bitmap once; several condition codes share an icon
+    iconFrameCount = 0;
+    for (int code = 1; code <= 44; code++) {
+        const uint8_t* icon = weatherIcon(code);
+        bool known = false;
+        for (int i = 0; i < iconFrameCount; i++) {
+            known = known || iconFrameSources[i] == icon;
+        }
+        if (!known && iconFrameCount < MAX_ANIMATED_ICONS) {
+            iconFrameSources[iconFrameCount++] = icon;
+        }
+    }
+
+    size_t bytes = (size_t)iconFrameCount * ICON_ANIMATION_PHASES * ICON_FRAME_BYTES;
+    iconFrames = (uint8_t*)heap_caps_calloc(1, bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (iconFrames == nullptr) {
+        LOG_WARNINGF("AccuWeather: No memory for icon animation (%u bytes), icon will be static\n", (unsigned)bytes);
+        iconFrameCount = 0;
+        return;
+    }
+
+    // Same nearest-neighbour scaling the dashboard used to run per pixel on every frame
+    for (int phase = 0; phase < ICON_ANIMATION_PHASES; phase++) {
+        float t = (float)phase * ICON_PULSE_PERIOD_MS / ICON_ANIMATION_PHASES;
+        float scale = 1.0f + 0.1f * sin(t / 1000.0f);
+
+        for (int i = 0; i < iconFrameCount; i++) {
+            const uint8_t* icon = iconFrameSources[i];
+            uint8_t* frame = iconFrames + ((size_t)i * ICON_ANIMATION_PHASES + phase) * ICON_FRAME_BYTES;
+
+            for (int y = 0; y < ICON_FRAME_SIZE; y++) {
+                for (int x = 0; x < ICON_FRAME_SIZE; x++) {
+                    int srcX = ((x * 18) / ICON_FRAME_SIZE) / scale;
+                    int srcY = ((y * 18) / ICON_FRAME_SIZE) / scale;
+                    if (srcX < ICON_SOURCE_SIZE && srcY < ICON_SOURCE_SIZE &&
+                        (pgm_read_byte(&icon[srcY * 2 + srcX / 8]) & (1 << (srcX % 8)))) {
+                        frame[y * ICON_FRAME_STRIDE + x / 8] |= 1 << (x % 8);
+                    }
+                }
+            }
+        }
+    }
+
+    LOG_INFOF("AccuWeather: %d icons x %d animation frames prepared (%u bytes)\n", iconFrameCount,
+              ICON_ANIMATION_PHASES, (unsigned)bytes);
+}
+
+const uint8_t* AccuWeather::getIconFrame(const uint8_t* icon, unsigned long now) const {
+    for (int i = 0; i < iconFrameCount; i++) {
+        if (iconFrameSources[i] == icon) {
+            int phase = (now % ICON_PULSE_PERIOD_MS) * ICON_ANIMATION_PHASES / ICON_PULSE_PERIOD_MS;
+            return iconFrames + ((size_t)i * ICON_ANIMATION_PHASES + phase) * ICON_FRAME_BYTES;
+        }
+    }
+    return nullptr;
+}
+
 bool AccuWeather::IsReady() { return ready; }
 
+uint32_t AccuWeather::GetRedrawInterval() {
+    // Static "No Weather" text only changes when a fetch completes, which requests a redraw itself
+    if (!ready || forecasts[0].time == 0) {
+        return REDRAW_NEVER;
+    }
+
+    // Wake exactly when the pulsing icon moves to its next precomputed frame
+    uint32_t position = millis() % ICON_PULSE_PERIOD_MS;
+    uint32_t nextPhase = position * ICON_ANIMATION_PHASES / ICON_PULSE_PERIOD_MS + 1;
+    uint32_t boundary = (nextPhase * ICON_PULSE_PERIOD_MS + ICON_ANIMATION_PHASES - 1) / ICON_ANIMATION_PHASES;
+    return boundary - position;
+}
+
+bool AccuWeather::GetBounds(Bounds& bounds) const {
+    bounds.x = moduleConfig.positionX;
+    bounds.y = moduleConfig.positionY;
+    bounds.width = moduleConfig.width;
+    bounds.height = moduleConfig.height;
+    return true;
+}
+
+uint32_t AccuWeather::GetContentVersion() {
+    // Draw() depends on the forecasts, the local hour (which rows are shown) and the icon pulse phase
+    time_t now = time(nullptr);
+    uint32_t hour = (uint32_t)((now + TimezoneUtils::getOffsetAt(now)) / 3600);
+    uint32_t phase = (millis() % ICON_PULSE_PERIOD_MS) * ICON_ANIMATION_PHASES / ICON_PULSE_PERIOD_MS;
+
+    uint32_t version = forecastRevision.load(std::memory_order_relaxed);
+    version = version * 31 + hour;
+    version = version * 31 + phase;
+    version = version * 2 + (ready ? 1 : 0);
+    return version == CONTENT_UNVERSIONED ? 1 : version;
+}
+
 bool AccuWeather::isDataFresh() const {
-    // Check if we have no data saved
-    if (lastDataSaveTime == 0) {
+    CacheService::Freshness freshness;
+    if (!CacheService::getInstance()->getFreshness(CACHE_NAMESPACE, CACHE_FORECASTS, freshness)) {
         LOG_INFO("No data saved, data is not fresh");
         return false;
     }
 
-    // Get current Unix timestamp
-    time_t currentTime = time(nullptr);
-    
-    // Check if system time is synchronized (should be > year 2020)
-    if (currentTime < 1577836800) {  // Jan 1, 2020 00:00:00 UTC
+    if (freshness.age < 0) {
         LOG_INFO("System time not synchronized, treating data as stale");
         return false;
     }
 
-    // Calculate age in seconds
-    time_t dataAge = currentTime - lastDataSaveTime;
-    const time_t TWO_HOURS = 2 * 60 * 60;  // 2 hours in seconds
+    LOG_INFOF("Data is %s: age=%ld seconds (ttl %lu seconds)\n", freshness.fresh ? "fresh" : "stale",
+              (long)freshness.age, (unsigned long)freshness.ttlSeconds);
+    return freshness.fresh;
+}
 
-    // Convert to human readable for debugging
-    struct tm* savedTimeinfo = localtime(&lastDataSaveTime);
-    struct tm* currentTimeinfo = localtime(&currentTime);
-    
-    if (savedTimeinfo && currentTimeinfo) {
-        char savedTimeStr[64], currentTimeStr[64];
-        strftime(savedTimeStr, sizeof(savedTimeStr), "%H:%M:%S", savedTimeinfo);
-        strftime(currentTimeStr, sizeof(currentTimeStr), "%H:%M:%S", currentTimeinfo);
-        LOG_INFOF("Data saved at: %s, current time: %s, age: %ld seconds\n", 
-                     savedTimeStr, currentTimeStr, dataAge);
+RefreshScheduler::Config AccuWeather::makeSchedule() const {
+    RefreshScheduler::Config schedule;
+    schedule.intervalSeconds = moduleConfig.refreshIntervalMinutes * 60;
+    schedule.leadSeconds = moduleConfig.refreshLeadSeconds;
+    schedule.dailyBudget = moduleConfig.dailyBudget;
+    return schedule;
+}
+
+void AccuWeather::Reconfigure(const ConfigSection& section) {
+    // Fetches read the API key and city on the module task, so the change is applied there
+    reconfigurePending.store(true);
+    if (taskHandle != NULL) {
+        xTaskNotifyGive(taskHandle);
     }
+}
 
-    if (dataAge < TWO_HOURS && dataAge >= 0) {
-        LOG_INFOF("Data is fresh: age=%ld seconds (<%ld seconds)\n", dataAge, TWO_HOURS);
-        return true;
-    } else {
-        LOG_INFOF("Data is stale: age=%ld seconds (>=%ld seconds)\n", dataAge, TWO_HOURS);
+bool AccuWeather::sleepOrReconfigure(TickType_t ticks) {
+    if (!Sleep(ticks)) {
         return false;
     }
+    if (reconfigurePending.exchange(false)) {
+        applyReconfiguration();
+    }
+    return true;
 }
 
-bool AccuWeather::fetchWeatherData() {
-    // Request memory for weather data fetch operation
-    if (!MEMORY_REQUEST(MemoryManager::Operation::HTTP_REQUEST, 
-                       MemoryManager::Priority::NORMAL, 
-                       8192, "AccuWeather-Fetch")) {
-        LOG_INFO("AccuWeather: Cannot get memory for weather fetch, skipping");
-        TerminalEvent event(0, "AW", "Memory unavailable", TerminalEvent::State::FAILURE);
-        EventManager::Emit(event);
-        return false;
+bool AccuWeather::waitForWiFi() {
+    while (!WiFiManager::IsConnected()) {
+        if (!sleepOrReconfigure(pdMS_TO_TICKS(WIFI_POLL_MS))) {
+            return false;
+        }
     }
+    return true;
+}
 
+void AccuWeather::applyReconfiguration() {
+    ConfigManager* configManager = ConfigManager::getInstance();
+    ConfigSection section = configManager->getConfigSection("accuweather");
+    section.keyValuePairs["systemTimezone"] = configManager->getSystemTimezone();
+
+    String previousCity = moduleConfig.city;
+    String previousKey = moduleConfig.apiKey;
+    Display::LockComposition();
+    bool valid = ConfigureFromSection(section);
+    Display::UnlockComposition();
+    Display::InvalidateDashboard();
+
+    // Another location or key makes the cached forecast irrelevant; otherwise only the plan changes
+    bool fetchNow = valid && (moduleConfig.city != previousCity || moduleConfig.apiKey != previousKey);
+    scheduler.start(makeSchedule(), fetchNow);
+    LOG_INFOF("AccuWeather: Reconfigured, next fetch in %lu s\n", (unsigned long)(scheduler.getDelayMs() / 1000));
+}
+
+void AccuWeather::runDiagnosticFetches() {
+    HttpService* http = HttpService::getInstance();
+    for (int run = 0; run < Diagnostics::GetFetchRuns(); run++) {
+        if (!WiFiManager::IsConnected() || !scheduler.beginRequest()) {
+            LOG_WARNING("AccuWeather: Diagnostic fetches stopped, offline or out of budget");
+            break;
+        }
+        if (run == 0) {
+            http->dropConnection();
+        }
+        // A 304 would skip reading and parsing, which is what is being measured
+        http->forgetValidators();
+
+        HttpService::RequestTiming timing = {};
+        int httpCode = 0;
+        RefreshScheduler::Outcome outcome = fetchWeatherData(&timing, &httpCode);
+        scheduler.report(outcome);
+        Metrics::Add(outcome == RefreshScheduler::Outcome::SUCCESS ? fetchSuccessMetric : fetchFailureMetric);
+        ready = outcome == RefreshScheduler::Outcome::SUCCESS || hasForecastData();
+        Diagnostics::ReportFetch("AW", run, httpCode, timing);
+        if (outcome != RefreshScheduler::Outcome::SUCCESS) {
+            break;
+        }
+    }
+    Display::RequestRedraw();
+}
+
+RefreshScheduler::Outcome AccuWeather::fetchWeatherData(HttpService::RequestTiming* timing, int* statusCode) {
     // Check if API key and city are configured
     if (moduleConfig.apiKey.isEmpty() || moduleConfig.city.isEmpty()) {
         LOG_INFO("AccuWeather API key or city not configured");
@@ -643,9 +780,7 @@ bool AccuWeather::fetchWeatherData() {
         LOG_INFOF("City: %s\n", moduleConfig.city.isEmpty() ? "EMPTY" : moduleConfig.city.c_str());
         TerminalEvent event(0, "AW", "API key or city not configured", TerminalEvent::State::FAILURE);
         EventManager::Emit(event);
-        
-        MEMORY_RELEASE(MemoryManager::Operation::HTTP_REQUEST, "AccuWeather-Fetch");
-        return false;
+        return RefreshScheduler::Outcome::FATAL_ERROR;
     }
 
     // Verify WiFi connection before making request
@@ -653,15 +788,10 @@ bool AccuWeather::fetchWeatherData() {
         LOG_INFO("[AccuWeather] WiFi not connected, cannot fetch weather data");
         TerminalEvent event(0, "AW", "WiFi not connected", TerminalEvent::State::FAILURE);
         EventManager::Emit(event);
-        
-        MEMORY_RELEASE(MemoryManager::Operation::HTTP_REQUEST, "AccuWeather-Fetch");
-        return false;
+        return RefreshScheduler::Outcome::TRANSIENT_ERROR;
     }
-    
-    LOG_INFOF("[AccuWeather] WiFi status: %d, RSSI: %d dBm\n", WiFi.status(), WiFi.RSSI());
 
-    // Create HTTP client
-    HTTPClient http;
+    LOG_INFOF("[AccuWeather] WiFi status: %d, RSSI: %d dBm\n", WiFi.status(), WiFi.RSSI());
 
     // Build URL for 12-hour forecast with details to ensure all fields are present
     String url = "http://dataservice.accuweather.com/forecasts/v1/hourly/12hour/" + moduleConfig.city +
@@ -669,507 +799,136 @@ bool AccuWeather::fetchWeatherData() {
 
     LOG_INFO("Fetching weather data from AccuWeather API");
     LOG_INFOF("City ID: %s\n", moduleConfig.city.c_str());
-    LOG_INFOF("API Key: %s\n", moduleConfig.apiKey.c_str());
-    LOG_INFOF("Full URL: %s\n", url.c_str());
-    LOG_INFOF("URL length: %d\n", url.length());
 
-    // Configure HTTP client
-    http.begin(url);
-    http.setTimeout(10000);  // 10 seconds timeout
-    
-    // Add headers for better compatibility - use standard browser User-Agent
-    http.addHeader("User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/91.0.4472.124 Safari/537.36");
-    http.addHeader("Accept", "application/json");
-    http.addHeader("Accept-Encoding", "identity"); // Disable compression to avoid issues
-    http.addHeader("Connection", "close");
-
-    // Send GET request
-    int httpCode = http.GET();
+    // The shared service owns the socket, memory reservation and conditional-request validators
+    String errorResponse;
+    int httpCode = HttpService::getInstance()->get(
+        url, [this](Stream& body) { return parseWeatherData(body); }, "AccuWeather-Fetch", &errorResponse,
+        "application/json", timing);
+    if (statusCode != nullptr) {
+        *statusCode = httpCode;
+    }
 
     LOG_INFOF("HTTP response code: %d\n", httpCode);
-    
-    // Debug: Print response headers
-    String contentLength = http.header("Content-Length");
-    String contentType = http.header("Content-Type");
-    String server = http.header("Server");
-    LOG_INFOF("Content-Length: %s\n", contentLength.c_str());
-    LOG_INFOF("Content-Type: %s\n", contentType.c_str());
-    LOG_INFOF("Server: %s\n", server.c_str());
-    LOG_INFOF("Response size from getSize(): %d\n", http.getSize());
-
-    if (httpCode > 0) {
-        if (httpCode == HTTP_CODE_OK) {
-            int contentLength = http.getSize();
-            LOG_INFOF("[AccuWeather] Expected content length: %d bytes\n", contentLength);
-            
-            String payload = "";
-            
-            if (contentLength > 0) {
-                // Method 1: Read in small chunks to avoid memory issues
-                WiFiClient* stream = http.getStreamPtr();
-                if (stream) {
-                    LOG_INFOF("[AccuWeather] Free heap before reading: %d bytes\n", ESP.getFreeHeap());
-                    
-                    const int CHUNK_SIZE = 1024; // Read 1KB at a time
-                    char chunk[CHUNK_SIZE + 1];
-                    int totalBytesRead = 0;
-                    
-                    unsigned long startTime = millis();
-                    const unsigned long timeout = 10000; // 10 seconds
-                    
-                    LOG_INFO("[AccuWeather] Starting chunked read...");
-                    payload.reserve(contentLength > 8192 ? 8192 : contentLength); // Reserve reasonable amount
-                    
-                    while (totalBytesRead < contentLength && (millis() - startTime < timeout)) {
-                        if (stream->available()) {
-                            int available = stream->available();
-                            int toRead = min(available, min(CHUNK_SIZE, contentLength - totalBytesRead));
-                            int actualRead = stream->readBytes(chunk, toRead);
-                            
-                            if (actualRead > 0) {
-                                // Create String from buffer with explicit length to avoid null-termination issues
-                                String chunkStr = "";
-                                chunkStr.reserve(actualRead + 10);
-                                for (int i = 0; i < actualRead; i++) {
-                                    chunkStr += (char)chunk[i];
-                                }
-                                payload += chunkStr;
-                                totalBytesRead += actualRead;
-                                
-                                LOG_INFOF("[AccuWeather] Read chunk %d bytes, total: %d/%d, heap: %d\n", 
-                                             actualRead, totalBytesRead, contentLength, ESP.getFreeHeap());
-                            }
-                        } else {
-                            delay(10);
-                        }
-                    }
-                    
-                    LOG_INFOF("[AccuWeather] Chunked read completed: %d bytes, String length: %d\n", 
-                                 totalBytesRead, payload.length());
-                }
-                LOG_INFOF("[AccuWeather] Stream method: payload size: %d bytes\n", payload.length());
-            }
-            
-            // Fallback to getString() if stream method failed or no content-length
-            if (payload.length() == 0) {
-                LOG_INFO("[AccuWeather] Trying getString() method...");
-                payload = http.getString();
-                LOG_INFOF("[AccuWeather] getString() method: payload size: %d bytes\n", payload.length());
-            }
-            
-            LOG_INFOF("[AccuWeather] Final payload size: %d bytes\n", payload.length());
-
-            // Check if response is empty
-            if (payload.length() == 0) {
-                LOG_INFO("[AccuWeather] Empty response from API");
-                TerminalEvent event(0, "AW", "Empty API response", TerminalEvent::State::FAILURE);
-                EventManager::Emit(event);
-                http.end();
-                MEMORY_RELEASE(MemoryManager::Operation::HTTP_REQUEST, "AccuWeather-Fetch");
-                return false;
-            }
 
-            // Check if response looks like JSON
-            payload.trim(); // Remove any leading/trailing whitespace
-            if (!payload.startsWith("{") && !payload.startsWith("[")) {
-                LOG_INFO("[AccuWeather] Response is not JSON format");
-                LOG_INFOF("[AccuWeather] Response content: %s\n", payload.c_str());
-                TerminalEvent event(0, "AW", "Invalid response format", TerminalEvent::State::FAILURE);
-                EventManager::Emit(event);
-                http.end();
-                MEMORY_RELEASE(MemoryManager::Operation::HTTP_REQUEST, "AccuWeather-Fetch");
-                return false;
-            }
-
-            // Parse JSON response
-            LOG_INFO("[AccuWeather] Starting JSON parsing...");
-            if (!parseWeatherData(payload)) {
-                LOG_INFO("[AccuWeather] JSON parsing failed!");
-                http.end();
-                MEMORY_RELEASE(MemoryManager::Operation::HTTP_REQUEST, "AccuWeather-Fetch");
-                return false;
-            }
-            LOG_INFO("[AccuWeather] JSON parsing completed successfully!");
-
-            TerminalEvent event(0, "AW", "Weather data updated", TerminalEvent::State::SUCCESS);
-            EventManager::Emit(event);
-            http.end();
-            MEMORY_RELEASE(MemoryManager::Operation::HTTP_REQUEST, "AccuWeather-Fetch");
-            return true;
-        } else {
-            // Get error response for debugging
-            String errorResponse = http.getString();
-            LOG_INFOF("HTTP error: %d\n", httpCode);
-            LOG_INFOF("Error response: %s\n", errorResponse.c_str());
-            
-            // Handle specific AccuWeather API error codes
-            if (httpCode == 401) {
-                LOG_INFO("Invalid API key");
-                TerminalEvent event(0, "AW", "Invalid API key", TerminalEvent::State::FAILURE);
-                EventManager::Emit(event);
-            } else if (httpCode == 400) {
-                LOG_INFO("Bad request - check city ID");
-                TerminalEvent event(0, "AW", "Bad request", TerminalEvent::State::FAILURE);
-                EventManager::Emit(event);
-            } else if (httpCode == 403) {
-                LOG_INFO("API key exceeded quota");
-                TerminalEvent event(0, "AW", "API quota exceeded", TerminalEvent::State::FAILURE);
-                EventManager::Emit(event);
-            } else {
-                TerminalEvent event(0, "AW", "HTTP error " + String(httpCode), TerminalEvent::State::FAILURE);
-                EventManager::Emit(event);
-            }
-            
-            http.end();
-            MEMORY_RELEASE(MemoryManager::Operation::HTTP_REQUEST, "AccuWeather-Fetch");
-            return false;
-        }
-    } else {
-        LOG_INFOF("HTTP connection failed: %s\n", http.errorToString(httpCode).c_str());
-        TerminalEvent event(0, "AW", "Connection failed", TerminalEvent::State::FAILURE);
+    if (httpCode == HTTP_CODE_OK) {
+        LOG_INFO("[AccuWeather] JSON parsing completed successfully!");
+        TerminalEvent event(0, "AW", "Weather data updated", TerminalEvent::State::SUCCESS);
         EventManager::Emit(event);
-        http.end();
-        MEMORY_RELEASE(MemoryManager::Operation::HTTP_REQUEST, "AccuWeather-Fetch");
-        return false;
+        return RefreshScheduler::Outcome::SUCCESS;
     }
-}
 
-bool AccuWeather::parseWeatherData(const String& jsonData) {
-    // Request memory for JSON parsing operation - reduced size
-    if (!MEMORY_REQUEST(MemoryManager::Operation::JSON_PARSING, 
-                       MemoryManager::Priority::NORMAL, 
-                       8192, "AccuWeather-Parse")) {
-        LOG_INFO("AccuWeather: Cannot get memory for JSON parsing, skipping");
-        TerminalEvent event(0, "AW", "Memory unavailable for parsing", TerminalEvent::State::FAILURE);
+    if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+        // Forecast unchanged on the server: keep the data we have and mark it fresh again
+        LOG_INFO("[AccuWeather] Forecast not modified since last fetch");
+        saveForecasts(false);
+        TerminalEvent event(0, "AW", "Weather data unchanged", TerminalEvent::State::SUCCESS);
         EventManager::Emit(event);
-        return false;
+        return RefreshScheduler::Outcome::SUCCESS;
     }
 
-    // Log JSON data size for debugging
-    LOG_INFOF("[AccuWeather] JSON data size: %d bytes\n", jsonData.length());
-    
-    // Log first 200 characters of JSON for debugging
-    LOG_INFO("[AccuWeather] JSON response preview:");
-    LOG_INFO(jsonData.substring(0, 200));
-    
-    // Check if response looks like an error
-    if (jsonData.indexOf("\"fault\"") != -1 || jsonData.indexOf("\"error\"") != -1) {
-        LOG_INFO("AccuWeather API returned error response");
-        LOG_INFO("Full response: " + jsonData);
-        TerminalEvent event(0, "AW", "API returned error", TerminalEvent::State::FAILURE);
-        EventManager::Emit(event);
-        
-        MEMORY_RELEASE(MemoryManager::Operation::JSON_PARSING, "AccuWeather-Parse");
-        return false;
+    if (httpCode == HttpService::ERROR_BODY_REJECTED) {
+        // parseWeatherData() already reported the reason
+        LOG_INFO("[AccuWeather] JSON parsing failed!");
+        return RefreshScheduler::Outcome::TRANSIENT_ERROR;
     }
 
-    // Parse detailed response (12 hours, with details) - use smaller buffer
-    DynamicJsonDocument doc(8 * 1024);  // 8KB - further reduced for memory constraints
-
-    DeserializationError error = deserializeJson(doc, jsonData);
-    if (error) {
-        LOG_INFOF("[AccuWeather] JSON parsing failed: %s\n", error.c_str());
-        LOG_INFOF("[AccuWeather] Free heap after failed parsing: %d bytes\n", ESP.getFreeHeap());
-        
-        // If memory error, try alternative simple parsing for first few forecasts
-        if (error == DeserializationError::NoMemory) {
-            LOG_INFO("[AccuWeather] Trying simple text parsing due to memory constraints...");
-            return parseWeatherDataSimple(jsonData);
+    if (httpCode > 0) {
+        LOG_INFOF("HTTP error: %d\n", httpCode);
+        LOG_INFOF("Error response: %s\n", errorResponse.c_str());
+
+        // Handle specific AccuWeather API error codes
+        if (httpCode == 401) {
+            LOG_INFO("Invalid API key");
+            TerminalEvent event(0, "AW", "Invalid API key", TerminalEvent::State::FAILURE);
+            EventManager::Emit(event);
+            return RefreshScheduler::Outcome::FATAL_ERROR;
+        } else if (httpCode == 400) {
+            LOG_INFO("Bad request - check city ID");
+            TerminalEvent event(0, "AW", "Bad request", TerminalEvent::State::FAILURE);
+            EventManager::Emit(event);
+            return RefreshScheduler::Outcome::FATAL_ERROR;
+        } else if (httpCode == 403) {
+            LOG_INFO("API key exceeded quota");
+            TerminalEvent event(0, "AW", "API quota exceeded", TerminalEvent::State::FAILURE);
+            EventManager::Emit(event);
+            return RefreshScheduler::Outcome::QUOTA_EXCEEDED;
+        } else {
+            TerminalEvent event(0, "AW", "HTTP error " + String(httpCode), TerminalEvent::State::FAILURE);
+            EventManager::Emit(event);
         }
-        
-        LOG_INFO("[AccuWeather] JSON that failed to parse:");
-        LOG_INFO(jsonData.substring(0, 500)); // Show only first 500 chars
-        TerminalEvent event(0, "AW", "JSON parsing failed", TerminalEvent::State::FAILURE);
-        EventManager::Emit(event);
-        return false;
+        return RefreshScheduler::Outcome::TRANSIENT_ERROR;
     }
 
-    LOG_INFOF("[AccuWeather] JSON parsing successful, free heap: %d bytes\n", ESP.getFreeHeap());
-
-    // Check if response is an array
-    if (!doc.is<JsonArray>()) {
-        LOG_INFO("[AccuWeather] API response is not an array");
-        LOG_INFO("[AccuWeather] Full response: " + jsonData);
-        TerminalEvent event(0, "AW", "Invalid response format", TerminalEvent::State::FAILURE);
+    LOG_INFOF("HTTP request failed: %s\n", HttpService::errorToString(httpCode).c_str());
+    if (httpCode == HttpService::ERROR_NO_MEMORY) {
+        TerminalEvent event(0, "AW", "Memory unavailable", TerminalEvent::State::FAILURE);
+        EventManager::Emit(event);
+    } else {
+        TerminalEvent event(0, "AW", "Connection failed", TerminalEvent::State::FAILURE);
         EventManager::Emit(event);
-        return false;
     }
-    
-    // Clear existing forecasts
-    clearForecasts();
+    return RefreshScheduler::Outcome::TRANSIENT_ERROR;
+}
+
+bool AccuWeather::parseWeatherData(Stream& stream) {
+    // The handler runs inside the HTTP request reservation, so its PSRAM arena can hold the document
+    PsramArena* arena = MemoryManager::getInstance()->getArena(MemoryManager::Operation::HTTP_REQUEST);
+    BasicJsonDocument<ArenaJsonAllocator> entry(ForecastParser::ENTRY_DOCUMENT_SIZE, ArenaJsonAllocator(arena));
 
     // Get current time rounded to current hour for filtering (all in UTC for proper comparison)
     time_t currentTime = time(nullptr);  // This is UTC time
-    
+
     // Get timezone offset to convert current time to local time for hour calculation
-    ConfigManager* configManager = ConfigManager::getInstance();
-    String timezone = configManager->getSystemTimezone();
-    int timezoneOffset = TimezoneUtils::getTimezoneOffset(timezone);
-    
+    int timezoneOffset = TimezoneUtils::getOffsetAt(currentTime);
+
     // Apply timezone offset to get local time
     time_t localCurrentTime = currentTime + timezoneOffset;
-    
+
     // Round down to the current hour in local time using simple math
     time_t currentHourTimeUTC = (localCurrentTime / 3600) * 3600 - timezoneOffset;
     // We want to show forecasts from next hour onwards, not current hour
     time_t nextHourTimeUTC = currentHourTimeUTC + 3600;
-    
-    LOG_INFOF("[AccuWeather] Current UTC time: %ld, local time: %ld, current hour UTC: %ld, next hour UTC: %ld\n", 
-                 currentTime, localCurrentTime, currentHourTimeUTC, nextHourTimeUTC);
-    LOG_INFOF("[AccuWeather] Timezone: %s, offset: %d seconds\n", timezone.c_str(), timezoneOffset);
-
-    // Process each forecast entry
-    JsonArray forecastsArray = doc.as<JsonArray>();
-    int index = 0;
-    int processedEntries = 0;
-    
-    LOG_INFOF("[AccuWeather] Processing %d forecast entries\n", forecastsArray.size());
 
-    for (JsonObject forecast : forecastsArray) {
-        if (index >= 6) break;  // We only store first 6 out of 12 forecasts for memory optimization
+    LOG_INFOF("[AccuWeather] Current UTC time: %ld, local time: %ld, current hour UTC: %ld, next hour UTC: %ld\n",
+                 currentTime, localCurrentTime, currentHourTimeUTC, nextHourTimeUTC);
+    LOG_INFOF("[AccuWeather] Timezone offset: %d seconds\n", timezoneOffset);
 
-        LOG_INFOF("[AccuWeather] === Processing forecast entry %d ===\n", processedEntries);
-        
-        // Extract forecast data with validation - detailed debugging
-        LOG_INFOF("[AccuWeather] Forecast entry %d keys:\n", processedEntries);
-        for (JsonPair kv : forecast) {
-            LOG_INFOF("[AccuWeather]   '%s'\n", kv.key().c_str());
-        }
-        
-        bool hasEpochDateTime = forecast.containsKey("EpochDateTime");
-        bool hasDateTime = forecast.containsKey("DateTime");
-        bool hasTemperature = forecast.containsKey("Temperature");
-        bool hasIconPhrase = forecast.containsKey("IconPhrase");
-        bool hasWeatherIcon = forecast.containsKey("WeatherIcon");
-        bool hasHumidity = forecast.containsKey("RelativeHumidity");
-        
-        LOG_INFOF("Entry %d: EpochDateTime=%s, DateTime=%s, Temperature=%s, IconPhrase=%s, WeatherIcon=%s, Humidity=%s\n",
-                     processedEntries, hasEpochDateTime ? "YES" : "NO", hasDateTime ? "YES" : "NO", 
-                     hasTemperature ? "YES" : "NO", hasIconPhrase ? "YES" : "NO", hasWeatherIcon ? "YES" : "NO",
-                     hasHumidity ? "YES" : "NO");
-        
-        if (!hasEpochDateTime && !hasDateTime) {
-            LOG_INFOF("Forecast entry %d missing time field - SKIPPING\n", processedEntries);
-            processedEntries++;
-            continue;
-        }
-        if (!hasTemperature || !hasIconPhrase || !hasWeatherIcon) {
-            LOG_INFOF("Forecast entry %d missing required fields - SKIPPING\n", processedEntries);
-            processedEntries++;
-            continue;
-        }
+    // Parsed off to the side; Draw() keeps showing the previous set until it is published whole
+    int count = 0;
+    ForecastParser::Result result = ForecastParser::parse(stream, entry, nextHourTimeUTC, staged, 6, count);
 
-        // Get time (prefer EpochDateTime, fallback to parsing DateTime)
-        long epochTime = 0;
-        if (hasEpochDateTime) {
-            epochTime = forecast["EpochDateTime"];
-            LOG_INFOF("Entry %d: Got EpochDateTime = %ld\n", processedEntries, epochTime);
-        } else if (hasDateTime) {
-            // TODO: Parse DateTime string if needed
-            epochTime = 0; // For now, set to 0 to skip this entry
-            LOG_INFOF("Entry %d: DateTime parsing not implemented yet - SKIPPING\n", processedEntries);
-            processedEntries++;
-            continue;
-        }
-        
-        // Filter out forecasts from past and current hour (comparing UTC times)
-        if (epochTime < nextHourTimeUTC) {
-            LOG_INFOF("Entry %d: Forecast time %ld is before next hour %ld (UTC) - SKIPPING\n", 
-                         processedEntries, epochTime, nextHourTimeUTC);
-            processedEntries++;
-            continue;
-        }
-        
-        if (!forecast["Temperature"].containsKey("Value")) {
-            LOG_INFOF("Forecast entry %d missing Temperature.Value - SKIPPING\n", processedEntries);
-            processedEntries++;
-            continue;
-        }
-        
-        int temperature = forecast["Temperature"]["Value"];
-        int humidity = hasHumidity ? (int)forecast["RelativeHumidity"] : 0;
-        const char* phrase = forecast["IconPhrase"];
-        int icon = forecast["WeatherIcon"];
-
-        LOG_INFOF("[AccuWeather] Forecast %d BEFORE UPDATE: time=%ld, temp=%d, humidity=%d, icon=%d, phrase=%s\n", 
-                     index, epochTime, temperature, humidity, icon, phrase);
-
-        // Update forecast
-        updateForecast(index, epochTime, temperature, humidity, phrase, icon);
-        
-        // Verify that the forecast was actually saved
-        LOG_INFOF("[AccuWeather] Forecast %d AFTER UPDATE: time=%ld, temp=%d, humidity=%d, icon=%d\n", 
-                     index, forecasts[index].time, forecasts[index].temperature, 
-                     forecasts[index].humidity, forecasts[index].icon);
-        
-        index++;
-        processedEntries++;
+    const char* failure = nullptr;
+    switch (result) {
+        case ForecastParser::Result::OK:
+            break;
+        case ForecastParser::Result::EMPTY:
+            failure = "Empty API response";
+            break;
+        case ForecastParser::Result::API_ERROR:
+            failure = "API returned error";
+            break;
+        case ForecastParser::Result::NOT_JSON:
+            failure = "Invalid response format";
+            break;
+        case ForecastParser::Result::PARSE_ERROR:
+            failure = "JSON parsing failed";
+            break;
+        case ForecastParser::Result::NO_FORECASTS:
+            LOG_INFO("[AccuWeather] No valid forecasts found in response");
+            failure = "No forecasts in response";
+            break;
     }
-
-    LOG_INFOF("[AccuWeather] Successfully parsed %d forecasts\n", index);
-    
-    if (index == 0) {
-        LOG_INFO("[AccuWeather] No valid forecasts found in response");
-        TerminalEvent event(0, "AW", "No forecasts in response", TerminalEvent::State::FAILURE);
+    if (failure != nullptr) {
+        TerminalEvent event(0, "AW", failure, TerminalEvent::State::FAILURE);
         EventManager::Emit(event);
         return false;
     }
-    
-    // Save all forecasts to EEPROM after successful parsing
-    LOG_INFO("[AccuWeather] Saving all forecasts to EEPROM after parsing...");
-    saveToEEPROM();
-    
-    // Debug: Print all forecasts after saving
-    LOG_INFO("[AccuWeather] All forecasts after saving to EEPROM:");
-    for (int i = 0; i < 6; i++) {
-        LOG_INFOF("  Forecast %d: time=%ld, temp=%d, humidity=%d, icon=%d\n", 
-                     i, forecasts[i].time, forecasts[i].temperature, 
-                     forecasts[i].humidity, forecasts[i].icon);
-    }
-    
-    MEMORY_RELEASE(MemoryManager::Operation::JSON_PARSING, "AccuWeather-Parse");
-    return true;
-}
+    publishForecasts(staged);
 
-bool AccuWeather::parseWeatherDataSimple(const String& jsonData) {
-    LOG_INFO("[AccuWeather] Starting simple text-based parsing...");
-    
-    // Clear existing forecasts
-    clearForecasts();
-    
-    // Get current time rounded to current hour for filtering (all in UTC for proper comparison)
-    time_t currentTime = time(nullptr);  // This is UTC time
-    
-    // Get timezone offset to convert current time to local time for hour calculation  
-    ConfigManager* configManager = ConfigManager::getInstance();
-    String timezone = configManager->getSystemTimezone();
-    int timezoneOffset = TimezoneUtils::getTimezoneOffset(timezone);
-    
-    // Apply timezone offset to get local time
-    time_t localCurrentTime = currentTime + timezoneOffset;
-    
-    // Round down to the current hour in local time using simple math
-    time_t currentHourTimeUTC = (localCurrentTime / 3600) * 3600 - timezoneOffset;
-    // We want to show forecasts from next hour onwards, not current hour
-    time_t nextHourTimeUTC = currentHourTimeUTC + 3600;
-    
-    LOG_INFOF("[AccuWeather] Simple parse - Current UTC time: %ld, local time: %ld, current hour UTC: %ld, next hour UTC: %ld\n", 
-                 currentTime, localCurrentTime, currentHourTimeUTC, nextHourTimeUTC);
-    LOG_INFOF("[AccuWeather] Simple parse - Timezone: %s, offset: %d seconds\n", timezone.c_str(), timezoneOffset);
-    
-    int forecastIndex = 0;
-    int searchPos = 0;
-    
-    // Find up to 6 forecasts by searching for "EpochDateTime" pattern
-    while (forecastIndex < 6 && searchPos < jsonData.length()) {
-        // Find next EpochDateTime
-        int epochPos = jsonData.indexOf("\"EpochDateTime\":", searchPos);
-        if (epochPos == -1) break;
-        
-        // Extract epoch time
-        int epochStart = epochPos + 16; // Length of "EpochDateTime":
-        int epochEnd = jsonData.indexOf(",", epochStart);
-        if (epochEnd == -1) epochEnd = jsonData.indexOf("}", epochStart);
-        if (epochEnd == -1) break;
-        
-        String epochStr = jsonData.substring(epochStart, epochEnd);
-        long epochTime = epochStr.toInt();
-        
-        // Filter out forecasts from past and current hour (comparing UTC times)
-        if (epochTime < nextHourTimeUTC) {
-            LOG_INFOF("[AccuWeather] Simple parse: Forecast time %ld is before next hour %ld (UTC) - SKIPPING\n", 
-                         epochTime, nextHourTimeUTC);
-            searchPos = epochEnd;
-            continue;
-        }
-        
-        // Find temperature value after this epoch
-        int tempPos = jsonData.indexOf("\"Temperature\":{\"Value\":", epochPos);
-        if (tempPos == -1 || tempPos > epochPos + 2000) { // Look within reasonable range
-            searchPos = epochEnd;
-            continue;
-        }
-        
-        int tempStart = tempPos + 23; // Length of "Temperature":{"Value":
-        int tempEnd = jsonData.indexOf(",", tempStart);
-        if (tempEnd == -1) tempEnd = jsonData.indexOf("}", tempStart);
-        if (tempEnd == -1) {
-            searchPos = epochEnd;
-            continue;
-        }
-        
-        String tempStr = jsonData.substring(tempStart, tempEnd);
-        int temperature = (int)tempStr.toFloat();
-        
-        // Find humidity
-        int humidityPos = jsonData.indexOf("\"RelativeHumidity\":", epochPos);
-        int humidity = 50; // Default if not found
-        if (humidityPos != -1 && humidityPos < epochPos + 2000) {
-            int humStart = humidityPos + 19; // Length of "RelativeHumidity":
-            int humEnd = jsonData.indexOf(",", humStart);
-            if (humEnd == -1) humEnd = jsonData.indexOf("}", humStart);
-            if (humEnd != -1) {
-                String humStr = jsonData.substring(humStart, humEnd);
-                humidity = humStr.toInt();
-            }
-        }
-        
-        // Find weather icon
-        int iconPos = jsonData.indexOf("\"WeatherIcon\":", epochPos);
-        int icon = 1; // Default sunny if not found
-        if (iconPos != -1 && iconPos < tempPos) {
-            int iconStart = iconPos + 14; // Length of "WeatherIcon":
-            int iconEnd = jsonData.indexOf(",", iconStart);
-            if (iconEnd == -1) iconEnd = jsonData.indexOf("}", iconStart);
-            if (iconEnd != -1) {
-                String iconStr = jsonData.substring(iconStart, iconEnd);
-                icon = iconStr.toInt();
-            }
-        }
-        
-        // Find icon phrase
-        int phrasePos = jsonData.indexOf("\"IconPhrase\":\"", epochPos);
-        String phrase = "Weather";
-        if (phrasePos != -1 && phrasePos < tempPos) {
-            int phraseStart = phrasePos + 14; // Length of "IconPhrase":"
-            int phraseEnd = jsonData.indexOf("\"", phraseStart);
-            if (phraseEnd != -1) {
-                phrase = jsonData.substring(phraseStart, phraseEnd);
-            }
-        }
-        
-        LOG_INFOF("[AccuWeather] Simple parse %d: time=%ld, temp=%d, humidity=%d, icon=%d, phrase=%s\n", 
-                     forecastIndex, epochTime, temperature, humidity, icon, phrase.c_str());
-        
-        // Update forecast
-        updateForecast(forecastIndex, epochTime, temperature, humidity, phrase.c_str(), icon);
-        forecastIndex++;
-        
-        // Move search position forward
-        searchPos = epochEnd;
-    }
-    
-    LOG_INFOF("[AccuWeather] Simple parsing completed, extracted %d forecasts\n", forecastIndex);
-    
-    if (forecastIndex == 0) {
-        LOG_INFO("[AccuWeather] No forecasts found in simple parsing");
-        TerminalEvent event(0, "AW", "No forecasts found", TerminalEvent::State::FAILURE);
-        EventManager::Emit(event);
-        return false;
-    }
-    
-    // Save all forecasts to EEPROM after successful simple parsing
-    LOG_INFO("[AccuWeather] Saving all forecasts to EEPROM after simple parsing...");
-    saveToEEPROM();
-    
-    // Debug: Print all forecasts after saving
-    LOG_INFO("[AccuWeather] All forecasts after simple parsing and saving to EEPROM:");
-    for (int i = 0; i < 6; i++) {
-        LOG_INFOF("  Forecast %d: time=%ld, temp=%d, humidity=%d, icon=%d\n", 
-                     i, forecasts[i].time, forecasts[i].temperature, 
-                     forecasts[i].humidity, forecasts[i].icon);
-    }
-    
+    // One transaction for the whole fetch
+    LOG_INFO("[AccuWeather] Saving all forecasts after parsing...");
+    saveForecasts();
     return true;
 }
 
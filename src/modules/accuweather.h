@@ -4,8 +4,13 @@
 #include <Arduino.h>
 #include "logger.h"
 #include <stdint.h>
+#include <atomic>
 #include "event_manager.h"
+#include "forecast_parser.h"
 #include "module.h"
+#include "../cache_service.h"
+#include "../http_service.h"
+#include "../refresh_scheduler.h"
 
 namespace modules {
 
@@ -15,6 +20,9 @@ struct AccuWeatherConfig : public ModuleConfig {
     String city = "";
     String timezone = "";
     String systemTimezone = "UTC";  // Fallback timezone from system
+    uint32_t refreshIntervalMinutes = 60;
+    uint32_t refreshLeadSeconds = 120;  // Fetch this long before each interval boundary
+    uint16_t dailyBudget = 40;          // Free tier allows 50 calls a day
 };
 
 class AccuWeather : public IModule {
@@ -25,30 +33,22 @@ class AccuWeather : public IModule {
     bool IsReady() override;
     void Configure(const ModuleConfig& config) override;
     bool ConfigureFromSection(const ConfigSection& section) override;
-
-    class Forecast {
-      public:
-        long time;
-        int temperature;
-        int humidity;
-        char phrase[64];  // Changed from pointer to fixed-size array for EEPROM storage
-        int icon;
-
-        // Default constructor
-        Forecast() {
-            time = 0;
-            temperature = 0;
-            humidity = 0;
-            memset(phrase, 0, sizeof(phrase));
-            icon = 0;
-        }
-    };
-
-    // EEPROM methods
-    void saveToEEPROM();
-    void loadFromEEPROM();
-
-    // Forecast management methods
+    void Reconfigure(const ConfigSection& section) override;
+    uint32_t GetRedrawInterval() override;
+    bool GetBounds(Bounds& bounds) const override;
+    uint32_t GetContentVersion() override;
+    const char* GetName() const override { return "AccuWeather"; }
+
+    using Forecast = HourlyForecast;
+
+    // Persistence through CacheService: forecasts (only when changed) plus their freshness
+    void saveForecasts(bool forecastsChanged = true);
+    void loadForecasts();
+    // Copies a complete set into forecasts[] under the composition lock, so Draw() never sees it half-written
+    void publishForecasts(const Forecast (&source)[6]);
+    void clearStaged();
+
+    // Forecast management methods; updates stay in RAM until saveForecasts()
     void updateForecast(int index, const long time, int temperature, int humidity, const char* phrase, int icon);
     void updateForecast(int index, const Forecast& forecast);
     Forecast getForecast(int index) const;
@@ -56,29 +56,67 @@ class AccuWeather : public IModule {
     bool hasForecastData() const;
     int getValidForecastCount() const;
 
-    // API methods
-    bool fetchWeatherData();
+    // API methods; timing and statusCode are filled in for diagnostics
+    RefreshScheduler::Outcome fetchWeatherData(HttpService::RequestTiming* timing = nullptr, int* statusCode = nullptr);
 
     // Data freshness check
     bool isDataFresh() const;
 
   private:
     const uint8_t* weatherIcon(int p);
-    bool parseWeatherData(const String& jsonData);
-    bool parseWeatherDataSimple(const String& jsonData);
-
-    // EEPROM addresses
-    static const int EEPROM_FORECAST_START = 0;
-    static const int EEPROM_FORECAST_SIZE = sizeof(Forecast);
-    static const int EEPROM_TOTAL_SIZE = EEPROM_FORECAST_SIZE * 6;  // Updated for 6 forecasts
+    bool parseWeatherData(Stream& stream);
+
+    // Diagnostics mode: timed full fetches, the first on a cold connection
+    void runDiagnosticFetches();
+
+    RefreshScheduler::Config makeSchedule() const;
+    // Sleep up to the given ticks; a pending configuration change ends it early and is applied,
+    // a stop request ends it without applying anything and returns false
+    bool sleepOrReconfigure(TickType_t ticks);
+    // Wait for the WiFi link in slices of WIFI_POLL_MS, so a stop or a change is not held up
+    // while offline; false once the module is being stopped
+    bool waitForWiFi();
+    static const uint32_t WIFI_POLL_MS = 1000;
+    void applyReconfiguration();
+
+    // Pulsing current-weather icon: one 2*pi second sine cycle sampled into fixed phases
+    static const int ICON_SOURCE_SIZE = 16;
+    static const int ICON_FRAME_SIZE = 19;
+    static const int ICON_FRAME_STRIDE = (ICON_FRAME_SIZE + 7) / 8;
+    static const int ICON_FRAME_BYTES = ICON_FRAME_STRIDE * ICON_FRAME_SIZE;
+    static const int ICON_ANIMATION_PHASES = 16;
+    static const uint32_t ICON_PULSE_PERIOD_MS = 6283;
+    static const int MAX_ANIMATED_ICONS = 48;
+
+    // Render every phase of every icon once, so Draw() only blits
+    void buildIconFrames();
+    const uint8_t* getIconFrame(const uint8_t* icon, unsigned long now) const;
+
+    // Animation frames (PSRAM), ICON_ANIMATION_PHASES frames per entry of iconFrameSources
+    uint8_t* iconFrames = nullptr;
+    const uint8_t* iconFrameSources[MAX_ANIMATED_ICONS];
+    int iconFrameCount = 0;
+
+    // Cache entry; bump the version whenever the layout of Forecast changes
+    static const char* CACHE_NAMESPACE;
+    static const char* CACHE_FORECASTS;
+    static const uint16_t FORECASTS_VERSION = 1;
+    static const uint32_t FORECASTS_TTL_SECONDS = 2 * 60 * 60;
+
+    RefreshScheduler scheduler{"AW", CACHE_NAMESPACE};
 
     // Module configuration (injected)
     AccuWeatherConfig moduleConfig;
 
     // Module state
     Forecast forecasts[6];  // Reduced from 12 to 6 for memory optimization
+    Forecast staged[6];     // Parse and cache-load target on the module task, published whole to forecasts[]
     bool ready = false;
-    time_t lastDataSaveTime = 0;  // Unix timestamp instead of millis()
+    std::atomic<uint32_t> forecastRevision{1};  // Bumped whenever forecasts[] changes
+
+    // Runtime config changes are applied on the module task, between requests
+    TaskHandle_t taskHandle = NULL;
+    std::atomic<bool> reconfigurePending{false};
 };
 
 }  // namespace modules
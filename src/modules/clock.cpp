@@ -2,11 +2,11 @@
 #include "logger.h"
 #include <Arduino.h>
 #include <U8g2lib.h>
-#include <WiFi.h>
+#include <sys/time.h>
 #include <time.h>
 #include "../config_manager.h"
+#include "../time_service.h"
 #include "../timezone_utils.h"
-#include "../wifi_manager.h"
 #include "module_registry.h"
 
 extern U8G2_SSD1309_128X64_NONAME0_F_4W_HW_SPI u8g2;
@@ -29,8 +29,7 @@ void Clock::Configure(const ModuleConfig& config) {
 bool Clock::ConfigureFromSection(const ConfigSection& section) {
     // Parse configuration from INI section
     moduleConfig.format = section.getValue("format", "24h");
-    moduleConfig.showSeconds = section.getBoolValue("showSeconds", true);
-    moduleConfig.syncInterval = section.getIntValue("syncInterval", 3600);
+    moduleConfig.showSeconds = section.getBoolValue("show_seconds", true);
     moduleConfig.positionX = section.getIntValue("position_x", 0);
     moduleConfig.positionY = section.getIntValue("position_y", 0);
     moduleConfig.width = section.getIntValue("width", 128);
@@ -43,15 +42,9 @@ bool Clock::ConfigureFromSection(const ConfigSection& section) {
         moduleConfig.format = "24h";
     }
 
-    if (moduleConfig.syncInterval < 60) {
-        LOG_INFO("Clock: Sync interval too low, using 3600 seconds");
-        moduleConfig.syncInterval = 3600;
-    }
-
     LOG_INFO("Clock configured from INI section");
     LOG_INFOF("  Format: %s\n", moduleConfig.format.c_str());
     LOG_INFOF("  Show seconds: %s\n", moduleConfig.showSeconds ? "YES" : "NO");
-    LOG_INFOF("  Sync interval: %d seconds\n", moduleConfig.syncInterval);
     LOG_INFOF("  Position: (%d, %d)\n", moduleConfig.positionX, moduleConfig.positionY);
     LOG_INFOF("  Size: %dx%d\n", moduleConfig.width, moduleConfig.height);
     LOG_INFOF("  Enabled: %s\n", moduleConfig.enable ? "YES" : "NO");
@@ -61,68 +54,49 @@ bool Clock::ConfigureFromSection(const ConfigSection& section) {
 
 void Clock::Setup() { LOG_INFO("Clock Setup"); }
 
-void Clock::Run(void* parameter) {
-    LOG_INFO("Clock Run");
-
-    // Wait for configuration to be ready
-    ConfigManager* configManager = ConfigManager::getInstance();
-    while (!configManager->IsReady()) {
-        LOG_INFO("Waiting for config to be ready...");
-        vTaskDelay(pdMS_TO_TICKS(1000));
-    }
-
-    // Re-configure from INI section now that config is ready
-    ConfigSection moduleSection = configManager->getConfigSection("clock");
-    
-    if (!ConfigureFromSection(moduleSection)) {
-        LOG_INFO("Failed to re-configure Clock module after config ready");
-        vTaskDelete(NULL);
-        return;
-    }
+uint32_t Clock::Tick() {
+    if (!configured) {
+        // Re-configure from INI section now that config is ready
+        ConfigSection moduleSection = ConfigManager::getInstance()->getConfigSection("clock");
+        if (!ConfigureFromSection(moduleSection)) {
+            LOG_INFO("Failed to re-configure Clock module after config ready");
+            return TICK_DONE;
+        }
+        configured = true;
 
-    // Wait for WiFi connection
-    while (!WiFiManager::IsConnected()) {
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        if (!moduleConfig.enable) {
+            return TICK_DONE;
+        }
     }
 
-    if (!moduleConfig.enable) {
-        vTaskDelete(NULL);
-        return;
+    // A clock restored from RTC memory is valid before the network is up
+    if (!TimeService::isTimeValid()) {
+        return 1000;
     }
 
     ready = true;
-    LOG_INFO("Clock module ready - using system time sync");
+    LOG_INFOF("Clock module ready - time %s\n", TimeService::wasRestored() ? "restored from RTC" : "synchronized");
 
-    while (true) {
-        vTaskDelay(pdMS_TO_TICKS(1000));
-    }
-    vTaskDelete(NULL);
-    return;
+    // Drawing is paced by GetRedrawInterval(), nothing left to do here
+    return TICK_DONE;
 }
 
 void Clock::Draw() {
     // Get current time and display it
     struct tm timeinfo;
     if (getLocalTime(&timeinfo)) {
-        // Always use system timezone from ConfigManager
-        ConfigManager* configManager = ConfigManager::getInstance();
-        String timezone = configManager->getSystemTimezone();
-
-        if (timezone != "") {
-            // getLocalTime() returns UTC time since configTime was called with (0,0)
-            // Convert tm to timestamp treating it as UTC time
-            // Using portable implementation instead of timegm()
-            time_t utcTime = mktime(&timeinfo) - timezone_offset_from_mktime_to_utc();
-            
-            // Apply timezone offset to get local time
-            int timezoneOffset = TimezoneUtils::getTimezoneOffset(timezone);
-            time_t localTime = utcTime + timezoneOffset;
-
-            // Convert back to tm structure
-            struct tm* adjustedTime = gmtime(&localTime);
-            if (adjustedTime != nullptr) {
-                timeinfo = *adjustedTime;
-            }
+        // getLocalTime() returns UTC time since configTime was called with (0,0)
+        // Convert tm to timestamp treating it as UTC time
+        // Using portable implementation instead of timegm()
+        time_t utcTime = mktime(&timeinfo) - timezone_offset_from_mktime_to_utc();
+
+        // Apply the system timezone offset (cached until the next DST transition)
+        time_t localTime = utcTime + TimezoneUtils::getOffsetAt(utcTime);
+
+        // Convert back to tm structure
+        struct tm* adjustedTime = gmtime(&localTime);
+        if (adjustedTime != nullptr) {
+            timeinfo = *adjustedTime;
         }
 
         char timeString[64];
@@ -177,4 +151,38 @@ time_t Clock::timezone_offset_from_mktime_to_utc() {
 
 bool Clock::IsReady() { return ready; }
 
+bool Clock::GetBounds(Bounds& bounds) const {
+    bounds.x = moduleConfig.positionX;
+    bounds.y = moduleConfig.positionY;
+    bounds.width = moduleConfig.width;
+    bounds.height = moduleConfig.height;
+    return true;
+}
+
+uint32_t Clock::GetContentVersion() {
+    time_t now = time(nullptr);
+    if (!TimeService::isTimeValid()) {
+        return CONTENT_UNVERSIONED;
+    }
+
+    // The text changes with the displayed second (or minute) and with the UTC offset
+    uint32_t version = (uint32_t)(moduleConfig.showSeconds ? now : now / 60);
+    version = version * 31 + (uint32_t)TimezoneUtils::getOffsetAt(now);
+    return version == CONTENT_UNVERSIONED ? 1 : version;
+}
+
+uint32_t Clock::GetRedrawInterval() {
+    struct timeval now;
+    if (!ready || gettimeofday(&now, nullptr) != 0) {
+        return 1000;
+    }
+
+    // Wake right after the displayed digits change: the next second, or the next minute without seconds
+    uint32_t msIntoSecond = now.tv_usec / 1000;
+    if (moduleConfig.showSeconds) {
+        return 1000 - msIntoSecond;
+    }
+    return (60 - now.tv_sec % 60) * 1000 - msIntoSecond;
+}
+
 }  // namespace modules
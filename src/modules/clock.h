@@ -4,26 +4,27 @@
 #include "module.h"
 #include "logger.h"
 
-// Forward declaration
-class WiFiManager;
-
 namespace modules {
 
 // Clock specific configuration
 struct ClockConfig : public ModuleConfig {
     String format = "24h";  // "12h" or "24h"
-    bool showSeconds = true;
-    int syncInterval = 3600;        // Time sync interval in seconds
+    bool showSeconds = true;        // SNTP interval (sync_interval) is read by TimeService
 };
 
 class Clock : public IModule {
   public:
     void Setup() override;
-    void Run(void* parameter) override;
     void Draw() override;
     bool IsReady() override;
     void Configure(const ModuleConfig& config) override;
     bool ConfigureFromSection(const ConfigSection& section) override;
+    uint32_t GetRedrawInterval() override;
+    bool GetBounds(Bounds& bounds) const override;
+    uint32_t GetContentVersion() override;
+    const char* GetName() const override { return "Clock"; }
+    bool IsCooperative() const override { return true; }
+    uint32_t Tick() override;
 
   private:
     // Module configuration (injected)
@@ -31,6 +32,7 @@ class Clock : public IModule {
 
     // Module state
     bool ready = false;
+    bool configured = false;
     
     // Helper function to calculate timezone offset for mktime conversion
     time_t timezone_offset_from_mktime_to_utc();
@@ -0,0 +1,126 @@
+#include "forecast_parser.h"
+#include <cctype>
+#include "../logger.h"
+
+namespace modules {
+
+// Next character after any whitespace; 0 when the stream ends or times out first
+static char nextNonSpace(Stream& stream) {
+    char c = 0;
+    do {
+        if (stream.readBytes(&c, 1) != 1) {
+            return 0;
+        }
+    } while (isspace((unsigned char)c));
+    return c;
+}
+
+ForecastParser::Result ForecastParser::parse(Stream& stream, JsonDocument& entry, time_t notBefore, HourlyForecast* out,
+                                             int maxForecasts, int& count) {
+    count = 0;
+    if (maxForecasts > MAX_FORECASTS) {
+        maxForecasts = MAX_FORECASTS;
+    }
+
+    // Skip leading whitespace: a successful response is an array, an object is an API fault
+    char first = nextNonSpace(stream);
+    if (first == 0) {
+        LOG_INFO("[AccuWeather] Empty response from API");
+        return Result::EMPTY;
+    }
+
+    if (first != '[') {
+        if (first == '{') {
+            LOG_INFO("AccuWeather API returned error response");
+            return Result::API_ERROR;
+        }
+        LOG_INFOF("[AccuWeather] Response is not JSON format (starts with '%c')\n", first);
+        return Result::NOT_JSON;
+    }
+
+    // Keep only the fields we display, so each array element fits in a small fixed document
+    StaticJsonDocument<192> filter;
+    filter["EpochDateTime"] = true;
+    filter["Temperature"]["Value"] = true;
+    filter["RelativeHumidity"] = true;
+    filter["IconPhrase"] = true;
+    filter["WeatherIcon"] = true;
+
+    // Parse into a staging array so a truncated response never leaves half-updated forecasts
+    HourlyForecast parsed[MAX_FORECASTS];
+    int index = 0;
+    int processedEntries = 0;
+    bool complete = false;  // Closing ']' seen, or every wanted hour collected
+
+    while (!complete) {
+        DeserializationError error = deserializeJson(entry, stream, DeserializationOption::Filter(filter));
+        if (error) {
+            LOG_INFOF("[AccuWeather] JSON parsing failed at entry %d: %s\n", processedEntries, error.c_str());
+            break;
+        }
+        processedEntries++;
+
+        if (readForecast(entry, notBefore, parsed[index])) {
+            LOG_DEBUGF("[AccuWeather] Forecast %d: time=%ld, temp=%d, humidity=%d, icon=%d, phrase=%s\n", index,
+                       parsed[index].time, parsed[index].temperature, parsed[index].humidity, parsed[index].icon,
+                       parsed[index].phrase);
+            index++;
+        }
+
+        // Only the first upcoming hours are kept; the rest of the body is never read
+        if (index >= maxForecasts) {
+            complete = true;
+            break;
+        }
+        char separator = nextNonSpace(stream);
+        if (separator == ']') {
+            complete = true;
+        } else if (separator != ',') {
+            LOG_INFOF("[AccuWeather] Response cut off after entry %d\n", processedEntries - 1);
+            break;
+        }
+    }
+
+    if (!complete) {
+        return Result::PARSE_ERROR;
+    }
+    LOG_INFOF("[AccuWeather] Successfully parsed %d forecasts from %d entries\n", index, processedEntries);
+    if (index == 0) {
+        return Result::NO_FORECASTS;
+    }
+
+    for (int i = 0; i < maxForecasts; i++) {
+        out[i] = parsed[i];
+    }
+    count = index;
+    return Result::OK;
+}
+
+bool ForecastParser::readForecast(const JsonDocument& entry, time_t notBefore, HourlyForecast& forecast) {
+    if (!entry.containsKey("EpochDateTime") || !entry["Temperature"].containsKey("Value") ||
+        !entry.containsKey("IconPhrase") || !entry.containsKey("WeatherIcon")) {
+        LOG_DEBUG("Forecast entry missing required fields - SKIPPING");
+        return false;
+    }
+
+    long epochTime = entry["EpochDateTime"];
+
+    // Filter out forecasts from past and current hour (comparing UTC times)
+    if (epochTime < notBefore) {
+        LOG_DEBUGF("Forecast time %ld is before next hour %ld (UTC) - SKIPPING\n", epochTime, (long)notBefore);
+        return false;
+    }
+
+    forecast = HourlyForecast();
+    forecast.time = epochTime;
+    forecast.temperature = entry["Temperature"]["Value"];
+    forecast.humidity = entry["RelativeHumidity"] | 0;
+    forecast.icon = entry["WeatherIcon"];
+    const char* phrase = entry["IconPhrase"];
+    if (phrase != nullptr) {
+        strncpy(forecast.phrase, phrase, sizeof(forecast.phrase) - 1);
+    }
+    return true;
+}
+
+}  // namespace modules
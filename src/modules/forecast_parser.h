@@ -0,0 +1,67 @@
+#ifndef FORECAST_PARSER_H
+#define FORECAST_PARSER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <cstring>
+#include <time.h>
+
+namespace modules {
+
+// One hour of the AccuWeather hourly forecast, as displayed and persisted
+class HourlyForecast {
+  public:
+    long time;
+    int temperature;
+    int humidity;
+    char phrase[64];  // Fixed-size array so forecasts persist as a flat record
+    int icon;
+
+    // Default constructor
+    HourlyForecast() {
+        time = 0;
+        temperature = 0;
+        humidity = 0;
+        memset(phrase, 0, sizeof(phrase));
+        icon = 0;
+    }
+};
+
+/**
+ * AccuWeather Hourly Forecast Parser
+ *
+ * Streams the hourly forecast array element by element through a field filter, so only the
+ * displayed fields of one element are ever held in the document. Stops reading as soon as
+ * enough upcoming hours were collected. Independent of networking and persistence, so it also
+ * builds in the native benchmark environment.
+ */
+class ForecastParser {
+  public:
+    enum class Result {
+        OK,            // At least one upcoming forecast parsed
+        EMPTY,         // Nothing but whitespace
+        API_ERROR,     // A JSON object instead of the array: the API reported a fault
+        NOT_JSON,
+        PARSE_ERROR,   // Malformed, or cut off before the closing ']' or the last wanted forecast
+        NO_FORECASTS   // Well-formed, but no forecast at or after notBefore
+    };
+
+    // Parse into out[0..maxForecasts); entries before notBefore (UTC) are skipped. out is only
+    // written on OK, i.e. once maxForecasts entries were read or the array was closed, so a
+    // truncated response never leaves half-updated forecasts behind.
+    static Result parse(Stream& stream, JsonDocument& entry, time_t notBefore, HourlyForecast* out, int maxForecasts,
+                        int& count);
+
+    // Each filtered element fits in a document of this capacity
+    static const size_t ENTRY_DOCUMENT_SIZE = 384;
+
+  private:
+    static const int MAX_FORECASTS = 12;
+
+    // Fill forecast from one filtered element; false when it lacks a field or lies before notBefore
+    static bool readForecast(const JsonDocument& entry, time_t notBefore, HourlyForecast& forecast);
+};
+
+}  // namespace modules
+
+#endif  // FORECAST_PARSER_H
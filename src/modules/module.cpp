@@ -1,4 +1,34 @@
 #include "module.h"
 #include "logger.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
-std::vector<modules::IModule*> active_modules;
\ No newline at end of file
+std::vector<modules::IModule*> active_modules;
+
+namespace modules {
+
+void IModule::Run(void* parameter) {
+    uint32_t delayMs;
+    while ((delayMs = Tick()) != TICK_DONE) {
+        if (!Sleep(pdMS_TO_TICKS(delayMs))) {
+            return;
+        }
+    }
+
+    // Stay alive so the module keeps being drawn, until it is stopped
+    while (Sleep(portMAX_DELAY)) {
+    }
+}
+
+bool IModule::Sleep(TickType_t ticks) {
+    if (!stopRequested.load()) {
+        ulTaskNotifyTake(pdTRUE, ticks);
+    }
+    // The manager notifies the task after changing either flag, so no wake-up is missed
+    while (suspended.load() && !stopRequested.load()) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    return !stopRequested.load();
+}
+
+}  // namespace modules
@@ -3,11 +3,16 @@
 
 #include <Arduino.h>
 #include "logger.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
 #include <map>
 #include <vector>
 
 namespace modules {
 
+class ModuleManager;
+
 // Structure to hold a configuration section from INI file
 struct ConfigSection {
     std::map<String, String> keyValuePairs;
@@ -30,6 +35,27 @@ struct ConfigSection {
         String value = getValue(key, String(defaultValue));
         return value.toInt();
     }
+
+    // Helper method to get a task core affinity: "0", "1" or "any"
+    BaseType_t getCoreValue(const String& key, BaseType_t defaultValue) const {
+        String value = getValue(key);
+        value.toLowerCase();
+        if (value == "0" || value == "1") {
+            return value.toInt();
+        }
+        if (value == "any") {
+            return tskNO_AFFINITY;
+        }
+        return defaultValue;
+    }
+};
+
+// Screen rectangle a module draws into
+struct Bounds {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
 };
 
 // Base configuration structure for all modules
@@ -45,9 +71,26 @@ struct ModuleConfig {
 
 class IModule {
   public:
+    // Returned by GetRedrawInterval() when the module only changes on explicit Display::RequestRedraw()
+    static const uint32_t REDRAW_NEVER = UINT32_MAX;
+
+    // Returned by Tick() when the module needs no further ticks
+    static const uint32_t TICK_DONE = UINT32_MAX;
+
+    // Returned by GetContentVersion() when the module must be drawn on every frame
+    static const uint32_t CONTENT_UNVERSIONED = 0;
+
     virtual ~IModule() = default;
     virtual void Setup() = 0;
-    virtual void Run(void* parameter) = 0;
+
+    // Counterpart of Setup(), called on the module runtime task once the module is off the dashboard
+    // and, for a dedicated module, its Run() has returned. Undo registrations made in Setup() here;
+    // the instance is deleted right after.
+    virtual void Teardown() {}
+
+    // Body of a dedicated module task. The default drives Tick() on the calling task. Run() returns
+    // once Sleep() reports a stop, which it must use for every wait so a stop or resume wakes it.
+    virtual void Run(void* parameter);
     virtual void Draw() = 0;
     virtual bool IsReady() = 0;
 
@@ -56,9 +99,56 @@ class IModule {
 
     // New method to configure from INI section
     virtual bool ConfigureFromSection(const ConfigSection& section) = 0;
+
+    // Apply the module's INI section after it changed at runtime. Called on the module runtime task
+    // with the dashboard composition lock held, so Draw() never sees a half-applied configuration.
+    // The default re-runs ConfigureFromSection(); modules whose own task reads the configuration
+    // override it to hand the change over to that task.
+    virtual void Reconfigure(const ConfigSection& section) { ConfigureFromSection(section); }
     
     // Method to identify overlay modules (should be drawn last)
     virtual bool IsOverlay() const { return false; }
+
+    // Stacking order on the dashboard, higher is drawn later (on top); overlays default above modules
+    virtual int GetZOrder() const { return IsOverlay() ? 1 : 0; }
+
+    // Hidden modules are skipped by the compositor; changing this re-renders only their bounds
+    virtual bool IsVisible() const { return true; }
+
+    // Short name used in diagnostics such as the display frame-time report
+    virtual const char* GetName() const { return "Module"; }
+
+    // Milliseconds until the module needs to be drawn again, queried after every dashboard frame.
+    // Modules that change asynchronously should also call Display::RequestRedraw() when they do.
+    virtual uint32_t GetRedrawInterval() { return 1000; }
+
+    // Rectangle Draw() stays within, usually the position and size from the module's config.
+    // Modules reporting one are clipped to it and only re-rendered when their area is invalidated;
+    // without bounds the module covers the whole screen.
+    virtual bool GetBounds(Bounds& /*bounds*/) const { return false; }
+
+    // Identifies what Draw() would render right now. A module with bounds that returns a version is
+    // drawn once per version into a retained bitmap, which the display reuses until the version
+    // changes. The bitmap is ORed into the frame, so such modules must only draw lit pixels.
+    virtual uint32_t GetContentVersion() { return CONTENT_UNVERSIONED; }
+
+    // Cooperative modules share the module runtime task instead of getting their own. They must not
+    // block: Tick() does a bounded amount of work and returns the milliseconds until it should run
+    // again, or TICK_DONE. Modules doing blocking I/O keep the default and implement Run().
+    virtual bool IsCooperative() const { return false; }
+    virtual uint32_t Tick() { return TICK_DONE; }
+
+  protected:
+    // Wait on the module task up to the given ticks; any task notification ends it early. Parks
+    // while the module is suspended. Returns false once the module is being stopped.
+    bool Sleep(TickType_t ticks);
+    bool IsStopRequested() const { return stopRequested.load(); }
+
+  private:
+    // Lifecycle flags, set by the module manager
+    friend class ModuleManager;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> suspended{false};
 };
 
 }  // namespace modules
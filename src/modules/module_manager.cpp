@@ -1,99 +1,411 @@
 #include "module_manager.h"
+#include <algorithm>
+#include <cstring>
 #include "logger.h"
+#include "../boot_sequencer.h"
 #include "../config.h"
 #include "../config_manager.h"
+#include "../display.h"
 
 namespace modules {
 
-std::vector<TaskHandle_t> ModuleManager::taskHandles;
+ModuleManager::Slot ModuleManager::slots[ModuleRegistry::MAX_MODULES];
+int ModuleManager::slotCount = 0;
+TaskHandle_t ModuleManager::runtimeTask = NULL;
+QueueHandle_t ModuleManager::pendingCommands = NULL;
 
-void ModuleManager::StartAllModules() {
+void ModuleManager::StartAllModules(UBaseType_t runtimePriority, uint32_t runtimeStackSize) {
     LOG_INFO("Starting all registered modules...");
 
     // Print registered modules
     ModuleRegistry::PrintRegisteredModules();
 
-    const auto& modules = ModuleRegistry::GetModules();
+    pendingCommands = xQueueCreate(PENDING_COMMANDS, sizeof(Command));
+    // Sized once, so adding a module never reallocates the list the display iterates
+    active_modules.reserve(ModuleRegistry::MAX_MODULES);
+    EventManager::Subscribe<ConfigChangedEvent>(onConfigChanged);
 
-    for (const auto& moduleInfo : modules) {
-        LOG_INFOF("Starting module: %s\n", moduleInfo.name.c_str());
+    BaseType_t result =
+        xTaskCreate(runtimeTaskWrapper, "ModuleRuntime", runtimeStackSize, NULL, runtimePriority, &runtimeTask);
+    if (result != pdPASS) {
+        runtimeTask = NULL;
+        LOG_ERROR("Failed to start module runtime");
+    }
+}
+
+void ModuleManager::runtimeTaskWrapper(void* parameter) {
+    // Modules configure themselves from the INI file, so nothing starts before it is parsed
+    BootSequencer::begin(BootSequencer::Stage::MODULES);
+
+    slotCount = ModuleRegistry::GetModuleCount();
+    for (int i = 0; i < slotCount; i++) {
+        slots[i] = {&ModuleRegistry::GetModules()[i], nullptr, NULL, State::STOPPED, false, false, 0};
+        if (isEnabled(*slots[i].info)) {
+            startModule(slots[i]);
+        } else {
+            LOG_INFOF("Module %s is disabled, not instantiated\n", slots[i].info->name);
+        }
+    }
+    BootSequencer::complete(BootSequencer::Stage::MODULES);
 
-        TaskHandle_t taskHandle = NULL;
+    while (true) {
+        // Sleep until the next tick is due, or indefinitely without ticks; a queued command wakes it early
+        TickType_t sleep = isTicking() ? pdMS_TO_TICKS(tickCooperativeModules()) : portMAX_DELAY;
+        ulTaskNotifyTake(pdTRUE, sleep);
+        applyPendingCommands();
+    }
+}
 
-        // Create a copy of module info for the task
-        ModuleInfo* moduleInfoCopy = new ModuleInfo(moduleInfo);
+bool ModuleManager::StartModule(const String& name) { return post(Action::START, name.c_str()); }
 
-        BaseType_t result = xTaskCreate(ModuleTaskWrapper, moduleInfo.name.c_str(), moduleInfo.stackSize,
-                                        moduleInfoCopy, moduleInfo.taskPriority, &taskHandle);
+bool ModuleManager::StopModule(const String& name) { return post(Action::STOP, name.c_str()); }
 
-        if (result == pdPASS) {
-            taskHandles.push_back(taskHandle);
-            LOG_INFOF("Module %s started successfully\n", moduleInfo.name.c_str());
-        } else {
-            LOG_INFOF("Failed to start module %s\n", moduleInfo.name.c_str());
-            delete moduleInfoCopy;
+bool ModuleManager::SuspendModule(const String& name) { return post(Action::SUSPEND, name.c_str()); }
+
+bool ModuleManager::ResumeModule(const String& name) { return post(Action::RESUME, name.c_str()); }
+
+void ModuleManager::StopAllModules() {
+    LOG_INFO("Stopping all modules...");
+    post(Action::STOP_ALL, "");
+}
+
+bool ModuleManager::post(Action action, const char* target, bool enableChanged, TickType_t wait) {
+    if (pendingCommands == NULL || strlen(target) > ConfigChangedEvent::MAX_SECTION_LENGTH) {
+        return false;
+    }
+
+    Command command;
+    command.action = action;
+    command.enableChanged = enableChanged;
+    strcpy(command.target, target);
+    if (xQueueSend(pendingCommands, &command, wait) != pdTRUE) {
+        return false;
+    }
+    if (runtimeTask != NULL) {
+        xTaskNotifyGive(runtimeTask);
+    }
+    return true;
+}
+
+void ModuleManager::onConfigChanged(const ConfigChangedEvent& event) {
+    // Runs on the emitting config task: queue the section, the runtime applies it
+    if (!post(Action::RECONFIGURE, event.section, event.enable_changed)) {
+        LOG_WARNINGF("Module runtime: Change of [%s] dropped, queue full\n", event.section);
+    }
+}
+
+void ModuleManager::applyPendingCommands() {
+    Command command;
+    while (pendingCommands != NULL && xQueueReceive(pendingCommands, &command, 0) == pdTRUE) {
+        applyCommand(command);
+    }
+}
+
+void ModuleManager::applyCommand(const Command& command) {
+    if (command.action == Action::RECONFIGURE) {
+        reconfigureSection(command.target, command.enableChanged);
+        return;
+    }
+    if (command.action == Action::STOP_ALL) {
+        for (int i = 0; i < slotCount; i++) {
+            slots[i].restartPending = false;
+            stopModule(slots[i]);
+        }
+        return;
+    }
+
+    Slot* slot = findSlot(command.target);
+    if (slot == nullptr) {
+        LOG_WARNINGF("Module runtime: No module named %s\n", command.target);
+        return;
+    }
+
+    switch (command.action) {
+        case Action::START:
+            startModule(*slot);
+            break;
+        case Action::STOP:
+            slot->restartPending = false;
+            stopModule(*slot);
+            break;
+        case Action::SUSPEND:
+            suspendModule(*slot, true);
+            break;
+        case Action::RESUME:
+            suspendModule(*slot, false);
+            break;
+        case Action::EXITED:
+            // A slot has at most one task, and is only started again after its report
+            if (slot->task != NULL) {
+                releaseModule(*slot);
+                if (slot->restartPending) {
+                    slot->restartPending = false;
+                    startModule(*slot);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+ModuleManager::Slot* ModuleManager::findSlot(const char* name) {
+    for (int i = 0; i < slotCount; i++) {
+        if (strcmp(slots[i].info->name, name) == 0) {
+            return &slots[i];
         }
     }
+    return nullptr;
 }
 
-void ModuleManager::ModuleTaskWrapper(void* parameter) {
-     // Wait for configuration to be ready
-     ConfigManager* configManager = ConfigManager::getInstance();
-     while (!configManager->IsReady()) {
-         LOG_INFO("Waiting for config to be ready...");
-         vTaskDelay(pdMS_TO_TICKS(100));
-     }
- 
-
-    ModuleInfo* moduleInfo = static_cast<ModuleInfo*>(parameter);
-
-    if (!moduleInfo) {
-        LOG_INFO("Invalid module info in task wrapper");
-        vTaskDelete(NULL);
+bool ModuleManager::isTicking() {
+    for (int i = 0; i < slotCount; i++) {
+        if (slots[i].ticking) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ModuleManager::isEnabled(const ModuleInfo& moduleInfo) {
+    // Same spelling as ConfigSection::getBoolValue(), without copying the section
+    char value[8];
+    if (!ConfigManager::getInstance()->getValue(moduleInfo.configSection, "enable", value, sizeof(value))) {
+        return moduleInfo.enabledByDefault;
+    }
+    return strcasecmp(value, "true") == 0 || strcmp(value, "1") == 0 || strcasecmp(value, "yes") == 0;
+}
+
+void ModuleManager::reconfigureSection(const char* section, bool enableChanged) {
+    int applied = 0;
+    for (int i = 0; i < slotCount; i++) {
+        Slot& slot = slots[i];
+        if (strcasecmp(slot.info->configSection, section) != 0) {
+            continue;
+        }
+
+        // A flipped "enable" starts or stops the module; a running one that stays on is reconfigured
+        bool live = slot.state == State::RUNNING || slot.state == State::SUSPENDED;
+        if (enableChanged && !isEnabled(*slot.info)) {
+            slot.restartPending = false;
+            stopModule(slot);
+            continue;
+        }
+        if (enableChanged && !live) {
+            startModule(slot);
+            continue;
+        }
+
+        if (live) {
+            Display::LockComposition();
+            slot.module->Reconfigure(ConfigManager::getInstance()->getConfigSection(slot.info->configSection));
+            Display::UnlockComposition();
+            applied++;
+        }
+    }
+
+    if (applied > 0) {
+        LOG_INFOF("Module runtime: Reconfigured %d module(s) from [%s]\n", applied, section);
+        Display::InvalidateDashboard();
+    }
+}
+
+void ModuleManager::startModule(Slot& slot) {
+    const ModuleInfo& moduleInfo = *slot.info;
+    if (slot.state == State::STOPPING) {
+        // The old task is still on its way out; start again once it reported back
+        slot.restartPending = true;
+        return;
+    }
+    if (slot.state != State::STOPPED) {
         return;
     }
 
-    LOG_INFOF("Module task wrapper started for: %s\n", moduleInfo->name.c_str());
+    LOG_INFOF("Starting module: %s\n", moduleInfo.name);
 
-    // Create module instance
-    IModule* module = moduleInfo->factory();
-    if (!module) {
-        LOG_INFOF("Failed to create module instance: %s\n", moduleInfo->name.c_str());
-        delete moduleInfo;
-        vTaskDelete(NULL);
+    // Constructed in the entry's static storage
+    IModule* module = moduleInfo.construct();
+    if (module->IsCooperative() != (moduleInfo.stack == nullptr)) {
+        LOG_ERRORF("Module %s: stack size in the module table does not match IsCooperative()\n", moduleInfo.name);
+        module->~IModule();
         return;
     }
 
-    // Add to active modules
+    if (module->IsCooperative()) {
+        module->Setup();
+        slot.module = module;
+        slot.state = State::RUNNING;
+        slot.ticking = true;
+        slot.nextTickMs = millis();
+        Display::LockComposition();
+        active_modules.push_back(module);
+        Display::UnlockComposition();
+        Display::InvalidateDashboard();
+        LOG_INFOF("Module %s started on the shared runtime\n", moduleInfo.name);
+        return;
+    }
+
+    // The table gives the defaults; the module's INI section may override priority and core
+    ConfigManager* configManager = ConfigManager::getInstance();
+    UBaseType_t priority = moduleInfo.taskPriority;
+    char value[8];
+    if (configManager->getValue(moduleInfo.configSection, "priority", value, sizeof(value)) && atoi(value) > 0 &&
+        atoi(value) < configMAX_PRIORITIES) {
+        priority = atoi(value);
+    }
+    BaseType_t core = moduleInfo.core;
+    if (configManager->getValue(moduleInfo.configSection, "core", value, sizeof(value))) {
+        if (strcmp(value, "0") == 0 || strcmp(value, "1") == 0) {
+            core = atoi(value);
+        } else if (strcasecmp(value, "any") == 0) {
+            core = tskNO_AFFINITY;
+        }
+    }
+
+    // On the dashboard before the task exists, so a suspend or stop always finds it there
+    slot.module = module;
+    slot.state = State::RUNNING;
+    Display::LockComposition();
     active_modules.push_back(module);
+    Display::UnlockComposition();
 
-    // Note: Configuration is now handled by the module itself in Run() method
-    // after waiting for config readiness
-    
-    module->Setup();
-    module->Run(parameter);
+    slot.task = xTaskCreateStaticPinnedToCore(ModuleTaskWrapper, moduleInfo.name, moduleInfo.stackSize, &slot,
+                                              priority, moduleInfo.stack, moduleInfo.taskBuffer, core);
+    if (slot.task != NULL) {
+        LOG_INFOF("Module %s started successfully\n", moduleInfo.name);
+    } else {
+        LOG_INFOF("Failed to start module %s\n", moduleInfo.name);
+        releaseModule(slot);
+    }
+}
+
+void ModuleManager::stopModule(Slot& slot) {
+    if (slot.state != State::RUNNING && slot.state != State::SUSPENDED) {
+        return;
+    }
+    LOG_INFOF("Stopping module: %s\n", slot.info->name);
+
+    // Off the dashboard first, so nothing draws it while it winds down
+    Display::LockComposition();
+    active_modules.erase(std::remove(active_modules.begin(), active_modules.end(), slot.module),
+                         active_modules.end());
+    Display::UnlockComposition();
+    Display::InvalidateDashboard();
 
-    // Remove from active modules
+    slot.module->stopRequested.store(true);
+    if (slot.task == NULL) {
+        releaseModule(slot);
+        return;
+    }
+
+    // The task leaves Run() at its next Sleep() and reports back through an EXITED command
+    slot.state = State::STOPPING;
+    xTaskNotifyGive(slot.task);
+}
+
+void ModuleManager::suspendModule(Slot& slot, bool suspend) {
+    State target = suspend ? State::SUSPENDED : State::RUNNING;
+    State from = suspend ? State::RUNNING : State::SUSPENDED;
+    if (slot.state != from) {
+        return;
+    }
+    LOG_INFOF("%s module: %s\n", suspend ? "Suspending" : "Resuming", slot.info->name);
+
+    slot.module->suspended.store(suspend);
+    slot.state = target;
+
+    Display::LockComposition();
+    if (suspend) {
+        active_modules.erase(std::remove(active_modules.begin(), active_modules.end(), slot.module),
+                             active_modules.end());
+    } else {
+        active_modules.push_back(slot.module);
+    }
+    Display::UnlockComposition();
+    Display::InvalidateDashboard();
+
+    if (slot.task != NULL) {
+        xTaskNotifyGive(slot.task);
+    }
+    if (!suspend) {
+        slot.nextTickMs = millis();
+    }
+}
+
+void ModuleManager::releaseModule(Slot& slot) {
+    IModule* module = slot.module;
+    Display::LockComposition();
     active_modules.erase(std::remove(active_modules.begin(), active_modules.end(), module), active_modules.end());
+    Display::UnlockComposition();
+
+    if (slot.task != NULL) {
+        // The task parks itself right after its report; deleting it from here, and not from the task
+        // itself, hands its static stack and control block back at once
+        while (eTaskGetState(slot.task) != eSuspended) {
+            vTaskDelay(1);
+        }
+        vTaskDelete(slot.task);
+    }
 
-    // Cleanup
-    delete module;
-    delete moduleInfo;
+    module->Teardown();
+    Display::ForgetModule(module);
+    module->~IModule();
 
-    vTaskDelete(NULL);
+    slot.module = nullptr;
+    slot.task = NULL;
+    slot.ticking = false;
+    slot.state = State::STOPPED;
+    Display::InvalidateDashboard();
+    LOG_INFOF("Module %s stopped and released\n", slot.info->name);
 }
 
-void ModuleManager::StopAllModules() {
-    LOG_INFO("Stopping all modules...");
+uint32_t ModuleManager::tickCooperativeModules() {
+    uint32_t sleepMs = MAX_RUNTIME_SLEEP_MS;
+
+    for (int i = 0; i < slotCount; i++) {
+        Slot& slot = slots[i];
+        if (!slot.ticking || slot.state != State::RUNNING) {
+            continue;
+        }
+        int32_t untilDue = (int32_t)(slot.nextTickMs - millis());
 
-    for (TaskHandle_t taskHandle : taskHandles) {
-        if (taskHandle != NULL) {
-            vTaskDelete(taskHandle);
+        if (untilDue <= 0) {
+            uint32_t delayMs = slot.module->Tick();
+            if (delayMs == IModule::TICK_DONE) {
+                // The module stays active for drawing, it just no longer needs ticks
+                slot.ticking = false;
+                continue;
+            }
+            slot.nextTickMs = millis() + delayMs;
+            untilDue = delayMs;
         }
+
+        sleepMs = std::min(sleepMs, (uint32_t)untilDue);
     }
 
-    taskHandles.clear();
-    active_modules.clear();
+    // Always yield at least one tick so lower-priority tasks are not starved
+    return std::max<uint32_t>(sleepMs, portTICK_PERIOD_MS);
+}
+
+void ModuleManager::ModuleTaskWrapper(void* parameter) {
+    // The slot is not changed by the runtime until this task reports back
+    Slot* slot = static_cast<Slot*>(parameter);
+    IModule* module = slot->module;
+    const ModuleInfo* moduleInfo = slot->info;
+
+    LOG_INFOF("Module task wrapper started for: %s\n", moduleInfo->name);
+
+    // Note: Configuration is handled by the module itself in Run()
+
+    module->Setup();
+    module->Run(const_cast<ModuleInfo*>(moduleInfo));
+
+    // Whether stopped or finished on its own, the runtime deletes this task and tears the module down;
+    // the report must not be lost, so wait for room in the queue
+    LOG_INFOF("Module %s left Run()\n", moduleInfo->name);
+    post(Action::EXITED, moduleInfo->name, false, portMAX_DELAY);
+
+    vTaskSuspend(NULL);
 }
 
-}  // namespace modules
\ No newline at end of file
+}  // namespace modules
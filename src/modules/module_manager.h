@@ -3,27 +3,102 @@
 
 #include <freertos/FreeRTOS.h>
 #include "logger.h"
+#include <freertos/queue.h>
 #include <freertos/task.h>
 #include "../config_manager.h"
+#include "../event_manager.h"
 #include "module_registry.h"
 
 namespace modules {
 
+/**
+ * Module Runtime
+ *
+ * A single runtime task waits for the configuration boot stage, starts every registered module
+ * whose section enables it and then ticks the cooperative ones itself, sleeping until the earliest
+ * one is due. Modules that block on I/O get a dedicated task with the stack size and priority from
+ * their table entry. A disabled module is never constructed and its task never created.
+ *
+ * The runtime task owns the module lifecycle. Start, stop, suspend and resume requests from any
+ * task are queued to it, as are configuration changes: a ConfigChangedEvent for a module's
+ * section wakes it, and every live module registered for that section is handed the new values
+ * through IModule::Reconfigure() with the dashboard composition lock held. When the section's
+ * "enable" flipped, the module is started or stopped instead.
+ *
+ * Instances and task stacks live in the static storage of their module table entry, so starting
+ * a module allocates nothing. Stopping takes a module off the dashboard under the composition lock
+ * first. A dedicated module's task is then asked to leave Run() and parks itself; the runtime
+ * deletes the task, tears the module down and destroys the instance, leaving the storage ready
+ * for the next start. A suspended module keeps its instance but is neither drawn nor ticked.
+ */
 class ModuleManager {
   public:
-    // Start all registered modules
-    static void StartAllModules();
+    // Start the runtime task, which starts all enabled modules
+    static void StartAllModules(UBaseType_t runtimePriority, uint32_t runtimeStackSize);
+
+    // Lifecycle requests by registered name, applied asynchronously on the runtime task.
+    // False when the runtime is not running or its queue is full.
+    static bool StartModule(const String& name);
+    static bool StopModule(const String& name);
+    static bool SuspendModule(const String& name);
+    static bool ResumeModule(const String& name);
 
     // Universal module task wrapper
     static void ModuleTaskWrapper(void* parameter);
 
-    // Stop all modules
+    // Stop all modules; the runtime keeps running so they can be started again
     static void StopAllModules();
 
   private:
-    static std::vector<TaskHandle_t> taskHandles;
+    // Longest the runtime sleeps, so newly due work is never delayed by more than this
+    static const uint32_t MAX_RUNTIME_SLEEP_MS = 1000;
+
+    enum class State { STOPPED, RUNNING, SUSPENDED, STOPPING };
+
+    // One per table entry, only touched on the runtime task
+    struct Slot {
+        const ModuleInfo* info;
+        IModule* module;        // In the entry's static storage, nullptr while stopped
+        TaskHandle_t task;      // NULL for cooperative modules
+        State state;
+        bool restartPending;    // Started again while still stopping
+        bool ticking;           // Cooperative module that still wants Tick()
+        uint32_t nextTickMs;
+    };
+
+    enum class Action : uint8_t { RECONFIGURE, START, STOP, SUSPEND, RESUME, STOP_ALL, EXITED };
+
+    struct Command {
+        Action action;
+        bool enableChanged;   // RECONFIGURE: the section's "enable" flipped
+        char target[ConfigChangedEvent::MAX_SECTION_LENGTH + 1];  // Section for RECONFIGURE, else module name
+    };
+
+    static const int PENDING_COMMANDS = 8;
+
+    static Slot slots[ModuleRegistry::MAX_MODULES];
+    static int slotCount;
+    static TaskHandle_t runtimeTask;
+    static QueueHandle_t pendingCommands;
+
+    static void runtimeTaskWrapper(void* parameter);
+    static bool post(Action action, const char* target, bool enableChanged = false, TickType_t wait = 0);
+    static void applyPendingCommands();
+    static void applyCommand(const Command& command);
+    static Slot* findSlot(const char* name);
+    static bool isEnabled(const ModuleInfo& moduleInfo);
+    static bool isTicking();
+
+    static void startModule(Slot& slot);
+    static void stopModule(Slot& slot);
+    static void suspendModule(Slot& slot, bool suspend);
+    static void releaseModule(Slot& slot);
+    static void reconfigureSection(const char* section, bool enableChanged);
+
+    static uint32_t tickCooperativeModules();
+    static void onConfigChanged(const ConfigChangedEvent& event);
 };
 
 }  // namespace modules
 
-#endif  // MODULE_MANAGER_H
\ No newline at end of file
+#endif  // MODULE_MANAGER_H
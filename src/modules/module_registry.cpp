@@ -1,22 +1,21 @@
 #include "module_registry.h"
+#include <cstring>
 #include "logger.h"
 
 namespace modules {
 
-std::vector<ModuleInfo> ModuleRegistry::modules;
+// Defined in module_table.cpp
+extern const ModuleInfo MODULE_TABLE[];
+extern const int MODULE_TABLE_SIZE;
 
-void ModuleRegistry::RegisterModule(const String& name, const String& configSection, int priority, int stackSize,
-                                    std::function<IModule*()> factory) {
-    LOG_INFOF("Registering module: %s\n", name.c_str());
-    modules.emplace_back(name, configSection, priority, stackSize, factory);
-}
+const ModuleInfo* ModuleRegistry::GetModules() { return MODULE_TABLE; }
 
-const std::vector<ModuleInfo>& ModuleRegistry::GetModules() { return modules; }
+int ModuleRegistry::GetModuleCount() { return MODULE_TABLE_SIZE; }
 
-const ModuleInfo* ModuleRegistry::GetModule(const String& name) {
-    for (const auto& module : modules) {
-        if (module.name == name) {
-            return &module;
+const ModuleInfo* ModuleRegistry::GetModule(const char* name) {
+    for (int i = 0; i < MODULE_TABLE_SIZE; i++) {
+        if (strcmp(MODULE_TABLE[i].name, name) == 0) {
+            return &MODULE_TABLE[i];
         }
     }
     return nullptr;
@@ -24,10 +23,18 @@ const ModuleInfo* ModuleRegistry::GetModule(const String& name) {
 
 void ModuleRegistry::PrintRegisteredModules() {
     LOG_INFO("Registered modules:");
-    for (const auto& module : modules) {
-        LOG_INFOF("  - %s (config: %s, priority: %d, stack: %d)\n", module.name.c_str(),
-                      module.configSection.c_str(), module.taskPriority, module.stackSize);
+    for (int i = 0; i < MODULE_TABLE_SIZE; i++) {
+        const ModuleInfo& module = MODULE_TABLE[i];
+        if (module.stackSize == 0) {
+            LOG_INFOF("  - %s (config: %s, cooperative)\n", module.name, module.configSection);
+        } else if (module.core == tskNO_AFFINITY) {
+            LOG_INFOF("  - %s (config: %s, priority: %u, stack: %u, core: any)\n", module.name, module.configSection,
+                      (unsigned)module.taskPriority, (unsigned)module.stackSize);
+        } else {
+            LOG_INFOF("  - %s (config: %s, priority: %u, stack: %u, core: %d)\n", module.name, module.configSection,
+                      (unsigned)module.taskPriority, (unsigned)module.stackSize, (int)module.core);
+        }
     }
 }
 
-}  // namespace modules
\ No newline at end of file
+}  // namespace modules
@@ -3,60 +3,86 @@
 
 #include <Arduino.h>
 #include "logger.h"
-#include <functional>
-#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <new>
+#include <type_traits>
 #include "module.h"
 
 namespace modules {
 
-// Structure to hold module metadata
+// One entry of the module table, fixed at compile time
 struct ModuleInfo {
-    String name;
-    String configSection;
-    int taskPriority;
-    int stackSize;
-    std::function<IModule*()> factory;
-
-    ModuleInfo(const String& name, const String& configSection, int priority, int stack,
-               std::function<IModule*()> factory)
-        : name(name), configSection(configSection), taskPriority(priority), stackSize(stack), factory(factory) {}
+    const char* name;
+    const char* configSection;
+    UBaseType_t taskPriority;
+    uint32_t stackSize;     // Bytes of the module's static task stack, 0 for a cooperative module
+    BaseType_t core;        // Core the module task is pinned to, or tskNO_AFFINITY
+    bool enabledByDefault;  // Whether the module runs when its section has no "enable" key
+    IModule* (*construct)();  // Builds the instance in its static storage
+    StackType_t* stack;       // nullptr for a cooperative module
+    StaticTask_t* taskBuffer;
 };
 
-class ModuleRegistry {
-  private:
-    static std::vector<ModuleInfo> modules;
+// Static storage for one module type: room for its single instance and, with a task, the task's
+// stack and control block. ESP-IDF counts stacks in bytes, i.e. StackType_t is one byte.
+template <typename T, uint32_t StackSize>
+struct ModuleStorage {
+    static IModule* construct() { return new (&object) T(); }
+
+    static typename std::aligned_storage<sizeof(T), alignof(T)>::type object;
+    static StackType_t stack[StackSize > 0 ? StackSize : 1];
+    static StaticTask_t taskBuffer;
+};
+
+template <typename T, uint32_t StackSize>
+typename std::aligned_storage<sizeof(T), alignof(T)>::type ModuleStorage<T, StackSize>::object;
+
+template <typename T, uint32_t StackSize>
+StackType_t ModuleStorage<T, StackSize>::stack[StackSize > 0 ? StackSize : 1];
+
+template <typename T, uint32_t StackSize>
+StaticTask_t ModuleStorage<T, StackSize>::taskBuffer;
 
+// Table entry for module type T. A stack size of 0 runs it on the module runtime, which requires
+// IModule::IsCooperative(); otherwise it gets a task with this much static stack. Priority and
+// core can be overridden by "priority" and "core" in its INI section.
+template <typename T, uint32_t StackSize>
+constexpr ModuleInfo DefineModule(const char* name, const char* configSection, UBaseType_t priority,
+                                  BaseType_t core = tskNO_AFFINITY, bool enabledByDefault = false) {
+    static_assert(std::is_base_of<IModule, T>::value, "T must implement IModule");
+    return ModuleInfo{name,
+                      configSection,
+                      priority,
+                      StackSize,
+                      core,
+                      enabledByDefault,
+                      &ModuleStorage<T, StackSize>::construct,
+                      StackSize > 0 ? ModuleStorage<T, StackSize>::stack : nullptr,
+                      StackSize > 0 ? &ModuleStorage<T, StackSize>::taskBuffer : nullptr};
+}
+
+/**
+ * Module Registry
+ *
+ * Read-only view of the module table in module_table.cpp, which lists every firmware module with
+ * DefineModule(). The table is constant-initialized, so it needs no registration code at boot,
+ * and each module's instance and task stack are reserved in static storage at link time.
+ */
+class ModuleRegistry {
   public:
-    // Register a module
-    static void RegisterModule(const String& name, const String& configSection, int priority, int stackSize,
-                               std::function<IModule*()> factory);
+    static const int MAX_MODULES = 8;
 
-    // Get all registered modules
-    static const std::vector<ModuleInfo>& GetModules();
+    static const ModuleInfo* GetModules();
+    static int GetModuleCount();
 
     // Get module by name
-    static const ModuleInfo* GetModule(const String& name);
+    static const ModuleInfo* GetModule(const char* name);
 
     // Print all registered modules
     static void PrintRegisteredModules();
 };
 
-// Helper class for auto-registration
-class ModuleRegistrar {
-  public:
-    ModuleRegistrar(const String& name, const String& configSection, int priority, int stackSize,
-                    std::function<IModule*()> factory) {
-        ModuleRegistry::RegisterModule(name, configSection, priority, stackSize, factory);
-    }
-};
-
 }  // namespace modules
 
-// Macro for easy module registration
-#define REGISTER_MODULE(name, configSection, priority, stackSize, moduleClass)                               \
-    namespace {                                                                                              \
-    static modules::ModuleRegistrar auto_registrar(name, configSection, priority, stackSize,                 \
-                                                   []() -> modules::IModule* { return new moduleClass(); }); \
-    }
-
-#endif  // MODULE_REGISTRY_H
\ No newline at end of file
+#endif  // MODULE_REGISTRY_H
@@ -0,0 +1,22 @@
+#include "module_registry.h"
+#include "../pins.h"
+#include "accuweather.h"
+#include "clock.h"
+#include "overlay.h"
+
+namespace modules {
+
+// Every firmware module, in start order. Cooperative modules have no stack of their own; modules
+// doing network I/O belong on NETWORK_CORE.
+extern constexpr ModuleInfo MODULE_TABLE[] = {
+    DefineModule<Clock, 0>("Clock", "clock", 2),
+    DefineModule<AccuWeather, 12 * 1024>("AccuWeather", "accuweather", 5, NETWORK_CORE),
+    DefineModule<Overlay, 0>("Overlay", "overlay", 3, tskNO_AFFINITY, true),
+};
+
+extern const int MODULE_TABLE_SIZE = sizeof(MODULE_TABLE) / sizeof(MODULE_TABLE[0]);
+
+static_assert(sizeof(MODULE_TABLE) / sizeof(MODULE_TABLE[0]) <= ModuleRegistry::MAX_MODULES,
+              "Raise ModuleRegistry::MAX_MODULES");
+
+}  // namespace modules
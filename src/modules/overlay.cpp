@@ -4,6 +4,8 @@
 #include <U8g2lib.h>
 #include <WiFi.h>
 #include "../config_manager.h"
+#include "../display.h"
+#include "../telemetry.h"
 #include "../wifi_manager.h"
 #include "module_registry.h"
 
@@ -37,6 +39,7 @@ bool Overlay::ConfigureFromSection(const ConfigSection& section) {
     moduleConfig.showWifi = section.getBoolValue("show_wifi", true);
     moduleConfig.showCpu = section.getBoolValue("show_cpu", true);
     moduleConfig.showUptime = section.getBoolValue("show_uptime", true);
+    moduleConfig.showFrameStats = section.getBoolValue("show_frame_stats", false);
     moduleConfig.fontSize = section.getIntValue("font_size", 3);        // Largest font for visibility
     moduleConfig.corner = section.getIntValue("corner", 1);             // Top-left corner
     moduleConfig.spacing = section.getIntValue("spacing", 12);          // More spacing for bigger font
@@ -64,6 +67,7 @@ bool Overlay::ConfigureFromSection(const ConfigSection& section) {
     LOG_INFOF("  Show WiFi: %s\n", moduleConfig.showWifi ? "YES" : "NO");
     LOG_INFOF("  Show CPU: %s\n", moduleConfig.showCpu ? "YES" : "NO");
     LOG_INFOF("  Show Uptime: %s\n", moduleConfig.showUptime ? "YES" : "NO");
+    LOG_INFOF("  Show Frame Stats: %s\n", moduleConfig.showFrameStats ? "YES" : "NO");
     LOG_INFOF("  Font Size: %d\n", moduleConfig.fontSize);
     LOG_INFOF("  Corner: %d\n", moduleConfig.corner);
     LOG_INFOF("  Spacing: %d\n", moduleConfig.spacing);
@@ -80,12 +84,12 @@ void Overlay::Setup() {
     instance = this;
     
     // Subscribe to button events
-    EventManager::Subscribe<ButtonLongPressEvent>(onButtonLongPress);
-    EventManager::Subscribe<ButtonShortPressEvent>(onButtonShortPress);
+    EventManager::Subscribe<ButtonLongPressEvent>(onButtonLongPress, EventManager::Delivery::QUEUED);
+    EventManager::Subscribe<ButtonShortPressEvent>(onButtonShortPress, EventManager::Delivery::QUEUED);
     
     // Initialize FPS tracking
     lastFrameTime = millis();
-    frameCount = 0;
+    frameCount = Display::GetFrameCount();
     currentFps = 0.0f;
     lastFpsUpdate = millis();
     
@@ -112,54 +116,51 @@ void Overlay::Setup() {
     LOG_INFO("Overlay: Use long press to show, short press to hide");
 }
 
-void Overlay::Run(void* parameter) {
-    LOG_INFO("Overlay Run");
+void Overlay::Teardown() {
+    EventManager::Unsubscribe<ButtonLongPressEvent>(onButtonLongPress);
+    EventManager::Unsubscribe<ButtonShortPressEvent>(onButtonShortPress);
 
-    // Wait for configuration to be ready
-    ConfigManager* configManager = ConfigManager::getInstance();
-    while (!configManager->IsReady()) {
-        LOG_INFO("Waiting for config to be ready...");
-        vTaskDelay(pdMS_TO_TICKS(1000));
+    // A callback already dispatched holds the composition lock while it touches the instance
+    Display::LockComposition();
+    if (instance == this) {
+        instance = nullptr;
     }
+    Display::UnlockComposition();
+}
 
-    // Re-configure from INI section now that config is ready
-    ConfigSection moduleSection = configManager->getConfigSection("overlay");
-    
-    if (!ConfigureFromSection(moduleSection)) {
-        LOG_INFO("Failed to re-configure Overlay module after config ready");
-        vTaskDelete(NULL);
-        return;
-    }
+uint32_t Overlay::Tick() {
+    if (!configured) {
+        // Re-configure from INI section now that config is ready
+        ConfigSection moduleSection = ConfigManager::getInstance()->getConfigSection("overlay");
+        if (!ConfigureFromSection(moduleSection)) {
+            LOG_INFO("Failed to re-configure Overlay module after config ready");
+            return TICK_DONE;
+        }
+        configured = true;
 
-    if (!moduleConfig.enable) {
-        vTaskDelete(NULL);
-        return;
-    }
+        if (!moduleConfig.enable) {
+            return TICK_DONE;
+        }
 
-    ready = true;
-    LOG_INFO("Overlay module is now READY and enabled!");
+        ready = true;
+        LOG_INFO("Overlay module is now READY and enabled!");
+    }
 
-    while (true) {
-        // Update overlay information periodically (not FPS - that's counted in Draw())
-        updateMemory();
-        updateWifi();
-        updateCpu();
-        updateUptime();
-        
-        // Debug log every 5 seconds
-        static unsigned long lastDebugLog = 0;
-        if (millis() - lastDebugLog > 5000) {
-            LOG_INFOF("Overlay: FPS=%.1f, MEM=%s, WiFi=%s, CPU=%.1f%%, Uptime=%s\n", 
-                     currentFps, formatMemory(currentFreeHeap).c_str(), formatWifiSignal(currentRssi).c_str(),
-                     currentCpuUsage, formatUptime(currentUptime).c_str());
-            lastDebugLog = millis();
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(100)); // Update every 100ms
+    // Update overlay information periodically (not FPS - that's counted in Draw())
+    updateMemory();
+    updateWifi();
+    updateCpu();
+    updateUptime();
+
+    // Debug log every 5 seconds
+    if (millis() - lastDebugLog > 5000) {
+        LOG_INFOF("Overlay: FPS=%.1f, MEM=%s, WiFi=%s, CPU=%.1f%%, Uptime=%s\n",
+                  currentFps, formatMemory(currentFreeHeap).c_str(), formatWifiSignal(currentRssi).c_str(),
+                  currentCpuUsage, formatUptime(currentUptime).c_str());
+        lastDebugLog = millis();
     }
-    
-    vTaskDelete(NULL);
-    return;
+
+    return 100;  // Update every 100ms
 }
 
 void Overlay::Draw() {
@@ -177,14 +178,24 @@ bool Overlay::IsReady() {
     return ready; 
 }
 
+bool Overlay::GetBounds(Bounds& bounds) const {
+    // Before the first draw the size is unknown; the whole screen is safe
+    if (!hasDrawnBounds) {
+        return false;
+    }
+    bounds = drawnBounds;
+    return true;
+}
+
 void Overlay::updateFps() {
+    // Frames actually sent: Draw() may run once per invalidated region of a frame
     unsigned long currentTime = millis();
-    frameCount++;
-    
+    uint32_t frames = Display::GetFrameCount();
+
     // Update FPS every second
     if (currentTime - lastFpsUpdate >= 1000) {
-        currentFps = frameCount / ((currentTime - lastFpsUpdate) / 1000.0f);
-        frameCount = 0;
+        currentFps = (frames - frameCount) / ((currentTime - lastFpsUpdate) / 1000.0f);
+        frameCount = frames;
         lastFpsUpdate = currentTime;
     }
 }
@@ -216,60 +227,9 @@ void Overlay::updateWifi() {
 void Overlay::updateCpu() {
     unsigned long currentTime = millis();
     
-    // Update CPU info every 1 second
+    // Update CPU info every 1 second from the telemetry snapshot taken by the system monitor
     if (currentTime - lastCpuUpdate >= 1000) {
-        // Simple CPU usage estimation based on system activity
-        // We'll use a combination of factors to estimate CPU load
-        
-        static unsigned long lastUpdateTime = 0;
-        static size_t lastHeapSize = ESP.getFreeHeap();
-        static int lastWifiRssi = WiFi.RSSI();
-        
-        if (lastUpdateTime == 0) {
-            // First run - initialize values
-            lastUpdateTime = currentTime;
-            lastHeapSize = ESP.getFreeHeap();
-            lastWifiRssi = WiFi.RSSI();
-            currentCpuUsage = 5.0f; // Default low usage
-        } else {
-            // Calculate simple heuristic based on system changes
-            size_t currentHeap = ESP.getFreeHeap();
-            int currentWifiRssi = WiFi.RSSI();
-            
-            // Memory allocation activity (more allocation = more CPU usage)
-            float memoryActivity = 0.0f;
-            if (lastHeapSize > currentHeap) {
-                size_t allocated = lastHeapSize - currentHeap;
-                memoryActivity = (allocated > 5000) ? 30.0f : (allocated > 1000) ? 15.0f : 5.0f;
-            }
-            
-            // WiFi activity (RSSI changes can indicate network activity)
-            float wifiActivity = 0.0f;
-            if (abs(currentWifiRssi - lastWifiRssi) > 5) {
-                wifiActivity = 10.0f;
-            }
-            
-            // Task switching estimation (simplified)
-            float baseUsage = 8.0f; // Base system overhead
-            
-            // Combine factors
-            currentCpuUsage = baseUsage + memoryActivity + wifiActivity;
-            
-            // Add some variation to make it look realistic
-            static int variation = 0;
-            variation = (variation + 1) % 10;
-            currentCpuUsage += (variation - 5) * 2.0f; // +/- 10% variation
-            
-            // Clamp values between 0 and 100
-            if (currentCpuUsage < 0.0f) currentCpuUsage = 0.0f;
-            if (currentCpuUsage > 100.0f) currentCpuUsage = 100.0f;
-            
-            // Update tracking variables
-            lastHeapSize = currentHeap;
-            lastWifiRssi = currentWifiRssi;
-        }
-        
-        lastUpdateTime = currentTime;
+        currentCpuUsage = Telemetry::getInstance()->getTotalLoad();
         lastCpuUpdate = currentTime;
     }
 }
@@ -285,7 +245,11 @@ void Overlay::updateUptime() {
 }
 
 String Overlay::formatCpuUsage(float cpuUsage) {
-    return String((int)cpuUsage) + "%";
+    // Negative means run-time stats are not compiled into FreeRTOS
+    if (cpuUsage < 0.0f) {
+        return "--";
+    }
+    return String((int)(cpuUsage + 0.5f)) + "%";
 }
 
 String Overlay::formatUptime(unsigned long uptimeMs) {
@@ -305,6 +269,14 @@ String Overlay::formatUptime(unsigned long uptimeMs) {
     }
 }
 
+String Overlay::formatLatency(const LatencyHistogram& histogram) {
+    // p50/p95/max in milliseconds, one decimal
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%.1f/%.1f/%.1f", histogram.getPercentile(50) / 1000.0f,
+             histogram.getPercentile(95) / 1000.0f, histogram.getMax() / 1000.0f);
+    return String(buffer);
+}
+
 void Overlay::drawOverlayInfo() {
     // Select font based on size
     switch (moduleConfig.fontSize) {
@@ -326,7 +298,7 @@ void Overlay::drawOverlayInfo() {
     getPositionForCorner(baseX, baseY);
     
     // Prepare all texts first to calculate dimensions
-    String texts[5];
+    String texts[8];
     int textCount = 0;
     
     if (moduleConfig.showFps) {
@@ -344,6 +316,15 @@ void Overlay::drawOverlayInfo() {
     if (moduleConfig.showUptime) {
         texts[textCount++] = "UP:" + formatUptime(currentUptime);
     }
+    if (moduleConfig.showFrameStats) {
+        // Bus wait and send are written by the transfer task; work on a consistent copy.
+        // Static so the display task stack does not carry three histograms.
+        static LatencyHistogram spiWait, draw, send;
+        Display::CopyFrameHistograms(spiWait, draw, send);
+        texts[textCount++] = "BUS:" + formatLatency(spiWait);
+        texts[textCount++] = "DRW:" + formatLatency(draw);
+        texts[textCount++] = "TX:" + formatLatency(send);
+    }
     
     if (textCount == 0) return; // Nothing to draw
     
@@ -364,6 +345,10 @@ void Overlay::drawOverlayInfo() {
         bgX = 128 - backgroundWidth ;
     }
     
+    // Area for the compositor, which clips the next frame to it and re-renders it once hidden
+    drawnBounds = {bgX, baseY - 8, backgroundWidth, backgroundHeight};
+    hasDrawnBounds = true;
+
     // Draw background rectangle (filled)
     u8g2.setDrawColor(1);
     u8g2.drawBox(bgX, baseY - 8, backgroundWidth, backgroundHeight);
@@ -441,17 +426,30 @@ void Overlay::getPositionForCorner(int& x, int& y) {
     }
 }
 
-void Overlay::onButtonLongPress(const ButtonLongPressEvent& event) {
-    if (instance != nullptr) {
-        LOG_INFO("Overlay: Long press detected - showing overlay");
-        instance->isVisible = true;
+uint32_t Overlay::GetRedrawInterval() {
+    // Hidden overlay never needs a frame; visible one refreshes as fast as its fastest stat (memory)
+    if (!ready || !isVisible) {
+        return REDRAW_NEVER;
     }
+    return 500;
 }
 
-void Overlay::onButtonShortPress(const ButtonShortPressEvent& event) {
-    if (instance != nullptr) {
-        LOG_INFO("Overlay: Short press detected - hiding overlay");
-        instance->isVisible = false;
+void Overlay::onButtonLongPress(const ButtonLongPressEvent& event) { setVisible(true); }
+
+void Overlay::onButtonShortPress(const ButtonShortPressEvent& event) { setVisible(false); }
+
+void Overlay::setVisible(bool visible) {
+    Display::LockComposition();
+    bool changed = instance != nullptr;
+    if (changed) {
+        LOG_INFOF("Overlay: %s press detected - %s overlay\n", visible ? "Long" : "Short",
+                  visible ? "showing" : "hiding");
+        instance->isVisible = visible;
+    }
+    Display::UnlockComposition();
+
+    if (changed) {
+        Display::RequestRedraw();
     }
 }
 
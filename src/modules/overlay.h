@@ -5,6 +5,7 @@
 #include "logger.h"
 #include "module.h"
 #include "../event_manager.h"
+#include "../latency_histogram.h"
 
 namespace modules {
 
@@ -15,6 +16,7 @@ struct OverlayConfig : public ModuleConfig {
     bool showWifi = true;
     bool showCpu = true;
     bool showUptime = true;
+    bool showFrameStats = false;  // p50/p95/max of SPI wait, draw and transfer time
     int fontSize = 1;           // 1=small, 2=medium, 3=large
     int corner = 1;             // 1=top-left, 2=top-right, 3=bottom-left, 4=bottom-right
     int spacing = 8;            // spacing between lines
@@ -24,12 +26,18 @@ struct OverlayConfig : public ModuleConfig {
 class Overlay : public IModule {
   public:
     void Setup() override;
-    void Run(void* parameter) override;
+    void Teardown() override;
     void Draw() override;
     bool IsReady() override;
     void Configure(const ModuleConfig& config) override;
     bool ConfigureFromSection(const ConfigSection& section) override;
     bool IsOverlay() const override { return true; }
+    bool IsVisible() const override { return ready && isVisible; }
+    bool GetBounds(Bounds& bounds) const override;
+    const char* GetName() const override { return "Overlay"; }
+    uint32_t GetRedrawInterval() override;
+    bool IsCooperative() const override { return true; }
+    uint32_t Tick() override;
 
   private:
     // Module configuration
@@ -37,11 +45,15 @@ class Overlay : public IModule {
 
     // Module state
     bool ready = false;
+    bool configured = false;
     bool isVisible = false;  // Controls overlay visibility
+    Bounds drawnBounds;      // Background box of the last draw
+    bool hasDrawnBounds = false;
+    unsigned long lastDebugLog = 0;
     
     // FPS tracking
     unsigned long lastFrameTime = 0;
-    unsigned long frameCount = 0;
+    unsigned long frameCount = 0;  // Display frame count at lastFpsUpdate
     float currentFps = 0.0f;
     unsigned long lastFpsUpdate = 0;
     
@@ -64,7 +76,8 @@ class Overlay : public IModule {
     // Button event handlers
     static void onButtonLongPress(const ButtonLongPressEvent& event);
     static void onButtonShortPress(const ButtonShortPressEvent& event);
-    static Overlay* instance;  // Static instance for event callbacks
+    static void setVisible(bool visible);
+    static Overlay* instance;  // Static instance for event callbacks, guarded by the composition lock
     
     // Helper methods
     void updateFps();
@@ -77,6 +90,7 @@ class Overlay : public IModule {
     String formatWifiSignal(int rssi);
     String formatCpuUsage(float cpuUsage);
     String formatUptime(unsigned long uptimeMs);
+    String formatLatency(const LatencyHistogram& histogram);
     void getPositionForCorner(int& x, int& y);
 };
 
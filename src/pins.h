@@ -20,4 +20,11 @@
 #define DISPLAY_DC_PIN 5
 #define DISPLAY_RES_PIN 15
 
+// The WiFi driver and lwIP run on core 0; rendering gets core 1 to itself so downloads never cost frames
+#define NETWORK_CORE 0
+#define RENDER_CORE 1
+
+// With -DDISPLAY_USE_DMA the panel needs its own SCK/MOSI pair, e.g. in build_flags:
+//   -DDISPLAY_USE_DMA -DDISPLAY_DMA_CLK_PIN=<pin> -DDISPLAY_DMA_MOSI_PIN=<pin>
+
 #endif
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "power_manager.h"
+#include <esp_idf_version.h>
+#include <esp_pm.h>
+#include "button.h"
+#include "logger.h"
+
+bool PowerManager::powerSaving = false;
+bool PowerManager::displayActive = false;
+bool PowerManager::buzzerActive = false;
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t displayLock = nullptr;
+static esp_pm_lock_handle_t buzzerLock = nullptr;
+#endif
+
+int PowerManager::clampFrequency(int mhz) {
+    // The S3 only runs its PLL at 80, 160 or 240 MHz
+    if (mhz <= MIN_CPU_MHZ) {
+        return MIN_CPU_MHZ;
+    }
+    if (mhz <= 160) {
+        return 160;
+    }
+    return MAX_CPU_MHZ;
+}
+
+void PowerManager::Configure(const Config::PowerSettings& settings) {
+    int maxMhz = clampFrequency(settings.maxCpuMhz);
+    int minMhz = clampFrequency(settings.minCpuMhz);
+    if (minMhz > maxMhz) {
+        minMhz = maxMhz;
+    }
+
+    if (!settings.enabled) {
+        if (getCpuFrequencyMhz() != (uint32_t)maxMhz) {
+            setCpuFrequencyMhz(maxMhz);
+        }
+        LOG_INFOF("Power: Fixed %d MHz, power management off\n", maxMhz);
+        return;
+    }
+
+#if CONFIG_PM_ENABLE
+    bool lightSleep = settings.lightSleep;
+#if !CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    if (lightSleep) {
+        LOG_WARNING("Power: Light sleep needs tickless idle in the framework build, using DFS only");
+        lightSleep = false;
+    }
+#endif
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t pmConfig = {};
+#else
+    esp_pm_config_esp32s3_t pmConfig = {};
+#endif
+    pmConfig.max_freq_mhz = maxMhz;
+    pmConfig.min_freq_mhz = minMhz;
+    pmConfig.light_sleep_enable = lightSleep;
+
+    esp_err_t err = esp_pm_configure(&pmConfig);
+    if (err != ESP_OK) {
+        LOG_ERRORF("Power: esp_pm_configure failed (%d), staying at %u MHz\n", err, getCpuFrequencyMhz());
+        return;
+    }
+    if (displayLock == nullptr && esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "display", &displayLock) != ESP_OK) {
+        displayLock = nullptr;
+        LOG_WARNING("Power: Display frequency lock unavailable");
+    }
+    if (buzzerLock == nullptr && esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "buzzer", &buzzerLock) != ESP_OK) {
+        buzzerLock = nullptr;
+        LOG_WARNING("Power: Buzzer sleep lock unavailable");
+    }
+    if (lightSleep) {
+        Button::EnableWakeup();
+    }
+
+    powerSaving = true;
+    LOG_INFOF("Power: DFS %d-%d MHz, light sleep %s\n", minMhz, maxMhz, lightSleep ? "on" : "off");
+#else
+    setCpuFrequencyMhz(maxMhz);
+    LOG_WARNINGF("Power: Framework built without CONFIG_PM_ENABLE, fixed %d MHz\n", maxMhz);
+#endif
+}
+
+void PowerManager::SetDisplayActive(bool active) {
+    // Called from the display task only
+    if (active == displayActive) {
+        return;
+    }
+    displayActive = active;
+#if CONFIG_PM_ENABLE
+    if (displayLock != nullptr) {
+        if (active) {
+            esp_pm_lock_acquire(displayLock);
+        } else {
+            esp_pm_lock_release(displayLock);
+        }
+    }
+#endif
+}
+
+void PowerManager::SetBuzzerActive(bool active) {
+    if (active == buzzerActive) {
+        return;
+    }
+    buzzerActive = active;
+#if CONFIG_PM_ENABLE
+    if (buzzerLock != nullptr) {
+        if (active) {
+            esp_pm_lock_acquire(buzzerLock);
+        } else {
+            esp_pm_lock_release(buzzerLock);
+        }
+    }
+#endif
+}
@@ -0,0 +1,45 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+/**
+ * Power Management
+ *
+ * With [power] enable=true the CPU clock follows the load through esp_pm dynamic frequency
+ * scaling between min_cpu_mhz and max_cpu_mhz, and the chip enters automatic light sleep
+ * whenever every task is blocked (needs a framework built with tickless idle). Buttons are
+ * armed as GPIO wake sources so a press still wakes the chip.
+ *
+ * Subsystems that need full speed hold a frequency lock while they are busy; the display
+ * holds one while it animates, the buzzer keeps the chip out of light sleep while a tone plays
+ * (LEDC stops in light sleep). Without CONFIG_PM_ENABLE the CPU is set once to max_cpu_mhz.
+ */
+class PowerManager {
+  public:
+    // Apply the [power] settings, called once after the configuration is loaded
+    static void Configure(const Config::PowerSettings& settings);
+
+    // True once DFS is active; the display then governs its frame rate
+    static bool IsPowerSaving() { return powerSaving; }
+
+    // Keep the CPU at max_cpu_mhz while the display animates, release it when the frame is static
+    static void SetDisplayActive(bool active);
+
+    // Hold off light sleep while the buzzer sounds; called by the buzzer with its sequencer locked
+    static void SetBuzzerActive(bool active);
+
+  private:
+    // The APB bus runs from the CPU PLL only from 80 MHz up; lower would retime SPI and UART
+    static const int MIN_CPU_MHZ = 80;
+    static const int MAX_CPU_MHZ = 240;
+
+    static bool powerSaving;
+    static bool displayActive;
+    static bool buzzerActive;
+
+    static int clampFrequency(int mhz);
+};
+
+#endif  // POWER_MANAGER_H
@@ -0,0 +1,67 @@
+#include "psram_arena.h"
+#include <esp_heap_caps.h>
+#include <cstring>
+
+PsramArena::~PsramArena() {
+    if (base != nullptr) {
+        heap_caps_free(base);
+    }
+}
+
+bool PsramArena::begin(size_t requestedCapacity) {
+    if (base != nullptr) {
+        return true;
+    }
+
+    base = (uint8_t*)heap_caps_malloc(requestedCapacity, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (base == nullptr) {
+        return false;
+    }
+
+    capacity = requestedCapacity;
+    reset();
+    return true;
+}
+
+void* PsramArena::allocate(size_t bytes) {
+    size_t offset = (used + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (base == nullptr || bytes > capacity || offset > capacity - bytes) {
+        return nullptr;
+    }
+
+    used = offset + bytes;
+    lastOffset = offset;
+    if (used > highWater) {
+        highWater = used;
+    }
+    return base + offset;
+}
+
+void* PsramArena::reallocate(void* ptr, size_t oldBytes, size_t newBytes) {
+    if (ptr == nullptr) {
+        return allocate(newBytes);
+    }
+
+    size_t offset = (uint8_t*)ptr - base;
+    if (owns(ptr) && offset == lastOffset) {
+        if (newBytes > capacity - offset) {
+            return nullptr;
+        }
+        used = offset + newBytes;
+        if (used > highWater) {
+            highWater = used;
+        }
+        return ptr;
+    }
+
+    void* moved = allocate(newBytes);
+    if (moved != nullptr) {
+        memcpy(moved, ptr, oldBytes < newBytes ? oldBytes : newBytes);
+    }
+    return moved;
+}
+
+void PsramArena::reset() {
+    used = 0;
+    lastOffset = SIZE_MAX;
+}
@@ -0,0 +1,81 @@
+#ifndef PSRAM_ARENA_H
+#define PSRAM_ARENA_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * PSRAM Arena
+ *
+ * Bump allocator over one PSRAM block. Allocations are never freed individually; the whole
+ * arena is reset when the operation that owns it finishes, so repeated parse/response cycles
+ * leave no fragmentation behind and internal SRAM stays free for WiFi and TCP buffers.
+ * The most recent allocation can grow in place, which suits append-only buffers.
+ * Not synchronized: an arena belongs to one operation at a time (see MemoryManager::getArena).
+ */
+class PsramArena {
+public:
+    PsramArena() = default;
+    ~PsramArena();
+
+    PsramArena(const PsramArena&) = delete;
+    PsramArena& operator=(const PsramArena&) = delete;
+
+    // Reserve the backing block once; fails when PSRAM is missing or exhausted
+    bool begin(size_t capacity);
+    bool isReady() const { return base != nullptr; }
+
+    void* allocate(size_t bytes);
+    // Grows in place when ptr is the last allocation, otherwise copies into a new one
+    void* reallocate(void* ptr, size_t oldBytes, size_t newBytes);
+    void reset();
+
+    bool owns(const void* ptr) const {
+        return base != nullptr && (const uint8_t*)ptr >= base && (const uint8_t*)ptr < base + capacity;
+    }
+
+    size_t getUsed() const { return used; }
+    size_t getCapacity() const { return capacity; }
+    size_t getHighWater() const { return highWater; }
+
+private:
+    static const size_t ALIGNMENT = 8;
+
+    uint8_t* base = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+    size_t highWater = 0;
+    size_t lastOffset = SIZE_MAX;
+};
+
+/**
+ * ArduinoJson allocator drawing from a PsramArena, for BasicJsonDocument<ArenaJsonAllocator>.
+ * Falls back to the regular heap when there is no arena or it is full.
+ */
+struct ArenaJsonAllocator {
+    PsramArena* arena;
+
+    explicit ArenaJsonAllocator(PsramArena* arena = nullptr) : arena(arena) {}
+
+    void* allocate(size_t size) {
+        void* ptr = arena != nullptr ? arena->allocate(size) : nullptr;
+        return ptr != nullptr ? ptr : malloc(size);
+    }
+
+    void deallocate(void* ptr) {
+        if (arena == nullptr || !arena->owns(ptr)) {
+            free(ptr);
+        }
+    }
+
+    void* reallocate(void* ptr, size_t newSize) {
+        // ArduinoJson only shrinks documents (shrinkToFit); arena memory can simply stay put
+        if (arena != nullptr && arena->owns(ptr)) {
+            return ptr;
+        }
+        return realloc(ptr, newSize);
+    }
+};
+
+#endif // PSRAM_ARENA_H
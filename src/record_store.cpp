@@ -0,0 +1,180 @@
+#include "record_store.h"
+#include <esp_heap_caps.h>
+#include <cstring>
+#include "config_store.h"
+#include "logger.h"
+
+RecordStore::~RecordStore() { discard(); }
+
+bool RecordStore::load(const char* key, uint16_t version, void* data, size_t size) {
+    nvs_handle_t handle;
+    if (nvs_open(nvsNamespace, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+
+    size_t length = sizeof(Header) + size;
+    uint8_t* record = (uint8_t*)heap_caps_malloc(length, MALLOC_CAP_8BIT);
+    if (record == nullptr) {
+        nvs_close(handle);
+        return false;
+    }
+
+    size_t stored = length;
+    esp_err_t result = nvs_get_blob(handle, key, record, &stored);
+    nvs_close(handle);
+
+    Header header;
+    memcpy(&header, record, sizeof(header));
+    bool valid = result == ESP_OK && stored == length && header.magic == RECORD_MAGIC && header.version == version &&
+                 header.size == size && ConfigStore::crc32((const char*)record + sizeof(Header), size) == header.crc;
+
+    if (valid) {
+        memcpy(data, record + sizeof(Header), size);
+        remember(key, header);
+    } else if (result != ESP_ERR_NVS_NOT_FOUND) {
+        LOG_WARNINGF("RecordStore: %s/%s rejected (version, size or CRC mismatch)\n", nvsNamespace, key);
+    }
+
+    heap_caps_free(record);
+    return valid;
+}
+
+bool RecordStore::stage(const char* key, uint16_t version, const void* data, size_t size) {
+    if (strlen(key) > MAX_KEY_LENGTH) {
+        return false;
+    }
+
+    Staged* entry = nullptr;
+    for (int i = 0; i < stagedCount; i++) {
+        if (strcmp(staged[i].key, key) == 0) {
+            entry = &staged[i];
+            heap_caps_free(entry->record);
+            break;
+        }
+    }
+    if (entry == nullptr) {
+        if (stagedCount == MAX_STAGED) {
+            LOG_WARNINGF("RecordStore: Transaction full, %s not staged\n", key);
+            return false;
+        }
+        entry = &staged[stagedCount++];
+        strcpy(entry->key, key);
+    }
+
+    entry->length = sizeof(Header) + size;
+    entry->record = (uint8_t*)heap_caps_malloc(entry->length, MALLOC_CAP_8BIT);
+    if (entry->record == nullptr) {
+        // Keep the table dense: move the last entry into this slot
+        *entry = staged[--stagedCount];
+        return false;
+    }
+
+    Header header;
+    header.magic = RECORD_MAGIC;
+    header.version = version;
+    header.reserved = 0;
+    header.size = size;
+    header.crc = ConfigStore::crc32((const char*)data, size);
+    memcpy(entry->record, &header, sizeof(header));
+    memcpy(entry->record + sizeof(header), data, size);
+    return true;
+}
+
+int RecordStore::commit() {
+    if (stagedCount == 0) {
+        return 0;
+    }
+
+    nvs_handle_t handle;
+    if (nvs_open(nvsNamespace, NVS_READWRITE, &handle) != ESP_OK) {
+        LOG_ERRORF("RecordStore: Cannot open NVS namespace %s\n", nvsNamespace);
+        return -1;
+    }
+
+    int written = 0;
+    bool failed = false;
+    for (int i = 0; i < stagedCount && !failed; i++) {
+        if (matchesFlash(handle, staged[i])) {
+            continue;
+        }
+        if (nvs_set_blob(handle, staged[i].key, staged[i].record, staged[i].length) != ESP_OK) {
+            failed = true;
+            break;
+        }
+        written++;
+    }
+
+    if (!failed && written > 0 && nvs_commit(handle) != ESP_OK) {
+        failed = true;
+    }
+    nvs_close(handle);
+
+    if (failed) {
+        LOG_ERRORF("RecordStore: Commit to %s failed\n", nvsNamespace);
+        return -1;
+    }
+
+    for (int i = 0; i < stagedCount; i++) {
+        Header header;
+        memcpy(&header, staged[i].record, sizeof(header));
+        remember(staged[i].key, header);
+    }
+    LOG_DEBUGF("RecordStore: %s committed, %d of %d records written\n", nvsNamespace, written, stagedCount);
+    discard();
+    return written;
+}
+
+void RecordStore::discard() {
+    for (int i = 0; i < stagedCount; i++) {
+        heap_caps_free(staged[i].record);
+        staged[i].record = nullptr;
+    }
+    stagedCount = 0;
+}
+
+bool RecordStore::matchesFlash(nvs_handle_t handle, const Staged& entry) {
+    Header header;
+    memcpy(&header, entry.record, sizeof(header));
+
+    const Known* last = findKnown(entry.key);
+    if (last != nullptr) {
+        return last->crc == header.crc && last->size == header.size && last->version == header.version;
+    }
+
+    // Nothing loaded or written this boot: compare against the stored header
+    size_t storedLength = 0;
+    if (nvs_get_blob(handle, entry.key, nullptr, &storedLength) != ESP_OK || storedLength != entry.length) {
+        return false;
+    }
+    uint8_t* stored = (uint8_t*)heap_caps_malloc(storedLength, MALLOC_CAP_8BIT);
+    if (stored == nullptr) {
+        return false;
+    }
+    bool same = nvs_get_blob(handle, entry.key, stored, &storedLength) == ESP_OK &&
+                memcmp(stored, entry.record, entry.length) == 0;
+    heap_caps_free(stored);
+    return same;
+}
+
+void RecordStore::remember(const char* key, const Header& header) {
+    Known* entry = const_cast<Known*>(findKnown(key));
+    if (entry == nullptr) {
+        if (knownCount == MAX_STAGED) {
+            return;
+        }
+        entry = &known[knownCount++];
+        strcpy(entry->key, key);
+    }
+    entry->crc = header.crc;
+    entry->size = header.size;
+    entry->version = header.version;
+}
+
+const RecordStore::Known* RecordStore::findKnown(const char* key) const {
+    for (int i = 0; i < knownCount; i++) {
+        if (strcmp(known[i].key, key) == 0) {
+            return &known[i];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,77 @@
+#ifndef RECORD_STORE_H
+#define RECORD_STORE_H
+
+#include <Arduino.h>
+#include <nvs.h>
+#include <stdint.h>
+
+/**
+ * Record Store
+ *
+ * Transactional persistence of small binary records in one NVS namespace. Every record is
+ * stored with a header carrying its layout version, payload size and CRC-32, so a record written
+ * by an older layout or damaged in flash is rejected on load rather than trusted. Writers stage
+ * records in RAM and commit a whole logical transaction at once; a staged record whose content
+ * equals what is already in flash is dropped without writing, so an unchanged forecast costs no
+ * flash wear at all. NVS itself spreads writes across its pages.
+ */
+class RecordStore {
+  public:
+    explicit RecordStore(const char* nvsNamespace) : nvsNamespace(nvsNamespace) {}
+    ~RecordStore();
+
+    RecordStore(const RecordStore&) = delete;
+    RecordStore& operator=(const RecordStore&) = delete;
+
+    // Read a record; false when it is missing, from another version or of another size, or corrupt
+    bool load(const char* key, uint16_t version, void* data, size_t size);
+
+    // Copy a record into the pending transaction, replacing an earlier stage of the same key
+    bool stage(const char* key, uint16_t version, const void* data, size_t size);
+
+    // Write every staged record that differs from flash, with a single NVS commit.
+    // Returns the number of records written, or -1 on failure. The staged records are then still
+    // staged; call commit() again to retry or discard() to drop them, as CacheService does.
+    int commit();
+    void discard();
+
+    static const size_t MAX_KEY_LENGTH = 15;  // NVS limit
+    static const int MAX_STAGED = 4;
+
+  private:
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t size;
+        uint32_t crc;
+    };
+
+    struct Staged {
+        char key[MAX_KEY_LENGTH + 1];
+        uint8_t* record;  // Header followed by the payload
+        size_t length;
+    };
+
+    // CRC of the last record loaded or written per key, so unchanged data is detected without a read
+    struct Known {
+        char key[MAX_KEY_LENGTH + 1];
+        uint32_t crc;
+        uint32_t size;
+        uint16_t version;
+    };
+
+    static const uint32_t RECORD_MAGIC = 0x44524357;  // "WCRD"
+
+    const char* nvsNamespace;
+    Staged staged[MAX_STAGED] = {};
+    int stagedCount = 0;
+    Known known[MAX_STAGED] = {};
+    int knownCount = 0;
+
+    bool matchesFlash(nvs_handle_t handle, const Staged& entry);
+    void remember(const char* key, const Header& header);
+    const Known* findKnown(const char* key) const;
+};
+
+#endif  // RECORD_STORE_H
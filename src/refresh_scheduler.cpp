@@ -0,0 +1,187 @@
+#include "refresh_scheduler.h"
+#include "cache_service.h"
+#include "event_manager.h"
+#include "logger.h"
+#include "time_service.h"
+#include "timezone_utils.h"
+
+const char* RefreshScheduler::CACHE_KEY = "budget";
+
+void RefreshScheduler::start(const Config& newConfig, bool fetchNow) {
+    config = newConfig;
+    if (config.intervalSeconds == 0) {
+        config.intervalSeconds = 3600;
+    }
+    if (config.leadSeconds >= config.intervalSeconds) {
+        config.leadSeconds = config.intervalSeconds / 2;
+    }
+    if (config.backoffMaxSeconds < config.backoffBaseSeconds) {
+        config.backoffMaxSeconds = config.backoffBaseSeconds;
+    }
+
+    if (!CacheService::getInstance()->get(cacheNamespace, CACHE_KEY, USAGE_VERSION, &usage, sizeof(usage))) {
+        usage = {};
+    }
+    rollDay(time(nullptr));
+    LOG_INFOF("%s scheduler: %u of %u requests used today\n", tag, usage.count, config.dailyBudget);
+
+    failures = 0;
+    state = State::WAITING;
+    if (fetchNow) {
+        scheduleIn(0);
+    } else {
+        uint32_t wait = secondsUntilAligned(time(nullptr));
+        scheduleIn(wait);
+        announce("Next update in " + String(wait / 60) + " min", false);
+    }
+}
+
+uint32_t RefreshScheduler::getDelayMs() const {
+    if (state == State::STOPPED) {
+        return UINT32_MAX;
+    }
+    int32_t remaining = (int32_t)(nextAttemptMs - millis());
+    return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+bool RefreshScheduler::beginRequest() {
+    if (state == State::STOPPED) {
+        return false;
+    }
+
+    time_t now = time(nullptr);
+    rollDay(now);
+    if (usage.count >= config.dailyBudget) {
+        state = State::BUDGET_EXHAUSTED;
+        scheduleIn(secondsUntilNextDay(now));
+        announce("Daily budget used (" + String(usage.count) + ")", true);
+        return false;
+    }
+
+    usage.count++;
+    saveUsage();
+    return true;
+}
+
+void RefreshScheduler::report(Outcome outcome) {
+    time_t now = time(nullptr);
+    switch (outcome) {
+        case Outcome::SUCCESS: {
+            failures = 0;
+            state = State::WAITING;
+            uint32_t wait = secondsUntilAligned(now);
+            scheduleIn(wait);
+            announce("Next update in " + String(wait / 60) + " min", false);
+            break;
+        }
+        case Outcome::TRANSIENT_ERROR: {
+            if (failures < UINT16_MAX) {
+                failures++;
+            }
+            state = State::BACKOFF;
+            uint32_t wait = backoffSeconds();
+            scheduleIn(wait);
+            announce("Retry in " + String(wait) + " s", true);
+            break;
+        }
+        case Outcome::QUOTA_EXCEEDED:
+            state = State::BUDGET_EXHAUSTED;
+            scheduleIn(secondsUntilNextDay(now));
+            announce("Quota exceeded, paused", true);
+            break;
+        case Outcome::FATAL_ERROR:
+            state = State::STOPPED;
+            announce("Updates stopped", true);
+            break;
+    }
+    LOG_INFOF("%s scheduler: %s, %u requests today, next attempt in %lu s\n", tag, stateToString(state),
+              usage.count, state == State::STOPPED ? 0UL : (unsigned long)(getDelayMs() / 1000));
+}
+
+const char* RefreshScheduler::stateToString(State state) {
+    switch (state) {
+        case State::WAITING:
+            return "waiting";
+        case State::BACKOFF:
+            return "backoff";
+        case State::BUDGET_EXHAUSTED:
+            return "budget exhausted";
+        case State::STOPPED:
+            return "stopped";
+    }
+    return "unknown";
+}
+
+void RefreshScheduler::scheduleIn(uint32_t seconds) { nextAttemptMs = millis() + seconds * 1000; }
+
+uint32_t RefreshScheduler::secondsUntilAligned(time_t now) const {
+    // Without wall-clock time there is no boundary to align to
+    if (now < TimeService::MIN_VALID_EPOCH) {
+        return config.intervalSeconds;
+    }
+
+    // Boundaries follow local time, so hourly forecasts roll over on the displayed hour
+    time_t local = now + TimezoneUtils::getOffsetAt(now);
+    time_t boundary = ((local + config.leadSeconds) / config.intervalSeconds + 1) * config.intervalSeconds;
+    uint32_t wait = (uint32_t)(boundary - config.leadSeconds - local);
+
+    // Data fetched this close to a boundary already covers it
+    if (wait < config.intervalSeconds / 4) {
+        wait += config.intervalSeconds;
+    }
+    return wait;
+}
+
+uint32_t RefreshScheduler::secondsUntilNextDay(time_t now) const {
+    if (now < TimeService::MIN_VALID_EPOCH) {
+        return config.backoffMaxSeconds;
+    }
+    // A small margin keeps the attempt clear of the server's own day rollover
+    return SECONDS_PER_DAY - (uint32_t)(now % SECONDS_PER_DAY) + 60;
+}
+
+uint32_t RefreshScheduler::backoffSeconds() const {
+    uint32_t wait = config.backoffBaseSeconds;
+    for (uint16_t i = 1; i < failures && wait < config.backoffMaxSeconds; i++) {
+        wait *= 2;
+    }
+    if (wait > config.backoffMaxSeconds) {
+        wait = config.backoffMaxSeconds;
+    }
+
+    // +/-25% jitter so devices sharing an outage do not retry in lockstep
+    uint32_t spread = wait / 4;
+    if (spread > 0) {
+        wait = wait - spread + random(2 * spread + 1);
+    }
+    return wait;
+}
+
+void RefreshScheduler::rollDay(time_t now) {
+    if (now < TimeService::MIN_VALID_EPOCH) {
+        return;
+    }
+    uint32_t day = (uint32_t)(now / SECONDS_PER_DAY);
+    if (usage.day == day) {
+        return;
+    }
+
+    // Requests made before time was known are charged to the first known day
+    if (usage.day != 0) {
+        usage.count = 0;
+    }
+    usage.day = day;
+    if (state == State::BUDGET_EXHAUSTED) {
+        state = State::WAITING;
+    }
+}
+
+void RefreshScheduler::saveUsage() {
+    CacheService::getInstance()->put(cacheNamespace, CACHE_KEY, USAGE_VERSION, &usage, sizeof(usage),
+                                     SECONDS_PER_DAY);
+}
+
+void RefreshScheduler::announce(const String& info, bool failure) {
+    TerminalEvent event(0, tag, info, failure ? TerminalEvent::State::FAILURE : TerminalEvent::State::SUCCESS);
+    EventManager::Emit(event);
+}
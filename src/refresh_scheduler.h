@@ -0,0 +1,86 @@
+#ifndef REFRESH_SCHEDULER_H
+#define REFRESH_SCHEDULER_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * Network Refresh Scheduler
+ *
+ * Decides when a module fetches from a rate-limited API. After a success the next fetch is
+ * aligned to the wall clock: it lands leadSeconds before the next multiple of intervalSeconds
+ * (just before the top of the hour for hourly forecasts), and a boundary that is very close is
+ * skipped. Transient failures back off exponentially from backoffBaseSeconds up to
+ * backoffMaxSeconds with +/-25% jitter. A quota error pauses until the next UTC day, an
+ * authorization or configuration error stops fetching altogether.
+ *
+ * Every attempt counts against a daily request budget (UTC day). The count is persisted in
+ * CacheService under the owner's namespace, so reboots do not reset it. State changes are
+ * reported to the terminal under the owner's tag. Used from the owning module's task only.
+ */
+class RefreshScheduler {
+public:
+    enum class Outcome {
+        SUCCESS,          // Data fetched or confirmed unchanged
+        TRANSIENT_ERROR,  // Network, memory, server or parse failure: retry with backoff
+        QUOTA_EXCEEDED,   // API refused for the day
+        FATAL_ERROR       // Bad key or request: retrying cannot help
+    };
+
+    enum class State { WAITING, BACKOFF, BUDGET_EXHAUSTED, STOPPED };
+
+    struct Config {
+        uint32_t intervalSeconds = 3600;
+        uint32_t leadSeconds = 120;
+        uint16_t dailyBudget = 40;
+        uint32_t backoffBaseSeconds = 30;
+        uint32_t backoffMaxSeconds = 1800;
+    };
+
+    RefreshScheduler(const char* tag, const char* cacheNamespace) : tag(tag), cacheNamespace(cacheNamespace) {}
+
+    // Apply the configuration and restore today's request count; fetchNow schedules an immediate attempt
+    void start(const Config& config, bool fetchNow);
+
+    // Milliseconds until the next attempt is due, UINT32_MAX once stopped
+    uint32_t getDelayMs() const;
+
+    // Take one request from the budget; false when the budget is used up (the state says until when)
+    bool beginRequest();
+    void report(Outcome outcome);
+
+    State getState() const { return state; }
+    static const char* stateToString(State state);
+    uint16_t getRequestsToday() const { return usage.count; }
+    uint16_t getConsecutiveFailures() const { return failures; }
+
+private:
+    struct Usage {
+        uint32_t day;     // Unix time / 86400, 0 when time was unknown
+        uint16_t count;
+        uint16_t reserved;
+    };
+
+    static const char* CACHE_KEY;
+    static const uint16_t USAGE_VERSION = 1;
+    static const uint32_t SECONDS_PER_DAY = 24 * 60 * 60;
+
+    const char* tag;
+    const char* cacheNamespace;
+    Config config;
+    State state = State::WAITING;
+    Usage usage = {};
+    uint16_t failures = 0;
+    uint32_t nextAttemptMs = 0;
+
+    void scheduleIn(uint32_t seconds);
+    uint32_t secondsUntilAligned(time_t now) const;
+    uint32_t secondsUntilNextDay(time_t now) const;
+    uint32_t backoffSeconds() const;
+    void rollDay(time_t now);
+    void saveUsage();
+    void announce(const String& info, bool failure);
+};
+
+#endif // REFRESH_SCHEDULER_H
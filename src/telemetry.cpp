@@ -0,0 +1,155 @@
+#include "telemetry.h"
+#include <esp_heap_caps.h>
+#include <cstring>
+#include <utility>
+#include "logger.h"
+
+// Static instance
+Telemetry* Telemetry::instance = nullptr;
+
+Telemetry::Telemetry() {
+    dataMutex = xSemaphoreCreateMutex();
+    if (dataMutex == nullptr) {
+        LOG_ERROR("Telemetry: Failed to create mutex");
+    }
+    statusBuffer = (TaskStatus_t*)heap_caps_malloc(MAX_TASKS * sizeof(TaskStatus_t), MALLOC_CAP_8BIT);
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        coreLoad[i] = -1.0f;
+    }
+}
+
+Telemetry* Telemetry::getInstance() {
+    if (instance == nullptr) {
+        instance = new Telemetry();
+    }
+    return instance;
+}
+
+void Telemetry::initialize() {
+    getInstance()->sample();
+    LOG_INFOF("Telemetry: Task sampling initialized (run-time stats %s)\n",
+              getInstance()->isCpuAvailable() ? "enabled" : "not available");
+}
+
+bool Telemetry::isCpuAvailable() const {
+#if configGENERATE_RUN_TIME_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Telemetry::sample() {
+    unsigned long now = millis();
+    if (statusBuffer == nullptr || (lastSampleTime != 0 && now - lastSampleTime < SAMPLE_INTERVAL_MS)) {
+        return;
+    }
+    lastSampleTime = now;
+
+    uint32_t totalRunTime = 0;
+    UBaseType_t count = uxTaskGetSystemState(statusBuffer, MAX_TASKS, &totalRunTime);
+    if (count == 0) {
+        LOG_WARNINGF("Telemetry: More than %d tasks, snapshot skipped\n", MAX_TASKS);
+        return;
+    }
+
+    // Every core accumulates the full elapsed time, so capacity is elapsed * cores
+    uint32_t elapsed = totalRunTime - previousTotalRunTime;
+    bool haveDelta = isCpuAvailable() && previousCount > 0 && elapsed > 0;
+
+    TaskSample* fresh = staging;
+    float freshCoreLoad[portNUM_PROCESSORS];
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        freshCoreLoad[i] = -1.0f;
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t& status = statusBuffer[i];
+        TaskSample& task = fresh[i];
+        strncpy(task.name, status.pcTaskName, sizeof(task.name) - 1);
+        task.name[sizeof(task.name) - 1] = '\0';
+        task.stackFreeBytes = status.usStackHighWaterMark * sizeof(StackType_t);
+        task.priority = status.uxCurrentPriority;
+        task.core = status.xCoreID < portNUM_PROCESSORS ? status.xCoreID : -1;
+        task.cpuPercent = -1.0f;
+
+#if configGENERATE_RUN_TIME_STATS
+        if (haveDelta) {
+            uint32_t taskTime = status.ulRunTimeCounter - findPreviousRunTime(status.xTaskNumber);
+            task.cpuPercent = 100.0f * taskTime / ((float)elapsed * portNUM_PROCESSORS);
+
+            // IDLE0 / IDLE1 are pinned; their share of one core is that core's idle time
+            if (strncmp(status.pcTaskName, "IDLE", 4) == 0 && task.core >= 0) {
+                float idle = 100.0f * taskTime / (float)elapsed;
+                freshCoreLoad[task.core] = idle >= 100.0f ? 0.0f : 100.0f - idle;
+            }
+        }
+        current[i].taskNumber = status.xTaskNumber;
+        current[i].runTime = status.ulRunTimeCounter;
+#endif
+    }
+    std::swap(previous, current);
+    previousCount = count;
+    previousTotalRunTime = totalRunTime;
+
+    if (dataMutex != nullptr && xSemaphoreTake(dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        memcpy(tasks, fresh, count * sizeof(TaskSample));
+        taskCount = count;
+        memcpy(coreLoad, freshCoreLoad, sizeof(coreLoad));
+        xSemaphoreGive(dataMutex);
+    }
+}
+
+uint32_t Telemetry::findPreviousRunTime(UBaseType_t taskNumber) const {
+    for (int i = 0; i < previousCount; i++) {
+        if (previous[i].taskNumber == taskNumber) {
+            return previous[i].runTime;
+        }
+    }
+    return 0;  // Created since the last snapshot
+}
+
+float Telemetry::getCoreLoad(int core) const {
+    if (core < 0 || core >= portNUM_PROCESSORS) {
+        return -1.0f;
+    }
+    return coreLoad[core];
+}
+
+float Telemetry::getTotalLoad() const {
+    float total = 0.0f;
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        if (coreLoad[i] < 0.0f) {
+            return -1.0f;
+        }
+        total += coreLoad[i];
+    }
+    return total / portNUM_PROCESSORS;
+}
+
+int Telemetry::getTasks(TaskSample* out, int maxTasks) const {
+    if (dataMutex == nullptr || xSemaphoreTake(dataMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return 0;
+    }
+    int count = taskCount < maxTasks ? taskCount : maxTasks;
+    memcpy(out, tasks, count * sizeof(TaskSample));
+    xSemaphoreGive(dataMutex);
+    return count;
+}
+
+void Telemetry::logReport() const {
+    TaskSample snapshot[MAX_TASKS];
+    int count = getTasks(snapshot, MAX_TASKS);
+
+    if (isCpuAvailable()) {
+        LOG_INFOF("Telemetry: CPU core0=%.1f%% core1=%.1f%%, %d tasks\n", getCoreLoad(0), getCoreLoad(1), count);
+    } else {
+        LOG_INFOF("Telemetry: %d tasks (CPU usage needs run-time stats)\n", count);
+    }
+
+    for (int i = 0; i < count; i++) {
+        const TaskSample& task = snapshot[i];
+        LOG_INFOF("  %-16s core=%2d prio=%2u cpu=%5.1f%% stack_free=%u B\n", task.name, task.core,
+                  (unsigned)task.priority, task.cpuPercent, (unsigned)task.stackFreeBytes);
+    }
+}
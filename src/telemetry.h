@@ -0,0 +1,76 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+/**
+ * Task Telemetry
+ *
+ * Periodically snapshots every FreeRTOS task with uxTaskGetSystemState() and derives, from
+ * the difference between two snapshots, each task's share of the CPU and each core's load
+ * (100% minus its idle task). Stack high-water marks are recorded for every task so stack
+ * sizes can be tuned from data. Run-time counters need CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS;
+ * without it only stack figures are collected and CPU values read as unavailable (-1).
+ */
+class Telemetry {
+public:
+    struct TaskSample {
+        char name[configMAX_TASK_NAME_LEN];
+        float cpuPercent;          // Share of total CPU capacity (all cores) since the last sample
+        uint32_t stackFreeBytes;   // Minimum free stack ever seen
+        UBaseType_t priority;
+        int8_t core;               // -1 when the task is not pinned
+    };
+
+    static const int MAX_TASKS = 32;
+    static const uint32_t SAMPLE_INTERVAL_MS = 1000;
+
+    static Telemetry* getInstance();
+    static void initialize();
+
+    // Take a new snapshot (called from the system monitor; cheap when called early)
+    void sample();
+
+    bool isCpuAvailable() const;
+    float getCoreLoad(int core) const;
+    float getTotalLoad() const;
+
+    // Copy of the last snapshot, returns the number of tasks written
+    int getTasks(TaskSample* out, int maxTasks) const;
+
+    // Log a per-task table (CPU, stack headroom) at INFO level
+    void logReport() const;
+
+private:
+    Telemetry();
+
+    static Telemetry* instance;
+    mutable SemaphoreHandle_t dataMutex;
+
+    // Previous run-time counter of each task, matched by task number
+    struct Counter {
+        UBaseType_t taskNumber;
+        uint32_t runTime;
+    };
+
+    TaskStatus_t* statusBuffer = nullptr;
+    // Two buffers swapped after each sample, so lookups never see entries of the sample in progress
+    Counter counters[2][MAX_TASKS];
+    Counter* previous = counters[0];
+    Counter* current = counters[1];
+    int previousCount = 0;
+    uint32_t previousTotalRunTime = 0;
+    unsigned long lastSampleTime = 0;
+
+    TaskSample staging[MAX_TASKS];  // Built by sample() without holding the mutex
+    TaskSample tasks[MAX_TASKS];
+    int taskCount = 0;
+    float coreLoad[portNUM_PROCESSORS];
+
+    uint32_t findPreviousRunTime(UBaseType_t taskNumber) const;
+};
+
+#endif // TELEMETRY_H
@@ -1,61 +1,103 @@
 #include "terminal.h"
 #include "logger.h"
-#include "memory_manager.h"
+#include <cstring>
 #include "event_manager.h"
 
-std::vector<Terminal::ConsoleLine> Terminal::consoleLines;
+Terminal::Line Terminal::lines[Terminal::MAX_LINES];
+uint32_t Terminal::lineCount = 0;
+uint32_t Terminal::nextRevision = 1;
+std::atomic<uint32_t> Terminal::sequence{0};
+SemaphoreHandle_t Terminal::writeMutex = NULL;
 
 void Terminal::Setup() {
-    // Subscribe to unified terminal event
-    EventManager::Subscribe<TerminalEvent>(onTerminalEvent);
+    writeMutex = xSemaphoreCreateMutex();
+
+    // Subscribe to unified terminal event; queued so emitters never wait on the console
+    EventManager::Subscribe<TerminalEvent>(onTerminalEvent, EventManager::Delivery::QUEUED);
 
     // Add welcome line
-    consoleLines.push_back(ConsoleLine(0, "SYS", "Welcome Hoowachy 1.0", "OK"));
+    AddLine(0, "SYS", "Welcome Hoowachy 1.0", "OK");
 }
 
-void Terminal::AddLine(int8_t id, const String& group, const String& description, const String& status) {
-    // Check memory before adding new console lines
-    if (MEMORY_CHECK_CRITICAL()) {
-        LOG_WARNING("Terminal: Skipping line addition due to critical memory");
-        return;
-    }
-    
-    // Limit console buffer size to prevent memory issues
-    if (consoleLines.size() >= 20) {
-        consoleLines.erase(consoleLines.begin()); // Remove oldest line
-    }
-    
-    consoleLines.push_back(ConsoleLine(id, group, description, status));
+void Terminal::AddLine(int8_t id, const char* group, const char* description, const char* status) {
+    beginWrite();
+    appendLocked(id, group, description, status);
+    endWrite();
 }
 
-const std::vector<Terminal::ConsoleLine>& Terminal::GetLines() { return consoleLines; }
+void Terminal::UpdateLine(int8_t id, const char* group, const char* description, const char* status) {
+    beginWrite();
 
-void Terminal::UpdateLine(int8_t id, const String& group, const String& description, const String& status) {
-    // Check memory before updating console lines
-    if (MEMORY_CHECK_CRITICAL()) {
-        LOG_WARNING("Terminal: Skipping line update due to critical memory");
-        return;
-    }
-    
-    for (int i = 0; i < consoleLines.size(); i++) {
-        if (consoleLines[i].id == id && consoleLines[i].group == group) {
-            consoleLines[i].description = description;
-            consoleLines[i].status = status;
-            consoleLines[i].offsetX = 0;
+    uint32_t count = lineCount < MAX_LINES ? lineCount : MAX_LINES;
+    for (uint32_t i = 0; i < count; i++) {
+        Line& line = lines[(lineCount - 1 - i) % MAX_LINES];
+        if (line.id == id && strncmp(line.group, group, GROUP_SIZE - 1) == 0) {
+            setText(line, description, status);
+            endWrite();
             return;
         }
     }
-    
-    // If not found, add new line (with memory check)
-    if (consoleLines.size() < 20) { // Limit buffer size
-        consoleLines.push_back(ConsoleLine(id, group, description, status));
+
+    // Not on screen yet: add it, evicting the oldest line when the ring is full
+    appendLocked(id, group, description, status);
+    endWrite();
+}
+
+int Terminal::GetLines(Line* out, int maxLines) {
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            taskYIELD();
+            continue;
+        }
+
+        uint32_t total = lineCount;
+        int count = total < (uint32_t)maxLines ? (int)total : maxLines;
+        for (int i = 0; i < count; i++) {
+            out[i] = lines[(total - count + i) % MAX_LINES];
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) {
+            return count;
+        }
     }
+    return -1;
+}
+
+void Terminal::beginWrite() {
+    if (writeMutex != NULL) {
+        xSemaphoreTake(writeMutex, portMAX_DELAY);
+    }
+    sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void Terminal::endWrite() {
+    sequence.fetch_add(1, std::memory_order_release);
+    if (writeMutex != NULL) {
+        xSemaphoreGive(writeMutex);
+    }
+}
+
+void Terminal::appendLocked(int8_t id, const char* group, const char* description, const char* status) {
+    Line& line = lines[lineCount % MAX_LINES];
+    line.id = id;
+    snprintf(line.group, sizeof(line.group), "%s", group);
+    setText(line, description, status);
+    lineCount++;
+}
+
+void Terminal::setText(Line& line, const char* description, const char* status) {
+    snprintf(line.description, sizeof(line.description), "%s", description);
+    snprintf(line.status, sizeof(line.status), "%s", status);
+    line.revision = nextRevision++;
 }
 
 void Terminal::onTerminalEvent(const TerminalEvent& event) {
     LOG_INFOF("Terminal event: [%s] %s\n", event.group.c_str(), event.info.c_str());
 
-    String status = "";
+    const char* status = "";
     if (event.state == TerminalEvent::State::SUCCESS) {
         status = "OK";
     } else if (event.state == TerminalEvent::State::FAILURE) {
@@ -63,10 +105,12 @@ void Terminal::onTerminalEvent(const TerminalEvent& event) {
     }
 
     // Combine info with extra data if available
-    String fullInfo = event.info;
-    if (!event.extra.isEmpty()) {
-        fullInfo += " " + event.extra;
+    char description[DESCRIPTION_SIZE];
+    if (event.extra.isEmpty()) {
+        snprintf(description, sizeof(description), "%s", event.info.c_str());
+    } else {
+        snprintf(description, sizeof(description), "%s %s", event.info.c_str(), event.extra.c_str());
     }
 
-    UpdateLine(event.step, event.group, fullInfo, status);
-}
\ No newline at end of file
+    UpdateLine(event.step, event.group.c_str(), description, status);
+}
@@ -2,35 +2,62 @@
 #define TERMINAL_H
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
 #include "logger.h"
-#include <vector>
 
 // Forward declarations
 class TerminalEvent;
 
+/**
+ * Boot Terminal
+ *
+ * The last MAX_LINES console lines in a preallocated ring of fixed-size records; adding or
+ * updating a line never allocates. Writers (terminal events, delivered on the dispatcher task)
+ * are serialized by a mutex and bracket every change with a sequence counter. The renderer
+ * copies the lines it shows under that seqlock without taking any lock, retrying when a write
+ * overlapped the copy. Rendering state such as scroll offsets belongs to the reader.
+ */
 class Terminal {
   public:
-    class ConsoleLine {
-      public:
+    static const int MAX_LINES = 20;
+    static const size_t GROUP_SIZE = 8;  // Drawn as "[GROUP]" in a 10 character label
+    static const size_t DESCRIPTION_SIZE = 96;
+    static const size_t STATUS_SIZE = 8;
+
+    struct Line {
+        uint32_t revision;  // Changes whenever the text of the line changes
         int8_t id;
-        String group;
-        String description;
-        String status;
-        float offsetX = 0;
-        ConsoleLine(int8_t id, const String& group, const String& description, const String& status)
-            : id(id), group(group), description(description), status(status) {}
+        char group[GROUP_SIZE];
+        char description[DESCRIPTION_SIZE];
+        char status[STATUS_SIZE];  // Empty while the step is in progress
     };
 
     static void Setup();
-    static void AddLine(int8_t id, const String& group, const String& description, const String& status);
-    static const std::vector<ConsoleLine>& GetLines();
-    static void UpdateLine(int8_t id, const String& group, const String& description, const String& status);
+    static void AddLine(int8_t id, const char* group, const char* description, const char* status);
+    static void UpdateLine(int8_t id, const char* group, const char* description, const char* status);
+
+    // Copy up to maxLines of the newest lines, oldest first. Returns the number copied, or -1 when
+    // writers kept changing the ring during every attempt (keep the previous copy then).
+    static int GetLines(Line* out, int maxLines);
 
   private:
-    static std::vector<ConsoleLine> consoleLines;
+    static const int MAX_READ_ATTEMPTS = 8;
+
+    static Line lines[MAX_LINES];
+    static uint32_t lineCount;  // Lines ever added; the newest is lines[(lineCount - 1) % MAX_LINES]
+    static uint32_t nextRevision;
+    static std::atomic<uint32_t> sequence;  // Odd while a write is in progress
+    static SemaphoreHandle_t writeMutex;
+
+    static void beginWrite();
+    static void endWrite();
+    static void appendLocked(int8_t id, const char* group, const char* description, const char* status);
+    static void setText(Line& line, const char* description, const char* status);
 
     // Single unified event handler
     static void onTerminalEvent(const TerminalEvent& event);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,119 @@
+#include "time_service.h"
+#include <esp_attr.h>
+#include <esp_sntp.h>
+#include <esp_system.h>
+#include "boot_sequencer.h"
+#include "config.h"
+#include "config_manager.h"
+#include "event_manager.h"
+#include "logger.h"
+#include "wifi_manager.h"
+
+extern Config config;
+
+TaskHandle_t TimeService::taskHandle = nullptr;
+volatile uint32_t TimeService::syncCount = 0;
+volatile time_t TimeService::lastSyncTime = 0;
+bool TimeService::restored = false;
+
+// Undefined after power-on, hence the magic and check word
+RTC_NOINIT_ATTR TimeService::Checkpoint TimeService::rtcCheckpoint;
+
+void TimeService::restore() {
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool intact = rtcCheckpoint.magic == CHECKPOINT_MAGIC &&
+                  rtcCheckpoint.check == (~CHECKPOINT_MAGIC ^ (uint32_t)rtcCheckpoint.epoch) &&
+                  rtcCheckpoint.epoch >= MIN_VALID_EPOCH;
+    if (reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT || !intact || isTimeValid()) {
+        rtcCheckpoint.magic = 0;
+        return;
+    }
+
+    // The reset itself took a fraction of a second beyond the last checkpoint; SNTP corrects the rest
+    struct timeval tv = {(time_t)rtcCheckpoint.epoch + 1, 0};
+    settimeofday(&tv, nullptr);
+    restored = true;
+    LOG_INFOF("TimeService: Clock restored from RTC memory (%lld)\n", (long long)rtcCheckpoint.epoch);
+}
+
+void TimeService::Run() {
+    LOG_INFO("Time sync task started");
+    taskHandle = xTaskGetCurrentTaskHandle();
+
+    // A restored clock is good enough for the boot trace, without waiting for WiFi
+    if (restored) {
+        BootSequencer::complete(BootSequencer::Stage::TIME);
+    }
+
+    bool sntpStarted = false;
+    uint32_t reportedSyncs = 0;
+    while (true) {
+        // Woken early by the sync callback, otherwise once per checkpoint interval
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CHECKPOINT_INTERVAL_MS));
+        checkpoint();
+
+        // Offline the checkpoint keeps running, so a second reset does not restore a stale epoch
+        if (!sntpStarted && WiFiManager::IsConnected()) {
+            if (!restored) {
+                BootSequencer::begin(BootSequencer::Stage::TIME);
+            }
+            startSntp();
+            sntpStarted = true;
+        }
+
+        uint32_t syncs = syncCount;
+        if (syncs == reportedSyncs) {
+            continue;
+        }
+        reportedSyncs = syncs;
+        LOG_INFO("Time synchronized successfully");
+        if (!BootSequencer::isComplete(BootSequencer::Stage::TIME)) {
+            BootSequencer::complete(BootSequencer::Stage::TIME);
+        }
+        if (syncs == 1) {
+            EventManager::Emit(TerminalEvent(0, "TIME", "Time synchronized", TerminalEvent::State::SUCCESS));
+        }
+    }
+}
+
+void TimeService::startSntp() {
+    uint32_t interval = readSyncInterval();
+
+    // Smooth mode slews small offsets; IDF steps the clock when it is off by more than ~35 minutes
+    sntp_set_time_sync_notification_cb(onTimeSync);
+    sntp_set_sync_mode(SNTP_SYNC_MODE_SMOOTH);
+    sntp_set_sync_interval(interval * 1000);
+    configTime(0, 0, config.system.ntpServer.c_str());
+    LOG_INFOF("TimeService: SNTP started (%s, every %lu s)\n", config.system.ntpServer.c_str(),
+              (unsigned long)interval);
+}
+
+void TimeService::onTimeSync(struct timeval* tv) {
+    // Runs in the SNTP (lwIP) task: record and hand off
+    lastSyncTime = tv != nullptr ? tv->tv_sec : time(nullptr);
+    syncCount = syncCount + 1;
+    if (taskHandle != nullptr) {
+        xTaskNotifyGive(taskHandle);
+    }
+}
+
+void TimeService::checkpoint() {
+    if (!isTimeValid()) {
+        return;
+    }
+    int64_t now = (int64_t)time(nullptr);
+    rtcCheckpoint.epoch = now;
+    rtcCheckpoint.check = ~CHECKPOINT_MAGIC ^ (uint32_t)now;
+    rtcCheckpoint.magic = CHECKPOINT_MAGIC;
+}
+
+uint32_t TimeService::readSyncInterval() {
+    modules::ConfigSection section = ConfigManager::getInstance()->getConfigSection("clock");
+    int interval = section.getIntValue("sync_interval", DEFAULT_SYNC_INTERVAL_S);
+    if (interval < (int)MIN_SYNC_INTERVAL_S) {
+        LOG_WARNINGF("TimeService: sync_interval %d too low, using %lu seconds\n", interval,
+                     (unsigned long)DEFAULT_SYNC_INTERVAL_S);
+        interval = DEFAULT_SYNC_INTERVAL_S;
+    }
+    return (uint32_t)interval;
+}
@@ -0,0 +1,64 @@
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <time.h>
+
+/**
+ * Time Service
+ *
+ * Owns the wall clock. restore() runs first thing at boot: after a reset (not a power-on)
+ * the time checkpointed in RTC memory is set again, so the clock is right to within a second
+ * or two before the network comes up. Once WiFi connects, SNTP runs in smooth mode at the
+ * configured interval ([clock] sync_interval); successful syncs are reported by the SNTP
+ * callback, so "synchronized" means a reply actually arrived. Small corrections are slewed
+ * with adjtime() instead of stepping the displayed seconds.
+ */
+class TimeService {
+public:
+    // Any earlier wall-clock time means the clock was never set (2020-09-13); the one check
+    // for every component that trusts time(nullptr)
+    static const time_t MIN_VALID_EPOCH = 1600000000;
+
+    static const uint32_t DEFAULT_SYNC_INTERVAL_S = 3600;
+    static const uint32_t MIN_SYNC_INTERVAL_S = 60;
+
+    // Set the clock from the RTC checkpoint when it survived the reset
+    static void restore();
+
+    // Task body: checkpoint the clock to RTC memory every second from the start, and start SNTP
+    // once WiFi first connects
+    static void Run();
+
+    static bool isTimeValid() { return time(nullptr) >= MIN_VALID_EPOCH; }
+    static bool isSynchronized() { return syncCount > 0; }
+    static bool wasRestored() { return restored; }
+    static time_t getLastSyncTime() { return lastSyncTime; }
+
+private:
+    struct Checkpoint {
+        uint32_t magic;
+        int64_t epoch;
+        uint32_t check;  // ~magic ^ low word of epoch, rejects RTC garbage after power-on
+    };
+
+    static const uint32_t CHECKPOINT_MAGIC = 0x4B4C4354;  // "TCLK"
+    static const uint32_t CHECKPOINT_INTERVAL_MS = 1000;
+
+    static TaskHandle_t taskHandle;
+    static volatile uint32_t syncCount;
+    static volatile time_t lastSyncTime;
+    static bool restored;
+    static Checkpoint rtcCheckpoint;  // RTC memory, kept across software resets and panics
+
+    static void onTimeSync(struct timeval* tv);
+    static void checkpoint();
+    static void startSntp();
+    static uint32_t readSyncInterval();
+};
+
+#endif // TIME_SERVICE_H
@@ -1,142 +1,355 @@
 #include "timezone_utils.h"
+#include <freertos/FreeRTOS.h>
+#include <strings.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include "logger.h"
-#include <time.h>
-
-// Helper function to calculate day of week (0=Sunday, 1=Monday, ..., 6=Saturday)
-// Using Zeller's congruence formula for Gregorian calendar
-static int calculateDayOfWeek(int year, int month, int day) {
-    if (month < 3) {
-        month += 12;
-        year--;
-    }
-    int k = year % 100;
-    int j = year / 100;
-    int h = (day + (13 * (month + 1)) / 5 + k + k/4 + j/4 - 2*j) % 7;
-    // Convert to Sunday=0 format
-    return (h + 5) % 7;
+
+namespace {
+
+struct ZoneEntry {
+    const char* name;
+    const char* rule;
+};
+
+// IANA names and the abbreviations accepted before, mapped to POSIX TZ rules
+constexpr ZoneEntry ZONES[] = {
+    {"UTC", "UTC0"},
+    {"GMT", "GMT0"},
+
+    // Europe
+    {"CET", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"Europe/Berlin", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"Europe/Paris", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"Europe/Madrid", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"Europe/Rome", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"Europe/Amsterdam", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"Europe/Brussels", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"Europe/Vienna", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"Europe/Zurich", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"Europe/Prague", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"Europe/Warsaw", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"Europe/Stockholm", "CET-1CEST,M3.5.0,M10.5.0/3"},
+    {"EET", "EET-2EEST,M3.5.0/3,M10.5.0/4"},
+    {"Europe/Kiev", "EET-2EEST,M3.5.0/3,M10.5.0/4"},
+    {"Europe/Kyiv", "EET-2EEST,M3.5.0/3,M10.5.0/4"},
+    {"Europe/Helsinki", "EET-2EEST,M3.5.0/3,M10.5.0/4"},
+    {"Europe/Athens", "EET-2EEST,M3.5.0/3,M10.5.0/4"},
+    {"Europe/Bucharest", "EET-2EEST,M3.5.0/3,M10.5.0/4"},
+    {"Europe/Sofia", "EET-2EEST,M3.5.0/3,M10.5.0/4"},
+    {"Europe/Riga", "EET-2EEST,M3.5.0/3,M10.5.0/4"},
+    {"Europe/Vilnius", "EET-2EEST,M3.5.0/3,M10.5.0/4"},
+    {"Europe/Tallinn", "EET-2EEST,M3.5.0/3,M10.5.0/4"},
+    {"BST", "GMT0BST,M3.5.0/1,M10.5.0"},
+    {"Europe/London", "GMT0BST,M3.5.0/1,M10.5.0"},
+    {"Europe/Dublin", "GMT0IST,M3.5.0/1,M10.5.0"},
+    {"Europe/Lisbon", "WET0WEST,M3.5.0/1,M10.5.0"},
+    {"Europe/Istanbul", "<+03>-3"},
+    {"Europe/Minsk", "<+03>-3"},
+    {"Europe/Moscow", "MSK-3"},
+
+    // America
+    {"EST", "EST5EDT,M3.2.0,M11.1.0"},
+    {"America/New_York", "EST5EDT,M3.2.0,M11.1.0"},
+    {"America/Toronto", "EST5EDT,M3.2.0,M11.1.0"},
+    {"CST", "CST6CDT,M3.2.0,M11.1.0"},
+    {"America/Chicago", "CST6CDT,M3.2.0,M11.1.0"},
+    {"America/Mexico_City", "CST6"},
+    {"MST", "MST7MDT,M3.2.0,M11.1.0"},
+    {"America/Denver", "MST7MDT,M3.2.0,M11.1.0"},
+    {"America/Phoenix", "MST7"},
+    {"PST", "PST8PDT,M3.2.0,M11.1.0"},
+    {"America/Los_Angeles", "PST8PDT,M3.2.0,M11.1.0"},
+    {"America/Vancouver", "PST8PDT,M3.2.0,M11.1.0"},
+    {"America/Anchorage", "AKST9AKDT,M3.2.0,M11.1.0"},
+    {"Pacific/Honolulu", "HST10"},
+    {"America/Sao_Paulo", "<-03>3"},
+    {"America/Argentina/Buenos_Aires", "<-03>3"},
+
+    // Asia
+    {"JST", "JST-9"},
+    {"Asia/Tokyo", "JST-9"},
+    {"Asia/Seoul", "KST-9"},
+    {"Asia/Shanghai", "CST-8"},
+    {"Asia/Hong_Kong", "HKT-8"},
+    {"Asia/Singapore", "<+08>-8"},
+    {"Asia/Bangkok", "<+07>-7"},
+    {"Asia/Jakarta", "WIB-7"},
+    {"IST", "IST-5:30"},
+    {"Asia/Kolkata", "IST-5:30"},
+    {"Asia/Dubai", "<+04>-4"},
+    {"Asia/Jerusalem", "IST-2IDT,M3.4.4/26,M10.5.0"},
+
+    // Oceania and Africa
+    {"Australia/Sydney", "AEST-10AEDT,M10.1.0,M4.1.0/3"},
+    {"Australia/Melbourne", "AEST-10AEDT,M10.1.0,M4.1.0/3"},
+    {"Australia/Brisbane", "AEST-10"},
+    {"Australia/Adelaide", "ACST-9:30ACDT,M10.1.0,M4.1.0/3"},
+    {"Australia/Perth", "AWST-8"},
+    {"Pacific/Auckland", "NZST-12NZDT,M9.5.0,M4.1.0/3"},
+    {"Africa/Johannesburg", "SAST-2"},
+    {"Africa/Lagos", "WAT-1"},
+    {"Africa/Nairobi", "EAT-3"},
+};
+
+portMUX_TYPE cacheLock = portMUX_INITIALIZER_UNLOCKED;
+
+const int64_t SECONDS_PER_DAY = 86400;
+
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant's algorithm)
+int64_t daysFromCivil(int year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yoe = (unsigned)(year - era * 400);
+    const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+int yearFromDays(int64_t days) {
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = (unsigned)(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    return (int)(yoe + era * 400) + (mp >= 10 ? 1 : 0);
+}
+
+int64_t floorDiv(int64_t value, int64_t divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+unsigned daysInMonth(int year, unsigned month) {
+    static const uint8_t DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0));
+    return month == 2 && leap ? 29 : DAYS[month - 1];
 }
 
-// Helper function to find last Sunday of a month
-static int findLastSunday(int year, int month) {
-    // Get days in month
-    int daysInMonth;
-    if (month == 2) {
-        daysInMonth = (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) ? 29 : 28;
-    } else if (month == 4 || month == 6 || month == 9 || month == 11) {
-        daysInMonth = 30;
-    } else {
-        daysInMonth = 31;
-    }
-    
-    // Start from last day and work backwards to find Sunday
-    for (int day = daysInMonth; day >= 1; day--) {
-        if (calculateDayOfWeek(year, month, day) == 0) { // Sunday
-            return day;
+// Zone abbreviation: letters, or anything quoted in <...>
+bool skipZoneName(const char*& p) {
+    const char* start = p;
+    if (*p == '<') {
+        const char* close = strchr(p, '>');
+        if (close == nullptr) {
+            return false;
         }
+        p = close + 1;
+        return close - start > 1;
+    }
+    while (isalpha((unsigned char)*p)) {
+        p++;
     }
-    return 31; // Fallback (should not happen)
+    return p - start >= 3;
 }
 
-// Helper function to determine if it's daylight saving time for European timezones
-// Uses UTC time and applies standard timezone offset to determine local time for DST calculation
-bool TimezoneUtils::isDaylightSavingTimeForTimezone(const String& timezone) {
-    // Get current UTC time
-    time_t utcTime = time(nullptr);
-    if (utcTime == -1) {
-        LOG_INFO("TimezoneUtils: Could not get UTC time, defaulting to standard time");
-        return false;  // Default to standard time if we can't get time
-    }
-
-    // Get standard (winter) timezone offset in seconds
-    int standardOffset = 0;
-    if (timezone == "CET" || timezone == "Europe/Berlin") {
-        standardOffset = 1 * 3600;  // CET is UTC+1
-    } else if (timezone == "EET" || timezone == "Europe/Kiev") {
-        standardOffset = 2 * 3600;  // EET is UTC+2  
-    } else if (timezone == "BST" || timezone == "Europe/London") {
-        standardOffset = 0;  // GMT is UTC+0
-    } else {
-        // For non-European timezones, no DST calculation needed
+// [+|-]hh[:mm[:ss]] in seconds
+bool parseClock(const char*& p, int32_t& seconds) {
+    int sign = 1;
+    if (*p == '+' || *p == '-') {
+        sign = *p == '-' ? -1 : 1;
+        p++;
+    }
+    if (!isdigit((unsigned char)*p)) {
         return false;
     }
 
-    // Apply standard offset to get local time
-    time_t localTime = utcTime + standardOffset;
-    struct tm* timeinfo = gmtime(&localTime);
-    if (!timeinfo) {
-        LOG_INFO("TimezoneUtils: Could not convert time, defaulting to standard time");
-        return false;
+    int32_t value = strtol(p, (char**)&p, 10) * 3600;
+    for (int32_t unit = 60; unit >= 1 && *p == ':'; unit /= 60) {
+        p++;
+        value += strtol(p, (char**)&p, 10) * unit;
     }
+    seconds = sign * value;
+    return true;
+}
 
-    int year = timeinfo->tm_year + 1900;
-    int month = timeinfo->tm_mon + 1;  // tm_mon is 0-based
-    int day = timeinfo->tm_mday;
+}  // namespace
 
-    // DST runs from last Sunday in March to last Sunday in October
+TimezoneUtils::Cache TimezoneUtils::active;
 
-    // Before March or after October - definitely standard time
-    if (month < 3 || month > 10) {
-        return false;
+void TimezoneUtils::setTimezone(const String& timezone) {
+    Rule rule;
+    if (!resolve(timezone.c_str(), rule)) {
+        LOG_WARNINGF("TimezoneUtils: Unknown timezone '%s', defaulting to UTC\n", timezone.c_str());
     }
 
-    // April to September - definitely daylight saving time
-    if (month > 3 && month < 10) {
-        return true;
+    taskENTER_CRITICAL(&cacheLock);
+    strncpy(active.name, timezone.c_str(), sizeof(active.name) - 1);
+    active.name[sizeof(active.name) - 1] = '\0';
+    active.rule = rule;
+    active.validFrom = 0;
+    active.validUntil = 0;
+    taskEXIT_CRITICAL(&cacheLock);
+
+    LOG_INFOF("TimezoneUtils: Using %s (UTC%+d min%s)\n", timezone.c_str(), (int)(rule.standardOffset / 60),
+              rule.hasDaylight ? ", with DST" : "");
+}
+
+int TimezoneUtils::getOffset() { return getOffsetAt(time(nullptr)); }
+
+int TimezoneUtils::getOffsetAt(time_t utcTime) {
+    taskENTER_CRITICAL(&cacheLock);
+    if (utcTime >= active.validFrom && utcTime < active.validUntil) {
+        int32_t offset = active.offset;
+        taskEXIT_CRITICAL(&cacheLock);
+        return offset;
+    }
+    Rule rule = active.rule;
+    taskEXIT_CRITICAL(&cacheLock);
+
+    // Crossed a transition (or first use): recompute outside the lock, then publish
+    time_t from;
+    time_t until;
+    int32_t offset = computeOffset(rule, utcTime, from, until);
+
+    taskENTER_CRITICAL(&cacheLock);
+    active.offset = offset;
+    active.validFrom = from;
+    active.validUntil = until;
+    taskEXIT_CRITICAL(&cacheLock);
+    return offset;
+}
+
+int TimezoneUtils::getTimezoneOffset(const String& timezone) {
+    taskENTER_CRITICAL(&cacheLock);
+    bool isSystemZone = strcmp(timezone.c_str(), active.name) == 0;
+    taskEXIT_CRITICAL(&cacheLock);
+    if (isSystemZone) {
+        return getOffset();
+    }
+
+    // Some other zone: resolve on the spot without disturbing the cache
+    Rule rule;
+    if (!resolve(timezone.c_str(), rule)) {
+        LOG_INFOF("Warning: Unknown timezone '%s', defaulting to UTC\n", timezone.c_str());
+        return 0;
     }
+    time_t from;
+    time_t until;
+    return computeOffset(rule, time(nullptr), from, until);
+}
+
+bool TimezoneUtils::resolve(const char* timezone, Rule& rule) {
+    rule = Rule();
 
-    // March - check if we're past the last Sunday
-    if (month == 3) {
-        int lastSunday = findLastSunday(year, 3);
-        return day >= lastSunday;
+    for (const ZoneEntry& zone : ZONES) {
+        if (strcasecmp(zone.name, timezone) == 0) {
+            return parsePosix(zone.rule, rule);
+        }
     }
 
-    // October - check if we're before the last Sunday
-    if (month == 10) {
-        int lastSunday = findLastSunday(year, 10);
-        return day < lastSunday;
+    // GMT+X / UTC-X mean hours east / west of Greenwich, unlike POSIX "GMT+X"
+    if ((strncmp(timezone, "GMT", 3) == 0 || strncmp(timezone, "UTC", 3) == 0) &&
+        (timezone[3] == '+' || timezone[3] == '-')) {
+        const char* p = timezone + 3;
+        int32_t offset;
+        if (parseClock(p, offset) && *p == '\0') {
+            rule.standardOffset = offset;
+            return true;
+        }
     }
 
-    return false;  // Default to standard time
+    return parsePosix(timezone, rule);
 }
 
-// Convert timezone string to GMT offset in seconds
-int TimezoneUtils::getTimezoneOffset(const String& timezone) {
-    // Common timezone mappings (GMT offset in seconds)
-    if (timezone == "UTC" || timezone == "GMT") return 0;
+bool TimezoneUtils::parsePosix(const char* spec, Rule& rule) {
+    const char* p = spec;
+    int32_t value;
 
-    // Europe - with DST support using proper UTC-based calculation
-    if (timezone == "CET" || timezone == "Europe/Berlin") {
-        return isDaylightSavingTimeForTimezone(timezone) ? 2 * 3600 : 1 * 3600;  // CEST vs CET
+    // POSIX offsets are hours west of UTC
+    if (!skipZoneName(p) || !parseClock(p, value)) {
+        return false;
+    }
+    rule.standardOffset = -value;
+    rule.daylightOffset = rule.standardOffset;
+    if (*p == '\0') {
+        return true;
+    }
+
+    if (!skipZoneName(p)) {
+        return false;
     }
-    if (timezone == "EET" || timezone == "Europe/Kiev") {
-        return isDaylightSavingTimeForTimezone(timezone) ? 3 * 3600 : 2 * 3600;  // EEST vs EET
+    rule.hasDaylight = true;
+    rule.daylightOffset = parseClock(p, value) ? -value : rule.standardOffset + 3600;
+
+    if (*p == '\0') {
+        // No rule given: the POSIX default is the US one
+        rule.start = {3, 2, 0, 7200};
+        rule.end = {11, 1, 0, 7200};
+        return true;
     }
-    if (timezone == "BST" || timezone == "Europe/London") {
-        return isDaylightSavingTimeForTimezone(timezone) ? 1 * 3600 : 0;  // BST vs GMT
+
+    Transition* transitions[] = {&rule.start, &rule.end};
+    for (Transition* transition : transitions) {
+        if (*p++ != ',' || *p++ != 'M') {
+            // Julian-day rules are not used by any zone we ship
+            return false;
+        }
+        transition->month = strtol(p, (char**)&p, 10);
+        transition->week = *p == '.' ? strtol(p + 1, (char**)&p, 10) : 0;
+        transition->weekday = *p == '.' ? strtol(p + 1, (char**)&p, 10) : 7;
+        transition->time = 7200;
+        if (*p == '/' && !parseClock(++p, transition->time)) {
+            return false;
+        }
+        if (transition->month < 1 || transition->month > 12 || transition->week < 1 || transition->week > 5 ||
+            transition->weekday > 6) {
+            return false;
+        }
     }
+    return *p == '\0';
+}
 
-    // America - static offsets (no DST calculation for now)
-    if (timezone == "EST" || timezone == "America/New_York") return -5 * 3600;
-    if (timezone == "CST" || timezone == "America/Chicago") return -6 * 3600;
-    if (timezone == "MST" || timezone == "America/Denver") return -7 * 3600;
-    if (timezone == "PST" || timezone == "America/Los_Angeles") return -8 * 3600;
+int32_t TimezoneUtils::computeOffset(const Rule& rule, time_t utcTime, time_t& from, time_t& until) {
+    if (!rule.hasDaylight) {
+        from = std::numeric_limits<time_t>::min();
+        until = std::numeric_limits<time_t>::max();
+        return rule.standardOffset;
+    }
 
-    // Asia - static offsets
-    if (timezone == "JST" || timezone == "Asia/Tokyo") return 9 * 3600;
-    if (timezone == "CST" || timezone == "Asia/Shanghai") return 8 * 3600;
-    if (timezone == "IST" || timezone == "Asia/Kolkata") return 5 * 3600 + 30 * 60;
+    // Transitions of the surrounding years; sorted they alternate, which also covers the
+    // southern hemisphere where DST spans the new year
+    int year = yearFromDays(floorDiv((int64_t)utcTime + rule.standardOffset, SECONDS_PER_DAY));
+    time_t times[6];
+    bool toDaylight[6];
+    int count = 0;
+    for (int y = year - 1; y <= year + 1; y++) {
+        times[count] = transitionTime(rule.start, y, rule.standardOffset);
+        toDaylight[count++] = true;
+        times[count] = transitionTime(rule.end, y, rule.daylightOffset);
+        toDaylight[count++] = false;
+    }
+    for (int i = 1; i < count; i++) {
+        for (int j = i; j > 0 && times[j] < times[j - 1]; j--) {
+            std::swap(times[j], times[j - 1]);
+            std::swap(toDaylight[j], toDaylight[j - 1]);
+        }
+    }
 
-    // Try to parse as GMT+/-X format
-    if (timezone.startsWith("GMT+") || timezone.startsWith("UTC+")) {
-        int hours = timezone.substring(4).toInt();
-        return hours * 3600;
+    int last = -1;
+    while (last + 1 < count && times[last + 1] <= utcTime) {
+        last++;
     }
-    if (timezone.startsWith("GMT-") || timezone.startsWith("UTC-")) {
-        int hours = timezone.substring(4).toInt();
-        return -hours * 3600;
+
+    // Before the first of six transitions cannot happen for the middle year, but stay total
+    bool daylight = last >= 0 ? toDaylight[last] : !toDaylight[0];
+    from = last >= 0 ? times[last] : std::numeric_limits<time_t>::min();
+    until = last + 1 < count ? times[last + 1] : std::numeric_limits<time_t>::max();
+    return daylight ? rule.daylightOffset : rule.standardOffset;
+}
+
+time_t TimezoneUtils::transitionTime(const Transition& transition, int year, int32_t offsetBefore) {
+    // First matching weekday of the month, then step whole weeks; week 5 is clamped to the last
+    int64_t firstDay = daysFromCivil(year, transition.month, 1);
+    int firstWeekday = (int)((firstDay % 7 + 11) % 7);  // 1970-01-01 was a Thursday
+    int day = 1 + (transition.weekday - firstWeekday + 7) % 7 + (transition.week - 1) * 7;
+    while (day > (int)daysInMonth(year, transition.month)) {
+        day -= 7;
     }
 
-    // Default to UTC if timezone is not recognized
-    LOG_INFOF("Warning: Unknown timezone '%s', defaulting to UTC\n", timezone.c_str());
-    return 0;
-}
\ No newline at end of file
+    int64_t local = (firstDay + day - 1) * SECONDS_PER_DAY + transition.time;
+    return (time_t)(local - offsetBefore);
+}
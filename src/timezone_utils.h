@@ -2,15 +2,63 @@
 #define TIMEZONE_UTILS_H
 
 #include <Arduino.h>
+#include <time.h>
 #include "logger.h"
 
+/**
+ * Timezone Utilities
+ *
+ * Zone names are resolved once into a compact POSIX-style rule: either from the built-in
+ * table of IANA names and abbreviations, a "GMT+X"/"UTC-X" offset, or a raw POSIX TZ string
+ * such as "CET-1CEST,M3.5.0,M10.5.0/3". The system timezone's current offset is cached
+ * together with the UTC interval it is valid for, so the per-frame lookup is a range check
+ * until the next DST transition.
+ */
 class TimezoneUtils {
   public:
+    // Resolve and cache the system timezone (called when the configuration is parsed)
+    static void setTimezone(const String& timezone);
+
+    // Offset of the system timezone in seconds east of UTC, now or at a given UTC time
+    static int getOffset();
+    static int getOffsetAt(time_t utcTime);
+
+    // Offset of any zone; served from the cache when it is the system timezone
     static int getTimezoneOffset(const String& timezone);
-    
+
   private:
-    // Helper function to determine DST for European timezones based on UTC time and timezone
-    static bool isDaylightSavingTimeForTimezone(const String& timezone);
+    // DST switch in POSIX "Mm.w.d/time" form, time in local seconds (may exceed 24h)
+    struct Transition {
+        uint8_t month;    // 1-12
+        uint8_t week;     // 1-5, 5 means the last such weekday of the month
+        uint8_t weekday;  // 0=Sunday
+        int32_t time;
+    };
+
+    struct Rule {
+        int32_t standardOffset = 0;  // Seconds east of UTC
+        int32_t daylightOffset = 0;
+        bool hasDaylight = false;
+        Transition start = {3, 5, 0, 7200};
+        Transition end = {10, 5, 0, 10800};
+    };
+
+    struct Cache {
+        char name[48] = "UTC";
+        Rule rule;
+        int32_t offset = 0;
+        time_t validFrom = 0;
+        time_t validUntil = 0;  // Empty interval until the first lookup
+    };
+
+    static Cache active;
+
+    static bool resolve(const char* timezone, Rule& rule);
+    static bool parsePosix(const char* spec, Rule& rule);
+
+    // Offset at utcTime and the UTC interval [from, until) it holds for
+    static int32_t computeOffset(const Rule& rule, time_t utcTime, time_t& from, time_t& until);
+    static time_t transitionTime(const Transition& transition, int year, int32_t offsetBefore);
 };
 
-#endif  // TIMEZONE_UTILS_H
\ No newline at end of file
+#endif  // TIMEZONE_UTILS_H
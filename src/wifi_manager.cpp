@@ -1,62 +1,210 @@
 #include "wifi_manager.h"
 #include "logger.h"
 #include "memory_manager.h"
-#include <WiFi.h>
+#include "metrics.h"
+#include <cstring>
+#include "cache_service.h"
 #include "config_manager.h"
+#include "config_store.h"
+#include "boot_sequencer.h"
 #include "event_manager.h"
 
 extern Config config;
 
-void WiFiManager::Setup() { WiFi.mode(WIFI_AP); }
+const char* WiFiManager::CACHE_NAMESPACE = "wifi";
+const char* WiFiManager::CACHE_ACCESS_POINT = "ap";
 
-void WiFiManager::Run() {
-    while (!config.isReady()) {
-        vTaskDelay(pdMS_TO_TICKS(1000));
+EventGroupHandle_t WiFiManager::connectionEvents = nullptr;
+WiFiManager::AccessPoint WiFiManager::accessPoint = {};
+bool WiFiManager::accessPointValid = false;
+
+namespace {
+Metrics::Id connectedMetric = Metrics::NO_METRIC;
+Metrics::Id reconnectsMetric = Metrics::NO_METRIC;
+Metrics::Id rssiMetric = Metrics::NO_METRIC;
+}  // namespace
+
+void WiFiManager::Setup() {
+    connectionEvents = xEventGroupCreate();
+    connectedMetric = Metrics::Register(Metrics::Type::GAUGE, "wifi_connected", "1 while the station has an address");
+    reconnectsMetric = Metrics::Register(Metrics::Type::COUNTER, "wifi_reconnects_total", "Connections lost");
+    rssiMetric = Metrics::Register(Metrics::Type::GAUGE, "wifi_rssi_dbm", "Signal strength of the access point");
+
+    // Reconnects are ours: no driver auto-reconnect racing the backoff, no credential writes to flash
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);
+
+    WiFi.onEvent(onWiFiEvent, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    WiFi.onEvent(onWiFiEvent, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    WiFi.onEvent(onWiFiEvent, ARDUINO_EVENT_WIFI_STA_LOST_IP);
+}
+
+void WiFiManager::onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
+    // Runs in the WiFi event task: only publish the state, the manager task does the work
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        xEventGroupClearBits(connectionEvents, DISCONNECTED_BIT);
+        xEventGroupSetBits(connectionEvents, CONNECTED_BIT);
+    } else {
+        xEventGroupClearBits(connectionEvents, CONNECTED_BIT);
+        xEventGroupSetBits(connectionEvents, DISCONNECTED_BIT);
     }
+}
 
-    // WiFiManager will request memory only when connecting (not permanently)
+void WiFiManager::Run() {
+    BootSequencer::begin(BootSequencer::Stage::WIFI);
 
-    static int attempt = 0;
-    static int attemptReconnect = 0;
+    // WiFiManager bypasses MemoryManager - WiFi connection is critical for system
+    applyStaticAddress();
+    loadAccessPoint();
 
-    EventManager::Emit(TerminalEvent(0, "WIFI", "Connecting to WiFi", TerminalEvent::State::PROCESSING));
-    static bool prevConnectedStatus = false;
+    int attempt = 0;
+    int attemptReconnect = 0;
+    uint32_t backoffMs = 0;
+    bool prevConnectedStatus = false;
     char attempt_str[255];
-    while (true) {
-        vTaskDelay(pdMS_TO_TICKS(5000));
 
+    EventManager::Emit(TerminalEvent(0, "WIFI", "Connecting to WiFi", TerminalEvent::State::PROCESSING));
+    while (true) {
         if (IsConnected()) {
             if (!prevConnectedStatus) {
                 snprintf(attempt_str, sizeof(attempt_str), "Connected to %s", config.wifi.ssid.c_str());
                 EventManager::Emit(
                     TerminalEvent(attemptReconnect, "WIFI", String(attempt_str), TerminalEvent::State::SUCCESS));
                 prevConnectedStatus = true;
+                Metrics::Set(connectedMetric, 1);
+                BootSequencer::complete(BootSequencer::Stage::WIFI);
+                saveAccessPoint();
             }
+            attempt = 0;
+            backoffMs = 0;
+
+            // Nothing to do until the driver reports the link gone
+            xEventGroupWaitBits(connectionEvents, DISCONNECTED_BIT, pdFALSE, pdFALSE, portMAX_DELAY);
             continue;
         }
 
         if (prevConnectedStatus) {
             attemptReconnect++;
             prevConnectedStatus = false;
+            Metrics::Set(connectedMetric, 0);
+            Metrics::Add(reconnectsMetric);
+            LOG_INFO("WiFi: Connection lost, reconnecting");
+        }
+
+        if (backoffMs > 0) {
+            vTaskDelay(pdMS_TO_TICKS(backoffMs));
         }
 
-        snprintf(attempt_str, sizeof(attempt_str), "%d connecting to %s", attempt, config.wifi.ssid.c_str());
+        // Fast path on the first attempt of a round: join the known access point without scanning
+        bool fast = attempt == 0 && accessPointValid;
+        snprintf(attempt_str, sizeof(attempt_str), "%d connecting to %s%s", attempt, config.wifi.ssid.c_str(),
+                 fast ? " (fast)" : "");
         EventManager::Emit(
             TerminalEvent(attemptReconnect, "WIFI", String(attempt_str), TerminalEvent::State::PROCESSING));
 
-        // WiFiManager bypasses MemoryManager - WiFi connection is critical for system
-        WiFi.begin(config.wifi.ssid, config.wifi.password);
-        vTaskDelay(pdMS_TO_TICKS(2000)); // Wait for connection attempt
+        // Events of the previous attempt arrived during the backoff; only this attempt may end the wait
+        xEventGroupClearBits(connectionEvents, DISCONNECTED_BIT);
+        if (fast) {
+            WiFi.begin(config.wifi.ssid.c_str(), config.wifi.password.c_str(), accessPoint.channel,
+                       accessPoint.bssid);
+        } else {
+            WiFi.begin(config.wifi.ssid.c_str(), config.wifi.password.c_str());
+        }
 
+        unsigned long started = millis();
+        EventBits_t bits = xEventGroupWaitBits(connectionEvents, CONNECTED_BIT | DISCONNECTED_BIT, pdFALSE, pdFALSE,
+                                               pdMS_TO_TICKS(CONNECT_TIMEOUT_MS));
+        if (bits & CONNECTED_BIT) {
+            LOG_INFOF("WiFi: Connected in %lu ms%s\n", millis() - started, fast ? " (cached access point)" : "");
+            continue;
+        }
+
+        // Abandon the attempt; a cached access point that failed is not tried again until the next success
+        WiFi.disconnect();
+        if (fast) {
+            accessPointValid = false;
+        }
         attempt++;
+        backoffMs = backoffMs == 0 ? BACKOFF_BASE_MS : backoffMs * 2;
+        if (backoffMs > BACKOFF_MAX_MS) {
+            backoffMs = BACKOFF_MAX_MS;
+        }
+        LOG_INFOF("WiFi: Attempt %d failed, next in %lu ms\n", attempt, (unsigned long)backoffMs);
     }
-    
+
     // Note: Memory is intentionally not released here as WiFi operations are continuous
 }
 
 bool WiFiManager::IsConnected() {
-    wl_status_t status = WiFi.status();
-    bool connected = (status == WL_CONNECTED);
+    if (connectionEvents == nullptr) {
+        return WiFi.status() == WL_CONNECTED;
+    }
+    return (xEventGroupGetBits(connectionEvents) & CONNECTED_BIT) != 0;
+}
+
+bool WiFiManager::WaitForConnection(TickType_t timeout) {
+    if (connectionEvents == nullptr) {
+        return IsConnected();
+    }
+    EventBits_t bits = xEventGroupWaitBits(connectionEvents, CONNECTED_BIT, pdFALSE, pdFALSE, timeout);
+    return (bits & CONNECTED_BIT) != 0;
+}
+
+void WiFiManager::PublishMetrics() {
+    Metrics::Set(rssiMetric, IsConnected() ? WiFi.RSSI() : 0);
+}
+
+void WiFiManager::loadAccessPoint() {
+    uint32_t ssidCrc = ConfigStore::crc32(config.wifi.ssid.c_str(), config.wifi.ssid.length());
+    accessPointValid = CacheService::getInstance()->get(CACHE_NAMESPACE, CACHE_ACCESS_POINT, ACCESS_POINT_VERSION,
+                                                        &accessPoint, sizeof(accessPoint)) &&
+                       accessPoint.ssidCrc == ssidCrc && accessPoint.channel != 0;
+    if (accessPointValid) {
+        LOG_INFOF("WiFi: Cached access point %02X:%02X:%02X:%02X:%02X:%02X on channel %u\n", accessPoint.bssid[0],
+                  accessPoint.bssid[1], accessPoint.bssid[2], accessPoint.bssid[3], accessPoint.bssid[4],
+                  accessPoint.bssid[5], accessPoint.channel);
+    }
+}
+
+void WiFiManager::saveAccessPoint() {
+    const uint8_t* bssid = WiFi.BSSID();
+    int32_t channel = WiFi.channel();
+    if (bssid == nullptr || channel <= 0) {
+        return;
+    }
+
+    AccessPoint current = {};
+    current.ssidCrc = ConfigStore::crc32(config.wifi.ssid.c_str(), config.wifi.ssid.length());
+    memcpy(current.bssid, bssid, sizeof(current.bssid));
+    current.channel = (uint8_t)channel;
+
+    // Same access point as last time: nothing to write
+    if (accessPointValid && memcmp(&current, &accessPoint, sizeof(current)) == 0) {
+        return;
+    }
+    accessPoint = current;
+    accessPointValid = true;
+    CacheService::getInstance()->put(CACHE_NAMESPACE, CACHE_ACCESS_POINT, ACCESS_POINT_VERSION, &accessPoint,
+                                     sizeof(accessPoint), ACCESS_POINT_TTL_SECONDS);
+}
 
-    return connected;
-}
\ No newline at end of file
+void WiFiManager::applyStaticAddress() {
+    if (config.wifi.staticIp.isEmpty()) {
+        return;
+    }
+
+    IPAddress address, gateway, subnet, dns;
+    if (!address.fromString(config.wifi.staticIp) || !gateway.fromString(config.wifi.gateway) ||
+        !subnet.fromString(config.wifi.subnet)) {
+        LOG_WARNING("WiFi: Incomplete static address (static_ip, gateway, subnet), using DHCP");
+        return;
+    }
+    // DNS defaults to the gateway
+    if (!dns.fromString(config.wifi.dns)) {
+        dns = gateway;
+    }
+
+    WiFi.config(address, gateway, subnet, dns);
+    LOG_INFOF("WiFi: Static address %s\n", config.wifi.staticIp.c_str());
+}
@@ -2,18 +2,66 @@
 #define WIFI_MANAGER_H
 
 #include <Arduino.h>
+#include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
 #include "logger.h"
 
 // Forward declarations
-class WiFiClass;
 class ConfigManager;
 
+/**
+ * WiFi Station Manager
+ *
+ * Connection state comes from driver events (got IP, disconnected, lost IP) published in an
+ * event group, so IsConnected() is a bit test and tasks can block in WaitForConnection()
+ * instead of polling. The manager task sleeps while the link is up and reconnects as soon as
+ * it drops: the first attempt goes straight to the last access point (BSSID and channel cached
+ * through CacheService, skipping the scan), later attempts scan and back off exponentially.
+ * An optional static address in [wifi] skips DHCP.
+ */
 class WiFiManager {
   private:
+    // Time given to one WiFi.begin() attempt before retrying
+    static const int CONNECT_TIMEOUT_MS = 7000;
+    static const uint32_t BACKOFF_BASE_MS = 500;
+    static const uint32_t BACKOFF_MAX_MS = 30000;
+    static const uint32_t ACCESS_POINT_TTL_SECONDS = 30 * 24 * 60 * 60;
+
+    static const EventBits_t CONNECTED_BIT = 1u << 0;
+    static const EventBits_t DISCONNECTED_BIT = 1u << 1;
+
+    // Last access point joined, valid only for the SSID it was cached for
+    struct AccessPoint {
+        uint32_t ssidCrc;
+        uint8_t bssid[6];
+        uint8_t channel;
+        uint8_t reserved;
+    };
+
+    static const char* CACHE_NAMESPACE;
+    static const char* CACHE_ACCESS_POINT;
+    static const uint16_t ACCESS_POINT_VERSION = 1;
+
+    static EventGroupHandle_t connectionEvents;
+    static AccessPoint accessPoint;
+    static bool accessPointValid;
+
+    static void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info);
+    static void loadAccessPoint();
+    static void saveAccessPoint();
+    static void applyStaticAddress();
+
   public:
     static void Setup();
     static void Run();
     static bool IsConnected();
+
+    // Block until the station has an IP address; false on timeout
+    static bool WaitForConnection(TickType_t timeout = portMAX_DELAY);
+
+    // Signal strength gauge of the metrics registry, called from the system monitor
+    static void PublishMetrics();
 };
 
-#endif  // WIFI_MANAGER_H
\ No newline at end of file
+#endif  // WIFI_MANAGER_H